@@ -13,7 +13,29 @@
 #include "DX/DXContext.h"
 #include "DX/DXQuery.h"
 #include "core/GPUCapture.h"
+#include "core/SPSCQueue.h"
+#include "core/DynamicResolution.h"
+#include "core/AnomalyDetector.h"
+#include "core/TextureCompression.h"
+#include "core/AllocationCounter.h"
+#include "core/JobSystem.h"
 #include "DX/PSO.h"
+#include "DX/DXProfiler.h"
+#include "DX/DXShaderDebug.h"
+#include "DX/DXBundle.h"
+#include "DX/DXHotReload.h"
+#include "DX/DXStreamer.h"
+#include "DX/DXScreenCapture.h"
+#include "DX/ShaderPermutation.h"
+#include "DX/ShaderManifest.h"
+#include "DX/DXShaderBindings.h"
+#include "shaders/generated/SharedLayoutsBindings.h"
+#include "shaders/generated/ComputeShaderBindings.h"
+#include "shaders/generated/CullInstancesShaderBindings.h"
+#include "shaders/generated/VertexShaderBindings.h"
+#include "shaders/generated/UpsampleShaderBindings.h"
+#include "shaders/generated/GenerateMipsShaderBindings.h"
+#include "shaders/generated/CompressBCShaderBindings.h"
 
 #include <pix3.h>
 
@@ -21,54 +43,273 @@ AGILITY_SDK_DECLARE()
 
 DISABLE_OPTIMISATIONS()
 #include <chrono>
-std::chrono::steady_clock::time_point start_time;
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <optional>
 
 #pragma region GRAPHICS
 struct ComputeResources
 {
 	// Compute
-	Shader m_compute_shader;
-	RootSignature m_compute_root_signature;
-	PSO m_pso;
+	ShaderPermutations m_permutations;
+	// Indexed by permutation key, all built ahead of time so switching is free, pruned ones stay empty
+	std::vector<ShaderPipeline> m_pipelines;
+	ShaderPermutationKey m_key = 0;
+
+	// Dynamic resolution, the permutation renders at the scale and is upscaled to the output size
+	ShaderPipeline m_upsample_pipeline;
+	DynamicResolutionController m_dynamic_resolution;
+	bool m_dynamic_resolution_enabled = true;
+	float32 m_resolution_scale = 1.0f;
+
+	// Print and Assert records of the compute shaders
+	ShaderDebugChannel m_shader_debug;
+};
+
+// Timestamp scopes recorded every frame
+enum class GPUScope : uint32
+{
+	Compute = 0,
+	Upsample,
+	Cull,
+	Draw,
+	Count
+};
+
+static const std::vector<std::string> g_gpu_scope_names =
+{
+	"Compute",
+	"Upsample",
+	"Cull",
+	"Draw",
 };
 
 void ComputeWork
 (
 	DXContext& dx_context, 
 	ComputeResources& compute_resource, 
-	DXWindow& dx_window,
-	DXResource& output_resource
+	DXResource& output_resource,
+	GPUProfiler& gpu_profiler,
+	float32 time_seconds,
+	uint32 frame_index
 );
 
 void CreateComputeResources(DXContext& dx_context, const DXCompiler& dx_compiler, ComputeResources& resource);
 
+// Keep in sync with D3D12_DRAW_ARGUMENTS in CullInstancesShader.hlsl
+static const uint32 g_draw_arguments_size = sizeof(D3D12_DRAW_ARGUMENTS);
+
 struct GraphicsResources
 {
 	// Graphics
 	// Persistent resource
 	DXVertexBufferResource m_vertex_buffer;
+	DXResource m_instance_buffer;
+	uint32 m_instance_count;
+	// Persistent views so the indices captured by the draw bundle stay valid across frames
+	SRV m_vertex_srv;
+	SRV m_instance_srv;
 	Shader m_vertex_shader;
 	Shader m_pixel_shader;
 	RootSignature m_gfx_root_signature;
 	PSO m_pso;
+
+	// GPU driven culling
+	// Compute pass culls m_instance_buffer, compacts the survivors in m_visible_instance_buffer
+	// and writes their count in m_draw_args_buffer consumed by ExecuteIndirect
+	DXResource m_visible_instance_buffer;
+	SRV m_visible_srv;
+	DXResource m_draw_args_buffer;
+	DXResource m_draw_args_readback_buffer;
+	bool m_draw_args_written[g_backbuffer_count];
+	ComPtr<ID3D12CommandSignature> m_draw_command_signature;
+	Shader m_cull_shader;
+	RootSignature m_cull_root_signature;
+	PSO m_cull_pso;
+
+	// Draw sequence recorded once, replayed until one of its inputs changes
+	DXBundle m_draw_bundle;
+	bool m_use_bundle = true;
+
+	bool m_gpu_driven = false;
+	// Number of DrawInstanced the instances are split in, when not GPU driven
+	uint32 m_draw_count = 1;
+	float32 m_view_offset[2] = { 0.0f, 0.0f };
+	float32 m_view_scale = 1.0f;
+	// Instances drawn by the frame that last used the current backbuffer index
+	uint32 m_drawn_instance_count = 0;
 };
 
-void CreateGraphicsResources
+// Blocking upload through a temporary upload buffer, only meant for resource creation
+void UploadBuffer
 (
-	DXContext& dx_context, const DXCompiler& dx_compiler, const DXWindow& dx_window,
-	GraphicsResources& resource
+	DXContext& dx_context, 
+	DXResource& destination, 
+	const void* source, uint64 size_in_bytes,
+	D3D12_RESOURCE_STATES final_resource_state
 )
 {
-	resource.m_vertex_shader = dx_compiler.Compile(dx_context.GetDevice(), { ShaderType::VERTEX_SHADER, "VertexShader.hlsl", "main" });
-	resource.m_pixel_shader = dx_compiler.Compile(dx_context.GetDevice(), {ShaderType::PIXEL_SHADER, "PixelShader.hlsl", "main" });
+	DXResource upload_buffer{};
+	upload_buffer.SetResourceInfo(D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_FLAG_NONE, size_in_bytes);
+	// Needs to start in COMMON for buffers
+	upload_buffer.CreateResource(dx_context, "UploadBuffer");
+
+	void* data = nullptr;
+	upload_buffer.m_resource->Map(0, nullptr, &data) >> CHK;
+	memcpy(data, source, size_in_bytes);
+	upload_buffer.m_resource->Unmap(0, nullptr);
+	dx_context.InitCommandLists();
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, upload_buffer);
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, destination);
+	dx_context.GetCommandListGraphics()->CopyBufferRegion(destination.m_resource.Get(), 0, upload_buffer.m_resource.Get(), 0, size_in_bytes);
+	dx_context.Transition(final_resource_state, destination);
+	// Copy queue has some constraints regarding copy state and barriers
+	// Compute has synchronization issue
+	dx_context.ExecuteCommandListGraphics();
+	dx_context.Flush(1);
+}
 
+// Square grid with 0.5 spacing centered on the origin
+// 16 instances gives the original 4x4 layout
+std::vector<InstanceTransform> GenerateInstanceGrid(uint32 instance_count)
+{
+	const uint32 side = (uint32)std::ceil(std::sqrt((float64)instance_count));
+	const float32 spacing = 0.5f;
+	const float32 half_extent = (side - 1) * 0.5f;
+	std::vector<InstanceTransform> instances(instance_count);
+	for (uint32 i = 0; i < instance_count; ++i)
 	{
-		struct Vertex
+		instances[i] =
 		{
-			float2 position;
-			float3 color;
+			.position = { ((i % side) - half_extent) * spacing, ((i / side) - half_extent) * spacing },
+			.scale = 1.0f / 6.0f,
+			.padding = 0.0f,
 		};
+	}
+	return instances;
+}
+
+// Shaders: cull CS
+bool BuildCullPipeline(DXContext& dx_context, ShaderPipeline& pipeline)
+{
+	const Shader& cull_shader = pipeline.m_shaders[0];
+	pipeline.m_root_signature = dx_context.CreateRS(cull_shader);
+
+	ComputePipelineStream stream
+	{
+		.m_root_signature = pipeline.m_root_signature.m_signature.Get(),
+		.m_cs = BlobToByteCode(cull_shader.m_blob),
+	};
+	const D3D12_PIPELINE_STATE_STREAM_DESC stream_desc{ sizeof(stream), &stream };
+	return TryCreatePSO(dx_context, stream_desc, GetPipelineCacheKey(pipeline.m_shaders, nullptr, 0), "CullInstances", pipeline.m_pso);
+}
+
+void SwapCullPipeline(GraphicsResources& resource, ShaderPipeline& pipeline)
+{
+	std::swap(resource.m_cull_shader, pipeline.m_shaders[0]);
+	std::swap(resource.m_cull_root_signature, pipeline.m_root_signature);
+	std::swap(resource.m_cull_pso, pipeline.m_pso);
+}
+
+void CreateCullResources(DXContext& dx_context, const Shader& cull_shader, GraphicsResources& resource)
+{
+	ShaderPipeline pipeline{ .m_shaders = { cull_shader } };
+	bool success = BuildCullPipeline(dx_context, pipeline);
+	ASSERT(success);
+	SwapCullPipeline(resource, pipeline);
+
+	resource.m_visible_instance_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, resource.m_instance_count * sizeof(uint32));
+	resource.m_visible_instance_buffer.CreateResource(dx_context, "Visible Instance Buffer");
+	resource.m_visible_srv = dx_context.CreateSRV(resource.m_visible_instance_buffer, GetStructuredBufferSRVDesc(resource.m_instance_count, sizeof(uint32)), DescriptorLifetime::Persistent);
+
+	resource.m_draw_args_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, g_draw_arguments_size);
+	resource.m_draw_args_buffer.CreateResource(dx_context, "Draw Arguments Buffer");
+
+	// One slot per backbuffer to read the drawn instance count without stalling
+	resource.m_draw_args_readback_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, g_backbuffer_count * g_draw_arguments_size);
+	resource.m_draw_args_readback_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+	resource.m_draw_args_readback_buffer.CreateResource(dx_context, "Draw Arguments Readback");
+	memset(resource.m_draw_args_written, 0, sizeof(resource.m_draw_args_written));
+
+	// Only draw arguments, no root signature needed
+	D3D12_INDIRECT_ARGUMENT_DESC argument_descs[] =
+	{
+		{
+			.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW,
+		}
+	};
+	D3D12_COMMAND_SIGNATURE_DESC command_signature_desc
+	{
+		.ByteStride = g_draw_arguments_size,
+		.NumArgumentDescs = COUNT(argument_descs),
+		.pArgumentDescs = argument_descs,
+		.NodeMask = 0,
+	};
+	dx_context.GetDevice()->CreateCommandSignature(&command_signature_desc, nullptr, IID_PPV_ARGS(&resource.m_draw_command_signature)) >> CHK;
+	NAME_DX_OBJECT(resource.m_draw_command_signature, "Draw Command Signature");
+}
+
+// Shaders: VS, PS
+bool BuildGraphicsPipeline(DXContext& dx_context, DXGI_FORMAT render_target_format, ShaderPipeline& pipeline)
+{
+	const Shader& vertex_shader = pipeline.m_shaders[0];
+	const Shader& pixel_shader = pipeline.m_shaders[1];
+
+	// Same rootsignature for VS and PS
+	pipeline.m_root_signature = dx_context.CreateRS(pixel_shader);
+	
+	D3D12_RT_FORMAT_ARRAY render_target_formats{};
+	render_target_formats.NumRenderTargets = 1;
+	render_target_formats.RTFormats[0] = render_target_format;
+	GraphicsPipelineStream stream
+	{
+		.m_root_signature = pipeline.m_root_signature.m_signature.Get(),
+		.m_vs = BlobToByteCode(vertex_shader.m_blob),
+		.m_ps = BlobToByteCode(pixel_shader.m_blob),
+		.m_topology = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+		.m_render_target_formats = render_target_formats,
+	};
+	const D3D12_PIPELINE_STATE_STREAM_DESC stream_desc{ sizeof(stream), &stream };
+
+	// Root signature is embedded in the bytecode, only the fixed function state needs to be described
+	struct GraphicsPipelineDescription
+	{
+		D3D12_PRIMITIVE_TOPOLOGY_TYPE topology;
+		DXGI_FORMAT render_target_format;
+	} description{ D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE, render_target_format };
+	const uint64 cache_key = GetPipelineCacheKey(pipeline.m_shaders, &description, sizeof(description));
+	return TryCreatePSO(dx_context, stream_desc, cache_key, "Graphics", pipeline.m_pso);
+}
+
+void SwapGraphicsPipeline(GraphicsResources& resource, ShaderPipeline& pipeline)
+{
+	std::swap(resource.m_vertex_shader, pipeline.m_shaders[0]);
+	std::swap(resource.m_pixel_shader, pipeline.m_shaders[1]);
+	std::swap(resource.m_gfx_root_signature, pipeline.m_root_signature);
+	// New pipeline state invalidates the draw bundle through its key
+	std::swap(resource.m_pso, pipeline.m_pso);
+}
+
+void CreateGraphicsResources
+(
+	DXContext& dx_context, const DXCompiler& dx_compiler, DXGI_FORMAT render_target_format,
+	uint32 instance_count,
+	GraphicsResources& resource
+)
+{
+	// Compiles in the background while the buffers are uploaded
+	std::vector<std::future<Shader>> shaders = dx_compiler.CompileAsync
+	(
+		dx_context.GetDevice(),
+		{
+			{ ShaderType::VERTEX_SHADER, "VertexShader.hlsl", "main" },
+			{ ShaderType::PIXEL_SHADER, "PixelShader.hlsl", "main" },
+			{ ShaderType::COMPUTE_SHADER, "CullInstancesShader.hlsl", "main" },
+		}
+	);
 
+	{
 		const Vertex vertex_data[] =
 		{
 			{ {0.0f, +0.25f}, {1.0f, 0.0f, 0.0f} },
@@ -78,76 +319,156 @@ void CreateGraphicsResources
 
 		resource.m_vertex_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE, sizeof(vertex_data), sizeof(vertex_data[0]));
 		resource.m_vertex_buffer.CreateResource(dx_context, "VertexBuffer");
+		UploadBuffer(dx_context, resource.m_vertex_buffer, vertex_data, sizeof(vertex_data), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+		resource.m_vertex_srv = dx_context.CreateSRV(resource.m_vertex_buffer, GetStructuredBufferSRVDesc(resource.m_vertex_buffer.m_count, resource.m_vertex_buffer.m_stride), DescriptorLifetime::Persistent);
+
+		resource.m_instance_count = instance_count;
+		const std::vector<InstanceTransform> instances = GenerateInstanceGrid(instance_count);
+		const uint64 instances_size = instances.size() * sizeof(InstanceTransform);
+		resource.m_instance_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE, instances_size);
+		resource.m_instance_buffer.CreateResource(dx_context, "InstanceBuffer");
+		UploadBuffer(dx_context, resource.m_instance_buffer, instances.data(), instances_size, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+		resource.m_instance_srv = dx_context.CreateSRV(resource.m_instance_buffer, GetStructuredBufferSRVDesc(resource.m_instance_count, sizeof(InstanceTransform)), DescriptorLifetime::Persistent);
+
+		ShaderPipeline pipeline{ .m_shaders = { shaders[0].get(), shaders[1].get() } };
+		bool success = BuildGraphicsPipeline(dx_context, render_target_format, pipeline);
+		ASSERT(success);
+		SwapGraphicsPipeline(resource, pipeline);
+	}
 
-		DXResource vertex_upload_buffer{};
-		vertex_upload_buffer.SetResourceInfo(D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_FLAG_NONE, sizeof(vertex_data));
-		// Needs to start in COMMON for buffers
-		vertex_upload_buffer.CreateResource(dx_context, "VertexUploadBuffer");
+	CreateCullResources(dx_context, shaders[2].get(), resource);
+	resource.m_draw_bundle.Init(dx_context, "Draw Bundle");
+}
 
-		Vertex* data = nullptr;
-		vertex_upload_buffer.m_resource->Map(0, nullptr, reinterpret_cast<void**>(&data)) >> CHK;
-		memcpy(data, vertex_data, sizeof(vertex_data));
-		vertex_upload_buffer.m_resource->Unmap(0, nullptr);
-		dx_context.InitCommandLists();
-		dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, vertex_upload_buffer);
-		dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, resource.m_vertex_buffer);
-		dx_context.GetCommandListGraphics()->CopyResource(resource.m_vertex_buffer.m_resource.Get(), vertex_upload_buffer.m_resource.Get());
-		dx_context.Transition(D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, resource.m_vertex_buffer);
-		// Copy queue has some constraints regarding copy state and barriers
-		// Compute has synchronization issue
-		dx_context.ExecuteCommandListGraphics();
-		dx_context.Flush(1);
+// Compute pass writing the visible instance list and the indirect draw arguments
+void CullInstances
+(
+	DXContext& dx_context, 
+	GraphicsResources& resource,
+	GPUProfiler& gpu_profiler
+)
+{
+	gpu_profiler.BeginScope(dx_context, static_cast<uint32>(GPUScope::Cull));
+
+	// Reset arguments, InstanceCount gets accumulated by the culling pass
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, resource.m_draw_args_buffer);
+	const D3D12_GPU_VIRTUAL_ADDRESS draw_args_address = resource.m_draw_args_buffer.m_resource->GetGPUVirtualAddress();
+	D3D12_WRITEBUFFERIMMEDIATE_PARAMETER draw_args_reset[] =
+	{
+		{ draw_args_address + offsetof(D3D12_DRAW_ARGUMENTS, VertexCountPerInstance), resource.m_vertex_buffer.m_count },
+		{ draw_args_address + offsetof(D3D12_DRAW_ARGUMENTS, InstanceCount), 0 },
+		{ draw_args_address + offsetof(D3D12_DRAW_ARGUMENTS, StartVertexLocation), 0 },
+		{ draw_args_address + offsetof(D3D12_DRAW_ARGUMENTS, StartInstanceLocation), 0 },
+	};
+	dx_context.GetCommandListGraphics()->WriteBufferImmediate(COUNT(draw_args_reset), draw_args_reset, nullptr);
+
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, resource.m_draw_args_buffer);
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, resource.m_visible_instance_buffer);
+
+	UAV visible_uav = dx_context.CreateUAV(resource.m_visible_instance_buffer, GetStructuredBufferUAVDesc(resource.m_instance_count, sizeof(uint32)));
+	UAV draw_args_uav = dx_context.CreateUAV(resource.m_draw_args_buffer, GetByteBufferUAVDesc(g_draw_arguments_size));
+
+	CullConstants constants
+	{
+		.instance_count = resource.m_instance_count,
+		.instance_bindless_index = resource.m_instance_srv.m_bindless_index,
+		.visible_bindless_index = visible_uav.m_bindless_index,
+		.draw_args_bindless_index = draw_args_uav.m_bindless_index,
+		.view_offset = { resource.m_view_offset[0], resource.m_view_offset[1] },
+		.view_scale = resource.m_view_scale,
+		// Roughly a pixel on a 1080p target
+		.min_radius = 1.0f / 1080.0f,
+	};
+
+	SetPSO(dx_context.GetCommandListGraphics().Get(), resource.m_cull_pso);
+	dx_context.GetCommandListGraphics()->SetComputeRootSignature(resource.m_cull_root_signature.m_signature.Get());
+	SetComputeRootConstants(dx_context.GetCommandListGraphics().Get(), constants);
+	dx_context.GetCommandListGraphics()->Dispatch(DivideRoundUp(resource.m_instance_count, 64), 1, 1);
+
+	dx_context.Transition(D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, resource.m_draw_args_buffer);
+	dx_context.Transition(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, resource.m_visible_instance_buffer);
+
+	gpu_profiler.EndScope(dx_context, static_cast<uint32>(GPUScope::Cull));
+}
+
+// Reads the drawn instance count of the frame that last used the current backbuffer index
+void ReadbackDrawnInstances(GraphicsResources& resource)
+{
+	if (!resource.m_draw_args_written[g_current_buffer_index])
+	{
+		resource.m_drawn_instance_count = resource.m_instance_count;
+		return;
+	}
+	const uint64 slot_offset = g_current_buffer_index * g_draw_arguments_size;
+	const D3D12_RANGE range = { slot_offset, slot_offset + g_draw_arguments_size };
+	uint8* data = nullptr;
+	resource.m_draw_args_readback_buffer.m_resource->Map(0, &range, reinterpret_cast<void**>(&data)) >> CHK;
+	const D3D12_DRAW_ARGUMENTS* draw_args = reinterpret_cast<const D3D12_DRAW_ARGUMENTS*>(data + slot_offset);
+	resource.m_drawn_instance_count = draw_args->InstanceCount;
+	const D3D12_RANGE write_range = { 0, 0 };
+	resource.m_draw_args_readback_buffer.m_resource->Unmap(0, &write_range);
+	resource.m_draw_args_written[g_current_buffer_index] = false;
+}
+
+// Everything RecordDraw captures, the draw bundle is re-recorded when any of it changes
+// Zeroed before filled since it is compared bytewise
+struct DrawBundleKey
+{
+	ID3D12PipelineState* pipeline_state;
+	ID3D12RootSignature* root_signature;
+	DrawConstants constants;
+	uint32 vertex_count;
+	uint32 instance_count;
+	uint32 draw_count;
+	uint32 gpu_driven;
+};
+
+DrawBundleKey GetDrawBundleKey(const GraphicsResources& resource, const DrawConstants& constants)
+{
+	DrawBundleKey key;
+	memset(&key, 0, sizeof(key));
+	key.pipeline_state = resource.m_pso.m_pipeline_state.Get();
+	key.root_signature = resource.m_gfx_root_signature.m_signature.Get();
+	key.constants = constants;
+	key.vertex_count = resource.m_vertex_buffer.m_count;
+	key.instance_count = resource.m_instance_count;
+	key.draw_count = resource.m_draw_count;
+	key.gpu_driven = resource.m_gpu_driven;
+	return key;
+}
+
+// Draw sequence of the triangle grid, recorded either in a bundle or directly in the commandlist
+void RecordDraw(ID3D12GraphicsCommandList10* command_list, const GraphicsResources& resource, const DrawConstants& constants)
+{
+	command_list->SetGraphicsRootSignature(resource.m_gfx_root_signature.m_signature.Get());
 
-		// Same rootsignature for VS and PS
-		resource.m_gfx_root_signature = dx_context.CreateRS(resource.m_pixel_shader);
-		
-		std::string graphics_name { "Graphics" };
-		std::wstring graphics_wname = std::to_wstring(graphics_name);
-
-		// Need to export entry point with generic program
-		// Entry point needs to be differentiate between VS and PS
-		std::wstring common_entrypoint = L"main";
-		std::wstring vertexshader_entrypoint = L"mainVS";
-		std::wstring pixelshader_entrypoint = L"mainPS";
-
-		CD3DX12_STATE_OBJECT_DESC cstate_object_desc;
-		cstate_object_desc.SetStateObjectType(D3D12_STATE_OBJECT_TYPE_EXECUTABLE);
-
-		CD3DX12_DXIL_LIBRARY_SUBOBJECT* vs_subobj = cstate_object_desc.CreateSubobject<CD3DX12_DXIL_LIBRARY_SUBOBJECT>();
-		D3D12_SHADER_BYTECODE vs_byte_code = BlobToByteCode(resource.m_vertex_shader.m_blob);
-		vs_subobj->SetDXILLibrary(&vs_byte_code);
-		vs_subobj->DefineExport(vertexshader_entrypoint.c_str(), common_entrypoint.c_str());
-
-		CD3DX12_DXIL_LIBRARY_SUBOBJECT* ps_subobj = cstate_object_desc.CreateSubobject<CD3DX12_DXIL_LIBRARY_SUBOBJECT>();
-		D3D12_SHADER_BYTECODE ps_byte_code = BlobToByteCode(resource.m_pixel_shader.m_blob);
-		ps_subobj->SetDXILLibrary(&ps_byte_code);
-		ps_subobj->DefineExport(pixelshader_entrypoint.c_str(), common_entrypoint.c_str());
-		
-		CD3DX12_PRIMITIVE_TOPOLOGY_SUBOBJECT* topology_subobj = cstate_object_desc.CreateSubobject<CD3DX12_PRIMITIVE_TOPOLOGY_SUBOBJECT>();
-		topology_subobj->SetPrimitiveTopologyType(D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE);
-		CD3DX12_RENDER_TARGET_FORMATS_SUBOBJECT* rt_subobj = cstate_object_desc.CreateSubobject<CD3DX12_RENDER_TARGET_FORMATS_SUBOBJECT>();
-		rt_subobj->SetNumRenderTargets(1);
-		rt_subobj->SetRenderTargetFormat(0, dx_window.GetFormat());
-
-		CD3DX12_GENERIC_PROGRAM_SUBOBJECT* generic_subobj = cstate_object_desc.CreateSubobject<CD3DX12_GENERIC_PROGRAM_SUBOBJECT>();
-		generic_subobj->SetProgramName(graphics_wname.c_str());
-		generic_subobj->AddExport(vertexshader_entrypoint.c_str());
-		generic_subobj->AddExport(pixelshader_entrypoint.c_str());
-		generic_subobj->AddSubobject(*topology_subobj);
-		generic_subobj->AddSubobject(*rt_subobj);
-		// Seem like the SO still need RS, even when its embedded in the shader, in contrast to PSO
-		CD3DX12_GLOBAL_ROOT_SIGNATURE_SUBOBJECT* global_rootsignature_subobj = cstate_object_desc.CreateSubobject<CD3DX12_GLOBAL_ROOT_SIGNATURE_SUBOBJECT>();
-		global_rootsignature_subobj->SetRootSignature(resource.m_gfx_root_signature.m_signature.Get());
-		// TODO: CD3DX12 cause PIX to fail on CreateSO
-		resource.m_pso = CreatePSO(dx_context, cstate_object_desc, graphics_name);
+	SetPSO(command_list, resource.m_pso);
+	SetGraphicsRootConstants(command_list, constants);
+	command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	if (resource.m_gpu_driven)
+	{
+		command_list->ExecuteIndirect(resource.m_draw_command_signature.Get(), 1, resource.m_draw_args_buffer.m_resource.Get(), 0, nullptr, 0);
+	}
+	else
+	{
+		// Brute force, rasterizer clips whatever is outside
+		const uint32 instances_per_draw = DivideRoundUp(resource.m_instance_count, resource.m_draw_count);
+		for (uint32 instance_offset = 0; instance_offset < resource.m_instance_count; instance_offset += instances_per_draw)
+		{
+			const uint32 instance_count = (std::min)(instances_per_draw, resource.m_instance_count - instance_offset);
+			command_list->SetGraphicsRoot32BitConstant(DrawConstants::g_root_parameter_index, instance_offset, offsetof(DrawConstants, instance_offset) / 4);
+			command_list->DrawInstanced(resource.m_vertex_buffer.m_count, instance_count, 0, 0);
+		}
 	}
 }
 
 void GraphicsWork
 (
-	DXContext& dx_context, DXWindow& dx_window, 
+	DXContext& dx_context,
 	GraphicsResources& resource, 
-	DXTextureResource& output_resource
+	DXTextureResource& output_resource,
+	GPUProfiler& gpu_profiler
 )
 {
 	// Draw Work
@@ -157,8 +478,8 @@ void GraphicsWork
 			{
 				.TopLeftX = 0,
 				.TopLeftY = 0,
-				.Width = (float)dx_window.GetWidth(),
-				.Height = (float)dx_window.GetHeight(),
+				.Width = (float)output_resource.m_width,
+				.Height = (float)output_resource.m_height,
 				.MinDepth = 0,
 				.MaxDepth = 1,
 			}
@@ -168,32 +489,18 @@ void GraphicsWork
 			{
 				.left = 0,
 				.top = 0,
-				.right = (long)dx_window.GetWidth(),
-				.bottom = (long)dx_window.GetHeight(),
+				.right = (long)output_resource.m_width,
+				.bottom = (long)output_resource.m_height,
 			}
 		};
 		dx_context.GetCommandListGraphics()->RSSetViewports(1, view_ports);
 		dx_context.GetCommandListGraphics()->RSSetScissorRects(1, scissor_rects);
-		
-		D3D12_SHADER_RESOURCE_VIEW_DESC desc = GetStructuredBufferSRVDesc(resource.m_vertex_buffer.m_count, resource.m_vertex_buffer.m_stride);
-		SRV srv = dx_context.CreateSRV(resource.m_vertex_buffer, desc);
-
-		dx_context.GetCommandListGraphics()->SetGraphicsRootSignature(resource.m_gfx_root_signature.m_signature.Get());
 
-		D3D12_SET_PROGRAM_DESC program_desc
+		if (resource.m_gpu_driven)
 		{
-			.Type = D3D12_PROGRAM_TYPE_GENERIC_PIPELINE,
-			.GenericPipeline =
-			{
-				.ProgramIdentifier = resource.m_pso.m_program_id,
-			},
-		};
-		dx_context.GetCommandListGraphics()->SetProgram(&program_desc);
-		uint32 bindless_index = srv.m_bindless_index;
-		dx_context.GetCommandListGraphics()->SetGraphicsRoot32BitConstants(0, 1, &bindless_index, 0);
-		dx_context.GetCommandListGraphics()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		// transition
-		
+			CullInstances(dx_context, resource, gpu_profiler);
+		}
+
 		dx_context.Transition(D3D12_RESOURCE_STATE_RENDER_TARGET, output_resource);
 		D3D12_RENDER_TARGET_VIEW_DESC rtv_desc
 		{
@@ -207,24 +514,104 @@ void GraphicsWork
 		};
 		ID3D12Resource* d3d12_ouput_resource = output_resource.m_resource.Get();
 		dx_context.OMSetRenderTargets(1, &d3d12_ouput_resource, &rtv_desc, nullptr, nullptr);
-		dx_context.GetCommandListGraphics()->DrawInstanced(resource.m_vertex_buffer.m_count, 16, 0, 0);
+
+		DrawConstants constants
+		{
+			.bindless_index = resource.m_vertex_srv.m_bindless_index,
+			.instance_bindless_index = resource.m_instance_srv.m_bindless_index,
+			.view_offset = { resource.m_view_offset[0], resource.m_view_offset[1] },
+			// Unbound visible list draws every instance
+			.visible_bindless_index = resource.m_gpu_driven ? resource.m_visible_srv.m_bindless_index : SRV{}.m_bindless_index,
+			.view_scale = resource.m_view_scale,
+			.instance_offset = 0,
+		};
+
+		gpu_profiler.BeginScope(dx_context, static_cast<uint32>(GPUScope::Draw));
+		if (resource.m_use_bundle)
+		{
+			// Viewport, scissor and render target are not allowed in a bundle, they stay on the commandlist
+			DrawBundleKey key = GetDrawBundleKey(resource, constants);
+			resource.m_draw_bundle.Execute
+			(
+				dx_context, key, 
+				[&](ID3D12GraphicsCommandList10* command_list) { RecordDraw(command_list, resource, constants); }
+			);
+		}
+		else
+		{
+			RecordDraw(dx_context.GetCommandListGraphics().Get(), resource, constants);
+		}
+		gpu_profiler.EndScope(dx_context, static_cast<uint32>(GPUScope::Draw));
 		//dx_context.GetCommandListGraphics()->DrawInstanced(3, 1, 0, 0);
 		//dx_context.GetCommandListGraphics()->DrawIndexedInstanced(3, 1, 0, 0, 0);
+
+		if (resource.m_gpu_driven)
+		{
+			dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, resource.m_draw_args_buffer);
+			dx_context.GetCommandListGraphics()->CopyBufferRegion
+			(
+				resource.m_draw_args_readback_buffer.m_resource.Get(), g_current_buffer_index * g_draw_arguments_size,
+				resource.m_draw_args_buffer.m_resource.Get(), 0, g_draw_arguments_size
+			);
+			resource.m_draw_args_written[g_current_buffer_index] = true;
+		}
 	}
 }
 
+// Everything the render thread needs from the main thread for one frame, never modified once queued
+struct FrameSnapshot
+{
+	float32 m_time_seconds = 0.0f;
+	uint32 m_frame_index = 0;
+	WindowSnapshot m_window{};
+	bool m_capture = false;
+	// Last snapshot, the render thread exits without rendering it
+	bool m_quit = false;
+};
+
+// Frames the main thread can run ahead of the render thread
+static const uint32 g_frame_queue_size = 2;
+
+// Point of the frame copied by the screen capture
+enum class CapturePoint : uint32
+{
+	// Compute output in the back buffer, before the instances and the UI are drawn over it
+	Compute,
+	BackBuffer,
+	Count
+};
+
+static const char* g_capture_point_names[] = { "Compute output", "Back buffer" };
+static_assert(std::size(g_capture_point_names) == static_cast<uint32>(CapturePoint::Count));
+
+struct CaptureResources
+{
+	ScreenCapture m_screen_capture;
+	CapturePoint m_point = CapturePoint::BackBuffer;
+	// Used by the next sequence started
+	float32 m_sequence_frames_per_second = 30.0f;
+};
+
 void FillCommandList
 (
 	DXContext& dx_context, DXWindow& dx_window, 
 	GraphicsResources& gfx_resource,
-	ComputeResources& compute_resource
+	ComputeResources& compute_resource,
+	CaptureResources& capture_resource,
+	GPUProfiler& gpu_profiler,
+	const FrameSnapshot& frame
 )
 {
 	// Set descriptor heap before root signature, order required by spec
 	dx_context.GetCommandListGraphics()->SetDescriptorHeaps(1, dx_context.m_resources_descriptor_heap.m_heap.GetAddressOf());
 	{
-		ComputeWork(dx_context, compute_resource, dx_window, dx_window.m_buffers[g_current_buffer_index]);
-		GraphicsWork(dx_context, dx_window, gfx_resource, dx_window.m_buffers[g_current_buffer_index]);
+		compute_resource.m_shader_debug.Begin(dx_context);
+		ComputeWork(dx_context, compute_resource, dx_window.m_buffers[g_current_buffer_index], gpu_profiler, frame.m_time_seconds, frame.m_frame_index);
+		if (capture_resource.m_point == CapturePoint::Compute)
+		{
+			capture_resource.m_screen_capture.Record(dx_context, dx_window.m_buffers[g_current_buffer_index], frame.m_time_seconds);
+		}
+		GraphicsWork(dx_context, gfx_resource, dx_window.m_buffers[g_current_buffer_index], gpu_profiler);
 	}
 }
 
@@ -267,13 +654,119 @@ public:
 		);
 	}
 
-	void ImGUI(DXContext& dx_context)
+	void ImGUI(DXContext& dx_context, GraphicsResources& gfx_resource, ComputeResources& compute_resource, CaptureResources& capture_resource, const GPUProfiler& gpu_profiler, uint64 frame_allocation_count)
 	{
 		ImGui::ShowDemoWindow(); // Show demo window! :)
 		auto [bytes_used, bytes_budget] = GetVRAM(dx_context.m_adapter);
 		ImGui::Text("VRAM usage: %d MB / %d MB", ToMB(bytes_used), ToMB(bytes_budget));
 		auto [system_bytes_used, system_bytes_budget] = GetSystemRAM(dx_context.m_adapter);
 		ImGui::Text("System RAM usage: %d MB / %d MB", ToMB(system_bytes_used), ToMB(system_bytes_budget));
+		// Render thread only, ImGui allocates with malloc and is not counted
+		const FrameArena& frame_arena = dx_context.GetFrameArena();
+		ImGui::Text("Heap allocations last frame: %llu", frame_allocation_count);
+		ImGui::Text("Frame arena peak: %llu / %llu bytes, grown %u times", frame_arena.GetPeakBytes(), frame_arena.GetCapacity(), frame_arena.GetGrowCount());
+
+		// Every permutation is built, selecting one only changes the key
+		const ShaderPermutations& permutations = compute_resource.m_permutations;
+		const std::vector<ShaderPermutationAxis>& axes = permutations.GetDesc().m_axes;
+		for (uint32 i = 0; i < axes.size(); ++i)
+		{
+			const uint32 current_value = permutations.GetAxisValue(compute_resource.m_key, i);
+			if (ImGui::BeginCombo(axes[i].m_name.c_str(), axes[i].m_values[current_value].c_str()))
+			{
+				for (uint32 value = 0; value < axes[i].m_values.size(); ++value)
+				{
+					const ShaderPermutationKey key = permutations.SetAxisValue(compute_resource.m_key, i, value);
+					if (!permutations.IsPruned(key) && ImGui::Selectable(axes[i].m_values[value].c_str(), value == current_value))
+					{
+						compute_resource.m_key = key;
+					}
+				}
+				ImGui::EndCombo();
+			}
+		}
+
+		ImGui::Checkbox("Dynamic resolution", &compute_resource.m_dynamic_resolution_enabled);
+		float32 target_milliseconds = (float32)compute_resource.m_dynamic_resolution.GetDesc().m_target_milliseconds;
+		if (ImGui::SliderFloat("Compute budget (ms)", &target_milliseconds, 0.5f, 16.0f))
+		{
+			compute_resource.m_dynamic_resolution.SetTargetMilliseconds(target_milliseconds);
+		}
+		ImGui::Text("Compute resolution scale: %.2f", compute_resource.m_resolution_scale);
+		ImGui::Text("Shader debug records: %u, dropped %u", compute_resource.m_shader_debug.GetRecordCount(), compute_resource.m_shader_debug.GetDroppedCount());
+		ImGui::Checkbox("GPU driven culling", &gfx_resource.m_gpu_driven);
+		ImGui::Checkbox("Draw bundle", &gfx_resource.m_use_bundle);
+		ImGui::Text("Draw bundle recordings: %u", gfx_resource.m_draw_bundle.GetRecordCount());
+		ImGui::Text("Drawn instances: %u / %u", gfx_resource.m_drawn_instance_count, gfx_resource.m_instance_count);
+		for (uint32 scope = 0; scope < gpu_profiler.GetScopeCount(); ++scope)
+		{
+			ImGui::Text("GPU %s: %.3f ms", gpu_profiler.GetScopeName(scope).c_str(), gpu_profiler.GetScopeMilliseconds(scope));
+		}
+
+		ScreenCapture& screen_capture = capture_resource.m_screen_capture;
+		if (ImGui::Button("Screenshot"))
+		{
+			screen_capture.RequestScreenshot();
+		}
+		bool is_sequence_running = screen_capture.IsSequenceRunning();
+		if (ImGui::Checkbox("Capture sequence", &is_sequence_running))
+		{
+			if (is_sequence_running)
+			{
+				screen_capture.StartSequence(capture_resource.m_sequence_frames_per_second);
+			}
+			else
+			{
+				screen_capture.StopSequence();
+			}
+		}
+		ImGui::SliderFloat("Sequence frame rate", &capture_resource.m_sequence_frames_per_second, 1.0f, 60.0f);
+		const uint32 file_format = static_cast<uint32>(screen_capture.GetFileFormat());
+		if (ImGui::BeginCombo("Capture format", g_image_file_format_names[file_format]))
+		{
+			for (uint32 candidate = 0; candidate < static_cast<uint32>(ImageFileFormat::Count); ++candidate)
+			{
+				if (ImGui::Selectable(g_image_file_format_names[candidate], candidate == file_format))
+				{
+					screen_capture.SetFileFormat(static_cast<ImageFileFormat>(candidate));
+				}
+			}
+			ImGui::EndCombo();
+		}
+		const uint32 capture_point = static_cast<uint32>(capture_resource.m_point);
+		if (ImGui::BeginCombo("Capture point", g_capture_point_names[capture_point]))
+		{
+			for (uint32 candidate = 0; candidate < static_cast<uint32>(CapturePoint::Count); ++candidate)
+			{
+				if (ImGui::Selectable(g_capture_point_names[candidate], candidate == capture_point))
+				{
+					capture_resource.m_point = static_cast<CapturePoint>(candidate);
+				}
+			}
+			ImGui::EndCombo();
+		}
+		ImGui::Text("Captures written: %u, pending %u, dropped %u", screen_capture.GetWrittenCount(), screen_capture.GetPendingCount(), screen_capture.GetDroppedCount());
+
+		// Runtime filter only, levels compiled out of this build stay silent whatever is selected
+		for (uint32 category = 0; category < static_cast<uint32>(LogCategory::Count); ++category)
+		{
+			const LogLevel level = GetLogLevel(static_cast<LogCategory>(category));
+			// Rebuilt every frame, the frame arena keeps it off the heap
+			const uint32 label_size = 64;
+			char* label = dx_context.GetFrameArena().AllocateArray<char>(label_size);
+			std::format_to_n(label, label_size - 1, "Log {0}", g_log_category_names[category]);
+			if (ImGui::BeginCombo(label, g_log_level_names[static_cast<uint32>(level)]))
+			{
+				for (uint32 candidate = 0; candidate < static_cast<uint32>(LogLevel::Count); ++candidate)
+				{
+					if (ImGui::Selectable(g_log_level_names[candidate], candidate == static_cast<uint32>(level)))
+					{
+						SetLogLevel(static_cast<LogCategory>(category), static_cast<LogLevel>(candidate));
+					}
+				}
+				ImGui::EndCombo();
+			}
+		}
 	}
 
 	void FillcommandlistImGui(DXContext& dx_context, DXTextureResource& output)
@@ -296,13 +789,17 @@ public:
 		ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), dx_context.GetCommandListGraphics().Get());
 	}
 
-	void Render(DXContext& dx_context, DXTextureResource& output)
+	void Render(DXContext& dx_context, DXTextureResource& output, GraphicsResources& gfx_resource, ComputeResources& compute_resource, CaptureResources& capture_resource, const GPUProfiler& gpu_profiler, uint64 frame_allocation_count, std::recursive_mutex& input_mutex)
 	{
-		ImGui_ImplDX12_NewFrame();
-		ImGui_ImplWin32_NewFrame();
-		ImGui::NewFrame();
-		ImGUI(dx_context);
-		ImGui::Render();
+		{
+			// Message handler of the main thread feeds ImGui input concurrently
+			std::scoped_lock lock(input_mutex);
+			ImGui_ImplDX12_NewFrame();
+			ImGui_ImplWin32_NewFrame();
+			ImGui::NewFrame();
+			ImGUI(dx_context, gfx_resource, compute_resource, capture_resource, gpu_profiler, frame_allocation_count);
+			ImGui::Render();
+		}
 		FillcommandlistImGui(dx_context, output);
 
 	}
@@ -328,23 +825,203 @@ void RunWindowLoop(DXContext& dx_context, DXCompiler& dx_compiler, GPUCapture* g
 		ui.Init(dx_context, dx_window.m_buffers[g_current_buffer_index], dx_window.m_handle);
 		{
 			GraphicsResources gfx_resource{};
-			CreateGraphicsResources(dx_context, dx_compiler, dx_window, gfx_resource);
+			CreateGraphicsResources(dx_context, dx_compiler, dx_window.GetFormat(), 16, gfx_resource);
 			ComputeResources compute_resource{};
 			CreateComputeResources(dx_context, dx_compiler, compute_resource);
+			GPUProfiler gpu_profiler{};
+			gpu_profiler.Init(dx_context, g_gpu_scope_names);
+			CaptureResources capture_resource{};
+			capture_resource.m_screen_capture.Init({});
+
+			// Declared after the resources it swaps pipelines into
+			ShaderHotReload shader_hot_reload(dx_context, dx_compiler, "shaders");
+			for (ShaderPermutationKey key = 0; key < compute_resource.m_permutations.GetPermutationCount(); ++key)
+			{
+				if (compute_resource.m_permutations.IsPruned(key))
+				{
+					continue;
+				}
+				shader_hot_reload.Register
+				(
+					compute_resource.m_permutations.GetName(key), compute_resource.m_pipelines[key].m_shaders, BuildComputePipeline,
+					[&compute_resource, key](ShaderPipeline& pipeline) { SwapComputePipeline(compute_resource, key, pipeline); }
+				);
+			}
+			shader_hot_reload.Register
+			(
+				"Upsample", compute_resource.m_upsample_pipeline.m_shaders, BuildComputePipeline,
+				[&compute_resource](ShaderPipeline& pipeline) { SwapUpsamplePipeline(compute_resource, pipeline); }
+			);
+			const DXGI_FORMAT render_target_format = dx_window.GetFormat();
+			shader_hot_reload.Register
+			(
+				"Graphics", { gfx_resource.m_vertex_shader, gfx_resource.m_pixel_shader },
+				[render_target_format](DXContext& build_context, ShaderPipeline& pipeline) { return BuildGraphicsPipeline(build_context, render_target_format, pipeline); },
+				[&gfx_resource](ShaderPipeline& pipeline) { SwapGraphicsPipeline(gfx_resource, pipeline); }
+			);
+			shader_hot_reload.Register
+			(
+				"CullInstances", { gfx_resource.m_cull_shader }, BuildCullPipeline,
+				[&gfx_resource](ShaderPipeline& pipeline) { SwapCullPipeline(gfx_resource, pipeline); }
+			);
+			// Main thread pumps messages and handles input, the render thread records, submits and presents
+			SPSCQueue<FrameSnapshot, g_frame_queue_size> frame_queue;
+			std::atomic<bool> render_thread_done = false;
+			std::thread render_thread([&]()
+			{
+				FrameSnapshot frame{};
+				// Capture requested by a skipped frame moves to the next rendered one
+				bool capture = false;
+				// Frame time and GPU passes watched for hitches, a spike captures the following frames
+				std::vector<std::string> anomaly_series_names = { "Frame" };
+				anomaly_series_names.insert(anomaly_series_names.end(), g_gpu_scope_names.begin(), g_gpu_scope_names.end());
+				AnomalyDetector anomaly_detector{};
+				anomaly_detector.Init({}, anomaly_series_names);
+				std::vector<float64> anomaly_samples(anomaly_series_names.size());
+				std::vector<float64> gpu_scope_milliseconds(gpu_profiler.GetScopeCount());
+				uint32 anomaly_capture_frames_left = 0;
+				bool is_anomaly_capturing = false;
+				// Capturing slows the frames it covers, their timings are read back up to g_backbuffer_count frames later
+				uint32 anomaly_ignored_frames_left = 0;
+				// Unset after skipped frames, the gap is not a frame time
+				std::optional<std::chrono::steady_clock::time_point> previous_frame_time;
+				// Heap allocations of the render thread for the last frame, zero in steady state
+				uint64 frame_allocation_count = 0;
+				for (frame_queue.Pop(frame); !frame.m_quit; frame_queue.Pop(frame))
+				{
+					capture |= frame.m_capture;
+					// Handle resizing requested by the main thread
+					// Frames are skipped while back buffers are in flight instead of draining the GPU
+					if (!dx_window.UpdateResize(dx_context, frame.m_window))
+					{
+						previous_frame_time.reset();
+						std::this_thread::yield();
+						continue;
+					}
+					// Manual capture waits for a running anomaly capture
+					capture &= !is_anomaly_capturing;
+					if (capture && gpu_capture != nullptr)
+					{
+						gpu_capture->StartCapture();
+					}
+					else if (anomaly_capture_frames_left > 0 && !is_anomaly_capturing && gpu_capture != nullptr)
+					{
+						gpu_capture->StartCapture();
+						is_anomaly_capturing = true;
+					}
+
+					{
+						const uint64 allocation_count_begin = GetThreadAllocationCount();
+						dx_context.InitCommandLists();
+						// Fence of this backbuffer index is completed after InitCommandLists
+						gpu_profiler.Readback();
+						compute_resource.m_shader_debug.Readback();
+						ReadbackDrawnInstances(gfx_resource);
+						capture_resource.m_screen_capture.Readback();
+
+						// Includes the wait on the fence, a GPU bound hitch shows in the frame time as well
+						const std::chrono::steady_clock::time_point frame_time = std::chrono::steady_clock::now();
+						const float64 frame_milliseconds = previous_frame_time.has_value() ? std::chrono::duration<float64, std::milli>(frame_time - *previous_frame_time).count() : 0.0;
+						anomaly_samples[0] = frame_milliseconds;
+						for (uint32 scope = 0; scope < gpu_profiler.GetScopeCount(); ++scope)
+						{
+							gpu_scope_milliseconds[scope] = gpu_profiler.GetScopeMilliseconds(scope);
+							anomaly_samples[1 + scope] = gpu_scope_milliseconds[scope];
+						}
+						// Timings of the last frames for a device removal, same series as the anomaly detector
+						dx_context.m_crash_report.EndFrame(frame_milliseconds, gpu_scope_milliseconds);
+						if (anomaly_ignored_frames_left > 0)
+						{
+							--anomaly_ignored_frames_left;
+						}
+						else if (previous_frame_time.has_value() && anomaly_capture_frames_left == 0 && !capture)
+						{
+							if (anomaly_detector.Update(anomaly_samples) && gpu_capture != nullptr)
+							{
+								anomaly_capture_frames_left = anomaly_detector.GetDesc().m_capture_frame_count;
+								LOG_WARNING
+								(
+									Frame,
+									"{0} spike {1:.2f} ms over baseline {2:.2f} ms, capturing {3} frames",
+									anomaly_series_names[anomaly_detector.GetTriggerSeries()], anomaly_detector.GetTriggerMilliseconds(),
+									anomaly_detector.GetTriggerBaselineMilliseconds(), anomaly_capture_frames_left
+								);
+							}
+						}
+						previous_frame_time = frame_time;
+						if (compute_resource.m_dynamic_resolution_enabled)
+						{
+							compute_resource.m_resolution_scale = compute_resource.m_dynamic_resolution.Update(gpu_profiler.GetScopeMilliseconds(static_cast<uint32>(GPUScope::Compute)));
+						}
+						else
+						{
+							compute_resource.m_resolution_scale = 1.0f;
+						}
+						// Frame boundary, swaps in pipelines rebuilt in the background
+						shader_hot_reload.Update();
+						{
+							PIXScopedEvent(dx_context.GetCommandListGraphics().Get(), 0, "Frame");
+							dx_window.BeginFrame(dx_context);
+							{
+								PIXScopedEvent(dx_context.GetCommandListGraphics().Get(), 0, "FillCommandList");
+								FillCommandList(dx_context, dx_window, gfx_resource, compute_resource, capture_resource, gpu_profiler, frame);
+							}
+							{
+								PIXScopedEvent(dx_context.GetCommandListGraphics().Get(), 0, "ImGui");
+								ui.Render(dx_context, dx_window.m_buffers[g_current_buffer_index], gfx_resource, compute_resource, capture_resource, gpu_profiler, frame_allocation_count, dx_window.m_ui_mutex);
+							}
+							if (capture_resource.m_point == CapturePoint::BackBuffer)
+							{
+								capture_resource.m_screen_capture.Record(dx_context, dx_window.m_buffers[g_current_buffer_index], frame.m_time_seconds);
+							}
+							dx_window.EndFrame(dx_context);
+						}
+						gpu_profiler.Resolve(dx_context);
+						compute_resource.m_shader_debug.Resolve(dx_context);
+						dx_context.ExecuteCommandListGraphics();
+						dx_window.Present(dx_context);
+						frame_allocation_count = GetThreadAllocationCount() - allocation_count_begin;
+					}
+					if (capture && gpu_capture != nullptr)
+					{
+						gpu_capture->EndCapture();
+						gpu_capture->OpenCapture();
+						anomaly_ignored_frames_left = g_backbuffer_count + 1;
+					}
+					capture = false;
+					if (is_anomaly_capturing && --anomaly_capture_frames_left == 0)
+					{
+						// Not opened, nobody is watching when a hitch is captured
+						gpu_capture->EndCapture();
+						is_anomaly_capturing = false;
+						anomaly_ignored_frames_left = g_backbuffer_count + 1;
+						const std::filesystem::path metrics_path = std::filesystem::path(gpu_capture->GetCapturePath()).replace_extension(".metrics.csv");
+						if (!anomaly_detector.WriteHistory(metrics_path.string()))
+						{
+							LOG_ERROR(Frame, "Failed to write capture metrics {0}", metrics_path.string());
+						}
+					}
+				}
+				dx_context.Flush(dx_window.GetBackBufferCount());
+				capture_resource.m_screen_capture.Shutdown();
+				render_thread_done.store(true, std::memory_order_release);
+			});
+
+			const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+			uint32 frame_index = 0;
+			// Kept until a snapshot carrying it is queued
+			bool capture_pending = false;
 			while (!dx_window.ShouldClose())
 			{
-				std::chrono::milliseconds ms(8);
-				std::this_thread::sleep_for(ms);
 				// Process window message
 				dx_window.Update();
 
 				// Key input handling of application
 				static bool prev_F1_pressed = false;
-				bool capture = false;
 				bool current_F1_pressed = dx_window.input.IsKeyPressed(VK_F1);
 				if (current_F1_pressed && prev_F1_pressed != current_F1_pressed)
 				{
-					capture = true;
+					capture_pending = true;
 				}
 				prev_F1_pressed = current_F1_pressed;
 					
@@ -367,140 +1044,492 @@ void RunWindowLoop(DXContext& dx_context, DXCompiler& dx_compiler, GPUCapture* g
 				}
 				prev_F11_pressed = current_F11_pressed;
 
-				if (capture && gpu_capture != nullptr)
+				const FrameSnapshot frame
 				{
-					gpu_capture->StartCapture();
-				}
-				// rendering
+					.m_time_seconds = std::chrono::duration<float32>(std::chrono::steady_clock::now() - start_time).count(),
+					.m_frame_index = frame_index,
+					.m_window = dx_window.GetSnapshot(),
+					.m_capture = capture_pending,
+				};
+				if (frame_queue.TryPush(frame))
 				{
-					// Handle resizing
-					if (dx_window.ShouldResize())
-					{
-						dx_context.Flush(dx_window.GetBackBufferCount());
-						dx_window.Resize();
-						// Seems like back buffer index needs to be updated on resize
-						// Always sets it back 0
-						dx_window.UpdateBackBufferIndex();
-					}
-
-					{
-						dx_context.InitCommandLists();
-						{
-							PIXScopedEvent(dx_context.GetCommandListGraphics().Get(), 0, "Frame");
-							dx_window.BeginFrame(dx_context);
-							{
-								PIXScopedEvent(dx_context.GetCommandListGraphics().Get(), 0, "FillCommandList");
-								FillCommandList(dx_context, dx_window, gfx_resource, compute_resource);
-							}
-							{
-								PIXScopedEvent(dx_context.GetCommandListGraphics().Get(), 0, "ImGui");
-								ui.Render(dx_context, dx_window.m_buffers[g_current_buffer_index]);
-							}
-							dx_window.EndFrame(dx_context);
-						}
-						dx_context.ExecuteCommandListGraphics();
-						dx_window.Present(dx_context);
-					}
+					++frame_index;
+					capture_pending = false;
 				}
-				if (capture && gpu_capture != nullptr)
+				else
 				{
-					gpu_capture->EndCapture();
-					gpu_capture->OpenCapture();
+					// Render thread is behind, keep pumping messages rather than blocking on it
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
 				}
-
 			}
-			dx_context.Flush(dx_window.GetBackBufferCount());
+			// Keep pumping while the render thread drains, Present and ResizeBuffers can wait on the window thread
+			while (!frame_queue.TryPush(FrameSnapshot{ .m_quit = true }))
+			{
+				dx_window.Update();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			while (!render_thread_done.load(std::memory_order_acquire))
+			{
+				dx_window.Update();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			render_thread.join();
 		}
 
 
 	}
 }
-#pragma endregion
 
-#pragma region COMPUTE
-void CreateComputeResources(DXContext& dx_context, const DXCompiler& dx_compiler, ComputeResources& resource)
+// Brute force DrawInstanced against GPU culled ExecuteIndirect for growing instance counts
+// Zoomed out view so only a fraction of the grid is inside the frustum
+void RunInstanceCullingBenchmark(DXContext& dx_context, DXCompiler& dx_compiler)
 {
-	resource.m_compute_shader = dx_compiler.Compile(dx_context.GetDevice(), { ShaderType::COMPUTE_SHADER, "ComputeShader.hlsl", "main" });
+	const uint32 width = 1920;
+	const uint32 height = 1080;
+	DXTextureResource render_target{};
+	render_target.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET, width, height, DXGI_FORMAT_R8G8B8A8_UNORM);
+	render_target.CreateResource(dx_context, "Benchmark Render Target");
+
+	GPUProfiler gpu_profiler{};
+	gpu_profiler.Init(dx_context, g_gpu_scope_names);
+
+	const uint32 iteration_count = 16;
+	const uint32 min_instance_count = 1u << 10;
+	const uint32 max_instance_count = 1u << 22;
+	for (uint32 instance_count = min_instance_count; instance_count <= max_instance_count; instance_count <<= 2)
+	{
+		GraphicsResources resource{};
+		CreateGraphicsResources(dx_context, dx_compiler, render_target.m_format, instance_count, resource);
+		resource.m_view_scale = 1.0f / 16.0f;
+
+		for (bool gpu_driven : { false, true })
+		{
+			resource.m_gpu_driven = gpu_driven;
+			float64 cull_milliseconds = 0.0;
+			float64 draw_milliseconds = 0.0;
+			for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+			{
+				dx_context.InitCommandLists();
+				dx_context.GetCommandListGraphics()->SetDescriptorHeaps(1, dx_context.m_resources_descriptor_heap.m_heap.GetAddressOf());
+				GraphicsWork(dx_context, resource, render_target, gpu_profiler);
+				gpu_profiler.Resolve(dx_context);
+				dx_context.ExecuteCommandListGraphics();
+				dx_context.Flush(1);
+
+				gpu_profiler.Readback();
+				ReadbackDrawnInstances(resource);
+				cull_milliseconds += gpu_driven ? gpu_profiler.GetScopeMilliseconds(static_cast<uint32>(GPUScope::Cull)) : 0.0;
+				draw_milliseconds += gpu_profiler.GetScopeMilliseconds(static_cast<uint32>(GPUScope::Draw));
+			}
+			cull_milliseconds /= iteration_count;
+			draw_milliseconds /= iteration_count;
+			LOG_INFO
+			(
+				General,
+				"{0} instances {1}: drawn {2}, cull {3:.3f} ms, draw {4:.3f} ms, total {5:.3f} ms",
+				instance_count, gpu_driven ? "GPU culled" : "brute force", resource.m_drawn_instance_count,
+				cull_milliseconds, draw_milliseconds, cull_milliseconds + draw_milliseconds
+			);
+		}
+	}
+}
+
+// CPU recording time of the draw sequence, recorded directly against replayed from a bundle, for growing draw counts
+// Bundle numbers are steady state, the first frame pays the bundle recording on top
+void RunBundleBenchmark(DXContext& dx_context, DXCompiler& dx_compiler)
+{
+	const uint32 width = 1920;
+	const uint32 height = 1080;
+	DXTextureResource render_target{};
+	render_target.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET, width, height, DXGI_FORMAT_R8G8B8A8_UNORM);
+	render_target.CreateResource(dx_context, "Benchmark Render Target");
+
+	GPUProfiler gpu_profiler{};
+	gpu_profiler.Init(dx_context, g_gpu_scope_names);
+
+	const uint32 iteration_count = 64;
+	const uint32 max_draw_count = 1u << 14;
+	GraphicsResources resource{};
+	CreateGraphicsResources(dx_context, dx_compiler, render_target.m_format, max_draw_count, resource);
+	for (uint32 draw_count = 1; draw_count <= max_draw_count; draw_count <<= 2)
+	{
+		resource.m_draw_count = draw_count;
+		for (bool use_bundle : { false, true })
+		{
+			resource.m_use_bundle = use_bundle;
+			float64 first_milliseconds = 0.0;
+			float64 steady_milliseconds = 0.0;
+			for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+			{
+				dx_context.InitCommandLists();
+				dx_context.GetCommandListGraphics()->SetDescriptorHeaps(1, dx_context.m_resources_descriptor_heap.m_heap.GetAddressOf());
+				std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+				GraphicsWork(dx_context, resource, render_target, gpu_profiler);
+				std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+				gpu_profiler.Resolve(dx_context);
+				dx_context.ExecuteCommandListGraphics();
+				dx_context.Flush(1);
+				gpu_profiler.Readback();
+
+				const float64 milliseconds = std::chrono::duration<float64, std::milli>(end_time - begin_time).count();
+				if (iteration == 0)
+				{
+					first_milliseconds = milliseconds;
+				}
+				else
+				{
+					steady_milliseconds += milliseconds;
+				}
+			}
+			steady_milliseconds /= (iteration_count - 1);
+			LOG_INFO
+			(
+				General,
+				"{0} draws {1}: first frame {2:.4f} ms, steady {3:.4f} ms CPU recording",
+				draw_count, use_bundle ? "bundle" : "direct", first_milliseconds, steady_milliseconds
+			);
+		}
+	}
+}
+
+// Startup cost of compiling a permutation set serially against the worker pool for 1..N workers
+// Cache disabled, every permutation is a full compilation
+void RunShaderCompileBenchmark(DXContext& dx_context)
+{
+	// Every permutation of the manifest, replicated with a dummy define to make a larger set
+	std::vector<ShaderDesc> base_shader_descs{};
+	for (const ShaderPermutationDesc& permutation_desc : GetShaderManifest())
+	{
+		for (ShaderPermutationKey key = 0; key < GetPermutationCount(permutation_desc); ++key)
+		{
+			if (!IsPermutationPruned(permutation_desc, key))
+			{
+				base_shader_descs.push_back(GetPermutationShaderDesc(permutation_desc, key));
+			}
+		}
+	}
+	const uint32 replica_count = 8;
+	std::vector<ShaderDesc> shader_descs{};
+	for (uint32 replica = 0; replica < replica_count; ++replica)
+	{
+		for (ShaderDesc shader_desc : base_shader_descs)
+		{
+			shader_desc.m_defines.push_back("BENCHMARK_REPLICA=" + std::to_string(replica));
+			shader_descs.push_back(shader_desc);
+		}
+	}
+
+	const uint32 max_worker_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+	{
+		DXCompiler dx_compiler("shaders", 1);
+		dx_compiler.SetCacheEnabled(false);
+		std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+		for (const ShaderDesc& shader_desc : shader_descs)
+		{
+			dx_compiler.Compile(dx_context.GetDevice(), shader_desc);
+		}
+		const float64 milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+		LOG_INFO(General, "{0} shaders serial on main thread: {1:.1f} ms", shader_descs.size(), milliseconds);
+	}
+	for (uint32 worker_count = 1; worker_count <= max_worker_count; ++worker_count)
+	{
+		// Compiler instances are created up front, not part of the measurement
+		DXCompiler dx_compiler("shaders", worker_count);
+		dx_compiler.SetCacheEnabled(false);
+		std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+		std::vector<std::future<Shader>> shaders = dx_compiler.CompileAsync(dx_context.GetDevice(), shader_descs);
+		for (std::future<Shader>& shader : shaders)
+		{
+			shader.wait();
+		}
+		const float64 milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+		LOG_INFO(General, "{0} shaders on {1} workers: {2:.1f} ms", shader_descs.size(), worker_count, milliseconds);
+	}
+}
+
+// Cost on the calling thread of the asynchronous logger against the previous immediate path
+// Bursts fit in the ring so the asynchronous calls never wait for the logging thread
+void RunLoggerBenchmark()
+{
+	const uint32 call_count = 512;
+	const uint32 iteration_count = 16;
+	float64 async_milliseconds = 0.0;
+	float64 immediate_milliseconds = 0.0;
+	float64 compiled_out_milliseconds = 0.0;
+	for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+		for (uint32 i = 0; i < call_count; ++i)
+		{
+			Log(LogCategory::General, LogLevel::Trace, "Logger benchmark {0}: {1:.3f} ms {2}", i, (float64)i * 0.01, "async");
+		}
+		async_milliseconds += std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+		// Not measured, the burst is written by the logging thread meanwhile
+		LogFlush();
+
+		begin_time = std::chrono::steady_clock::now();
+		for (uint32 i = 0; i < call_count; ++i)
+		{
+			LogImmediate(LogCategory::General, LogLevel::Trace, "Logger benchmark {0}: {1:.3f} ms {2}", i, (float64)i * 0.01, "immediate");
+		}
+		immediate_milliseconds += std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+
+		// Frame traces are compiled out of every build, the loop is left empty
+		begin_time = std::chrono::steady_clock::now();
+		for (uint32 i = 0; i < call_count; ++i)
+		{
+			LOG_TRACE(Frame, "Logger benchmark {0}: {1:.3f} ms {2}", i, (float64)i * 0.01, "compiled out");
+		}
+		compiled_out_milliseconds += std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+	}
+	const float64 nanoseconds_per_call = 1000000.0 / (call_count * iteration_count);
+	LOG_INFO
+	(
+		General,
+		"Logger per call: async {0:.1f} ns, immediate {1:.1f} ns, compiled out {2:.1f} ns",
+		async_milliseconds * nanoseconds_per_call, immediate_milliseconds * nanoseconds_per_call, compiled_out_milliseconds * nanoseconds_per_call
+	);
+}
+
+// Scaling of the work stealing job system from a single worker up to one per hardware thread
+// Speedups are against the single worker system, which already has the calling thread helping
+void RunJobSystemBenchmark()
+{
+	const uint32 iteration_count = 8;
+	const std::vector<JobSystemScalingResult> results = MeasureJobSystemScaling((std::max)(std::thread::hardware_concurrency(), 2u) - 1, iteration_count);
+	for (const JobSystemScalingResult& result : results)
+	{
+		LOG_INFO
+		(
+			General,
+			"Job system {0} workers: kernel {1:.2f} ms ({2:.2f}x), spawn {3:.1f} ns per job, {4} steals",
+			result.m_worker_count, result.m_kernel_milliseconds, results[0].m_kernel_milliseconds / result.m_kernel_milliseconds,
+			result.m_spawn_nanoseconds_per_job, result.m_steal_count
+		);
+	}
+}
+
+// Synthetic files of every byte set to their index, written once and reused
+std::vector<std::string> WriteStreamingFiles(const std::string& directory, const std::vector<uint64>& sizes)
+{
+	std::filesystem::create_directories(directory);
+	std::vector<std::string> paths{};
+	for (uint32 i = 0; i < (uint32)sizes.size(); ++i)
+	{
+		const std::string path = std::format("{0}\\stream_{1}.bin", directory, i);
+		if (!std::filesystem::exists(path) || std::filesystem::file_size(path) != sizes[i])
+		{
+			std::vector<char> data(sizes[i], (char)i);
+			std::ofstream file(path, std::ios::binary);
+			file.write(data.data(), data.size());
+		}
+		paths.push_back(path);
+	}
+	return paths;
+}
+
+// Streaming throughput for several chunk sizes, scheduler alone and through the copy queue
+// The last file has a higher priority, it completes first even though it is submitted last
+void RunStreamingBenchmark(DXContext& dx_context)
+{
+	const uint32 texture_size = 4096;
+	const uint64 file_size = 64ull << 20;
+	const std::vector<uint64> sizes = { file_size, file_size, file_size, file_size, file_size, file_size, file_size, (uint64)texture_size * texture_size * 4 };
+	const std::vector<std::string> paths = WriteStreamingFiles("stream_benchmark", sizes);
+	std::vector<int32> priorities(paths.size(), 0);
+	priorities.back() = 1;
+
+	for (uint64 chunk_size : { 256ull << 10, 1ull << 20, 4ull << 20 })
+	{
+		const StreamSchedulerDesc desc{ .m_chunk_size = chunk_size, .m_staging_chunk_count = 16 };
+		const StreamSimulationResult result = SimulateStreaming(desc, paths, priorities, g_backbuffer_count);
+		LOG_INFO
+		(
+			General, "Streaming CPU {0} KB chunks: {1} MB in {2:.1f} ms, {3:.2f} GB/s, {4} batches",
+			chunk_size >> 10, result.m_bytes >> 20, result.m_milliseconds, result.m_bytes / (result.m_milliseconds * 1000000.0), result.m_batch_count
+		);
+
+		Streamer streamer{};
+		streamer.Init(dx_context, desc);
+		std::vector<DXResource> buffers(paths.size() - 1);
+		DXTextureResource texture{};
+		std::vector<StreamRequestId> completed{};
+		StreamCallback callback = [&completed](StreamRequestId request, StreamStatus status)
+		{
+			if (status == StreamStatus::Completed)
+			{
+				completed.push_back(request);
+			}
+		};
+		std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+		for (uint32 i = 0; i < (uint32)buffers.size(); ++i)
+		{
+			streamer.LoadBuffer(dx_context, paths[i], priorities[i], buffers[i], callback);
+		}
+		const StreamRequestId texture_request = streamer.LoadTexture(dx_context, paths.back(), texture_size, texture_size, DXGI_FORMAT_R8G8B8A8_UNORM, priorities.back(), texture, callback);
+		while (streamer.GetRequestCount() > 0)
+		{
+			streamer.Update(dx_context);
+			std::this_thread::yield();
+		}
+		const float64 milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+		streamer.Shutdown(dx_context);
+
+		uint64 bytes = 0;
+		for (uint64 size : sizes)
+		{
+			bytes += size;
+		}
+		LOG_INFO
+		(
+			General, "Streaming GPU {0} KB chunks: {1} MB in {2:.1f} ms, {3:.2f} GB/s, texture completed {4} of {5}",
+			chunk_size >> 10, bytes >> 20, milliseconds, bytes / (milliseconds * 1000000.0),
+			std::find(completed.begin(), completed.end(), texture_request) - completed.begin() + 1, completed.size()
+		);
+	}
+}
+#pragma endregion
+
+#pragma region COMPUTE
+// Shaders: CS
+bool BuildComputePipeline(DXContext& dx_context, ShaderPipeline& pipeline)
+{
+	const Shader& compute_shader = pipeline.m_shaders[0];
 
 	// Root signature embed in the shader
-	resource.m_compute_root_signature = dx_context.CreateRS(resource.m_compute_shader);
+	pipeline.m_root_signature = dx_context.CreateRS(compute_shader);
 
-	std::string compute_name{ "Compute" };
-	std::wstring compute_wname = std::to_wstring(compute_name);
+	ComputePipelineStream stream
+	{
+		.m_root_signature = pipeline.m_root_signature.m_signature.Get(),
+		.m_cs = BlobToByteCode(compute_shader.m_blob),
+	};
+	const D3D12_PIPELINE_STATE_STREAM_DESC stream_desc{ sizeof(stream), &stream };
+	return TryCreatePSO(dx_context, stream_desc, GetPipelineCacheKey(pipeline.m_shaders, nullptr, 0), "Compute", pipeline.m_pso);
+}
 
-	CD3DX12_STATE_OBJECT_DESC cstate_object_desc;
-	cstate_object_desc.SetStateObjectType(D3D12_STATE_OBJECT_TYPE_EXECUTABLE);
-	CD3DX12_DXIL_LIBRARY_SUBOBJECT* cs_subobj = cstate_object_desc.CreateSubobject<CD3DX12_DXIL_LIBRARY_SUBOBJECT>();
-	D3D12_SHADER_BYTECODE cs_byte_code = BlobToByteCode(resource.m_compute_shader.m_blob);
-	cs_subobj->SetDXILLibrary(&cs_byte_code);
-	CD3DX12_GENERIC_PROGRAM_SUBOBJECT* generic_subobj = cstate_object_desc.CreateSubobject<CD3DX12_GENERIC_PROGRAM_SUBOBJECT>();
-	generic_subobj->SetProgramName(compute_wname.c_str());
-	generic_subobj->AddExport(L"main");
-	// Apparently works without linking SO with RS, though RS is embedded in shader already but seem to be needed for graphics SO
-	resource.m_pso = CreatePSO(dx_context, cstate_object_desc, compute_name);
+void SwapComputePipeline(ComputeResources& resource, ShaderPermutationKey key, ShaderPipeline& pipeline)
+{
+	std::swap(resource.m_pipelines[key], pipeline);
+}
+
+void SwapUpsamplePipeline(ComputeResources& resource, ShaderPipeline& pipeline)
+{
+	std::swap(resource.m_upsample_pipeline, pipeline);
+}
+
+void CreateComputeResources(DXContext& dx_context, const DXCompiler& dx_compiler, ComputeResources& resource)
+{
+	resource.m_permutations.Init(GetComputePermutationDesc());
+	resource.m_permutations.CompileAll(dx_compiler, dx_context.GetDevice());
+	resource.m_pipelines.resize(resource.m_permutations.GetPermutationCount());
+	for (ShaderPermutationKey key = 0; key < resource.m_permutations.GetPermutationCount(); ++key)
+	{
+		if (resource.m_permutations.IsPruned(key))
+		{
+			continue;
+		}
+		ShaderPipeline pipeline{ .m_shaders = { resource.m_permutations.Get(dx_compiler, dx_context.GetDevice(), key) } };
+		bool success = BuildComputePipeline(dx_context, pipeline);
+		ASSERT(success);
+		SwapComputePipeline(resource, key, pipeline);
+	}
+	resource.m_key = resource.m_permutations.GetKey({ resource.m_permutations.GetValue("COMPUTE_MODE", "JULIA") });
+
+	ShaderPipeline upsample_pipeline{ .m_shaders = { dx_compiler.Compile(dx_context.GetDevice(), { ShaderType::COMPUTE_SHADER, "UpsampleShader.hlsl", "main" }) } };
+	bool success = BuildComputePipeline(dx_context, upsample_pipeline);
+	ASSERT(success);
+	SwapUpsamplePipeline(resource, upsample_pipeline);
+	resource.m_dynamic_resolution.Init({});
+	resource.m_shader_debug.Init(dx_context);
 }
 
 void ComputeWork
 (
 	DXContext& dx_context, 
 	ComputeResources& compute_resource, 
-	DXWindow& dx_window,
-	DXResource& output_resource
+	DXResource& output_resource,
+	GPUProfiler& gpu_profiler,
+	float32 time_seconds,
+	uint32 frame_index
 )
 {
+	// Dynamic resolution renders at a fraction of the output size and upscales
+	const uint32 output_width = (uint32)output_resource.m_resource_desc.Width;
+	const uint32 output_height = output_resource.m_resource_desc.Height;
+	const uint32 width = (std::max)((uint32)((float32)output_width * compute_resource.m_resolution_scale + 0.5f), 1u);
+	const uint32 height = (std::max)((uint32)((float32)output_height * compute_resource.m_resolution_scale + 0.5f), 1u);
+	const bool is_scaled = width != output_width || height != output_height;
+
 	DXTextureResource gpu_resource{};
-	gpu_resource.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, dx_window.GetWidth(), dx_window.GetHeight(), output_resource.m_resource_desc.Format);
+	gpu_resource.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, width, height, output_resource.m_resource_desc.Format);
 	gpu_resource.CreateResource(dx_context, "GPU resource");
 	
 	dx_context.m_resource_handler.RegisterResource(gpu_resource);
 
-	struct MyCBuffer
-	{
-		float32 iTime;
-		uint32 iFrame;
-		uint32 bindless_index;
-	}; 
-
 	// Compute Work
 	// Transition to UAV
 	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, gpu_resource);
 
-	D3D12_SET_PROGRAM_DESC program_desc
-	{
-		.Type = D3D12_PROGRAM_TYPE_GENERIC_PIPELINE,
-		.GenericPipeline =
-		{
-			.ProgramIdentifier = compute_resource.m_pso.m_program_id
-		},
-	};
-	dx_context.GetCommandListGraphics()->SetProgram(&program_desc);
+	const ShaderPipeline& pipeline = compute_resource.m_pipelines[compute_resource.m_key];
+	SetPSO(dx_context.GetCommandListGraphics().Get(), pipeline.m_pso);
 
 	D3D12_UNORDERED_ACCESS_VIEW_DESC UAV_desc = GetTexture2DUAVDesc(gpu_resource.m_format);
 	UAV uav = dx_context.CreateUAV(gpu_resource, UAV_desc);
-	
-	auto current_time = std::chrono::high_resolution_clock::now();
-	auto diff_seconds = (float32)std::chrono::duration_cast<std::chrono::milliseconds>(current_time - start_time).count();
-	diff_seconds /= 1000;
-	static uint32 iFrame = 0;
 
-	MyCBuffer cbuffer
+	ComputeConstants constants
 	{
-		.iTime = diff_seconds,
-		.iFrame = iFrame,
-		.bindless_index = uav.m_bindless_index
+		.iTime = time_seconds,
+		.iFrame = frame_index,
+		.bindless_index = uav.m_bindless_index,
+		.debug_bindless_index = compute_resource.m_shader_debug.GetBindlessIndex(),
 	};
-	++iFrame;
-	dx_context.GetCommandListGraphics()->SetComputeRootSignature(compute_resource.m_compute_root_signature.m_signature.Get());
-	dx_context.GetCommandListGraphics()->SetComputeRoot32BitConstants(0, sizeof(MyCBuffer) / 4, &cbuffer, 0);
+	dx_context.GetCommandListGraphics()->SetComputeRootSignature(pipeline.m_root_signature.m_signature.Get());
+	SetComputeRootConstants(dx_context.GetCommandListGraphics().Get(), constants);
 	uint32 dispatch_x = DivideRoundUp(gpu_resource.m_width, 8);
 	uint32 dispatch_y = DivideRoundUp(gpu_resource.m_height, 8);
+	gpu_profiler.BeginScope(dx_context, static_cast<uint32>(GPUScope::Compute));
 	dx_context.GetCommandListGraphics()->Dispatch(dispatch_x, dispatch_y, 1);
+	gpu_profiler.EndScope(dx_context, static_cast<uint32>(GPUScope::Compute));
+
+	DXTextureResource upsampled_resource{};
+	DXResource* copy_source = &gpu_resource;
+	if (is_scaled)
+	{
+		upsampled_resource.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, output_width, output_height, output_resource.m_resource_desc.Format);
+		upsampled_resource.CreateResource(dx_context, "Upsampled resource");
+		dx_context.m_resource_handler.RegisterResource(upsampled_resource);
+
+		dx_context.Transition(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, gpu_resource);
+		dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, upsampled_resource);
+		SRV source_srv = dx_context.CreateSRV(gpu_resource, GetTexture2DSRVDesc(gpu_resource.m_format));
+		UAV destination_uav = dx_context.CreateUAV(upsampled_resource, GetTexture2DUAVDesc(upsampled_resource.m_format));
+
+		const ShaderPipeline& upsample_pipeline = compute_resource.m_upsample_pipeline;
+		SetPSO(dx_context.GetCommandListGraphics().Get(), upsample_pipeline.m_pso);
+		dx_context.GetCommandListGraphics()->SetComputeRootSignature(upsample_pipeline.m_root_signature.m_signature.Get());
+		const UpsampleConstants upsample_constants
+		{
+			.source_bindless_index = source_srv.m_bindless_index,
+			.destination_bindless_index = destination_uav.m_bindless_index,
+		};
+		SetComputeRootConstants(dx_context.GetCommandListGraphics().Get(), upsample_constants);
+		gpu_profiler.BeginScope(dx_context, static_cast<uint32>(GPUScope::Upsample));
+		dx_context.GetCommandListGraphics()->Dispatch(DivideRoundUp(output_width, 8), DivideRoundUp(output_height, 8), 1);
+		gpu_profiler.EndScope(dx_context, static_cast<uint32>(GPUScope::Upsample));
+		copy_source = &upsampled_resource;
+	}
+
 	// Transition to Copy Src
 	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, output_resource);
-	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, gpu_resource);
-	dx_context.GetCommandListGraphics()->CopyResource(output_resource.m_resource.Get(), gpu_resource.m_resource.Get());
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, *copy_source);
+	dx_context.GetCommandListGraphics()->CopyResource(output_resource.m_resource.Get(), copy_source->m_resource.Get());
 
 	dx_context.m_resource_handler.ReRegisterResource(gpu_resource);
+	if (is_scaled)
+	{
+		dx_context.m_resource_handler.ReRegisterResource(upsampled_resource);
+	}
 }
 
 void RunComputeWork(DXContext& dx_context)
@@ -518,7 +1547,7 @@ void RunComputeWork(DXContext& dx_context)
 	{
 		for (uint32 i = 0; i < resource.m_cpu_resource.m_resource_desc.Width / sizeof(float32) / 4; i++)
 		{
-			LogTrace("uav[{}] = {}, {}, {}, {}\n", i, data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2], data[i * 4 + 3]);
+			LOG_TRACE(General, "uav[{}] = {}, {}, {}, {}\n", i, data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2], data[i * 4 + 3]);
 		}
 		has_display = true;
 	}
@@ -527,6 +1556,426 @@ void RunComputeWork(DXContext& dx_context)
 }
 #pragma endregion
 
+#pragma region TEXTURE
+// Mip generation and block compression of RGBA8 textures, CPU references in core/TextureCompression.h
+struct TextureResources
+{
+	ShaderPipeline m_mips_pipeline;
+	ShaderPermutations m_compress_permutations;
+	// Indexed by permutation key
+	std::vector<ShaderPipeline> m_compress_pipelines;
+	// Groups done with the first levels of GenerateMipsShader.hlsl, reset before every dispatch
+	DXResource m_counter_buffer;
+};
+
+// Mip 6 of the whole texture has to fit the tile of the last group
+static const uint32 g_generate_mips_max_size = 4096;
+
+DXGI_FORMAT GetBCDXGIFormat(BCFormat format)
+{
+	switch (format)
+	{
+	case BCFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+	case BCFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+	case BCFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+	case BCFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+	default: ASSERT(false); return DXGI_FORMAT_UNKNOWN;
+	}
+}
+
+void CreateTextureResources(DXContext& dx_context, const DXCompiler& dx_compiler, TextureResources& resource)
+{
+	ShaderPipeline mips_pipeline{ .m_shaders = { dx_compiler.Compile(dx_context.GetDevice(), { ShaderType::COMPUTE_SHADER, "GenerateMipsShader.hlsl", "main" }) } };
+	bool success = BuildComputePipeline(dx_context, mips_pipeline);
+	ASSERT(success);
+	std::swap(resource.m_mips_pipeline, mips_pipeline);
+
+	resource.m_compress_permutations.Init(GetCompressBCPermutationDesc());
+	resource.m_compress_permutations.CompileAll(dx_compiler, dx_context.GetDevice());
+	resource.m_compress_pipelines.resize(resource.m_compress_permutations.GetPermutationCount());
+	for (ShaderPermutationKey key = 0; key < resource.m_compress_permutations.GetPermutationCount(); ++key)
+	{
+		if (resource.m_compress_permutations.IsPruned(key))
+		{
+			continue;
+		}
+		ShaderPipeline pipeline{ .m_shaders = { resource.m_compress_permutations.Get(dx_compiler, dx_context.GetDevice(), key) } };
+		success = BuildComputePipeline(dx_context, pipeline);
+		ASSERT(success);
+		std::swap(resource.m_compress_pipelines[key], pipeline);
+	}
+
+	resource.m_counter_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, sizeof(uint32));
+	resource.m_counter_buffer.CreateResource(dx_context, "Generate Mips Counter");
+}
+
+// Blocking upload of tightly packed RGBA8 rows into mip 0, only meant for resource creation
+void UploadTexture
+(
+	DXContext& dx_context,
+	DXTextureResource& destination,
+	const uint8* rgba,
+	D3D12_RESOURCE_STATES final_resource_state
+)
+{
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint{};
+	uint32 row_count = 0;
+	uint64 row_size = 0;
+	uint64 size_in_bytes = 0;
+	dx_context.GetDevice()->GetCopyableFootprints(&destination.m_resource_desc, 0, 1, 0, &footprint, &row_count, &row_size, &size_in_bytes);
+
+	DXResource upload_buffer{};
+	upload_buffer.SetResourceInfo(D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_FLAG_NONE, size_in_bytes);
+	upload_buffer.CreateResource(dx_context, "UploadTexture");
+
+	uint8* data = nullptr;
+	upload_buffer.m_resource->Map(0, nullptr, reinterpret_cast<void**>(&data)) >> CHK;
+	for (uint32 y = 0; y < row_count; ++y)
+	{
+		memcpy(data + footprint.Offset + y * footprint.Footprint.RowPitch, rgba + y * row_size, row_size);
+	}
+	upload_buffer.m_resource->Unmap(0, nullptr);
+
+	dx_context.InitCommandLists();
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, upload_buffer);
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, destination);
+	const D3D12_TEXTURE_COPY_LOCATION destination_location
+	{
+		.pResource = destination.m_resource.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+		.SubresourceIndex = 0,
+	};
+	const D3D12_TEXTURE_COPY_LOCATION source_location
+	{
+		.pResource = upload_buffer.m_resource.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+		.PlacedFootprint = footprint,
+	};
+	dx_context.GetCommandListGraphics()->CopyTextureRegion(&destination_location, 0, 0, 0, &source_location, nullptr);
+	dx_context.Transition(final_resource_state, destination);
+	dx_context.ExecuteCommandListGraphics();
+	dx_context.Flush(1);
+}
+
+// Blocking readback of every mip with tightly packed rows, blocks rows for BC formats, only meant for validation
+std::vector<std::vector<uint8>> ReadbackTexture(DXContext& dx_context, DXTextureResource& texture)
+{
+	const uint32 mip_levels = texture.m_resource_desc.MipLevels;
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(mip_levels);
+	std::vector<uint32> row_counts(mip_levels);
+	std::vector<uint64> row_sizes(mip_levels);
+	uint64 size_in_bytes = 0;
+	dx_context.GetDevice()->GetCopyableFootprints(&texture.m_resource_desc, 0, mip_levels, 0, footprints.data(), row_counts.data(), row_sizes.data(), &size_in_bytes);
+
+	DXResource readback_buffer{};
+	readback_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, size_in_bytes);
+	readback_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+	readback_buffer.CreateResource(dx_context, "Texture Readback");
+
+	dx_context.InitCommandLists();
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, texture);
+	for (uint32 mip = 0; mip < mip_levels; ++mip)
+	{
+		const D3D12_TEXTURE_COPY_LOCATION destination
+		{
+			.pResource = readback_buffer.m_resource.Get(),
+			.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+			.PlacedFootprint = footprints[mip],
+		};
+		const D3D12_TEXTURE_COPY_LOCATION source
+		{
+			.pResource = texture.m_resource.Get(),
+			.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+			.SubresourceIndex = mip,
+		};
+		dx_context.GetCommandListGraphics()->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+	}
+	dx_context.ExecuteCommandListGraphics();
+	dx_context.Flush(1);
+
+	uint8* data = nullptr;
+	const D3D12_RANGE range = { 0, size_in_bytes };
+	readback_buffer.m_resource->Map(0, &range, reinterpret_cast<void**>(&data)) >> CHK;
+	std::vector<std::vector<uint8>> mips(mip_levels);
+	for (uint32 mip = 0; mip < mip_levels; ++mip)
+	{
+		mips[mip].resize(row_counts[mip] * row_sizes[mip]);
+		for (uint32 y = 0; y < row_counts[mip]; ++y)
+		{
+			memcpy(mips[mip].data() + y * row_sizes[mip], data + footprints[mip].Offset + y * footprints[mip].Footprint.RowPitch, row_sizes[mip]);
+		}
+	}
+	const D3D12_RANGE write_range = { 0, 0 };
+	readback_buffer.m_resource->Unmap(0, &write_range);
+	return mips;
+}
+
+// Mips 1 and below from mip 0 in a single dispatch, the texture is left in UNORDERED_ACCESS
+// sRGB formats have no UAV, the texture is UNORM and is_srgb filters in linear
+void GenerateMips(DXContext& dx_context, TextureResources& resource, DXTextureResource& texture, bool is_srgb)
+{
+	ASSERT(texture.m_width <= g_generate_mips_max_size && texture.m_height <= g_generate_mips_max_size);
+	const uint32 mip_count = texture.m_resource_desc.MipLevels - 1u;
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, texture);
+	if (mip_count == 0)
+	{
+		return;
+	}
+
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, resource.m_counter_buffer);
+	D3D12_WRITEBUFFERIMMEDIATE_PARAMETER counter_reset[] =
+	{
+		{ resource.m_counter_buffer.m_resource->GetGPUVirtualAddress(), 0 },
+	};
+	dx_context.GetCommandListGraphics()->WriteBufferImmediate(COUNT(counter_reset), counter_reset, nullptr);
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, resource.m_counter_buffer);
+
+	// One group per 64x64 tile of mip 0
+	const uint32 group_count_x = DivideRoundUp(texture.m_width, 64);
+	const uint32 group_count_y = DivideRoundUp(texture.m_height, 64);
+	UAV counter_uav = dx_context.CreateUAV(resource.m_counter_buffer, GetByteBufferUAVDesc(sizeof(uint32)));
+	GenerateMipsConstants constants
+	{
+		.mip_count = mip_count,
+		.is_srgb = is_srgb ? 1u : 0u,
+		.counter_bindless_index = counter_uav.m_bindless_index,
+		.group_count = group_count_x * group_count_y,
+	};
+	uint32* mip_bindless_indices[] = { constants.mip_bindless_indices0, constants.mip_bindless_indices1, constants.mip_bindless_indices2, constants.mip_bindless_indices3 };
+	for (uint32 mip = 0; mip <= mip_count; ++mip)
+	{
+		UAV mip_uav = dx_context.CreateUAV(texture, GetTexture2DUAVDesc(texture.m_format, mip));
+		mip_bindless_indices[mip / 4][mip % 4] = mip_uav.m_bindless_index;
+	}
+
+	SetPSO(dx_context.GetCommandListGraphics().Get(), resource.m_mips_pipeline.m_pso);
+	dx_context.GetCommandListGraphics()->SetComputeRootSignature(resource.m_mips_pipeline.m_root_signature.m_signature.Get());
+	SetComputeRootConstants(dx_context.GetCommandListGraphics().Get(), constants);
+	dx_context.GetCommandListGraphics()->Dispatch(group_count_x, group_count_y, 1);
+
+	// Mips are read through UAVs by whatever comes next
+	const D3D12_RESOURCE_BARRIER barrier
+	{
+		.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV,
+		.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+		.UAV = { .pResource = texture.m_resource.Get() },
+	};
+	dx_context.GetCommandListGraphics()->ResourceBarrier(1, &barrier);
+}
+
+// Every mip of source into a new placed BC texture of the same size, left in COPY_DEST
+// BC formats have no UAV, blocks are written to a buffer in the placed footprint layout of the texture and copied per mip
+void CompressTexture
+(
+	DXContext& dx_context,
+	TextureResources& resource,
+	DXTextureResource& source,
+	BCFormat format,
+	DXTextureResource& out_texture
+)
+{
+	// Mip 0 of a BC texture is made of whole blocks
+	ASSERT(source.m_width % 4 == 0 && source.m_height % 4 == 0);
+	const uint32 mip_levels = source.m_resource_desc.MipLevels;
+	out_texture.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_NONE, source.m_width, source.m_height, GetBCDXGIFormat(format), (uint16)mip_levels);
+	out_texture.CreateResource(dx_context, "Compressed Texture");
+
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(mip_levels);
+	uint64 size_in_bytes = 0;
+	dx_context.GetDevice()->GetCopyableFootprints(&out_texture.m_resource_desc, 0, mip_levels, 0, footprints.data(), nullptr, nullptr, &size_in_bytes);
+
+	DXResource block_buffer{};
+	block_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, size_in_bytes);
+	block_buffer.CreateResource(dx_context, "Block Buffer");
+	dx_context.m_resource_handler.RegisterResource(block_buffer);
+
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, source);
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, block_buffer);
+	UAV block_uav = dx_context.CreateUAV(block_buffer, GetByteBufferUAVDesc((uint32)size_in_bytes));
+
+	const ShaderPermutationKey key = resource.m_compress_permutations.GetKey({ resource.m_compress_permutations.GetValue("BC_FORMAT", g_bc_format_names[static_cast<uint32>(format)]) });
+	const ShaderPipeline& pipeline = resource.m_compress_pipelines[key];
+	SetPSO(dx_context.GetCommandListGraphics().Get(), pipeline.m_pso);
+	dx_context.GetCommandListGraphics()->SetComputeRootSignature(pipeline.m_root_signature.m_signature.Get());
+	for (uint32 mip = 0; mip < mip_levels; ++mip)
+	{
+		const uint32 mip_width = (std::max)(source.m_width >> mip, 1u);
+		const uint32 mip_height = (std::max)(source.m_height >> mip, 1u);
+		UAV source_uav = dx_context.CreateUAV(source, GetTexture2DUAVDesc(source.m_format, mip));
+		const CompressBCConstants constants
+		{
+			.source_bindless_index = source_uav.m_bindless_index,
+			.destination_bindless_index = block_uav.m_bindless_index,
+			.destination_offset = (uint32)footprints[mip].Offset,
+			.row_pitch = footprints[mip].Footprint.RowPitch,
+			.block_count_x = DivideRoundUp(mip_width, 4),
+			.block_count_y = DivideRoundUp(mip_height, 4),
+			.mip_width = mip_width,
+			.mip_height = mip_height,
+		};
+		SetComputeRootConstants(dx_context.GetCommandListGraphics().Get(), constants);
+		dx_context.GetCommandListGraphics()->Dispatch(DivideRoundUp(constants.block_count_x, 8), DivideRoundUp(constants.block_count_y, 8), 1);
+	}
+
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, block_buffer);
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, out_texture);
+	for (uint32 mip = 0; mip < mip_levels; ++mip)
+	{
+		const D3D12_TEXTURE_COPY_LOCATION destination
+		{
+			.pResource = out_texture.m_resource.Get(),
+			.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+			.SubresourceIndex = mip,
+		};
+		const D3D12_TEXTURE_COPY_LOCATION source_location
+		{
+			.pResource = block_buffer.m_resource.Get(),
+			.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+			.PlacedFootprint = footprints[mip],
+		};
+		dx_context.GetCommandListGraphics()->CopyTextureRegion(&destination, 0, 0, 0, &source_location, nullptr);
+	}
+	dx_context.m_resource_handler.ReRegisterResource(block_buffer);
+}
+
+// GPU mip chain and block compression of a synthetic image against the CPU references
+// GPU blocks are compared to EncodeBC of the GPU mips so only the encoders differ, quality is the PSNR of mip 0
+void RunTextureCompressionBenchmark(DXContext& dx_context, DXCompiler& dx_compiler)
+{
+	const uint32 size = 2048;
+	const bool is_srgb = true;
+	const uint32 iteration_count = 16;
+	const uint32 cpu_iteration_count = 4;
+	TextureResources resource{};
+	CreateTextureResources(dx_context, dx_compiler, resource);
+
+	// Gradients under a noisy checker, smooth and sharp blocks alike
+	std::vector<uint8> image(size * size * 4);
+	for (uint32 y = 0; y < size; ++y)
+	{
+		for (uint32 x = 0; x < size; ++x)
+		{
+			const uint32 hash = (x * 73856093u) ^ (y * 19349663u);
+			const bool is_checker = ((x / 32) ^ (y / 32)) & 1;
+			uint8* texel = image.data() + (y * size + x) * 4;
+			texel[0] = (uint8)(x * 255 / (size - 1));
+			texel[1] = (uint8)(y * 255 / (size - 1));
+			texel[2] = (uint8)((is_checker ? 224 : 32) + (hash >> 27));
+			texel[3] = (uint8)(128 + (hash >> 25));
+		}
+	}
+
+	const uint32 mip_levels = GetMipCount(size, size);
+	DXTextureResource texture{};
+	texture.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, size, size, DXGI_FORMAT_R8G8B8A8_UNORM, (uint16)mip_levels);
+	texture.CreateResource(dx_context, "Texture Benchmark Source");
+	UploadTexture(dx_context, texture, image.data(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	const uint32 format_count = static_cast<uint32>(BCFormat::Count);
+	std::vector<std::string> scope_names = { "GenerateMips" };
+	for (const char* name : g_bc_format_names)
+	{
+		scope_names.push_back(std::format("Compress {0}", name));
+	}
+	GPUProfiler gpu_profiler{};
+	gpu_profiler.Init(dx_context, scope_names);
+
+	std::vector<DXTextureResource> compressed(format_count);
+	std::vector<float64> gpu_milliseconds(scope_names.size(), 0.0);
+	for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		dx_context.InitCommandLists();
+		dx_context.GetCommandListGraphics()->SetDescriptorHeaps(1, dx_context.m_resources_descriptor_heap.m_heap.GetAddressOf());
+		gpu_profiler.BeginScope(dx_context, 0);
+		GenerateMips(dx_context, resource, texture, is_srgb);
+		gpu_profiler.EndScope(dx_context, 0);
+		for (uint32 format = 0; format < format_count; ++format)
+		{
+			gpu_profiler.BeginScope(dx_context, 1 + format);
+			CompressTexture(dx_context, resource, texture, static_cast<BCFormat>(format), compressed[format]);
+			gpu_profiler.EndScope(dx_context, 1 + format);
+		}
+		gpu_profiler.Resolve(dx_context);
+		dx_context.ExecuteCommandListGraphics();
+		dx_context.Flush(1);
+
+		gpu_profiler.Readback();
+		for (uint32 scope = 0; scope < (uint32)scope_names.size(); ++scope)
+		{
+			gpu_milliseconds[scope] += gpu_profiler.GetScopeMilliseconds(scope);
+		}
+	}
+
+	uint64 texel_count = 0;
+	for (uint32 mip = 0; mip < mip_levels; ++mip)
+	{
+		texel_count += (uint64)(std::max)(size >> mip, 1u) * (std::max)(size >> mip, 1u);
+	}
+
+	// Mip 6 is quantized between the two passes of the GPU, the reference keeps floats all along
+	const std::vector<std::vector<uint8>> gpu_mips = ReadbackTexture(dx_context, texture);
+	const std::vector<std::vector<uint8>> reference_mips = GenerateMipsReference(image.data(), size, size, is_srgb);
+	uint32 max_mip_error = 0;
+	for (uint32 mip = 1; mip < mip_levels; ++mip)
+	{
+		for (uint32 i = 0; i < (uint32)gpu_mips[mip].size(); ++i)
+		{
+			max_mip_error = (std::max)(max_mip_error, (uint32)std::abs((int32)gpu_mips[mip][i] - (int32)reference_mips[mip - 1][i]));
+		}
+	}
+	LOG_INFO
+	(
+		General, "GenerateMips {0}x{0}, {1} levels: GPU {2:.3f} ms, max error against the reference {3}",
+		size, mip_levels, gpu_milliseconds[0] / iteration_count, max_mip_error
+	);
+
+	// Channels stored by each format
+	const uint32 channel_counts[] = { 3, 1, 2, 4 };
+	static_assert(std::size(channel_counts) == static_cast<uint32>(BCFormat::Count));
+	for (uint32 format = 0; format < format_count; ++format)
+	{
+		const BCFormat bc_format = static_cast<BCFormat>(format);
+		const uint32 block_size = GetBCBlockSize(bc_format);
+		const std::vector<std::vector<uint8>> gpu_blocks = ReadbackTexture(dx_context, compressed[format]);
+
+		uint64 block_count = 0;
+		uint64 identical_block_count = 0;
+		float64 cpu_milliseconds = 0.0;
+		for (uint32 mip = 0; mip < mip_levels; ++mip)
+		{
+			const uint32 mip_size = (std::max)(size >> mip, 1u);
+			std::vector<uint8> cpu_blocks(gpu_blocks[mip].size());
+			const std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+			for (uint32 iteration = 0; iteration < cpu_iteration_count; ++iteration)
+			{
+				EncodeBC(bc_format, gpu_mips[mip].data(), mip_size, mip_size, cpu_blocks.data());
+			}
+			cpu_milliseconds += std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count() / cpu_iteration_count;
+			for (uint64 offset = 0; offset < cpu_blocks.size(); offset += block_size)
+			{
+				identical_block_count += memcmp(cpu_blocks.data() + offset, gpu_blocks[mip].data() + offset, block_size) == 0 ? 1 : 0;
+			}
+			block_count += cpu_blocks.size() / block_size;
+		}
+
+		std::vector<uint8> decoded(size * size * 4);
+		const bool is_decoded = DecodeBC(bc_format, gpu_blocks[0].data(), size, size, decoded.data());
+		ASSERT(is_decoded);
+		const float64 psnr = ComputePSNR(decoded.data(), gpu_mips[0].data(), size * size, channel_counts[format]);
+		const float64 gpu_format_milliseconds = gpu_milliseconds[1 + format] / iteration_count;
+		LOG_INFO
+		(
+			General,
+			"Compress {0}: GPU {1:.3f} ms {2:.0f} MTexels/s, CPU {3:.3f} ms {4:.0f} MTexels/s, {5:.2f}% blocks identical, mip 0 {6:.2f} dB",
+			g_bc_format_names[format],
+			gpu_format_milliseconds, texel_count / (gpu_format_milliseconds * 1000.0),
+			cpu_milliseconds, texel_count / (cpu_milliseconds * 1000.0),
+			100.0 * identical_block_count / block_count, psnr
+		);
+	}
+}
+#pragma endregion
+
 #pragma region WORKGRAPH
 struct WorkGraphResources
 {
@@ -543,11 +1992,15 @@ struct WorkGraphResources
 void CreateWorkGraphResource
  (
 	 DXContext& dx_context, DXCompiler& dx_compiler, 
+	 uint32 test_index,
 	 WorkGraphResources& resource,
 	 bool is_pix_running
  )
 {
-	resource.m_workgraph_shader = dx_compiler.Compile(dx_context.GetDevice(), { ShaderType::LIB_SHADER, "WorkGraphShader.hlsl", "main" });
+	// Only the permutation of the test is compiled
+	ShaderPermutations permutations{};
+	permutations.Init(GetWorkGraphPermutationDesc());
+	resource.m_workgraph_shader = permutations.Get(dx_compiler, dx_context.GetDevice(), permutations.GetKey({ test_index }));
 
 	D3D12_SHADER_BYTECODE byte_code = BlobToByteCode(resource.m_workgraph_shader.m_blob);
 
@@ -593,11 +2046,19 @@ void CreateWorkGraphResource
 	resource.m_cpu_buffer.CreateResource(dx_context, "Readback resource");
 }
 
-void RunWorkGraph(DXContext& dx_context, DXCompiler& dx_compiler, bool is_pix_running = false)
+uint32 FindWorkGraphTest(const std::string& test_name)
 {
-	WorkGraphResources resource{};
-	CreateWorkGraphResource(dx_context, dx_compiler, resource, is_pix_running);
+	uint32 test_index = 0;
+	while (test_index < g_workgraph_tests.size() && g_workgraph_tests[test_index].m_name != test_name)
+	{
+		++test_index;
+	}
+	return test_index;
+}
 
+// Records the graph dispatch with the CPU records of the test into the current command list
+void DispatchWorkGraph(DXContext& dx_context, WorkGraphResources& resource, const WorkGraphTest& test)
+{
 	D3D12_GPU_VIRTUAL_ADDRESS_RANGE backing_memory{};
 	if (resource.m_scratch_buffer.m_resource)
 	{
@@ -616,77 +2077,6 @@ void RunWorkGraph(DXContext& dx_context, DXCompiler& dx_compiler, bool is_pix_ru
 			.NodeLocalRootArgumentsTable = 0,
 		},
 	};
-//#define WORKGRAPH_TEST1
-//#define WORKGRAPH_TEST2
-//#define WORKGRAPH_TEST3
-//#define WORKGRAPH_TEST4
-//#define WORKGRAPH_TEST5
-//#define WORKGRAPH_TEST6
-#if defined(WORKGRAPH_TEST1)
-	struct Record
-	{
-		uint32 index;
-	};
-	std::vector<Record> records{};
-	//records.push_back(Record{ 0 });
-	//records.push_back(Record{ 1 });
-#elif defined(WORKGRAPH_TEST2)
-	struct Record
-	{
-		uint32 index;
-	};
-	std::vector<Record> records{};
-	records.push_back(Record{ 0 });
-	records.push_back(Record{ 1 });
-#elif defined(WORKGRAPH_TEST3)
-	struct Record
-	{
-		uint32 DispatchGrid[3];
-		uint32 index;
-	};
-	std::vector<Record> records{};
-	records.push_back( {{ 1, 2, 3 }, 0});
-	records.push_back( {{ 2, 2, 2 }, 1});
-#elif defined(WORKGRAPH_TEST4)
-	struct Record
-	{
-		uint32 index;
-	};
-	std::vector<Record> records{};
-	records.push_back(Record{ 0 });
-	records.push_back(Record{ 1 });
-	records.push_back(Record{ 2 });
-#elif defined(WORKGRAPH_TEST5)
-	struct Record
-	{
-		uint32 index;
-	};
-	std::vector<Record> records{};
-	records.push_back(Record{ 0 });
-	records.push_back(Record{ 1 });
-	//records.push_back(Record{ 2 });
-#elif defined(WORKGRAPH_TEST6)
-	struct Record
-	{
-		uint32 index;
-	};
-	std::vector<Record> records{};
-	records.push_back(Record{ 0 });
-	//records.push_back(Record{ 1 });
-	//records.push_back(Record{ 2 });
-#else
-
-	struct Record
-	{
-		uint32 gridSize; // : SV_DispatchGrid;
-		uint32 recordIndex;
-	};
-	std::vector<Record> records{};
-//	records.push_back(Record{ 1, 0 });
-	records.push_back(Record{ 2, 1 });
-//	records.push_back(Record{ 3, 2 });
-//	records.push_back(Record{ 4, 3 });
-#endif
 
 	D3D12_DISPATCH_GRAPH_DESC workgraph_desc =
 	{
@@ -694,18 +2084,31 @@ void RunWorkGraph(DXContext& dx_context, DXCompiler& dx_compiler, bool is_pix_ru
 		.NodeCPUInput =
 		{
 			.EntrypointIndex = 0,
-			.NumRecords = std::max((uint32)records.size(), 1u), // Needs at least 1 to dispatch work graph
-			.pRecords = records.data(),
-			.RecordStrideInBytes = sizeof(Record)
+			.NumRecords = std::max((uint32)(test.m_records.size() / test.m_record_stride), 1u), // Needs at least 1 to dispatch work graph
+			.pRecords = test.m_records.data(),
+			.RecordStrideInBytes = test.m_record_stride
 		},
 	};
 
-	dx_context.InitCommandLists();
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, resource.m_gpu_buffer);
 	dx_context.GetCommandListGraphics()->SetComputeRootSignature(resource.m_workgraph_root_signature.m_signature.Get());
 	dx_context.GetCommandListGraphics()->SetComputeRootUnorderedAccessView(0, resource.m_gpu_buffer.m_resource->GetGPUVirtualAddress());
 	dx_context.GetCommandListGraphics()->SetProgram(&program_desc);
 	dx_context.GetCommandListGraphics()->DispatchGraph(&workgraph_desc);
-	LogTrace("Workgraph Dispatched");
+}
+
+void RunWorkGraph(DXContext& dx_context, DXCompiler& dx_compiler, const std::string& test_name = "SAMPLE", bool is_pix_running = false)
+{
+	const uint32 test_index = FindWorkGraphTest(test_name);
+	ASSERT(test_index < g_workgraph_tests.size());
+	const WorkGraphTest& test = g_workgraph_tests[test_index];
+
+	WorkGraphResources resource{};
+	CreateWorkGraphResource(dx_context, dx_compiler, test_index, resource, is_pix_running);
+
+	dx_context.InitCommandLists();
+	DispatchWorkGraph(dx_context, resource, test);
+	LOG_TRACE(WorkGraph, "Workgraph Dispatched");
 
 	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, resource.m_gpu_buffer);
 	dx_context.GetCommandListGraphics()->CopyResource(resource.m_cpu_buffer.m_resource.Get(), resource.m_gpu_buffer.m_resource.Get());
@@ -716,15 +2119,345 @@ void RunWorkGraph(DXContext& dx_context, DXCompiler& dx_compiler, bool is_pix_ru
 	const D3D12_RANGE range = { 0, resource.m_cpu_buffer.m_resource_desc.Width };
 	resource.m_cpu_buffer.m_resource->Map(0, &range, (void**)&data);
 	resource.m_cpu_buffer.m_resource->Unmap(0, nullptr);
-	LogTrace("Readback from GPU");
+	LOG_TRACE(WorkGraph, "Readback from GPU");
 
 	for (uint32 i = 0; i < 33; ++i)
 	{
-		LogTrace("uav workgraph[{}] = {}\n", i, data[i]);
+		LOG_TRACE(WorkGraph, "uav workgraph[{}] = {}\n", i, data[i]);
 	}
 }
 #pragma endregion
 
+#pragma region HEADLESS
+enum class HeadlessPassType
+{
+	Compute,
+	WorkGraph,
+};
+
+struct HeadlessPass
+{
+	HeadlessPassType m_type;
+	// COMPUTE_MODE value for compute passes, test name for work graph passes
+	std::string m_value;
+};
+
+// Offscreen run without window, swap chain or ImGui
+// --headless --iterations N --size WxH --output dir --pass compute:JULIA --pass workgraph:SAMPLE --check-allocations
+struct HeadlessDesc
+{
+	std::vector<HeadlessPass> m_passes;
+	uint32 m_iteration_count = 1;
+	uint32 m_width = 1920;
+	uint32 m_height = 1080;
+	std::string m_output_directory = "headless";
+	// Fails the run when an iteration after the warm up allocates from the heap
+	bool m_check_allocations = false;
+};
+
+// Iterations filling the per frame containers and arenas before the steady state
+static const uint32 g_headless_warm_up_iteration_count = g_backbuffer_count;
+
+// Returns true when --headless is passed, unknown arguments are reported and skipped
+bool ParseHeadlessDesc(int argc, char** argv, HeadlessDesc& desc)
+{
+	bool is_headless = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (argument == "--headless")
+		{
+			is_headless = true;
+		}
+		else if (argument == "--iterations" && has_value)
+		{
+			desc.m_iteration_count = (std::max)((uint32)std::strtoul(argv[++i], nullptr, 10), 1u);
+		}
+		else if (argument == "--size" && has_value)
+		{
+			uint32 width = 0;
+			uint32 height = 0;
+			if (sscanf_s(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+			{
+				desc.m_width = width;
+				desc.m_height = height;
+			}
+			else
+			{
+				LOG_ERROR(General, "Invalid headless size {0}, expected WxH", argv[i]);
+			}
+		}
+		else if (argument == "--check-allocations")
+		{
+			desc.m_check_allocations = true;
+		}
+		else if (argument == "--output" && has_value)
+		{
+			desc.m_output_directory = argv[++i];
+		}
+		else if (argument == "--pass" && has_value)
+		{
+			const std::string pass = argv[++i];
+			const size_t separator = pass.find(':');
+			const std::string type = pass.substr(0, separator);
+			const std::string value = separator == std::string::npos ? "" : pass.substr(separator + 1);
+			if (type == "compute")
+			{
+				desc.m_passes.push_back({ .m_type = HeadlessPassType::Compute, .m_value = value.empty() ? "JULIA" : value });
+			}
+			else if (type == "workgraph")
+			{
+				desc.m_passes.push_back({ .m_type = HeadlessPassType::WorkGraph, .m_value = value.empty() ? "SAMPLE" : value });
+			}
+			else
+			{
+				LOG_ERROR(General, "Unknown headless pass {0}", pass);
+			}
+		}
+		else
+		{
+			LOG_ERROR(General, "Unknown argument {0}", argument);
+		}
+	}
+	if (desc.m_passes.empty())
+	{
+		desc.m_passes.push_back({ .m_type = HeadlessPassType::Compute, .m_value = "JULIA" });
+	}
+	return is_headless;
+}
+
+struct HeadlessPassResources
+{
+	// Compute
+	ShaderPermutationKey m_key = 0;
+	DXTextureResource m_output;
+	DXResource m_readback_buffer;
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_footprint{};
+	// Work graph
+	uint32 m_test_index = 0;
+	WorkGraphResources m_work_graph;
+	// Single scope timing the pass
+	GPUProfiler m_gpu_profiler;
+};
+
+void WriteHeadlessImage(const std::string& path, HeadlessPassResources& resource)
+{
+	const D3D12_SUBRESOURCE_FOOTPRINT& footprint = resource.m_footprint.Footprint;
+	uint8* data = nullptr;
+	const D3D12_RANGE range = { 0, resource.m_readback_buffer.m_resource_desc.Width };
+	resource.m_readback_buffer.m_resource->Map(0, &range, (void**)&data) >> CHK;
+
+	// Binary PPM, drops alpha of the RGBA8 rows
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << "P6\n" << footprint.Width << " " << footprint.Height << "\n255\n";
+	std::vector<uint8> row(footprint.Width * 3);
+	for (uint32 y = 0; y < footprint.Height; ++y)
+	{
+		const uint8* source = data + resource.m_footprint.Offset + (uint64)y * footprint.RowPitch;
+		for (uint32 x = 0; x < footprint.Width; ++x)
+		{
+			row[x * 3 + 0] = source[x * 4 + 0];
+			row[x * 3 + 1] = source[x * 4 + 1];
+			row[x * 3 + 2] = source[x * 4 + 2];
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	const D3D12_RANGE write_range = { 0, 0 };
+	resource.m_readback_buffer.m_resource->Unmap(0, &write_range);
+}
+
+void WriteHeadlessWorkGraph(const std::string& path, HeadlessPassResources& resource, uint32 iteration_count)
+{
+	uint32* data = nullptr;
+	const D3D12_RANGE range = { 0, resource.m_work_graph.m_cpu_buffer.m_resource_desc.Width };
+	resource.m_work_graph.m_cpu_buffer.m_resource->Map(0, &range, (void**)&data) >> CHK;
+
+	std::ofstream file(path, std::ios::trunc);
+	// The buffer is never cleared so values accumulate over iterations
+	file << "iterations " << iteration_count << "\n";
+	for (uint32 i = 0; i < 64; ++i)
+	{
+		file << "uav workgraph[" << i << "] = " << data[i] << "\n";
+	}
+
+	const D3D12_RANGE write_range = { 0, 0 };
+	resource.m_work_graph.m_cpu_buffer.m_resource->Unmap(0, &write_range);
+}
+
+// Runs the passes back to back every iteration and waits for the GPU after each one
+// Results of the last iteration and timings of all iterations are written to the output directory
+// False when the allocation check failed
+bool RunHeadless(DXContext& dx_context, DXCompiler& dx_compiler, const HeadlessDesc& desc)
+{
+	const uint32 pass_count = (uint32)desc.m_passes.size();
+	std::vector<HeadlessPassResources> resources(pass_count);
+	std::vector<std::string> pass_names(pass_count);
+
+	ComputeResources compute_resource{};
+	bool has_compute = false;
+	for (const HeadlessPass& pass : desc.m_passes)
+	{
+		has_compute |= pass.m_type == HeadlessPassType::Compute;
+	}
+	if (has_compute)
+	{
+		CreateComputeResources(dx_context, dx_compiler, compute_resource);
+	}
+
+	for (uint32 i = 0; i < pass_count; ++i)
+	{
+		const HeadlessPass& pass = desc.m_passes[i];
+		HeadlessPassResources& resource = resources[i];
+		if (pass.m_type == HeadlessPassType::Compute)
+		{
+			pass_names[i] = "compute_" + pass.m_value;
+			resource.m_key = compute_resource.m_permutations.GetKey({ compute_resource.m_permutations.GetValue("COMPUTE_MODE", pass.m_value) });
+			ASSERT(!compute_resource.m_permutations.IsPruned(resource.m_key));
+
+			resource.m_output.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_NONE, desc.m_width, desc.m_height, DXGI_FORMAT_R8G8B8A8_UNORM);
+			resource.m_output.CreateResource(dx_context, "Headless Output");
+
+			uint64 readback_size = 0;
+			dx_context.GetDevice()->GetCopyableFootprints(&resource.m_output.m_resource_desc, 0, 1, 0, &resource.m_footprint, nullptr, nullptr, &readback_size);
+			resource.m_readback_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, readback_size);
+			resource.m_readback_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+			resource.m_readback_buffer.CreateResource(dx_context, "Headless Readback");
+		}
+		else
+		{
+			pass_names[i] = "workgraph_" + pass.m_value;
+			resource.m_test_index = FindWorkGraphTest(pass.m_value);
+			ASSERT(resource.m_test_index < g_workgraph_tests.size());
+			CreateWorkGraphResource(dx_context, dx_compiler, resource.m_test_index, resource.m_work_graph, false);
+		}
+		resource.m_gpu_profiler.Init(dx_context, { pass_names[i] });
+	}
+
+	std::filesystem::create_directories(desc.m_output_directory);
+	std::ofstream timing_file(std::filesystem::path(desc.m_output_directory) / "timing.csv", std::ios::trunc);
+	timing_file << "iteration,cpu_ms,allocations";
+	for (const std::string& pass_name : pass_names)
+	{
+		timing_file << "," << pass_name << "_gpu_ms";
+	}
+	timing_file << "\n";
+
+	std::vector<float64> gpu_milliseconds_sum(pass_count, 0.0);
+	std::vector<float64> gpu_milliseconds_min(pass_count, std::numeric_limits<float64>::max());
+	std::vector<float64> gpu_milliseconds_max(pass_count, 0.0);
+	float64 cpu_milliseconds_sum = 0.0;
+	uint32 allocating_iteration_count = 0;
+	for (uint32 iteration = 0; iteration < desc.m_iteration_count; ++iteration)
+	{
+		const bool is_last_iteration = iteration + 1 == desc.m_iteration_count;
+		const auto begin_time = std::chrono::steady_clock::now();
+		const uint64 allocation_count_begin = GetThreadAllocationCount();
+
+		dx_context.InitCommandLists();
+		dx_context.GetCommandListGraphics()->SetDescriptorHeaps(1, dx_context.m_resources_descriptor_heap.m_heap.GetAddressOf());
+		for (uint32 i = 0; i < pass_count; ++i)
+		{
+			HeadlessPassResources& resource = resources[i];
+			if (desc.m_passes[i].m_type == HeadlessPassType::Compute)
+			{
+				// Fixed time step so every run produces the same images
+				compute_resource.m_key = resource.m_key;
+				ComputeWork(dx_context, compute_resource, resource.m_output, resource.m_gpu_profiler, (float32)iteration / 60.0f, iteration);
+				if (is_last_iteration)
+				{
+					dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, resource.m_output);
+					const D3D12_TEXTURE_COPY_LOCATION destination
+					{
+						.pResource = resource.m_readback_buffer.m_resource.Get(),
+						.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+						.PlacedFootprint = resource.m_footprint,
+					};
+					const D3D12_TEXTURE_COPY_LOCATION source
+					{
+						.pResource = resource.m_output.m_resource.Get(),
+						.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+						.SubresourceIndex = 0,
+					};
+					dx_context.GetCommandListGraphics()->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+				}
+			}
+			else
+			{
+				resource.m_gpu_profiler.BeginScope(dx_context, 0);
+				DispatchWorkGraph(dx_context, resource.m_work_graph, g_workgraph_tests[resource.m_test_index]);
+				resource.m_gpu_profiler.EndScope(dx_context, 0);
+				if (is_last_iteration)
+				{
+					dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, resource.m_work_graph.m_gpu_buffer);
+					dx_context.GetCommandListGraphics()->CopyResource(resource.m_work_graph.m_cpu_buffer.m_resource.Get(), resource.m_work_graph.m_gpu_buffer.m_resource.Get());
+				}
+			}
+			resource.m_gpu_profiler.Resolve(dx_context);
+		}
+		dx_context.ExecuteCommandListGraphics();
+		dx_context.Flush(1);
+
+		const float64 cpu_milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+		cpu_milliseconds_sum += cpu_milliseconds;
+		// Last iteration records the readback copies as well
+		const uint64 allocation_count = GetThreadAllocationCount() - allocation_count_begin;
+		if (iteration >= g_headless_warm_up_iteration_count && allocation_count > 0)
+		{
+			++allocating_iteration_count;
+			if (desc.m_check_allocations)
+			{
+				LOG_ERROR(General, "Headless iteration {0} made {1} heap allocations", iteration, allocation_count);
+			}
+		}
+		timing_file << iteration << "," << cpu_milliseconds << "," << allocation_count;
+		for (uint32 i = 0; i < pass_count; ++i)
+		{
+			resources[i].m_gpu_profiler.Readback();
+			const float64 gpu_milliseconds = resources[i].m_gpu_profiler.GetScopeMilliseconds(0);
+			gpu_milliseconds_sum[i] += gpu_milliseconds;
+			gpu_milliseconds_min[i] = (std::min)(gpu_milliseconds_min[i], gpu_milliseconds);
+			gpu_milliseconds_max[i] = (std::max)(gpu_milliseconds_max[i], gpu_milliseconds);
+			timing_file << "," << gpu_milliseconds;
+		}
+		timing_file << "\n";
+	}
+
+	for (uint32 i = 0; i < pass_count; ++i)
+	{
+		const std::filesystem::path directory = desc.m_output_directory;
+		if (desc.m_passes[i].m_type == HeadlessPassType::Compute)
+		{
+			WriteHeadlessImage((directory / (pass_names[i] + ".ppm")).string(), resources[i]);
+		}
+		else
+		{
+			WriteHeadlessWorkGraph((directory / (pass_names[i] + ".txt")).string(), resources[i], desc.m_iteration_count);
+		}
+		LOG_INFO
+		(
+			General,
+			"Headless {0}: gpu mean {1:.3f} ms, min {2:.3f} ms, max {3:.3f} ms",
+			pass_names[i], gpu_milliseconds_sum[i] / desc.m_iteration_count, gpu_milliseconds_min[i], gpu_milliseconds_max[i]
+		);
+	}
+	LOG_INFO(General, "Headless {0} iterations, cpu mean {1:.3f} ms, results in {2}", desc.m_iteration_count, cpu_milliseconds_sum / desc.m_iteration_count, desc.m_output_directory);
+	if (desc.m_check_allocations)
+	{
+		if (desc.m_iteration_count <= g_headless_warm_up_iteration_count)
+		{
+			LOG_WARNING(General, "Allocation check needs more than {0} iterations, nothing was checked", g_headless_warm_up_iteration_count);
+		}
+		else if (allocating_iteration_count == 0)
+		{
+			LOG_INFO(General, "Allocation check passed, no heap allocation after {0} warm up iterations", g_headless_warm_up_iteration_count);
+		}
+	}
+	return !desc.m_check_allocations || allocating_iteration_count == 0;
+}
+#pragma endregion
+
 enum class GPUCaptureType
 {
 	NONE,
@@ -758,7 +2491,7 @@ void StallWaitDebugger(bool enable_wait)
 #endif
 }
 
-int main()
+int main(int argc, char** argv)
 {
 	StallWaitDebugger(false);
 	MemoryTrack();
@@ -772,8 +2505,33 @@ int main()
 		DXContext dx_context{enable_debug_layer_cpu, enable_debug_layer_gpu, enable_dred, use_warp};
 		dx_report_context.SetDevice(dx_context.GetDevice(), dx_context.m_adapter);
 		DXCompiler dx_compiler("shaders");
-		//RunWorkGraph(dx_context, dx_compiler, dynamic_cast<PIXCapture*>(gpu_capture) != nullptr);
-		RunWindowLoop(dx_context, dx_compiler, gpu_capture.get());
+		//RunWorkGraph(dx_context, dx_compiler, "SAMPLE", dynamic_cast<PIXCapture*>(gpu_capture) != nullptr);
+		//RunInstanceCullingBenchmark(dx_context, dx_compiler);
+		//RunBundleBenchmark(dx_context, dx_compiler);
+		//RunShaderCompileBenchmark(dx_context);
+		//RunLoggerBenchmark();
+		//RunJobSystemBenchmark();
+		//RunStreamingBenchmark(dx_context);
+		//RunTextureCompressionBenchmark(dx_context, dx_compiler);
+#if defined(_DEBUG)
+		// Every Debug run checks the generated headers against the shaders, stale ones are rewritten and the run stops
+		if (!GenerateShaderBindings(dx_context.GetDevice(), dx_compiler, "shaders\\generated"))
+		{
+			return 1;
+		}
+#endif
+		HeadlessDesc headless_desc{};
+		if (ParseHeadlessDesc(argc, argv, headless_desc))
+		{
+			if (!RunHeadless(dx_context, dx_compiler, headless_desc))
+			{
+				return 1;
+			}
+		}
+		else
+		{
+			RunWindowLoop(dx_context, dx_compiler, gpu_capture.get());
+		}
 	}
 	return 0;
 }
\ No newline at end of file
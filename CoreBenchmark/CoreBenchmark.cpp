@@ -0,0 +1,289 @@
+// Headless benchmarks of the portable core, no GPU or window so it runs on build and test machines
+// Every run writes a report of one timing per line, optionally diffed against an older report to catch regressions
+#include "core/ImageEncoding.h"
+#include "core/JobSystem.h"
+#include "core/StreamScheduler.h"
+#include "core/TextureCompression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchmarkOptions
+{
+	uint32 m_iteration_count = 5;
+	// 0 is a worker per hardware thread but the calling one
+	uint32 m_max_worker_count = 0;
+	std::string m_report_path = "core_benchmark.txt";
+	std::string m_baseline_path;
+	// Increase in percent of a timing still accepted against the baseline, timings are noisier than shader costs
+	float64 m_tolerance = 10.0;
+};
+
+// Metric name to timing, lower is better, ordered so reports diff line by line
+using BenchmarkReport = std::map<std::string, float64>;
+
+// Fastest of the iterations, the one least disturbed by the rest of the machine
+static float64 MeasureMilliseconds(uint32 iteration_count, const std::function<void()>& function)
+{
+	float64 milliseconds = std::numeric_limits<float64>::infinity();
+	for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+	{
+		const std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+		function();
+		milliseconds = (std::min)(milliseconds, std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count());
+	}
+	return milliseconds;
+}
+
+// Gradients under a noisy checker, smooth and sharp blocks alike, same image as RunTextureCompressionBenchmark
+static std::vector<uint8> CreateImage(uint32 width, uint32 height)
+{
+	std::vector<uint8> image(width * height * 4);
+	for (uint32 y = 0; y < height; ++y)
+	{
+		for (uint32 x = 0; x < width; ++x)
+		{
+			const uint32 hash = (x * 73856093u) ^ (y * 19349663u);
+			const bool is_checker = ((x / 32) ^ (y / 32)) & 1;
+			uint8* texel = image.data() + (y * width + x) * 4;
+			texel[0] = (uint8)(x * 255 / (width - 1));
+			texel[1] = (uint8)(y * 255 / (height - 1));
+			texel[2] = (uint8)((is_checker ? 224 : 32) + (hash >> 27));
+			texel[3] = (uint8)(128 + (hash >> 25));
+		}
+	}
+	return image;
+}
+
+static void RunJobSystemBenchmarks(const BenchmarkOptions& options, BenchmarkReport& report)
+{
+	// Systems are rebuilt per iteration so the fastest is taken per worker count
+	for (uint32 iteration = 0; iteration < options.m_iteration_count; ++iteration)
+	{
+		for (const JobSystemScalingResult& result : MeasureJobSystemScaling(options.m_max_worker_count, 1))
+		{
+			const std::string workers = std::to_string(result.m_worker_count) + "_workers";
+			const std::string kernel_name = "job_system_kernel_" + workers + "_ms";
+			const std::string spawn_name = "job_system_spawn_" + workers + "_ns_per_job";
+			report[kernel_name] = iteration == 0 ? result.m_kernel_milliseconds : (std::min)(report[kernel_name], result.m_kernel_milliseconds);
+			report[spawn_name] = iteration == 0 ? result.m_spawn_nanoseconds_per_job : (std::min)(report[spawn_name], result.m_spawn_nanoseconds_per_job);
+		}
+	}
+}
+
+static void RunTextureBenchmarks(const BenchmarkOptions& options, BenchmarkReport& report)
+{
+	const uint32 size = 2048;
+	const std::vector<uint8> image = CreateImage(size, size);
+	report["generate_mips_2048_ms"] = MeasureMilliseconds(options.m_iteration_count, [&image]()
+	{
+		GenerateMipsReference(image.data(), size, size, true);
+	});
+
+	const uint32 block_row_count = size / 4;
+	for (uint32 format = 0; format < static_cast<uint32>(BCFormat::Count); ++format)
+	{
+		const BCFormat bc_format = static_cast<BCFormat>(format);
+		std::vector<uint8> blocks(block_row_count * block_row_count * GetBCBlockSize(bc_format));
+		std::string name = g_bc_format_names[format];
+		std::transform(name.begin(), name.end(), name.begin(), [](char character) { return (char)std::tolower(character); });
+		report["encode_" + name + "_2048_ms"] = MeasureMilliseconds(options.m_iteration_count, [&image, &blocks, bc_format]()
+		{
+			EncodeBC(bc_format, image.data(), size, size, blocks.data());
+		});
+	}
+
+	// Rows of blocks spread over the job system, the CPU encoder standing in for the compute shader
+	JobSystem job_system(options.m_max_worker_count);
+	const uint32 row_size = size * 4 * 4;
+	const uint32 block_row_size = block_row_count * GetBCBlockSize(BCFormat::BC7);
+	std::vector<uint8> blocks(block_row_count * block_row_size);
+	report["encode_bc7_2048_parallel_ms"] = MeasureMilliseconds(options.m_iteration_count, [&]()
+	{
+		job_system.ParallelFor(block_row_count, 4, [&](uint32 begin, uint32 end, uint32)
+		{
+			EncodeBC(BCFormat::BC7, image.data() + begin * row_size, size, (end - begin) * 4, blocks.data() + begin * block_row_size);
+		});
+	});
+}
+
+static void RunImageEncodingBenchmarks(const BenchmarkOptions& options, BenchmarkReport& report)
+{
+	const uint32 width = 1920;
+	const uint32 height = 1080;
+	const std::vector<uint8> image = CreateImage(width, height);
+	const ImageView view{ .m_data = image.data(), .m_width = width, .m_height = height, .m_row_pitch = width * 4 };
+	for (uint32 format = 0; format < static_cast<uint32>(ImageFileFormat::Count); ++format)
+	{
+		std::string name = g_image_file_format_names[format];
+		std::transform(name.begin(), name.end(), name.begin(), [](char character) { return (char)std::tolower(character); });
+		report["encode_" + name + "_1080p_ms"] = MeasureMilliseconds(options.m_iteration_count, [&view, format]()
+		{
+			EncodeImage(view, static_cast<ImageFileFormat>(format));
+		});
+	}
+}
+
+// Frames in flight of the application, a staging slot is reused that many batches after its copy was recorded
+static const uint32 g_copy_latency_batches = 3;
+
+static void RunStreamingBenchmarks(const BenchmarkOptions& options, BenchmarkReport& report)
+{
+	// Removed afterwards, the reads come from the file cache once the first iteration warmed it
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "CoreBenchmark";
+	std::filesystem::create_directories(directory);
+	const uint64 file_size = 16ull << 20;
+	std::vector<std::string> paths;
+	for (uint32 i = 0; i < 4; ++i)
+	{
+		paths.push_back((directory / ("stream" + std::to_string(i) + ".bin")).string());
+		std::ofstream file(paths.back(), std::ios::binary);
+		const std::vector<char> data(file_size, (char)i);
+		file.write(data.data(), data.size());
+	}
+	const std::vector<int32> priorities(paths.size(), 0);
+
+	// Milliseconds per GB rather than GB/s so that lower is better like every other timing
+	for (uint64 chunk_size : { 64ull << 10, 256ull << 10, 1ull << 20, 4ull << 20 })
+	{
+		for (uint32 slot_count : { 4u, 16u, 64u })
+		{
+			const StreamSchedulerDesc desc{ .m_chunk_size = chunk_size, .m_staging_chunk_count = slot_count };
+			float64 milliseconds_per_gb = std::numeric_limits<float64>::infinity();
+			for (uint32 iteration = 0; iteration < options.m_iteration_count; ++iteration)
+			{
+				const StreamSimulationResult result = SimulateStreaming(desc, paths, priorities, g_copy_latency_batches);
+				milliseconds_per_gb = (std::min)(milliseconds_per_gb, result.m_milliseconds * (1ull << 30) / (float64)(std::max)(result.m_bytes, (uint64)1));
+			}
+			report["stream_" + std::to_string(chunk_size >> 10) + "kb_" + std::to_string(slot_count) + "_slots_ms_per_gb"] = milliseconds_per_gb;
+		}
+	}
+	std::filesystem::remove_all(directory);
+}
+
+static bool WriteReport(const std::string& path, const BenchmarkReport& report)
+{
+	std::ofstream file(path);
+	for (const auto& [name, value] : report)
+	{
+		file << name << " " << value << "\n";
+	}
+	return file.good();
+}
+
+static bool ReadReport(const std::string& path, BenchmarkReport& out_report)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+	std::string name;
+	float64 value = 0.0;
+	while (file >> name >> value)
+	{
+		out_report[name] = value;
+	}
+	return true;
+}
+
+// Prints every timing against its baseline, increases above tolerance_percent are regressions
+// Returns the number of regressions
+static uint32 DiffReports(const BenchmarkReport& baseline, const BenchmarkReport& report, float64 tolerance_percent)
+{
+	uint32 regression_count = 0;
+	for (const auto& [name, value] : report)
+	{
+		const auto baseline_value = baseline.find(name);
+		if (baseline_value == baseline.end() || baseline_value->second <= 0.0)
+		{
+			continue;
+		}
+		const float64 change_percent = (value / baseline_value->second - 1.0) * 100.0;
+		const bool is_regression = change_percent > tolerance_percent;
+		regression_count += is_regression ? 1 : 0;
+		char line[256];
+		snprintf(line, sizeof(line), "%c %-40s %10.3f -> %10.3f (%+.1f%%)\n", is_regression ? '!' : ' ', name.c_str(), baseline_value->second, value, change_percent);
+		std::cout << line;
+	}
+	return regression_count;
+}
+
+static void PrintUsage()
+{
+	std::cout <<
+		"CoreBenchmark [--iterations <n>] [--workers <n>] [--report <file>] [--baseline <file>] [--tolerance <percent>]\n"
+		"  Times the job system, texture compression, image encoding and streaming, the fastest of the iterations is kept\n"
+		"  Streaming reads temporary files through the stream scheduler per chunk size and staging slot count\n"
+		"  Writes the timings to core_benchmark.txt by default, a baseline is an older report to diff against\n"
+		"  Exits with 2 when a timing grew more than the tolerance over the baseline\n";
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options{};
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (argument == "--iterations" && has_value) options.m_iteration_count = (uint32)std::stoul(argv[++i]);
+		else if (argument == "--workers" && has_value) options.m_max_worker_count = (uint32)std::stoul(argv[++i]);
+		else if (argument == "--report" && has_value) options.m_report_path = argv[++i];
+		else if (argument == "--baseline" && has_value) options.m_baseline_path = argv[++i];
+		else if (argument == "--tolerance" && has_value) options.m_tolerance = std::stod(argv[++i]);
+		else
+		{
+			PrintUsage();
+			return argument == "--help" ? 0 : 1;
+		}
+	}
+	options.m_iteration_count = (std::max)(options.m_iteration_count, 1u);
+	if (options.m_max_worker_count == 0)
+	{
+		options.m_max_worker_count = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+
+	BenchmarkReport report{};
+	RunJobSystemBenchmarks(options, report);
+	RunTextureBenchmarks(options, report);
+	RunImageEncodingBenchmarks(options, report);
+	RunStreamingBenchmarks(options, report);
+
+	for (const auto& [name, value] : report)
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "%-40s %10.3f\n", name.c_str(), value);
+		std::cout << line;
+	}
+	if (!WriteReport(options.m_report_path, report))
+	{
+		std::cerr << "Failed to write " << options.m_report_path << "\n";
+		return 1;
+	}
+	if (options.m_baseline_path.empty())
+	{
+		return 0;
+	}
+
+	BenchmarkReport baseline{};
+	if (!ReadReport(options.m_baseline_path, baseline))
+	{
+		std::cerr << "Failed to read the baseline " << options.m_baseline_path << "\n";
+		return 1;
+	}
+	std::cout << "Timings against " << options.m_baseline_path << ", regressions marked with !\n";
+	const uint32 regression_count = DiffReports(baseline, report, options.m_tolerance);
+	std::cout << regression_count << " timing regressions\n";
+	return regression_count > 0 ? 2 : 0;
+}
\ No newline at end of file
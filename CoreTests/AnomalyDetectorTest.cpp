@@ -0,0 +1,160 @@
+// ReplayAnomalyDetector over synthetic frame time and pass series
+#include "CoreTest.h"
+#include "core/AnomalyDetector.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> g_series_names = { "Frame", "Compute", "Draw" };
+
+// Steady frames with a little deterministic noise, 10 ms frame, 4 ms compute, 0.2 ms draw
+static std::vector<std::vector<float64>> CreateFrames(uint32 frame_count)
+{
+	std::vector<std::vector<float64>> frames(frame_count);
+	for (uint32 frame = 0; frame < frame_count; ++frame)
+	{
+		const float64 noise = (float64)((frame * 2654435761u) >> 28) / 16.0 * 0.5;
+		frames[frame] = { 10.0 + noise, 4.0 + noise * 0.5, 0.2 + noise * 0.05 };
+	}
+	return frames;
+}
+
+static AnomalyDetectorDesc CreateDesc()
+{
+	return
+	{
+		.m_baseline_frame_count = 60,
+		.m_cooldown_frame_count = 100,
+		.m_history_frame_count = 30,
+	};
+}
+
+static void TestSteady()
+{
+	CHECK(ReplayAnomalyDetector(CreateDesc(), g_series_names, CreateFrames(1000)).empty());
+}
+
+static void TestSingleSpike()
+{
+	std::vector<std::vector<float64>> frames = CreateFrames(400);
+	frames[200][1] = 40.0;
+	const std::vector<uint32> triggers = ReplayAnomalyDetector(CreateDesc(), g_series_names, frames);
+	CHECK(triggers == std::vector<uint32>{ 200 });
+
+	// Spiking series and its baseline are reported
+	AnomalyDetector detector{};
+	detector.Init(CreateDesc(), g_series_names);
+	for (uint32 frame = 0; frame <= 200; ++frame)
+	{
+		CHECK(detector.Update(frames[frame]) == (frame == 200));
+	}
+	CHECK(detector.GetTriggerSeries() == 1);
+	CHECK(detector.GetTriggerMilliseconds() == 40.0);
+	CHECK(detector.GetTriggerBaselineMilliseconds() > 4.0 && detector.GetTriggerBaselineMilliseconds() < 4.5);
+}
+
+static void TestBaselineNotFull()
+{
+	// No baseline to judge against yet
+	std::vector<std::vector<float64>> frames = CreateFrames(200);
+	frames[30][0] = 100.0;
+	CHECK(ReplayAnomalyDetector(CreateDesc(), g_series_names, frames).empty());
+}
+
+static void TestCooldown()
+{
+	// One hitch of several frames is one trigger, a later one triggers again
+	std::vector<std::vector<float64>> frames = CreateFrames(600);
+	for (uint32 frame : { 200u, 201u, 202u, 250u, 400u })
+	{
+		frames[frame][0] = 50.0;
+	}
+	CHECK((ReplayAnomalyDetector(CreateDesc(), g_series_names, frames) == std::vector<uint32>{ 200, 400 }));
+}
+
+static void TestMargin()
+{
+	// Ratio of 5 on the draw pass but under the absolute margin
+	std::vector<std::vector<float64>> frames = CreateFrames(400);
+	frames[200][2] = 1.0;
+	CHECK(ReplayAnomalyDetector(CreateDesc(), g_series_names, frames).empty());
+}
+
+static void TestLastingChange()
+{
+	// Compute cost jumps for good, one trigger then the baseline learns the new cost
+	std::vector<std::vector<float64>> frames = CreateFrames(1000);
+	for (uint32 frame = 300; frame < frames.size(); ++frame)
+	{
+		frames[frame][1] += 8.0;
+	}
+	CHECK((ReplayAnomalyDetector(CreateDesc(), g_series_names, frames) == std::vector<uint32>{ 300 }));
+
+	AnomalyDetector detector{};
+	detector.Init(CreateDesc(), g_series_names);
+	for (const std::vector<float64>& frame : frames)
+	{
+		detector.Update(frame);
+	}
+	CHECK(detector.GetBaselineMilliseconds(1) > 11.5);
+}
+
+static void TestSingleHitchBaseline()
+{
+	// Clamped to the spike threshold, a single hitch barely moves the baseline
+	std::vector<std::vector<float64>> frames = CreateFrames(200);
+	frames[150][0] = 1000.0;
+	AnomalyDetector detector{};
+	detector.Init(CreateDesc(), g_series_names);
+	for (const std::vector<float64>& frame : frames)
+	{
+		detector.Update(frame);
+	}
+	CHECK(detector.GetBaselineMilliseconds(0) < 10.6);
+}
+
+static void TestWriteHistory()
+{
+	AnomalyDetector detector{};
+	detector.Init(CreateDesc(), g_series_names);
+	for (const std::vector<float64>& frame : CreateFrames(100))
+	{
+		detector.Update(frame);
+	}
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "AnomalyDetectorTest.csv";
+	CHECK(detector.WriteHistory(path.string()));
+
+	std::ifstream file(path);
+	std::vector<std::string> lines;
+	for (std::string line; std::getline(file, line); )
+	{
+		lines.push_back(line);
+	}
+	file.close();
+	std::filesystem::remove(path);
+
+	// Header, the last m_history_frame_count frames oldest first, then the baselines
+	CHECK(lines.size() == 1 + 30 + 1);
+	if (lines.size() == 32)
+	{
+		CHECK(lines.front() == "frame,Frame ms,Compute ms,Draw ms");
+		CHECK(lines[1].rfind("70,", 0) == 0);
+		CHECK(lines[30].rfind("99,", 0) == 0);
+		CHECK(lines.back().rfind("baseline,", 0) == 0);
+	}
+}
+
+int main()
+{
+	TestSteady();
+	TestSingleSpike();
+	TestBaselineNotFull();
+	TestCooldown();
+	TestMargin();
+	TestLastingChange();
+	TestSingleHitchBaseline();
+	TestWriteHistory();
+	return GetTestResult();
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdio>
+
+// Checks of the core tests, no framework, every executable is one CTest test
+// A failed check is reported and the test carries on, the exit code fails it at the end
+inline int g_check_failure_count = 0;
+
+#define CHECK(x) do { if (!(x)) { std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #x); ++g_check_failure_count; } } while (0)
+
+// Returned from main
+inline int GetTestResult()
+{
+	if (g_check_failure_count > 0)
+	{
+		std::fprintf(stderr, "%d checks failed\n", g_check_failure_count);
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+// ReplayDynamicResolution over synthetic traces of full resolution GPU times
+#include "CoreTest.h"
+#include "core/DynamicResolution.h"
+
+#include <cmath>
+#include <vector>
+
+static const uint32 g_latency_frame_count = 3;
+
+// Every scale is a multiple of the step within the bounds
+static bool IsQuantized(const DynamicResolutionDesc& desc, float32 scale)
+{
+	const float32 steps = scale / desc.m_scale_step;
+	return scale >= desc.m_min_scale - 1e-4f && scale <= desc.m_max_scale + 1e-4f && std::fabs(steps - std::round(steps)) < 1e-3f;
+}
+
+static void TestUnderBudget()
+{
+	const DynamicResolutionDesc desc{};
+	const std::vector<float32> scales = ReplayDynamicResolution(desc, std::vector<float64>(300, desc.m_target_milliseconds * 0.5), g_latency_frame_count);
+	for (float32 scale : scales)
+	{
+		CHECK(scale == desc.m_max_scale);
+	}
+}
+
+static void TestOverBudget()
+{
+	// Twice the budget at full resolution, within budget from a scale of 1/sqrt(2)
+	const DynamicResolutionDesc desc{};
+	const float64 full_resolution_milliseconds = desc.m_target_milliseconds * 2.0;
+	const std::vector<float32> scales = ReplayDynamicResolution(desc, std::vector<float64>(600, full_resolution_milliseconds), g_latency_frame_count);
+	for (float32 scale : scales)
+	{
+		CHECK(IsQuantized(desc, scale));
+	}
+	// Settled, the last frames keep one scale
+	const float32 final_scale = scales.back();
+	for (uint32 frame = (uint32)scales.size() - 100; frame < scales.size(); ++frame)
+	{
+		CHECK(scales[frame] == final_scale);
+	}
+	const float64 final_milliseconds = full_resolution_milliseconds * final_scale * final_scale;
+	CHECK(final_milliseconds <= desc.m_target_milliseconds * desc.m_over_budget_ratio);
+	// Not lowered further than the hysteresis band asks for
+	CHECK(final_milliseconds >= desc.m_target_milliseconds * desc.m_under_budget_ratio * 0.8);
+	CHECK(final_scale < 0.75f && final_scale >= 0.6f);
+}
+
+static void TestRecovery()
+{
+	// Heavy section then a light one, lowered in one change and raised a step at a time
+	const DynamicResolutionDesc desc{};
+	std::vector<float64> trace(200, desc.m_target_milliseconds * 4.0);
+	trace.resize(1200, desc.m_target_milliseconds * 0.5);
+	const std::vector<float32> scales = ReplayDynamicResolution(desc, trace, g_latency_frame_count);
+
+	uint32 lower_count = 0;
+	for (uint32 frame = 1; frame < scales.size(); ++frame)
+	{
+		const float32 change = scales[frame] - scales[frame - 1];
+		CHECK(change <= desc.m_scale_step + 1e-4f);
+		lower_count += change < 0.0f ? 1 : 0;
+	}
+	// sqrt(1/4) is reached by the first decision
+	CHECK(lower_count == 1);
+	CHECK(scales[199] == 0.5f);
+	CHECK(scales.back() == desc.m_max_scale);
+}
+
+static void TestBounds()
+{
+	// No scale meets the budget, held at the minimum
+	DynamicResolutionDesc desc{};
+	desc.m_min_scale = 0.5f;
+	const std::vector<float32> scales = ReplayDynamicResolution(desc, std::vector<float64>(300, desc.m_target_milliseconds * 100.0), g_latency_frame_count);
+	for (float32 scale : scales)
+	{
+		CHECK(scale >= desc.m_min_scale);
+	}
+	CHECK(scales.back() == desc.m_min_scale);
+}
+
+static void TestMissingTimings()
+{
+	// Unresolved timestamps read as 0 and are ignored
+	DynamicResolutionController controller{};
+	controller.Init(DynamicResolutionDesc{});
+	for (uint32 frame = 0; frame < 100; ++frame)
+	{
+		CHECK(controller.Update(0.0) == 1.0f);
+	}
+	CHECK(controller.GetAverageMilliseconds() == 0.0);
+}
+
+int main()
+{
+	TestUnderBudget();
+	TestOverBudget();
+	TestRecovery();
+	TestBounds();
+	TestMissingTimings();
+	return GetTestResult();
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+// FrameArena allocation and growth, and the steady frames allocating nothing from the heap once warmed up
+#include "CoreTest.h"
+#include "core/AllocationCounter.h"
+#include "core/FrameArena.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Same count as the backbuffers of the application, an arena per index reset once its frame is done
+static const uint32 g_frame_count = 3;
+// Frames whose load grows before it is steady
+static const uint32 g_growing_frame_count = 6;
+// An arena that overflowed in the first steady frame merges its blocks when reset, a frame count later
+static const uint32 g_warm_up_frame_count = g_growing_frame_count + g_frame_count * 2;
+
+// Kept alive so the allocations of TestCounter are not optimized away
+static std::vector<std::unique_ptr<uint32>> g_counted_values;
+
+static void TestAllocate()
+{
+	FrameArena arena(1024);
+	CHECK(arena.GetCapacity() == 1024);
+	for (uint64 alignment : { 1, 4, 16, 64, 256 })
+	{
+		void* data = arena.Allocate(3, alignment);
+		CHECK(reinterpret_cast<uintptr_t>(data) % alignment == 0);
+	}
+
+	// Value initialized
+	uint32* values = arena.AllocateArray<uint32>(8);
+	bool is_zero = true;
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		is_zero = is_zero && values[i] == 0;
+	}
+	CHECK(is_zero);
+
+	const std::string_view string = arena.CopyString("render thread");
+	CHECK(string == "render thread");
+	CHECK(string.data()[string.size()] == '\0');
+	CHECK(arena.GetUsedBytes() > 0);
+	CHECK(arena.GetPeakBytes() >= arena.GetUsedBytes());
+
+	arena.Reset();
+	CHECK(arena.GetUsedBytes() == 0);
+	CHECK(arena.GetGrowCount() == 0);
+}
+
+static void TestGrow()
+{
+	// Overflow chains a block, the reset merges it so the same frame then fits
+	FrameArena arena(64);
+	uint8* first = static_cast<uint8*>(arena.Allocate(48, 1));
+	uint8* second = static_cast<uint8*>(arena.Allocate(48, 1));
+	for (uint32 i = 0; i < 48; ++i)
+	{
+		first[i] = 1;
+		second[i] = 2;
+	}
+	CHECK(first[47] == 1 && second[0] == 2);
+	arena.Reset();
+	CHECK(arena.GetGrowCount() == 1);
+	CHECK(arena.GetCapacity() >= 96);
+
+	arena.Allocate(48, 1);
+	arena.Allocate(48, 1);
+	arena.Reset();
+	CHECK(arena.GetGrowCount() == 1);
+}
+
+static void TestCounter()
+{
+	const uint64 thread_count_begin = GetThreadAllocationCount();
+	const uint64 count_begin = GetAllocationCount();
+	g_counted_values.push_back(std::make_unique<uint32>(1));
+	CHECK(GetThreadAllocationCount() - thread_count_begin == 2);
+	CHECK(GetAllocationCount() - count_begin >= 2);
+
+	// Allocations of another thread are not counted for this one
+	const uint64 thread_count_before_thread = GetThreadAllocationCount();
+	std::thread thread([]() { g_counted_values.push_back(std::make_unique<uint32>(2)); });
+	thread.join();
+	CHECK(GetThreadAllocationCount() - thread_count_before_thread <= 1);
+}
+
+// Per frame data of a render loop, strings and arrays growing over the first frames then steady
+static void SimulateFrame(FrameArena& arena, std::vector<uint32>& persistent_list, uint32 frame)
+{
+	const uint32 item_count = 64 + (frame < g_growing_frame_count ? frame * 32 : 200);
+	for (uint32 i = 0; i < item_count; ++i)
+	{
+		float32* transforms = arena.AllocateArray<float32>(16);
+		transforms[0] = (float32)i;
+		const char name[] = "Compute";
+		arena.CopyString({ name, sizeof(name) - 1 - i % 4 });
+	}
+	// Cleared, keeping the capacity of the frames before
+	persistent_list.clear();
+	for (uint32 i = 0; i < item_count; ++i)
+	{
+		persistent_list.push_back(i);
+	}
+}
+
+static void TestSteadyFrames()
+{
+	FrameArena arenas[g_frame_count] = { FrameArena(1024), FrameArena(1024), FrameArena(1024) };
+	std::vector<uint32> persistent_list;
+	uint32 grow_count_after_warm_up = 0;
+	for (uint32 frame = 0; frame < 100; ++frame)
+	{
+		const uint64 allocation_count_begin = GetThreadAllocationCount();
+		FrameArena& arena = arenas[frame % g_frame_count];
+		arena.Reset();
+		SimulateFrame(arena, persistent_list, frame);
+		const uint64 frame_allocation_count = GetThreadAllocationCount() - allocation_count_begin;
+		if (frame >= g_warm_up_frame_count)
+		{
+			CHECK(frame_allocation_count == 0);
+		}
+		else if (frame == g_warm_up_frame_count - 1)
+		{
+			grow_count_after_warm_up = arenas[0].GetGrowCount() + arenas[1].GetGrowCount() + arenas[2].GetGrowCount();
+		}
+	}
+	// Every arena grew to the steady frame once and never again
+	CHECK(grow_count_after_warm_up > 0);
+	CHECK(arenas[0].GetGrowCount() + arenas[1].GetGrowCount() + arenas[2].GetGrowCount() == grow_count_after_warm_up);
+}
+
+int main()
+{
+	TestAllocate();
+	TestGrow();
+	TestCounter();
+	TestSteadyFrames();
+	return GetTestResult();
+}
\ No newline at end of file
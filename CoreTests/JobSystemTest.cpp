@@ -0,0 +1,137 @@
+// JobSystem coverage, dependencies, nesting and helping from outside, on systems of 1 to 4 workers
+#include "CoreTest.h"
+#include "core/JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static void TestParallelFor(JobSystem& job_system)
+{
+	// Every index exactly once, in ranges no larger than the batch
+	std::vector<std::atomic<uint32>> hits(100003);
+	std::atomic<bool> is_batch_valid = true;
+	std::atomic<bool> is_worker_valid = true;
+	job_system.ParallelFor((uint32)hits.size(), 7, [&](uint32 begin, uint32 end, uint32 worker_index)
+	{
+		is_batch_valid = is_batch_valid && end > begin && end - begin <= 7;
+		is_worker_valid = is_worker_valid && worker_index < job_system.GetThreadSlotCount();
+		for (uint32 i = begin; i < end; ++i)
+		{
+			hits[i].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+	uint32 wrong_hit_count = 0;
+	for (const std::atomic<uint32>& hit : hits)
+	{
+		wrong_hit_count += hit.load() != 1 ? 1 : 0;
+	}
+	CHECK(wrong_hit_count == 0);
+	CHECK(is_batch_valid);
+	CHECK(is_worker_valid);
+}
+
+static void TestDependencies(JobSystem& job_system)
+{
+	// A then B then C, B and C queued before A finished
+	JobCounter a{};
+	JobCounter b{};
+	JobCounter c{};
+	std::atomic<uint32> stage = 0;
+	std::atomic<bool> is_order_valid = true;
+	for (uint32 i = 0; i < 100; ++i)
+	{
+		job_system.Submit([](uint32) {}, &a);
+	}
+	job_system.Submit([&stage](uint32) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); stage = 1; }, &a);
+	job_system.SubmitAfter(a, [&](uint32) { is_order_valid = is_order_valid && stage == 1; stage = 2; }, &b);
+	job_system.SubmitAfter(b, [&](uint32) { is_order_valid = is_order_valid && stage == 2; stage = 3; }, &c);
+	job_system.Wait(c);
+	CHECK(a.IsDone() && b.IsDone() && c.IsDone());
+	CHECK(stage == 3);
+	CHECK(is_order_valid);
+}
+
+static void TestNested(JobSystem& job_system)
+{
+	// Jobs spawning and waiting on jobs, waiting runs other jobs instead of blocking the worker
+	JobCounter root{};
+	std::atomic<uint32> sum = 0;
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		job_system.Submit([&](uint32)
+		{
+			JobCounter inner{};
+			for (uint32 k = 0; k < 1000; ++k)
+			{
+				job_system.Submit([&sum](uint32) { sum.fetch_add(1, std::memory_order_relaxed); }, &inner);
+			}
+			job_system.Wait(inner);
+		}, &root);
+	}
+	job_system.Wait(root);
+	CHECK(sum == 8000);
+	CHECK(job_system.Async([](uint32) { return 42; }).get() == 42);
+}
+
+static void TestOutsideThreads(JobSystem& job_system)
+{
+	// Two threads outside the system submitting and waiting at once, only one of them helps
+	std::atomic<uint32> count = 0;
+	auto submit_and_wait = [&]()
+	{
+		JobCounter counter{};
+		for (uint32 i = 0; i < 1000; ++i)
+		{
+			job_system.Submit([&count](uint32) { count.fetch_add(1, std::memory_order_relaxed); }, &counter);
+		}
+		job_system.Wait(counter);
+	};
+	std::thread thread(submit_and_wait);
+	submit_and_wait();
+	thread.join();
+	CHECK(count == 2000);
+}
+
+static void TestAffinity(JobSystem& job_system)
+{
+	// Affinity is a hint, every job still runs once
+	JobCounter counter{};
+	std::atomic<uint32> count = 0;
+	for (uint32 i = 0; i < 200; ++i)
+	{
+		job_system.Submit([&count](uint32) { count.fetch_add(1, std::memory_order_relaxed); }, &counter, i);
+	}
+	job_system.Wait(counter);
+	CHECK(count == 200);
+}
+
+int main()
+{
+	for (uint32 worker_count = 1; worker_count <= 4; ++worker_count)
+	{
+		std::atomic<uint32> count_at_exit = 0;
+		{
+			JobSystem job_system(worker_count);
+			CHECK(job_system.GetWorkerCount() == worker_count);
+			CHECK(job_system.GetThreadSlotCount() == worker_count + 1);
+			TestParallelFor(job_system);
+			TestDependencies(job_system);
+			TestNested(job_system);
+			TestOutsideThreads(job_system);
+			TestAffinity(job_system);
+
+			// Left running at destruction, including the jobs they spawn
+			for (uint32 i = 0; i < 100; ++i)
+			{
+				job_system.Submit([&](uint32)
+				{
+					job_system.Submit([&count_at_exit](uint32) { count_at_exit.fetch_add(1, std::memory_order_relaxed); });
+				});
+			}
+		}
+		CHECK(count_at_exit == 100);
+	}
+	return GetTestResult();
+}
\ No newline at end of file
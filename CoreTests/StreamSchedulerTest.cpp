@@ -0,0 +1,161 @@
+// StreamScheduler ordering, cancellation and staging bounds, and SimulateStreaming over temporary files
+#include "CoreTest.h"
+#include "core/StreamScheduler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const StreamSchedulerDesc g_desc{ .m_chunk_size = 1024, .m_staging_chunk_count = 4 };
+
+struct StreamEvent
+{
+	StreamRequestId m_request;
+	StreamStatus m_status;
+};
+
+static void RetireAll(StreamScheduler& scheduler, std::vector<StreamChunk>& chunks)
+{
+	for (const StreamChunk& chunk : chunks)
+	{
+		scheduler.Retire(chunk);
+	}
+	chunks.clear();
+}
+
+static void TestChunks()
+{
+	StreamScheduler scheduler{};
+	scheduler.Init(g_desc);
+	std::vector<StreamEvent> events;
+	const StreamCallback callback = [&events](StreamRequestId request, StreamStatus status) { events.push_back({ request, status }); };
+
+	// Granule of a texture row, chunks hold whole rows
+	const StreamRequestId request = scheduler.Submit(10 * 300, 300, 0, callback);
+	CHECK(request != g_invalid_stream_request);
+	CHECK(scheduler.Submit(100, g_desc.m_chunk_size + 1, 0, callback) == g_invalid_stream_request);
+
+	std::vector<StreamChunk> chunks;
+	uint64 next_offset = 0;
+	while (scheduler.GetRequestCount() > 0)
+	{
+		CHECK(scheduler.Schedule(chunks) <= g_desc.m_staging_chunk_count);
+		CHECK(scheduler.GetFreeStagingSlotCount() == g_desc.m_staging_chunk_count - chunks.size());
+		for (const StreamChunk& chunk : chunks)
+		{
+			CHECK(chunk.m_offset == next_offset);
+			CHECK(chunk.m_size % 300 == 0 && chunk.m_size <= g_desc.m_chunk_size);
+			CHECK(chunk.m_staging_slot < g_desc.m_staging_chunk_count);
+			next_offset += chunk.m_size;
+		}
+		RetireAll(scheduler, chunks);
+	}
+	CHECK(next_offset == 10 * 300);
+	CHECK(events.size() == 1 && events[0].m_request == request && events[0].m_status == StreamStatus::Completed);
+	CHECK(scheduler.GetFreeStagingSlotCount() == g_desc.m_staging_chunk_count);
+
+	// Nothing to copy, completed from Submit
+	events.clear();
+	scheduler.Submit(0, 1, 0, callback);
+	CHECK(events.size() == 1 && events[0].m_status == StreamStatus::Completed);
+}
+
+static void TestPriority()
+{
+	StreamScheduler scheduler{};
+	scheduler.Init(g_desc);
+	std::vector<StreamEvent> events;
+	const StreamCallback callback = [&events](StreamRequestId request, StreamStatus status) { events.push_back({ request, status }); };
+
+	const StreamRequestId low = scheduler.Submit(g_desc.m_chunk_size * 8, 1, 0, callback);
+	std::vector<StreamChunk> chunks;
+	scheduler.Schedule(chunks);
+	CHECK(chunks.size() == g_desc.m_staging_chunk_count);
+
+	// Submitted later with a higher priority, takes the next free slots
+	const StreamRequestId high = scheduler.Submit(g_desc.m_chunk_size * 2, 1, 1, callback);
+	RetireAll(scheduler, chunks);
+	scheduler.Schedule(chunks);
+	CHECK(chunks.size() == g_desc.m_staging_chunk_count);
+	CHECK(chunks[0].m_request == high && chunks[1].m_request == high);
+	CHECK(chunks[2].m_request == low && chunks[2].m_offset == g_desc.m_chunk_size * 4);
+	RetireAll(scheduler, chunks);
+	CHECK(events.size() == 1 && events[0].m_request == high);
+
+	while (scheduler.GetRequestCount() > 0)
+	{
+		scheduler.Schedule(chunks);
+		RetireAll(scheduler, chunks);
+	}
+	CHECK(events.size() == 2 && events[1].m_request == low && events[1].m_status == StreamStatus::Completed);
+}
+
+static void TestCancel()
+{
+	StreamScheduler scheduler{};
+	scheduler.Init(g_desc);
+	std::vector<StreamEvent> events;
+	const StreamCallback callback = [&events](StreamRequestId request, StreamStatus status) { events.push_back({ request, status }); };
+
+	const StreamRequestId request = scheduler.Submit(g_desc.m_chunk_size * 8, 1, 0, callback);
+	std::vector<StreamChunk> chunks;
+	scheduler.Schedule(chunks);
+	CHECK(scheduler.Cancel(request));
+	CHECK(!scheduler.Cancel(request));
+	// Chunks in flight are still retired before the callback
+	CHECK(events.empty());
+	std::vector<StreamChunk> more_chunks;
+	CHECK(scheduler.Schedule(more_chunks) == 0);
+	RetireAll(scheduler, chunks);
+	CHECK(events.size() == 1 && events[0].m_status == StreamStatus::Cancelled);
+	CHECK(scheduler.GetRequestCount() == 0);
+
+	// Cancelled before any chunk was handed out, finished right away
+	events.clear();
+	const StreamRequestId pending = scheduler.Submit(g_desc.m_chunk_size, 1, 0, callback);
+	CHECK(scheduler.Cancel(pending));
+	CHECK(events.size() == 1 && events[0].m_request == pending && events[0].m_status == StreamStatus::Cancelled);
+	CHECK(!scheduler.Cancel(pending));
+}
+
+static void TestSimulateStreaming()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "StreamSchedulerTest";
+	std::filesystem::create_directories(directory);
+	// Same size so only the priority orders them, the last one first
+	const uint64 file_size = g_desc.m_chunk_size * 16 + 100;
+	std::vector<std::string> paths;
+	for (uint32 i = 0; i < 3; ++i)
+	{
+		paths.push_back((directory / ("file" + std::to_string(i) + ".bin")).string());
+		std::ofstream file(paths.back(), std::ios::binary);
+		std::vector<char> data(file_size, (char)i);
+		file.write(data.data(), data.size());
+	}
+	paths.push_back((directory / "missing.bin").string());
+
+	const StreamSimulationResult result = SimulateStreaming(g_desc, paths, { 0, 0, 1, 0 }, 2);
+	const uint64 chunks_per_file = (file_size + g_desc.m_chunk_size - 1) / g_desc.m_chunk_size;
+	CHECK(result.m_bytes == file_size * 3);
+	CHECK(result.m_chunk_count == chunks_per_file * 3);
+	CHECK(result.m_batch_count >= result.m_chunk_count / g_desc.m_staging_chunk_count);
+	CHECK(result.m_completed_batches.size() == paths.size());
+	CHECK(result.m_completed_batches[2] > 0);
+	CHECK(result.m_completed_batches[2] < result.m_completed_batches[0]);
+	CHECK(result.m_completed_batches[0] <= result.m_completed_batches[1]);
+	// Missing file is skipped
+	CHECK(result.m_completed_batches[3] == 0);
+
+	std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+	TestChunks();
+	TestPriority();
+	TestCancel();
+	TestSimulateStreaming();
+	return GetTestResult();
+}
\ No newline at end of file
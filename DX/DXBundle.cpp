@@ -0,0 +1,50 @@
+#include "DXBundle.h"
+
+void DXBundle::Init(DXContext& dx_context, const std::string& name)
+{
+	for (uint32 i = 0; i < g_backbuffer_count; ++i)
+	{
+		dx_context.CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, m_allocators[i]);
+		NAME_DX_OBJECT(m_allocators[i].m_allocator, name + " Allocator " + std::to_string(i));
+		dx_context.CreateCommandList(D3D12_COMMAND_LIST_TYPE_BUNDLE, m_allocators[i], m_lists[i]);
+		NAME_DX_OBJECT(m_lists[i].m_list, name + " " + std::to_string(i));
+	}
+	Invalidate();
+}
+
+void DXBundle::Execute(DXContext& dx_context, const void* key, uint32 key_size, const RecordFunction& record_function)
+{
+	// Fence of the current slot is completed after InitCommandLists, allocator can be reset
+	const uint32 slot = g_current_buffer_index;
+	const uint8* key_bytes = static_cast<const uint8*>(key);
+	const bool is_key_equal = m_keys[slot].size() == key_size && memcmp(m_keys[slot].data(), key_bytes, key_size) == 0;
+	if (!m_is_recorded[slot] || !is_key_equal)
+	{
+		m_allocators[slot].m_allocator->Reset() >> CHK;
+		ID3D12GraphicsCommandList10* bundle = m_lists[slot].m_list.Get();
+		bundle->Reset(m_allocators[slot].m_allocator.Get(), nullptr) >> CHK;
+		// Bundle has to set the same descriptor heap as the executing commandlist to use bindless
+		bundle->SetDescriptorHeaps(1, dx_context.m_resources_descriptor_heap.m_heap.GetAddressOf());
+		record_function(bundle);
+		bundle->Close() >> CHK;
+
+		m_keys[slot].assign(key_bytes, key_bytes + key_size);
+		m_is_recorded[slot] = true;
+		++m_record_count;
+	}
+	dx_context.GetCommandListGraphics()->ExecuteBundle(m_lists[slot].m_list.Get());
+}
+
+void DXBundle::Invalidate()
+{
+	for (uint32 i = 0; i < g_backbuffer_count; ++i)
+	{
+		m_is_recorded[i] = false;
+		m_keys[i].clear();
+	}
+}
+
+uint32 DXBundle::GetRecordCount() const
+{
+	return m_record_count;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include "../core/Common.h"
+#include "DXCommon.h"
+#include "DXContext.h"
+
+#include <functional>
+
+// Bundle recorded once and replayed with ExecuteBundle until its key changes
+// Key is every input captured by the recording (program id, bindless indices, counts...), compared bytewise
+// One bundle per backbuffer slot so re-recording never resets an allocator still in flight
+class DXBundle
+{
+public:
+	using RecordFunction = std::function<void(ID3D12GraphicsCommandList10* command_list)>;
+
+	void Init(DXContext& dx_context, const std::string& name);
+
+	// Re-records the bundle of the current backbuffer slot if the key differs, then executes it on the graphics commandlist
+	template<typename Key>
+	void Execute(DXContext& dx_context, const Key& key, const RecordFunction& record_function)
+	{
+		static_assert(std::is_trivially_copyable_v<Key>, "Bundle key is compared bytewise");
+		Execute(dx_context, &key, sizeof(Key), record_function);
+	}
+
+	// Forces a re-record on next execute of every slot
+	void Invalidate();
+
+	uint32 GetRecordCount() const;
+private:
+	void Execute(DXContext& dx_context, const void* key, uint32 key_size, const RecordFunction& record_function);
+
+	CommandAllocator m_allocators[g_backbuffer_count];
+	CommandList m_lists[g_backbuffer_count];
+	std::vector<uint8> m_keys[g_backbuffer_count];
+	bool m_is_recorded[g_backbuffer_count]{};
+	// Number of times a bundle got (re)recorded, for debugging invalidation
+	uint32 m_record_count = 0;
+};
\ No newline at end of file
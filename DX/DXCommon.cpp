@@ -22,8 +22,8 @@ void operator>>(const HRSourceLocation hr_source_location, const CheckToken chk_
 
 		//auto trace = std::stacktrace::current();
 		//LogError(std::to_string(trace));
-		LogError(line_string);
-		LogError("Error Code " + std::to_string(hr_source_location.m_hr) + ": " + error_code_string);
+		LOG_ERROR(Device, line_string);
+		LOG_ERROR(Device, "Error Code " + std::to_string(hr_source_location.m_hr) + ": " + error_code_string);
 		ASSERT(false);
 	}
 #else
@@ -38,6 +38,18 @@ m_source_location(loc)
 
 }
 
+DXWideName::DXWideName(std::string_view name)
+{
+	// Longer names are truncated, ASCII names convert one to one
+	ASSERT(name.size() < COUNT(m_chars));
+	char chars[COUNT(m_chars)];
+	const size_t length = (std::min)(name.size(), COUNT(m_chars) - 1);
+	memcpy(chars, name.data(), length);
+	chars[length] = '\0';
+	size_t size = 0;
+	mbstowcs_s(&size, m_chars, COUNT(m_chars), chars, _TRUNCATE);
+}
+
 D3D12_SHADER_BYTECODE BlobToByteCode(ComPtr<IDxcBlob> blob)
 {
 	return
@@ -45,4 +57,4 @@ D3D12_SHADER_BYTECODE BlobToByteCode(ComPtr<IDxcBlob> blob)
 		.pShaderBytecode = blob->GetBufferPointer(),
 		.BytecodeLength = blob->GetBufferSize()
 	};
-}
+}
\ No newline at end of file
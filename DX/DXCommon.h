@@ -8,14 +8,24 @@
 
 #include <dxcapi.h> // DXC compiler
 
+#include <string_view>
+
 // Agility SDK needs to be included in main.cpp
 #define AGILITY_SDK_DECLARE() extern "C" { __declspec(dllexport) extern const UINT D3D12SDKVersion = 716; } \
 extern "C" { __declspec(dllexport) extern const char* D3D12SDKPath = ".\\AgilitySDK\\"; }
 
 static const uint32 g_backbuffer_count = 3u;
 
+// Wide copy of a name for D3D12 calls taking wide strings, on the stack so naming per frame objects does not allocate
+struct DXWideName
+{
+	explicit DXWideName(std::string_view name);
+
+	wchar_t m_chars[256];
+};
+
 #if defined(_DEBUG)
-#define NAME_DX_OBJECT(object, name) object->SetName(std::to_wstring(name).c_str()) >> CHK
+#define NAME_DX_OBJECT(object, name) object->SetName(DXWideName(name).m_chars) >> CHK
 #define NAME_DXGI_OBJECT(object, name) object->SetPrivateData(WKPDID_D3DDebugObjectName, sizeof(char) * COUNT(name), name) >> CHK;
 #else
 #define NAME_DX_OBJECT(object, name)
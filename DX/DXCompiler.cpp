@@ -1,30 +1,33 @@
 #include "DXCompiler.h"
 #include "DXContext.h"
 #include "DXQuery.h"
+#include "../core/Hash.h"
+#include "../core/JobSystem.h"
+#include "DXIncludeHandler.h"
+#include <chrono>
 
 #if defined(_DEBUG)
 #define DXC_COMPILER_DEBUG_ENABLE
 #endif
 
-static const std::pair<ShaderType, std::string> g_shader_type_map_string[] =
+DXCompiler::DXCompiler(const std::string& directory, uint32 worker_count)
 {
-	{ShaderType::VERTEX_SHADER, "vs"},
-	{ShaderType::PIXEL_SHADER, "ps"},
-	{ShaderType::COMPUTE_SHADER, "cs"},
-	{ShaderType::LIB_SHADER, "lib"},
-};
-
-std::string GetShaderTypeString(const ShaderType& shader_type)
-{
-	return g_shader_type_map_string[static_cast<int32>(shader_type)].second;
+	Init(directory, worker_count);
 }
 
-DXCompiler::DXCompiler(const std::string& directory)
+// Out of line, JobSystem is incomplete in the header
+DXCompiler::~DXCompiler() = default;
+
+DXCompilerInstance DXCompiler::CreateInstance() const
 {
-	Init(directory);
+	DXCompilerInstance instance{};
+	DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&instance.m_utils)) >> CHK;
+	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&instance.m_compiler)) >> CHK;
+	instance.m_include_handler = Make<DXIncludeHandler>(instance.m_utils);
+	return instance;
 }
 
-void DXCompiler::Init(const std::string& directory)
+void DXCompiler::Init(const std::string& directory, uint32 worker_count)
 {
 	#if defined(DXC_COMPILER_DEBUG_ENABLE)
 		m_debug = true;
@@ -32,21 +35,161 @@ void DXCompiler::Init(const std::string& directory)
 		m_debug = false;
 	#endif
 	m_directory = directory;
-	DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_utils)) >> CHK;
-	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_compiler)) >> CHK;
-	m_utils->CreateDefaultIncludeHandler(&m_include_handler);
+	m_instance = CreateInstance();
+
+	m_job_system = std::make_unique<JobSystem>(worker_count);
+	m_worker_instances.reserve(m_job_system->GetThreadSlotCount());
+	for (uint32 i = 0; i < m_job_system->GetThreadSlotCount(); ++i)
+	{
+		m_worker_instances.push_back(CreateInstance());
+	}
+
+	// Any compiler update invalidates the whole cache
+	ComPtr<IDxcVersionInfo> version_info{};
+	m_instance.m_compiler.As(&version_info) >> CHK;
+	uint32 major_version = 0;
+	uint32 minor_version = 0;
+	version_info->GetVersion(&major_version, &minor_version) >> CHK;
+	m_compiler_version_hash = Hash64(major_version);
+	m_compiler_version_hash = Hash64(minor_version, m_compiler_version_hash);
+	ComPtr<IDxcVersionInfo2> version_info2{};
+	if (SUCCEEDED(m_instance.m_compiler.As(&version_info2)))
+	{
+		uint32 commit_count = 0;
+		char* commit_hash = nullptr;
+		version_info2->GetCommitInfo(&commit_count, &commit_hash) >> CHK;
+		m_compiler_version_hash = Hash64(commit_count, m_compiler_version_hash);
+		m_compiler_version_hash = Hash64(std::string(commit_hash), m_compiler_version_hash);
+		CoTaskMemFree(commit_hash);
+	}
+
+	m_cache.Init(m_directory + "\\cache");
+	if (m_archive.Open(m_directory, m_directory + "\\shaders.archive"))
+	{
+		LOG_TRACE(Compiler, "Shader archive opened with {0} entries", m_archive.GetEntryCount());
+	}
+}
+
+void DXCompiler::SetCacheEnabled(bool enable)
+{
+	m_cache_enabled = enable;
+}
+
+uint32 DXCompiler::GetWorkerCount() const
+{
+	return m_job_system->GetWorkerCount();
+}
+
+bool DXCompiler::ComputeCacheKey(const DXCompilerInstance& instance, const DxcBuffer& source_buffer, const std::vector<LPCWSTR>& arguments, uint64& out_key) const
+{
+	// Preprocess only, resolves every #include so editing Common.hlsl changes the key of all its users
+	std::vector<LPCWSTR> preprocess_arguments = arguments;
+	preprocess_arguments.push_back(L"-P");
+	ComPtr<IDxcResult> preprocess_result{};
+	instance.m_compiler->Compile(&source_buffer, preprocess_arguments.data(), (uint32)preprocess_arguments.size(), instance.m_include_handler.Get(), IID_PPV_ARGS(&preprocess_result)) >> CHK;
+	HRESULT HR{};
+	preprocess_result->GetStatus(&HR) >> CHK;
+	if (FAILED(HR))
+	{
+		return false;
+	}
+	ComPtr<IDxcBlobUtf8> preprocessed_source{};
+	preprocess_result->GetOutput(DXC_OUT_HLSL, IID_PPV_ARGS(&preprocessed_source), nullptr) >> CHK;
+
+	uint64 key = Hash64(preprocessed_source->GetStringPointer(), preprocessed_source->GetStringLength(), m_compiler_version_hash);
+	// Arguments contain entry point, target profile, optimization and include directory
+	for (LPCWSTR argument : arguments)
+	{
+		key = Hash64(argument, (wcslen(argument) + 1) * sizeof(wchar_t), key);
+	}
+	out_key = key;
+	return true;
 }
 
 Shader DXCompiler::Compile(ComPtr<ID3D12Device> device, const ShaderDesc& shader_desc) const
 {
-	ComPtr<IDxcBlob> shader_blob;
+	return Compile(m_instance, device, shader_desc);
+}
+
+std::vector<Shader> DXCompiler::Compile(ComPtr<ID3D12Device> device, const std::vector<ShaderDesc>& shader_descs) const
+{
+	// A shader per range, compiles take long enough that splitting finer buys nothing
+	std::vector<Shader> shaders(shader_descs.size());
+	m_job_system->ParallelFor
+	(
+		(uint32)shader_descs.size(), 1,
+		[&](uint32 begin, uint32 end, uint32 worker_index)
+		{
+			for (uint32 i = begin; i < end; ++i)
+			{
+				shaders[i] = Compile(m_worker_instances[worker_index], device, shader_descs[i]);
+			}
+		}
+	);
+	return shaders;
+}
+
+std::vector<std::future<Shader>> DXCompiler::CompileAsync(ComPtr<ID3D12Device> device, const std::vector<ShaderDesc>& shader_descs) const
+{
+	std::vector<std::future<Shader>> shaders{};
+	shaders.reserve(shader_descs.size());
+	for (const ShaderDesc& shader_desc : shader_descs)
+	{
+		shaders.push_back
+		(
+			m_job_system->Async
+			(
+				[this, device, shader_desc](uint32 worker_index)
+				{
+					return Compile(m_worker_instances[worker_index], device, shader_desc);
+				}
+			)
+		);
+	}
+	return shaders;
+}
+
+Shader DXCompiler::Compile(const DXCompilerInstance& instance, ComPtr<ID3D12Device> device, const ShaderDesc& shader_desc) const
+{
+	const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
 	std::string shader_file = shader_desc.m_file_name;
 	ShaderType shader_type = shader_desc.m_type;
 	std::string entry_point = shader_desc.m_entry_point_name;
 	
-	ComPtr<IDxcBlobEncoding> shader_source{};
+	// Failures are reported through an empty blob, hot reload keeps the previous version then
+	Shader shader
+	{
+		.m_shader_desc = shader_desc,
+	};
 	const std::string shader_full_path = m_directory + "\\" + shader_file;
-	m_utils->LoadFile(std::to_wstring(shader_full_path).c_str(), nullptr, &shader_source) >> CHK;
+	instance.m_include_handler->ResetIncludedFiles();
+	auto collect_dependencies = [&]()
+	{
+		shader.m_dependencies = { NormalizeShaderPath(shader_full_path) };
+		const std::vector<std::string>& included_files = instance.m_include_handler->GetIncludedFiles();
+		shader.m_dependencies.insert(shader.m_dependencies.end(), included_files.begin(), included_files.end());
+	};
+
+	// Technically this needs to be supported by the DXC and not the device
+	const D3D_SHADER_MODEL shader_model = GetMaxShaderModel(device);
+	const std::string& shader_model_string = GetShaderModelString(shader_model);
+
+	// Archive lookup does not need the source, it only hashes the files when they are present
+	if (m_cache_enabled && m_archive.Load(instance.m_utils.Get(), shader_desc, shader_model_string, m_debug, shader))
+	{
+		const float64 milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+		LOG_TRACE(Compiler, "Shader archive hit {0} {1}: {2:.2f} ms", shader_file, entry_point, milliseconds);
+		return shader;
+	}
+
+	ComPtr<IDxcBlobEncoding> shader_source{};
+	// Can fail while an editor still holds the file
+	if (FAILED(instance.m_utils->LoadFile(std::to_wstring(shader_full_path).c_str(), nullptr, &shader_source)))
+	{
+		LOG_ERROR(Compiler, "Failed to load shader {0}", shader_full_path);
+		collect_dependencies();
+		return shader;
+	}
 	DxcBuffer source_buffer{};
 	source_buffer.Ptr = shader_source->GetBufferPointer();
 	source_buffer.Size = shader_source->GetBufferSize();
@@ -58,10 +201,6 @@ Shader DXCompiler::Compile(ComPtr<ID3D12Device> device, const ShaderDesc& shader
 	compile_arguments.push_back("-T"); // Target profile 
 	std::string shader_type_model_string = GetShaderTypeString(shader_type);
 
-	// Technically this needs to be supported by the DXC and not the device
-	const D3D_SHADER_MODEL shader_model = GetMaxShaderModel(device);
-
-	const std::string& shader_model_string = GetShaderModelString(shader_model);
 	shader_type_model_string += "_" + shader_model_string;
 
 	compile_arguments.push_back(shader_type_model_string.c_str());
@@ -82,6 +221,11 @@ Shader DXCompiler::Compile(ComPtr<ID3D12Device> device, const ShaderDesc& shader
 	compile_arguments.push_back("-WX"); // 	Treat warnings as errors
 	std::string include_string_argument = "-I " + m_directory;
 	compile_arguments.push_back(include_string_argument.c_str());
+	for (const std::string& define : shader_desc.m_defines)
+	{
+		compile_arguments.push_back("-D");
+		compile_arguments.push_back(define);
+	}
 
 	// Keep compile_arguments_wstring alive when passing compile_arguments_lpcwstr to compile
 	std::vector<std::wstring> compile_arguments_wstring = std::to_wstring(compile_arguments);
@@ -91,21 +235,64 @@ Shader DXCompiler::Compile(ComPtr<ID3D12Device> device, const ShaderDesc& shader
 		compile_arguments_lpcwstr.push_back(argument.c_str());
 	}
 
+	uint64 cache_key = 0;
+	const bool use_cache = m_cache_enabled && ComputeCacheKey(instance, source_buffer, compile_arguments_lpcwstr, cache_key);
+	ShaderCacheEntry cache_entry{};
+	if (use_cache && m_cache.Load(instance.m_utils.Get(), cache_key, cache_entry))
+	{
+		const float64 milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+		LOG_TRACE
+		(
+			Compiler,
+			"Shader cache hit {0} {1}: {2:.2f} ms, saved {3:.2f} ms", 
+			shader_file, entry_point, milliseconds, cache_entry.m_compile_milliseconds - milliseconds
+		);
+		shader.m_blob = cache_entry.m_blobs[static_cast<uint32>(ShaderCacheBlob::Object)];
+		shader.m_reflection_blob = cache_entry.m_blobs[static_cast<uint32>(ShaderCacheBlob::Reflection)];
+		shader.m_root_signature_blob = cache_entry.m_blobs[static_cast<uint32>(ShaderCacheBlob::RootSignature)];
+		// Preprocessing of the key went through the include handler
+		collect_dependencies();
+		return shader;
+	}
+
 	ComPtr<IDxcResult> compileResult{};
-	m_compiler->Compile(&source_buffer, compile_arguments_lpcwstr.data(), (uint32)compile_arguments_lpcwstr.size(), m_include_handler.Get(), IID_PPV_ARGS(&compileResult)) >> CHK;
+	instance.m_compiler->Compile(&source_buffer, compile_arguments_lpcwstr.data(), (uint32)compile_arguments_lpcwstr.size(), instance.m_include_handler.Get(), IID_PPV_ARGS(&compileResult)) >> CHK;
 	
 	ComPtr<IDxcBlobUtf8> errors{};
 	compileResult->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&errors), nullptr) >> CHK;
 	if (errors && errors->GetStringLength() > 0)
 	{
-		LogError("{0}", (char*)errors->GetBufferPointer());
+		LOG_ERROR(Compiler, "{0}", (char*)errors->GetBufferPointer());
 	}
+	collect_dependencies();
 	HRESULT HR{};
 	compileResult->GetStatus(&HR) >> CHK;
-	HR >> CHK;
+	if (FAILED(HR))
+	{
+		LOG_ERROR(Compiler, "Failed to compile {0} {1}", shader_file, entry_point);
+		return shader;
+	}
 
-	compileResult->GetOutput(DXC_OUT_OBJECT, __uuidof(IDxcBlob), (void**)&shader_blob, nullptr) >> CHK;
+	compileResult->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shader.m_blob), nullptr) >> CHK;
+	if (compileResult->HasOutput(DXC_OUT_REFLECTION))
+	{
+		compileResult->GetOutput(DXC_OUT_REFLECTION, IID_PPV_ARGS(&shader.m_reflection_blob), nullptr) >> CHK;
+	}
+	if (compileResult->HasOutput(DXC_OUT_ROOT_SIGNATURE))
+	{
+		compileResult->GetOutput(DXC_OUT_ROOT_SIGNATURE, IID_PPV_ARGS(&shader.m_root_signature_blob), nullptr) >> CHK;
+	}
 
-	return Shader{shader_blob, shader_desc};
-}
+	const float64 milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	if (use_cache)
+	{
+		cache_entry.m_blobs[static_cast<uint32>(ShaderCacheBlob::Object)] = shader.m_blob;
+		cache_entry.m_blobs[static_cast<uint32>(ShaderCacheBlob::Reflection)] = shader.m_reflection_blob;
+		cache_entry.m_blobs[static_cast<uint32>(ShaderCacheBlob::RootSignature)] = shader.m_root_signature_blob;
+		cache_entry.m_compile_milliseconds = milliseconds;
+		m_cache.Store(cache_key, cache_entry);
+		LOG_TRACE(Compiler, "Shader cache miss {0} {1}: compiled in {2:.2f} ms", shader_file, entry_point, milliseconds);
+	}
 
+	return shader;
+}
\ No newline at end of file
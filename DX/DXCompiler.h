@@ -2,6 +2,12 @@
 #include "../core/Common.h"
 #include <dxcapi.h> // DXC compiler
 #include "Shader.h"
+#include "DXShaderCache.h"
+#include "DXShaderArchive.h"
+#include "DXIncludeHandler.h"
+
+#include <future>
+#include <memory>
 
 struct IDxcUtils;
 struct IDxcBlob;
@@ -10,18 +16,55 @@ struct IDxcIncludeHandler;
 struct ID3D12Device;
 
 
+class JobSystem;
+
+// DXC objects are not thread safe, one set per thread compiling
+struct DXCompilerInstance
+{
+	ComPtr<IDxcUtils> m_utils;
+	ComPtr<IDxcCompiler3> m_compiler;
+	// Records the included files of the last compilation
+	ComPtr<DXIncludeHandler> m_include_handler;
+};
+
 class DXCompiler
 {
 public:
-	DXCompiler(const std::string& directory);
+	// 0 workers uses one per hardware thread but the calling one, which compiles too when waiting on a batch
+	DXCompiler(const std::string& directory, uint32 worker_count = 0);
+	~DXCompiler();
+
+	// Compiles on the calling thread
+	// Failure is logged and returns a shader without blob
 	Shader Compile(ComPtr<ID3D12Device> device, const ShaderDesc& shader_desc) const;
+	// Compiles the batch concurrently on the workers and the calling thread, shaders are in the order of shader_descs
+	std::vector<Shader> Compile(ComPtr<ID3D12Device> device, const std::vector<ShaderDesc>& shader_descs) const;
+	// Compiles the batch on the workers while the calling thread goes on, futures are in the order of shader_descs
+	std::vector<std::future<Shader>> CompileAsync(ComPtr<ID3D12Device> device, const std::vector<ShaderDesc>& shader_descs) const;
+
+	// Disables the shader archive as well
+	void SetCacheEnabled(bool enable);
+	uint32 GetWorkerCount() const;
 private:
-	void Init(const std::string& directory);
+	void Init(const std::string& directory, uint32 worker_count);
+	DXCompilerInstance CreateInstance() const;
+	Shader Compile(const DXCompilerInstance& instance, ComPtr<ID3D12Device> device, const ShaderDesc& shader_desc) const;
+	// Hash of the preprocessed source (includes resolved), full argument list and compiler version
+	// Fails when preprocessing fails, compilation reports the errors then
+	bool ComputeCacheKey(const DXCompilerInstance& instance, const DxcBuffer& source_buffer, const std::vector<LPCWSTR>& arguments, uint64& out_key) const;
 	
 	bool m_debug;
 	std::string m_directory;
 
-	ComPtr<IDxcUtils> m_utils;
-	ComPtr<IDxcCompiler3> m_compiler;
-	ComPtr<IDxcIncludeHandler> m_include_handler;
+	ShaderCache m_cache;
+	// Prebuilt by the ShaderBuild tool, checked before the cache, blobs out of it live as long as the compiler
+	ShaderArchive m_archive;
+	bool m_cache_enabled = true;
+	uint64 m_compiler_version_hash = 0;
+
+	// Used by Compile on the calling thread
+	DXCompilerInstance m_instance;
+	// Indexed by worker index, the last one is for the thread helping from outside the job system
+	std::vector<DXCompilerInstance> m_worker_instances;
+	std::unique_ptr<JobSystem> m_job_system;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "DXQuery.h"
 #include "DXResource.h"
 #include "RootSignature.h"
+#include "DXCrashReport.h"
 
 #if defined(_DEBUG)
 #include <dxgidebug.h>
@@ -11,6 +12,7 @@
 
 DXContext::~DXContext()
 {
+	m_pipeline_cache.Serialize();
 	UnregisterWait(m_device_removed_handle);
 #if defined(_DEBUG)
 	if (m_device)
@@ -93,188 +95,40 @@ namespace
 	}
 }
 
-static const std::map<D3D12_AUTO_BREADCRUMB_OP, std::string> g_breadcrumb_operation_map_string =
-{
-	{ D3D12_AUTO_BREADCRUMB_OP_SETMARKER, "Set Marker" },
-	{ D3D12_AUTO_BREADCRUMB_OP_BEGINEVENT, "Begin Event" },
-	{ D3D12_AUTO_BREADCRUMB_OP_ENDEVENT, "End Event" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DRAWINSTANCED, "Draw Instanced" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DRAWINDEXEDINSTANCED, "Draw Indexed Instanced" },
-	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEINDIRECT, "Execute Indirect" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DISPATCH, "Dispatch" },
-	{ D3D12_AUTO_BREADCRUMB_OP_COPYBUFFERREGION, "Copy Buffer Region" },
-	{ D3D12_AUTO_BREADCRUMB_OP_COPYTEXTUREREGION, "Copy Texture Region" },
-	{ D3D12_AUTO_BREADCRUMB_OP_COPYRESOURCE, "Copy Resource" },
-	{ D3D12_AUTO_BREADCRUMB_OP_COPYTILES, "Copy Tiles" },
-	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVESUBRESOURCE, "Resolve SubResource" },
-	{ D3D12_AUTO_BREADCRUMB_OP_CLEARRENDERTARGETVIEW, "Clear RTV" },
-	{ D3D12_AUTO_BREADCRUMB_OP_CLEARUNORDEREDACCESSVIEW, "Clear UAV" },
-	{ D3D12_AUTO_BREADCRUMB_OP_CLEARDEPTHSTENCILVIEW, "Clear DSV" },
-	{ D3D12_AUTO_BREADCRUMB_OP_RESOURCEBARRIER, "Resource Barrier" },
-	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEBUNDLE, "Execute Bundle" },
-	{ D3D12_AUTO_BREADCRUMB_OP_PRESENT, "Present" },
-	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVEQUERYDATA, "Resolve Query Data" },
-	{ D3D12_AUTO_BREADCRUMB_OP_BEGINSUBMISSION, "Begin Submission" },
-	{ D3D12_AUTO_BREADCRUMB_OP_ENDSUBMISSION, "End Submission" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DECODEFRAME, "Decode Frame" },
-	{ D3D12_AUTO_BREADCRUMB_OP_PROCESSFRAMES, "Process Frames" },
-	{ D3D12_AUTO_BREADCRUMB_OP_ATOMICCOPYBUFFERUINT, "Atomic Copy Buffer uint" },
-	{ D3D12_AUTO_BREADCRUMB_OP_ATOMICCOPYBUFFERUINT64, "Atomic Copy Buffer uint64" },
-	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVESUBRESOURCEREGION, "Resolve Subresource Region" },
-	{ D3D12_AUTO_BREADCRUMB_OP_WRITEBUFFERIMMEDIATE, "Write Buffer Immediate" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DECODEFRAME1, "Decpde Frame 1" },
-	{ D3D12_AUTO_BREADCRUMB_OP_SETPROTECTEDRESOURCESESSION, "Set Protected Resource Session" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DECODEFRAME2, "Decode Frame 2" },
-	{ D3D12_AUTO_BREADCRUMB_OP_PROCESSFRAMES1, "Process Frames 1" },
-	{ D3D12_AUTO_BREADCRUMB_OP_BUILDRAYTRACINGACCELERATIONSTRUCTURE, "Build ACC" },
-	{ D3D12_AUTO_BREADCRUMB_OP_EMITRAYTRACINGACCELERATIONSTRUCTUREPOSTBUILDINFO, "Emit ACC PostBuild Info" },
-	{ D3D12_AUTO_BREADCRUMB_OP_COPYRAYTRACINGACCELERATIONSTRUCTURE, "Copy ACC" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DISPATCHRAYS, "Dispatch Rays" },
-	{ D3D12_AUTO_BREADCRUMB_OP_INITIALIZEMETACOMMAND, "Initialize Meta Command" },
-	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEMETACOMMAND, "Execute Meta Command" },
-	{ D3D12_AUTO_BREADCRUMB_OP_ESTIMATEMOTION, "Estimate Motion" },
-	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVEMOTIONVECTORHEAP	, "Resolve Motion Vector Heap" },
-	{ D3D12_AUTO_BREADCRUMB_OP_SETPIPELINESTATE1, "Set PSO1" },
-	{ D3D12_AUTO_BREADCRUMB_OP_INITIALIZEEXTENSIONCOMMAND, "Initialize Extension Command" },
-	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEEXTENSIONCOMMAND, "Execute Extension Command" },
-	{ D3D12_AUTO_BREADCRUMB_OP_DISPATCHMESH, "Dispatch Mesh" },
-	{ D3D12_AUTO_BREADCRUMB_OP_ENCODEFRAME, "Encode Frame" },
-	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVEENCODEROUTPUTMETADATA, "Resolve Encoder Output Meta Data" },
-};
-
-std::string BreadCrumbOperationString(D3D12_AUTO_BREADCRUMB_OP operation)
-{
-	auto iterator = g_breadcrumb_operation_map_string.find(operation);
-	if (iterator != g_breadcrumb_operation_map_string.cend())
-	{
-		return iterator->second;
-	}
-	ASSERT(false && "Invalid Bread Crumb Operation");
-	return "";
-}
-
-std::string BreadCrumbNodeToString(const D3D12_AUTO_BREADCRUMB_NODE* node)
-{
-	std::string output{};
-
-	std::string command_list_name = node->pCommandListDebugNameA;
-	std::string command_queue_name = node->pCommandQueueDebugNameA;
-	uint32 index = *node->pLastBreadcrumbValue;
-	output = std::format("Command List %s, on Command Queue %s", command_list_name, command_queue_name);
-	D3D12_AUTO_BREADCRUMB_OP operation = node->pCommandHistory[index];
-	std::string operation_string = BreadCrumbOperationString(operation);
-	output += std::format(", Operation %s", operation_string);
-	return output;
-}
-
-std::string BreadCrumbToString(const D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT& bread_crumb)
-{
-	std::string output{};
-	const D3D12_AUTO_BREADCRUMB_NODE* bread_crumb_node = bread_crumb.pHeadAutoBreadcrumbNode;
-	while (bread_crumb_node != nullptr)
-	{
-		if (*bread_crumb_node->pLastBreadcrumbValue < bread_crumb_node->BreadcrumbCount)
-		{
-			output += BreadCrumbNodeToString(bread_crumb_node);
-			output += "\n";
-		}
-		bread_crumb_node = bread_crumb_node->pNext;
-	}
-
-	return output;
-}
-
-static const std::map<D3D12_DRED_ALLOCATION_TYPE, std::string> g_dred_allocation_type_map_string =
-{
-	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_QUEUE, "Command Queue" },
-	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_ALLOCATOR, "Command Allocator" },
-	{D3D12_DRED_ALLOCATION_TYPE_PIPELINE_STATE, "PSO" },
-	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_LIST, "Command List" },
-	{D3D12_DRED_ALLOCATION_TYPE_FENCE, "Fence" },
-	{D3D12_DRED_ALLOCATION_TYPE_DESCRIPTOR_HEAP, "Descriptor Heap" },
-	{D3D12_DRED_ALLOCATION_TYPE_HEAP, "Heap" },
-	{D3D12_DRED_ALLOCATION_TYPE_QUERY_HEAP, "Query Heap" },
-	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_SIGNATURE, "Command Signature" },
-	{D3D12_DRED_ALLOCATION_TYPE_PIPELINE_LIBRARY, "PSO Library" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_DECODER, "Video Decoder" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_PROCESSOR, "Video Processor" },
-	{D3D12_DRED_ALLOCATION_TYPE_RESOURCE, "Resource" },
-	{D3D12_DRED_ALLOCATION_TYPE_PASS, "Pass" },
-	{D3D12_DRED_ALLOCATION_TYPE_CRYPTOSESSION, "Crypto Session" },
-	{D3D12_DRED_ALLOCATION_TYPE_CRYPTOSESSIONPOLICY, "Crypto Session Policy" },
-	{D3D12_DRED_ALLOCATION_TYPE_PROTECTEDRESOURCESESSION, "Protected Resource Session" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_DECODER_HEAP, "Video Decode Heap" },
-	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_POOL, "Command Pool" },
-	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_RECORDER, "Command Recorder" },
-	{D3D12_DRED_ALLOCATION_TYPE_STATE_OBJECT, "SO" },
-	{D3D12_DRED_ALLOCATION_TYPE_METACOMMAND, "Meta Command" },
-	{D3D12_DRED_ALLOCATION_TYPE_SCHEDULINGGROUP, "Scheduling Group" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_MOTION_ESTIMATOR, "Video Motion Estimator" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_MOTION_VECTOR_HEAP, "Video Motion Vector Heap" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_EXTENSION_COMMAND, "Video Extension Command" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_ENCODER, "Video Encoder" },
-	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_ENCODER_HEAP, "Video Encoder Heap" },
-	{D3D12_DRED_ALLOCATION_TYPE_INVALID, "Invalid" },
-};
-
-std::string AllocationTypeString(D3D12_DRED_ALLOCATION_TYPE type)
-{
-	auto iterator = g_dred_allocation_type_map_string.find(type);
-	if (iterator != g_dred_allocation_type_map_string.cend())
-	{
-		return iterator->second;
-	}
-	ASSERT(false && "Invalid Allocation Type");
-	return "";
-}
-
-std::string AllocationNodeString(const D3D12_DRED_ALLOCATION_NODE* node)
-{
-	std::string output{};
-	while (node != nullptr)
-	{
-		std::string object_string = node->ObjectNameA;
-		std::string allocation_type_string = AllocationTypeString(node->AllocationType);
-		node = node->pNext;
-	}
-	return output;
-}
-
-std::string PageFaultToString(const D3D12_DRED_PAGE_FAULT_OUTPUT& page_fault)
-{
-	std::string output{};
-	output += std::format("Page Fault at %lld\n", page_fault.PageFaultVA);
-	output += "Active Allocations:\n";
-	output += AllocationNodeString(page_fault.pHeadExistingAllocationNode);
-	output += "\nFreed Allocations:\n";
-	output += AllocationNodeString(page_fault.pHeadRecentFreedAllocationNode);
-	return output;
-}
-
 void OnDeviceRemoved(PVOID context, BOOLEAN)
 {
-	// Data to pass is limited so we dont pass ComPtr
-	ID3D12Device* removed_device = static_cast<ID3D12Device*>(context);
-	ComPtr<ID3D12Device> device = removed_device;
+	// Data to pass is limited so we pass the context rather than ComPtr
+	DXContext* dx_context = static_cast<DXContext*>(context);
+	ComPtr<ID3D12Device> device = dx_context->m_device;
 	HRESULT removed_reason = device->GetDeviceRemovedReason();
 	std::string removed_reason_string = RemapHResult(removed_reason);
 	
 	if (removed_reason != S_OK)
 	{
+		// Report first, it is what reaches us from machines without a debugger
+		const std::string report_path = dx_context->m_crash_report.Write(device.Get(), removed_reason);
+		LOG_ERROR(Device, "Device removed: {0}, crash report {1}", removed_reason_string, report_path.empty() ? "failed" : report_path);
+
 		// DRED
 		ComPtr<ID3D12DeviceRemovedExtendedData> dred{};
-		device->QueryInterface(IID_PPV_ARGS(&dred));
-		D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT dred_autobreadcrumbs_output{};
-		D3D12_DRED_PAGE_FAULT_OUTPUT dred_page_fault_output{};
-		dred->GetAutoBreadcrumbsOutput(&dred_autobreadcrumbs_output) >> CHK;
-		std::string breadcrumb_string = BreadCrumbToString(dred_autobreadcrumbs_output);
-		LogError("%s\n", breadcrumb_string);
-		dred->GetPageFaultAllocationOutput(&dred_page_fault_output) >> CHK;
+		if (SUCCEEDED(device->QueryInterface(IID_PPV_ARGS(&dred))))
+		{
+			D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT dred_autobreadcrumbs_output{};
+			D3D12_DRED_PAGE_FAULT_OUTPUT dred_page_fault_output{};
+			if (SUCCEEDED(dred->GetAutoBreadcrumbsOutput(&dred_autobreadcrumbs_output)))
+			{
+				LOG_ERROR(Device, BreadCrumbToString(dred_autobreadcrumbs_output));
+			}
+			if (SUCCEEDED(dred->GetPageFaultAllocationOutput(&dred_page_fault_output)))
+			{
+				LOG_ERROR(Device, PageFaultToString(dred_page_fault_output));
+			}
+		}
 		ASSERT(false);
 	}
 
 	ASSERT(removed_reason == S_OK);
-	LogTrace(removed_reason_string);
+	LOG_ERROR(Device, removed_reason_string);
 }
 
 DXContext::DXContext
@@ -316,7 +170,13 @@ DXContext::DXContext
 		//d3d12_debug->SetEnableAutoName(true);
 		d3d12_debug->SetEnableSynchronizedCommandQueueValidation(true);
 	}
+#else
+	UNUSED(enable_debug_layer_cpu);
+	UNUSED(enable_debug_layer_gpu);
+	UNUSED(use_warp);
+#endif
 
+	// Not tied to the debug layer, release builds need it for the crash report of field machines
 	if (enable_dred)
 	{
 		// DRED: Auto WriteBufferImmediate (aka auto bread crumbs) & force GPU page fault instead of reading zeros
@@ -326,12 +186,6 @@ DXContext::DXContext
 		pDredSettings->SetAutoBreadcrumbsEnablement(D3D12_DRED_ENABLEMENT_FORCED_ON);
 		pDredSettings->SetPageFaultEnablement(D3D12_DRED_ENABLEMENT_FORCED_ON);
 	}
-#else
-	UNUSED(enable_debug_layer_cpu);
-	UNUSED(enable_debug_layer_gpu);
-	UNUSED(enable_dred);
-	UNUSED(use_warp);
-#endif
 
 	uint32 dxgi_factory_flag { 0 };
 #if defined(_DEBUG)
@@ -351,17 +205,17 @@ DXContext::DXContext
 	NAME_DXGI_OBJECT(m_adapter, "Adapter");
 
 	DXGI_ADAPTER_DESC adapter_desc = GetAdapterDesc(m_adapter);
-	LogTrace(std::to_string(adapter_desc.Description));
+	LOG_INFO(Device, std::to_string(adapter_desc.Description));
 
-	LogTrace("Total VRAM {0}, Total SRAM {1}",
+	LOG_INFO(Memory, "Total VRAM {0}, Total SRAM {1}",
 	         ToMB(adapter_desc.DedicatedVideoMemory),
 	         ToMB(adapter_desc.SharedSystemMemory));
 
 	auto[vram_bytes_used, vram_bytes_budget] = GetVRAM(m_adapter);
-	LogTrace("VRAM usage: {0} MB / {1} MB", ToMB(vram_bytes_used), ToMB(vram_bytes_budget));
+	LOG_TRACE(Memory, "VRAM usage: {0} MB / {1} MB", ToMB(vram_bytes_used), ToMB(vram_bytes_budget));
 
 	auto[system_ram_bytes_used, system_ram_bytes_budget] = GetSystemRAM(m_adapter);
-	LogTrace("System RAM usage: {0} MB / {1} MB", ToMB(system_ram_bytes_used), ToMB(system_ram_bytes_budget));
+	LOG_TRACE(Memory, "System RAM usage: {0} MB / {1} MB", ToMB(system_ram_bytes_used), ToMB(system_ram_bytes_budget));
 
 	D3D_FEATURE_LEVEL max_feature_level = GetMaxFeatureLevel(m_adapter);
 	D3D12CreateDevice(m_adapter.Get(), max_feature_level, IID_PPV_ARGS(&m_device)) >> CHK;
@@ -459,7 +313,7 @@ DXContext::DXContext
 		&m_device_removed_handle,
 		m_device_removed_fence.m_event,
 		OnDeviceRemoved,
-		m_device.Get(), // Pass the device as our context
+		this, // Pass the context, it outlives the wait unregistered in the destructor
 		INFINITE, // No timeout
 		0 // No flags
 	);
@@ -474,16 +328,25 @@ DXContext::DXContext
 
 	CacheDescriptorSizes();
 	//const uint32 max_allowed_cbv_srv_uav_descriptors = 1000000;
-	const uint32 max_allowed_cbv_srv_uav_descriptors = 10;
+	// Ring of transient descriptors, each frame allocates a handful per pass
+	const uint32 max_allowed_cbv_srv_uav_descriptors = 1024;
 	CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, max_allowed_cbv_srv_uav_descriptors, "Resources Descriptor Heap", m_resources_descriptor_heap);
+	ASSERT(s_persistent_descriptor_count < max_allowed_cbv_srv_uav_descriptors);
+	for (uint32 i = 0; i < g_backbuffer_count; ++i)
+	{
+		m_last_indices[i] = s_persistent_descriptor_count;
+	}
 	const uint32 max_allowed_sampler_descriptors = 2048;
 	CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, max_allowed_sampler_descriptors, "Samplers Descriptor Heap", m_samplers_descriptor_heap);
 
 #if defined(_DEBUG)
-	LogTrace(DumpDX12Capabilities(m_device));
+	LOG_TRACE(Device, DumpDX12Capabilities(m_device));
 #endif
 
 	m_rtv_descriptor_handler.Init(*this);
+
+	m_pipeline_cache.Init(m_device, m_adapter, ".\\cache\\pipeline_library.bin");
+	m_crash_report.Init(*this, ".\\crashes");
 }
 
 // Declaration
@@ -496,6 +359,7 @@ void DXContext::InitCommandLists()
 	m_start_index = m_last_indices[g_current_buffer_index];
 	// Free old transient resources
 	m_resource_handler.FreeResources();
+	m_frame_arenas[g_current_buffer_index].Reset();
 	CommandAllocator& command_allocator = m_command_allocator_graphics[g_current_buffer_index];
 	
 	if (!m_command_list_graphics.m_is_open)
@@ -559,6 +423,11 @@ void DXContext::Wait(const Fence& fence, uint32 index)
 	WaitForSingleObject(fence.m_event, INFINITE);
 }
 
+bool DXContext::IsComplete(const Fence& fence, uint32 index) const
+{
+	return fence.m_gpu->GetCompletedValue() >= fence.m_cpus[index];
+}
+
 void DXContext::SignalAndWait(uint32 buffer_index)
 {
 	Signal(m_queue_graphics, m_fence, buffer_index);
@@ -577,8 +446,11 @@ void DXContext::Flush(uint32 flush_count)
 
 RootSignature DXContext::CreateRS(const Shader& shader) const
 {
+	ASSERT(shader.m_blob);
 	RootSignature root_signature{};
-	m_device->CreateRootSignature(0, shader.m_blob->GetBufferPointer(), shader.m_blob->GetBufferSize(), IID_PPV_ARGS(&root_signature.m_signature)) >> CHK;
+	// Standalone root signature part when split out by the compiler, otherwise extracted from the full container
+	const ComPtr<IDxcBlob>& blob = shader.m_root_signature_blob ? shader.m_root_signature_blob : shader.m_blob;
+	m_device->CreateRootSignature(0, blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&root_signature.m_signature)) >> CHK;
 	NAME_DX_OBJECT(root_signature.m_signature, shader.m_shader_desc.m_file_name);
 	return root_signature;
 }
@@ -664,6 +536,16 @@ CommandQueue DXContext::GetCommandQueue() const
 	return m_queue_graphics;
 }
 
+CommandQueue DXContext::GetCommandQueueCopy() const
+{
+	return m_queue_copy;
+}
+
+FrameArena& DXContext::GetFrameArena()
+{
+	return m_frame_arenas[g_current_buffer_index];
+}
+
 D3D12_DESCRIPTOR_HEAP_FLAGS GetShaderVisible(D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
 {
 	// Only CBV / SRV / UAV can be accessed directly in shaders
@@ -798,10 +680,10 @@ void DXReportContext::ReportLDO()
 	if (m_adapter)
 	{
 		auto[vram_bytes_used, vram_bytes_budget] = GetVRAM(m_adapter);
-		LogTrace("VRAM usage: {0} MB / {1} MB", ToMB(vram_bytes_used), ToMB(vram_bytes_budget));
+		LOG_TRACE(Memory, "VRAM usage: {0} MB / {1} MB", ToMB(vram_bytes_used), ToMB(vram_bytes_budget));
 
 		auto[system_ram_bytes_used, system_ram_bytes_budget] = GetSystemRAM(m_adapter);
-		LogTrace("System RAM usage: {0} MB / {1} MB", ToMB(system_ram_bytes_used), ToMB(system_ram_bytes_budget));
+		LOG_TRACE(Memory, "System RAM usage: {0} MB / {1} MB", ToMB(system_ram_bytes_used), ToMB(system_ram_bytes_budget));
 
 		if (m_adapter) m_adapter.Reset();
 	}
@@ -898,6 +780,7 @@ void DXCommand::EndFrame()
 void DXContext::DescriptorAllocateCheck()
 {
 #if defined(_DEBUG)
+	const uint32 ring_size = m_resources_descriptor_heap.m_number_descriptors - s_persistent_descriptor_count;
 	uint32 number_allocated = 0;
 	if (m_start_index <= m_free_index)
 	{
@@ -905,33 +788,46 @@ void DXContext::DescriptorAllocateCheck()
 	}
 	else
 	{
-		number_allocated = m_resources_descriptor_heap.m_number_descriptors - (m_start_index - m_free_index);
+		number_allocated = ring_size - (m_start_index - m_free_index);
 	}
-	ASSERT(number_allocated < m_resources_descriptor_heap.m_number_descriptors);
+	ASSERT(number_allocated < ring_size);
 #endif
 }
 
-void DXContext::DescriptorAllocate(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor, uint32& bindless_index)
+void DXContext::DescriptorAllocate(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor, uint32& bindless_index, DescriptorLifetime lifetime)
 {
-	DescriptorAllocateCheck();
+	if (lifetime == DescriptorLifetime::Persistent)
+	{
+		// Never freed, reserved range is sized for the resources living across frames
+		ASSERT(m_persistent_free_index < s_persistent_descriptor_count);
+		bindless_index = m_persistent_free_index++;
+	}
+	else
+	{
+		DescriptorAllocateCheck();
 
-	bindless_index = m_free_index;
+		bindless_index = m_free_index;
+		m_free_index = m_free_index + 1;
+		if (m_free_index == m_resources_descriptor_heap.m_number_descriptors)
+		{
+			m_free_index = s_persistent_descriptor_count;
+		}
+	}
 	cpu_descriptor = GetCPUDescriptorHandle(m_resources_descriptor_heap, bindless_index);
 	gpu_descriptor = GetGPUDescriptorHandle(m_resources_descriptor_heap, bindless_index);
-
-	m_free_index = (m_free_index + 1) % m_resources_descriptor_heap.m_number_descriptors;
 }
 
 UAV DXContext::CreateUAV
 (
 	const DXResource& resource,
-	const D3D12_UNORDERED_ACCESS_VIEW_DESC& desc
+	const D3D12_UNORDERED_ACCESS_VIEW_DESC& desc,
+	DescriptorLifetime lifetime
 )
 {
 	D3D12_CPU_DESCRIPTOR_HANDLE cpu_descriptor{};
 	D3D12_GPU_DESCRIPTOR_HANDLE gpu_descriptor{};
 	uint32 bindless_index{};
-	DescriptorAllocate(cpu_descriptor, gpu_descriptor, bindless_index);
+	DescriptorAllocate(cpu_descriptor, gpu_descriptor, bindless_index, lifetime);
 
 	UAV uav
 	{
@@ -945,12 +841,12 @@ UAV DXContext::CreateUAV
 	return uav;
 }
 
-SRV DXContext::CreateSRV(const DXResource& resource, const D3D12_SHADER_RESOURCE_VIEW_DESC& desc)
+SRV DXContext::CreateSRV(const DXResource& resource, const D3D12_SHADER_RESOURCE_VIEW_DESC& desc, DescriptorLifetime lifetime)
 {
 	D3D12_CPU_DESCRIPTOR_HANDLE cpu_descriptor{};
 	D3D12_GPU_DESCRIPTOR_HANDLE gpu_descriptor{};
 	uint32 bindless_index{};
-	DescriptorAllocate(cpu_descriptor, gpu_descriptor, bindless_index);
+	DescriptorAllocate(cpu_descriptor, gpu_descriptor, bindless_index, lifetime);
 
 	SRV srv
 	{
@@ -1105,7 +1001,7 @@ D3D12_UNORDERED_ACCESS_VIEW_DESC GetTypedBufferUAVDesc(DXGI_FORMAT format, uint3
 	};
 }
 
-D3D12_SHADER_RESOURCE_VIEW_DESC GetTexture2DSRVDesc(DXGI_FORMAT format)
+D3D12_SHADER_RESOURCE_VIEW_DESC GetTexture2DSRVDesc(DXGI_FORMAT format, uint32 most_detailed_mip, uint32 mip_levels)
 {
 	return
 	{
@@ -1114,15 +1010,15 @@ D3D12_SHADER_RESOURCE_VIEW_DESC GetTexture2DSRVDesc(DXGI_FORMAT format)
 		.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
 		.Texture2D =
 		{
-			.MostDetailedMip = 0,
-			.MipLevels = 1, 
+			.MostDetailedMip = most_detailed_mip,
+			.MipLevels = mip_levels,
 			.PlaneSlice = 0,
 			.ResourceMinLODClamp = 0,
 		},
 	};
 }
 
-D3D12_UNORDERED_ACCESS_VIEW_DESC GetTexture2DUAVDesc(DXGI_FORMAT format)
+D3D12_UNORDERED_ACCESS_VIEW_DESC GetTexture2DUAVDesc(DXGI_FORMAT format, uint32 mip_slice)
 {
 	return
 	{
@@ -1130,7 +1026,7 @@ D3D12_UNORDERED_ACCESS_VIEW_DESC GetTexture2DUAVDesc(DXGI_FORMAT format)
 		.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D,
 		.Texture2D =
 		{
-			.MipSlice = 0, 
+			.MipSlice = mip_slice,
 			.PlaneSlice = 0,
 		},
 	};
@@ -1,9 +1,12 @@
 #pragma once
 #include "../core/Common.h"
+#include "../core/FrameArena.h"
 #include "DXCommon.h"
 #include "DXResource.h"
 #include "RootSignature.h"
 #include "Shader.h"
+#include "DXPipelineCache.h"
+#include "DXCrashReport.h"
 
 struct IDXGIFactory6;
 struct IDXGIAdapter1;
@@ -59,6 +62,14 @@ private:
 	uint32 m_frame_index{ 0 };
 };
 
+// Transient descriptors live in the ring and are recycled once the frame that allocated them completed
+// Persistent descriptors are never recycled, meant for views captured by recorded bundles
+enum class DescriptorLifetime
+{
+	Transient,
+	Persistent
+};
+
 class DXDescriptor;
 using SRV = DXDescriptor;
 using UAV = DXDescriptor;
@@ -203,6 +214,9 @@ public:
 	ComPtr<ID3D12GraphicsCommandList> GetCommandListCopy() const;
 	ComPtr<IDXGIFactory> GetFactory() const;
 	CommandQueue GetCommandQueue() const;
+	CommandQueue GetCommandQueueCopy() const;
+	// CPU data of the frame recorded on the current backbuffer index, reset by InitCommandLists once the GPU is done with it
+	FrameArena& GetFrameArena();
 
 	void CreateDescriptorHeap
 	(
@@ -246,6 +260,8 @@ public:
 
 	void Signal(const CommandQueue& command_queue, Fence& fence, uint32 index);
 	void Wait(const Fence& fence, uint32 index);
+	// Non blocking, true once the GPU reached the value last signaled for the index
+	bool IsComplete(const Fence& fence, uint32 index) const;
 
 	RootSignature CreateRS(const Shader& shader) const;
 
@@ -293,20 +309,29 @@ public:
 	RTVDescriptorHandler m_rtv_descriptor_handler;
 	
 	void DescriptorAllocateCheck();
-	void DescriptorAllocate(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor, uint32& bindless_index);
-	UAV CreateUAV(const DXResource& resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC& desc);
-	SRV CreateSRV(const DXResource& resource, const D3D12_SHADER_RESOURCE_VIEW_DESC& desc);
+	void DescriptorAllocate(D3D12_CPU_DESCRIPTOR_HANDLE& cpu_descriptor, D3D12_GPU_DESCRIPTOR_HANDLE& gpu_descriptor, uint32& bindless_index, DescriptorLifetime lifetime = DescriptorLifetime::Transient);
+	UAV CreateUAV(const DXResource& resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC& desc, DescriptorLifetime lifetime = DescriptorLifetime::Transient);
+	SRV CreateSRV(const DXResource& resource, const D3D12_SHADER_RESOURCE_VIEW_DESC& desc, DescriptorLifetime lifetime = DescriptorLifetime::Transient);
 	CBV CreateCBV(const DXResource& resource);
 
 public:
 	std::vector<std::pair<uint64, uint32>> m_list_pair_fence_free_index;
+	// Start of the heap is reserved for persistent descriptors, the ring uses the remainder
+	static const uint32 s_persistent_descriptor_count = 256;
+	uint32 m_persistent_free_index = 0;
 	uint32 m_last_indices[g_backbuffer_count];
-	uint32 m_start_index = 0;
-	uint32 m_free_index = 0;
+	uint32 m_start_index = s_persistent_descriptor_count;
+	uint32 m_free_index = s_persistent_descriptor_count;
 	DescriptorHeap m_resources_descriptor_heap;
 	DescriptorHeap m_samplers_descriptor_heap;
 
 	ResourceHandler m_resource_handler;
+	FrameArena m_frame_arenas[g_backbuffer_count];
+
+	// Serialized on destruction
+	PipelineCache m_pipeline_cache;
+	// Written by the device removed callback
+	CrashReport m_crash_report;
 };
 
 inline D3D12_CPU_DESCRIPTOR_HANDLE operator+(D3D12_CPU_DESCRIPTOR_HANDLE x, uint32 y)
@@ -321,9 +346,10 @@ inline D3D12_CPU_DESCRIPTOR_HANDLE operator+(uint32 x, D3D12_CPU_DESCRIPTOR_HAND
 
 // Textures are always typed
 // Ex. Use in HLSL: Texture2D<float3> with ex. DXGI_FORMAT_R32G32B32_FLOAT
-D3D12_SHADER_RESOURCE_VIEW_DESC GetTexture2DSRVDesc(DXGI_FORMAT format);
+// Mips most_detailed_mip to most_detailed_mip + mip_levels - 1
+D3D12_SHADER_RESOURCE_VIEW_DESC GetTexture2DSRVDesc(DXGI_FORMAT format, uint32 most_detailed_mip = 0, uint32 mip_levels = 1);
 // Ex. Use in HLSL: RWTexture2D<unorm float> with ex. R8_UNORM / R16_UNORM
-D3D12_UNORDERED_ACCESS_VIEW_DESC GetTexture2DUAVDesc(DXGI_FORMAT format);
+D3D12_UNORDERED_ACCESS_VIEW_DESC GetTexture2DUAVDesc(DXGI_FORMAT format, uint32 mip_slice = 0);
 
 
 // Ex. Use in HLSL: Buffer<float3>
@@ -343,4 +369,4 @@ D3D12_UNORDERED_ACCESS_VIEW_DESC GetStructuredBufferUAVDesc(uint32 number_elemen
 D3D12_SHADER_RESOURCE_VIEW_DESC GetByteBufferSRVDesc(uint32 number_bytes);
 
 // Ex. RWByteAddressBuffer
-D3D12_UNORDERED_ACCESS_VIEW_DESC GetByteBufferUAVDesc(uint32 number_bytes);
+D3D12_UNORDERED_ACCESS_VIEW_DESC GetByteBufferUAVDesc(uint32 number_bytes);
\ No newline at end of file
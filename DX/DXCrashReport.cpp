@@ -0,0 +1,373 @@
+#include "DXCrashReport.h"
+#include "DXContext.h"
+
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+namespace
+{
+	// Operations listed on each side of the last completed one, command lists can hold thousands
+	const uint32 g_crash_report_operation_window = 64;
+}
+
+static const std::map<D3D12_AUTO_BREADCRUMB_OP, std::string> g_breadcrumb_operation_map_string =
+{
+	{ D3D12_AUTO_BREADCRUMB_OP_SETMARKER, "Set Marker" },
+	{ D3D12_AUTO_BREADCRUMB_OP_BEGINEVENT, "Begin Event" },
+	{ D3D12_AUTO_BREADCRUMB_OP_ENDEVENT, "End Event" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DRAWINSTANCED, "Draw Instanced" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DRAWINDEXEDINSTANCED, "Draw Indexed Instanced" },
+	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEINDIRECT, "Execute Indirect" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DISPATCH, "Dispatch" },
+	{ D3D12_AUTO_BREADCRUMB_OP_COPYBUFFERREGION, "Copy Buffer Region" },
+	{ D3D12_AUTO_BREADCRUMB_OP_COPYTEXTUREREGION, "Copy Texture Region" },
+	{ D3D12_AUTO_BREADCRUMB_OP_COPYRESOURCE, "Copy Resource" },
+	{ D3D12_AUTO_BREADCRUMB_OP_COPYTILES, "Copy Tiles" },
+	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVESUBRESOURCE, "Resolve SubResource" },
+	{ D3D12_AUTO_BREADCRUMB_OP_CLEARRENDERTARGETVIEW, "Clear RTV" },
+	{ D3D12_AUTO_BREADCRUMB_OP_CLEARUNORDEREDACCESSVIEW, "Clear UAV" },
+	{ D3D12_AUTO_BREADCRUMB_OP_CLEARDEPTHSTENCILVIEW, "Clear DSV" },
+	{ D3D12_AUTO_BREADCRUMB_OP_RESOURCEBARRIER, "Resource Barrier" },
+	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEBUNDLE, "Execute Bundle" },
+	{ D3D12_AUTO_BREADCRUMB_OP_PRESENT, "Present" },
+	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVEQUERYDATA, "Resolve Query Data" },
+	{ D3D12_AUTO_BREADCRUMB_OP_BEGINSUBMISSION, "Begin Submission" },
+	{ D3D12_AUTO_BREADCRUMB_OP_ENDSUBMISSION, "End Submission" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DECODEFRAME, "Decode Frame" },
+	{ D3D12_AUTO_BREADCRUMB_OP_PROCESSFRAMES, "Process Frames" },
+	{ D3D12_AUTO_BREADCRUMB_OP_ATOMICCOPYBUFFERUINT, "Atomic Copy Buffer uint" },
+	{ D3D12_AUTO_BREADCRUMB_OP_ATOMICCOPYBUFFERUINT64, "Atomic Copy Buffer uint64" },
+	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVESUBRESOURCEREGION, "Resolve Subresource Region" },
+	{ D3D12_AUTO_BREADCRUMB_OP_WRITEBUFFERIMMEDIATE, "Write Buffer Immediate" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DECODEFRAME1, "Decpde Frame 1" },
+	{ D3D12_AUTO_BREADCRUMB_OP_SETPROTECTEDRESOURCESESSION, "Set Protected Resource Session" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DECODEFRAME2, "Decode Frame 2" },
+	{ D3D12_AUTO_BREADCRUMB_OP_PROCESSFRAMES1, "Process Frames 1" },
+	{ D3D12_AUTO_BREADCRUMB_OP_BUILDRAYTRACINGACCELERATIONSTRUCTURE, "Build ACC" },
+	{ D3D12_AUTO_BREADCRUMB_OP_EMITRAYTRACINGACCELERATIONSTRUCTUREPOSTBUILDINFO, "Emit ACC PostBuild Info" },
+	{ D3D12_AUTO_BREADCRUMB_OP_COPYRAYTRACINGACCELERATIONSTRUCTURE, "Copy ACC" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DISPATCHRAYS, "Dispatch Rays" },
+	{ D3D12_AUTO_BREADCRUMB_OP_INITIALIZEMETACOMMAND, "Initialize Meta Command" },
+	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEMETACOMMAND, "Execute Meta Command" },
+	{ D3D12_AUTO_BREADCRUMB_OP_ESTIMATEMOTION, "Estimate Motion" },
+	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVEMOTIONVECTORHEAP	, "Resolve Motion Vector Heap" },
+	{ D3D12_AUTO_BREADCRUMB_OP_SETPIPELINESTATE1, "Set PSO1" },
+	{ D3D12_AUTO_BREADCRUMB_OP_INITIALIZEEXTENSIONCOMMAND, "Initialize Extension Command" },
+	{ D3D12_AUTO_BREADCRUMB_OP_EXECUTEEXTENSIONCOMMAND, "Execute Extension Command" },
+	{ D3D12_AUTO_BREADCRUMB_OP_DISPATCHMESH, "Dispatch Mesh" },
+	{ D3D12_AUTO_BREADCRUMB_OP_ENCODEFRAME, "Encode Frame" },
+	{ D3D12_AUTO_BREADCRUMB_OP_RESOLVEENCODEROUTPUTMETADATA, "Resolve Encoder Output Meta Data" },
+};
+
+std::string BreadCrumbOperationString(D3D12_AUTO_BREADCRUMB_OP operation)
+{
+	auto iterator = g_breadcrumb_operation_map_string.find(operation);
+	if (iterator != g_breadcrumb_operation_map_string.cend())
+	{
+		return iterator->second;
+	}
+	// Newer runtimes add operations, the report must not fail on them
+	return std::format("Unknown Operation {0}", static_cast<uint32>(operation));
+}
+
+static const std::map<D3D12_DRED_ALLOCATION_TYPE, std::string> g_dred_allocation_type_map_string =
+{
+	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_QUEUE, "Command Queue" },
+	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_ALLOCATOR, "Command Allocator" },
+	{D3D12_DRED_ALLOCATION_TYPE_PIPELINE_STATE, "PSO" },
+	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_LIST, "Command List" },
+	{D3D12_DRED_ALLOCATION_TYPE_FENCE, "Fence" },
+	{D3D12_DRED_ALLOCATION_TYPE_DESCRIPTOR_HEAP, "Descriptor Heap" },
+	{D3D12_DRED_ALLOCATION_TYPE_HEAP, "Heap" },
+	{D3D12_DRED_ALLOCATION_TYPE_QUERY_HEAP, "Query Heap" },
+	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_SIGNATURE, "Command Signature" },
+	{D3D12_DRED_ALLOCATION_TYPE_PIPELINE_LIBRARY, "PSO Library" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_DECODER, "Video Decoder" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_PROCESSOR, "Video Processor" },
+	{D3D12_DRED_ALLOCATION_TYPE_RESOURCE, "Resource" },
+	{D3D12_DRED_ALLOCATION_TYPE_PASS, "Pass" },
+	{D3D12_DRED_ALLOCATION_TYPE_CRYPTOSESSION, "Crypto Session" },
+	{D3D12_DRED_ALLOCATION_TYPE_CRYPTOSESSIONPOLICY, "Crypto Session Policy" },
+	{D3D12_DRED_ALLOCATION_TYPE_PROTECTEDRESOURCESESSION, "Protected Resource Session" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_DECODER_HEAP, "Video Decode Heap" },
+	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_POOL, "Command Pool" },
+	{D3D12_DRED_ALLOCATION_TYPE_COMMAND_RECORDER, "Command Recorder" },
+	{D3D12_DRED_ALLOCATION_TYPE_STATE_OBJECT, "SO" },
+	{D3D12_DRED_ALLOCATION_TYPE_METACOMMAND, "Meta Command" },
+	{D3D12_DRED_ALLOCATION_TYPE_SCHEDULINGGROUP, "Scheduling Group" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_MOTION_ESTIMATOR, "Video Motion Estimator" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_MOTION_VECTOR_HEAP, "Video Motion Vector Heap" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_EXTENSION_COMMAND, "Video Extension Command" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_ENCODER, "Video Encoder" },
+	{D3D12_DRED_ALLOCATION_TYPE_VIDEO_ENCODER_HEAP, "Video Encoder Heap" },
+	{D3D12_DRED_ALLOCATION_TYPE_INVALID, "Invalid" },
+};
+
+std::string AllocationTypeString(D3D12_DRED_ALLOCATION_TYPE type)
+{
+	auto iterator = g_dred_allocation_type_map_string.find(type);
+	if (iterator != g_dred_allocation_type_map_string.cend())
+	{
+		return iterator->second;
+	}
+	return std::format("Unknown Allocation Type {0}", static_cast<uint32>(type));
+}
+
+namespace
+{
+	// Debug names are only set in debug builds, nodes of unnamed objects have null names
+	std::string DebugName(const char* name)
+	{
+		return name != nullptr ? std::string(name) : std::string("Unnamed");
+	}
+
+	std::string JsonString(std::string_view string)
+	{
+		std::string output = "\"";
+		for (char c : string)
+		{
+			switch (c)
+			{
+			case '"': output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\n': output += "\\n"; break;
+			case '\r': output += "\\r"; break;
+			case '\t': output += "\\t"; break;
+			default:
+				if ((uint8)c < 0x20)
+				{
+					output += std::format("\\u{0:04x}", (uint32)(uint8)c);
+				}
+				else
+				{
+					output += c;
+				}
+				break;
+			}
+		}
+		output += "\"";
+		return output;
+	}
+
+	// Breadcrumb value is the number of operations completed, it equals the count once the list finished
+	bool IsBreadCrumbNodeIncomplete(const D3D12_AUTO_BREADCRUMB_NODE* node)
+	{
+		return node->pLastBreadcrumbValue != nullptr && *node->pLastBreadcrumbValue < node->BreadcrumbCount;
+	}
+
+	void WriteBreadCrumbs(std::ostream& stream, const D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT& bread_crumb)
+	{
+		stream << "\t\"breadcrumbs\": [";
+		bool is_first_node = true;
+		for (const D3D12_AUTO_BREADCRUMB_NODE* node = bread_crumb.pHeadAutoBreadcrumbNode; node != nullptr; node = node->pNext)
+		{
+			const uint32 completed_count = node->pLastBreadcrumbValue != nullptr ? *node->pLastBreadcrumbValue : 0;
+			stream << (is_first_node ? "\n" : ",\n");
+			is_first_node = false;
+			stream << "\t\t{\n";
+			stream << "\t\t\t\"command_list\": " << JsonString(DebugName(node->pCommandListDebugNameA)) << ",\n";
+			stream << "\t\t\t\"command_queue\": " << JsonString(DebugName(node->pCommandQueueDebugNameA)) << ",\n";
+			stream << "\t\t\t\"operation_count\": " << node->BreadcrumbCount << ",\n";
+			// -1 when nothing completed, the operation after it is the one the GPU stopped on
+			stream << "\t\t\t\"last_completed_operation_index\": " << (int64)completed_count - 1 << ",\n";
+			stream << "\t\t\t\"is_complete\": " << (IsBreadCrumbNodeIncomplete(node) ? "false" : "true") << ",\n";
+			// Window around the first operation that did not complete
+			const uint32 first = completed_count > g_crash_report_operation_window ? completed_count - g_crash_report_operation_window : 0;
+			const uint32 last = (std::min)(completed_count + g_crash_report_operation_window, node->BreadcrumbCount);
+			stream << "\t\t\t\"first_operation_index\": " << first << ",\n";
+			stream << "\t\t\t\"operations\": [";
+			for (uint32 i = first; i < last; ++i)
+			{
+				stream << (i == first ? "" : ", ") << JsonString(BreadCrumbOperationString(node->pCommandHistory[i]));
+			}
+			stream << "]\n";
+			stream << "\t\t}";
+		}
+		stream << "\n\t],\n";
+	}
+
+	void WriteAllocations(std::ostream& stream, const char* name, const D3D12_DRED_ALLOCATION_NODE* node)
+	{
+		stream << "\t\t\"" << name << "\": [";
+		for (bool is_first = true; node != nullptr; node = node->pNext, is_first = false)
+		{
+			stream << (is_first ? "\n" : ",\n");
+			stream << "\t\t\t{ \"name\": " << JsonString(DebugName(node->ObjectNameA)) << ", \"type\": " << JsonString(AllocationTypeString(node->AllocationType)) << " }";
+		}
+		stream << "\n\t\t]";
+	}
+
+	void WritePageFault(std::ostream& stream, const D3D12_DRED_PAGE_FAULT_OUTPUT& page_fault)
+	{
+		stream << "\t\"page_fault\": {\n";
+		stream << "\t\t\"address\": " << JsonString(std::format("0x{0:016x}", page_fault.PageFaultVA)) << ",\n";
+		WriteAllocations(stream, "active_allocations", page_fault.pHeadExistingAllocationNode);
+		stream << ",\n";
+		WriteAllocations(stream, "freed_allocations", page_fault.pHeadRecentFreedAllocationNode);
+		stream << "\n\t},\n";
+	}
+}
+
+std::string BreadCrumbToString(const D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT& bread_crumb)
+{
+	std::string output{};
+	for (const D3D12_AUTO_BREADCRUMB_NODE* node = bread_crumb.pHeadAutoBreadcrumbNode; node != nullptr; node = node->pNext)
+	{
+		if (IsBreadCrumbNodeIncomplete(node))
+		{
+			const uint32 index = *node->pLastBreadcrumbValue;
+			output += std::format
+			(
+				"Command List {0}, on Command Queue {1}, Operation {2} {3} of {4}\n",
+				DebugName(node->pCommandListDebugNameA), DebugName(node->pCommandQueueDebugNameA),
+				index, BreadCrumbOperationString(node->pCommandHistory[index]), node->BreadcrumbCount
+			);
+		}
+	}
+	return output;
+}
+
+std::string AllocationNodeString(const D3D12_DRED_ALLOCATION_NODE* node)
+{
+	std::string output{};
+	for (; node != nullptr; node = node->pNext)
+	{
+		output += std::format("{0} {1}\n", AllocationTypeString(node->AllocationType), DebugName(node->ObjectNameA));
+	}
+	return output;
+}
+
+std::string PageFaultToString(const D3D12_DRED_PAGE_FAULT_OUTPUT& page_fault)
+{
+	std::string output{};
+	output += std::format("Page Fault at 0x{0:016x}\n", page_fault.PageFaultVA);
+	output += "Active Allocations:\n";
+	output += AllocationNodeString(page_fault.pHeadExistingAllocationNode);
+	output += "Freed Allocations:\n";
+	output += AllocationNodeString(page_fault.pHeadRecentFreedAllocationNode);
+	return output;
+}
+
+void CrashReport::Init(DXContext& dx_context, const std::string& directory)
+{
+	m_directory = directory;
+	// Readback heap stays in COPY_DEST, the state WriteBufferImmediate requires
+	m_marker_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, g_crash_report_max_passes * 2 * sizeof(uint32));
+	m_marker_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+	m_marker_buffer.CreateResource(dx_context, "Crash Report Pass Markers");
+	void* markers = nullptr;
+	m_marker_buffer.m_resource->Map(0, nullptr, &markers) >> CHK;
+	memset(markers, 0, g_crash_report_max_passes * 2 * sizeof(uint32));
+	m_markers = static_cast<const uint32*>(markers);
+}
+
+void CrashReport::SetPassNames(const std::vector<std::string>& pass_names)
+{
+	std::scoped_lock lock(m_mutex);
+	m_pass_names = pass_names;
+}
+
+void CrashReport::MarkPassBegin(ID3D12GraphicsCommandList2* command_list, uint32 pass) const
+{
+	MarkPass(command_list, pass, 0, D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN);
+}
+
+void CrashReport::MarkPassEnd(ID3D12GraphicsCommandList2* command_list, uint32 pass) const
+{
+	MarkPass(command_list, pass, 1, D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT);
+}
+
+void CrashReport::MarkPass(ID3D12GraphicsCommandList2* command_list, uint32 pass, uint32 slot, D3D12_WRITEBUFFERIMMEDIATE_MODE mode) const
+{
+	if (m_markers == nullptr || pass >= g_crash_report_max_passes)
+	{
+		return;
+	}
+	const D3D12_WRITEBUFFERIMMEDIATE_PARAMETER parameter
+	{
+		.Dest = m_marker_buffer.m_resource->GetGPUVirtualAddress() + (pass * 2 + slot) * sizeof(uint32),
+		.Value = m_frame_serial.load(std::memory_order_relaxed),
+	};
+	command_list->WriteBufferImmediate(1, &parameter, &mode);
+}
+
+void CrashReport::EndFrame(float64 cpu_milliseconds, const std::vector<float64>& gpu_milliseconds)
+{
+	std::scoped_lock lock(m_mutex);
+	if (m_frames.size() < g_crash_report_frame_count)
+	{
+		m_frames.emplace_back();
+	}
+	FrameTiming& timing = m_frames[m_frame_cursor];
+	timing.m_frame = m_frame_serial.fetch_add(1, std::memory_order_relaxed);
+	timing.m_cpu_milliseconds = cpu_milliseconds;
+	timing.m_gpu_milliseconds = gpu_milliseconds;
+	m_frame_cursor = (m_frame_cursor + 1) % g_crash_report_frame_count;
+}
+
+std::string CrashReport::Write(ID3D12Device* device, HRESULT removed_reason)
+{
+	std::error_code error_code{};
+	std::filesystem::create_directories(m_directory, error_code);
+	const uint64 timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	const std::string path = (std::filesystem::path(m_directory) / std::format("crash_{0}.json", timestamp)).string();
+	std::ofstream stream(path);
+	if (!stream)
+	{
+		return {};
+	}
+
+	stream << "{\n";
+	stream << "\t\"reason\": " << JsonString(RemapHResult(removed_reason)) << ",\n";
+	stream << "\t\"frame\": " << m_frame_serial.load(std::memory_order_relaxed) << ",\n";
+
+	// Only available when DRED was enabled before the device was created
+	ComPtr<ID3D12DeviceRemovedExtendedData> dred{};
+	D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT breadcrumbs_output{};
+	D3D12_DRED_PAGE_FAULT_OUTPUT page_fault_output{};
+	const bool has_dred = SUCCEEDED(device->QueryInterface(IID_PPV_ARGS(&dred)));
+	if (has_dred && SUCCEEDED(dred->GetAutoBreadcrumbsOutput(&breadcrumbs_output)))
+	{
+		WriteBreadCrumbs(stream, breadcrumbs_output);
+	}
+	if (has_dred && SUCCEEDED(dred->GetPageFaultAllocationOutput(&page_fault_output)))
+	{
+		WritePageFault(stream, page_fault_output);
+	}
+
+	std::scoped_lock lock(m_mutex);
+	// Passes begun but not ended are the ones the GPU was running
+	stream << "\t\"passes\": [";
+	for (uint32 pass = 0; pass < (std::min)((uint32)m_pass_names.size(), g_crash_report_max_passes); ++pass)
+	{
+		const uint32 begin_frame = m_markers != nullptr ? m_markers[pass * 2 + 0] : 0;
+		const uint32 end_frame = m_markers != nullptr ? m_markers[pass * 2 + 1] : 0;
+		stream << (pass == 0 ? "\n" : ",\n");
+		stream << std::format
+		(
+			"\t\t{{ \"name\": {0}, \"last_begun_frame\": {1}, \"last_ended_frame\": {2}, \"is_in_flight\": {3} }}",
+			JsonString(m_pass_names[pass]), begin_frame, end_frame, begin_frame > end_frame ? "true" : "false"
+		);
+	}
+	stream << "\n\t],\n";
+
+	// Oldest first
+	stream << "\t\"frames\": [";
+	for (uint32 i = 0; i < m_frames.size(); ++i)
+	{
+		const FrameTiming& timing = m_frames[(m_frame_cursor + i) % m_frames.size()];
+		stream << (i == 0 ? "\n" : ",\n");
+		stream << std::format("\t\t{{ \"frame\": {0}, \"cpu_ms\": {1:.3f}, \"gpu_ms\": {{", timing.m_frame, timing.m_cpu_milliseconds);
+		for (uint32 pass = 0; pass < timing.m_gpu_milliseconds.size(); ++pass)
+		{
+			const std::string name = pass < m_pass_names.size() ? m_pass_names[pass] : std::to_string(pass);
+			stream << std::format("{0} {1}: {2:.3f}", pass == 0 ? "" : ",", JsonString(name), timing.m_gpu_milliseconds[pass]);
+		}
+		stream << " } }";
+	}
+	stream << "\n\t]\n";
+	stream << "}\n";
+	return stream ? path : std::string{};
+}
\ No newline at end of file
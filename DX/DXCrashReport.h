@@ -0,0 +1,57 @@
+#pragma once
+#include "../core/Common.h"
+#include "DXCommon.h"
+#include "DXResource.h"
+#include <atomic>
+#include <mutex>
+
+class DXContext;
+
+// Passes with a GPU marker, scopes past it are not tracked
+static const uint32 g_crash_report_max_passes = 64;
+// Frames of timings kept for the report
+static const uint32 g_crash_report_frame_count = 120;
+
+// Report written when the device is removed, for offline triage of TDRs from other machines
+// JSON with the removal reason, DRED breadcrumbs and page fault, our pass markers and the timings of the last frames
+// Pass markers are written by the GPU into a readback buffer mapped for the whole run, the CPU copy survives the removal
+class CrashReport
+{
+public:
+	void Init(DXContext& dx_context, const std::string& directory);
+
+	void SetPassNames(const std::vector<std::string>& pass_names);
+	// Begin is written when the GPU starts the pass, end once all work before it completed
+	void MarkPassBegin(ID3D12GraphicsCommandList2* command_list, uint32 pass) const;
+	void MarkPassEnd(ID3D12GraphicsCommandList2* command_list, uint32 pass) const;
+	// Once per submitted frame, the markers of the next frame carry the next serial
+	void EndFrame(float64 cpu_milliseconds, const std::vector<float64>& gpu_milliseconds);
+
+	// From the device removed callback, returns the file written or an empty string
+	std::string Write(ID3D12Device* device, HRESULT removed_reason);
+private:
+	struct FrameTiming
+	{
+		uint32 m_frame = 0;
+		float64 m_cpu_milliseconds = 0.0;
+		std::vector<float64> m_gpu_milliseconds;
+	};
+
+	void MarkPass(ID3D12GraphicsCommandList2* command_list, uint32 pass, uint32 slot, D3D12_WRITEBUFFERIMMEDIATE_MODE mode) const;
+
+	DXResource m_marker_buffer;
+	// Begin and end frame serial per pass, 0 when never reached
+	const uint32* m_markers = nullptr;
+	std::atomic<uint32> m_frame_serial = 1;
+	std::string m_directory;
+
+	// Written by the render thread, read by the device removed callback
+	std::mutex m_mutex;
+	std::vector<std::string> m_pass_names;
+	std::vector<FrameTiming> m_frames;
+	uint32 m_frame_cursor = 0;
+};
+
+// Human readable summaries for the log
+std::string BreadCrumbToString(const D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT& bread_crumb);
+std::string PageFaultToString(const D3D12_DRED_PAGE_FAULT_OUTPUT& page_fault);
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "DXHotReload.h"
+#include "DXCompiler.h"
+#include "DXContext.h"
+#include "DXIncludeHandler.h"
+
+static const std::chrono::milliseconds g_settle_duration(100);
+
+ShaderHotReload::ShaderHotReload(DXContext& dx_context, const DXCompiler& dx_compiler, const std::string& directory) :
+	m_dx_context(dx_context),
+	m_dx_compiler(dx_compiler)
+{
+	m_file_watcher.Init(directory);
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+	// Build functions reference resources owned by the caller
+	for (std::unique_ptr<Entry>& entry : m_entries)
+	{
+		if (entry->m_pending.valid())
+		{
+			entry->m_pending.wait();
+		}
+	}
+}
+
+void ShaderHotReload::Register(const std::string& name, const std::vector<Shader>& shaders, PipelineBuildFunction build, PipelineApplyFunction apply)
+{
+	std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+	entry->m_name = name;
+	for (const Shader& shader : shaders)
+	{
+		entry->m_shader_descs.push_back(shader.m_shader_desc);
+	}
+	entry->m_build = std::move(build);
+	entry->m_apply = std::move(apply);
+	UpdateDependencies(*entry, shaders, true);
+	m_entries.push_back(std::move(entry));
+}
+
+void ShaderHotReload::UpdateDependencies(Entry& entry, const std::vector<Shader>& shaders, bool replace)
+{
+	// Includes can be added or removed by the edit
+	if (replace)
+	{
+		entry.m_dependencies.clear();
+	}
+	for (const Shader& shader : shaders)
+	{
+		entry.m_dependencies.insert(shader.m_dependencies.begin(), shader.m_dependencies.end());
+	}
+}
+
+void ShaderHotReload::Schedule(Entry& entry)
+{
+	if (entry.m_pending.valid())
+	{
+		entry.m_dirty = true;
+		return;
+	}
+	LOG_TRACE(Compiler, "Hot reload of {0} scheduled", entry.m_name);
+	entry.m_dirty = false;
+	entry.m_pending = m_thread_pool.Async
+	(
+		[this, shader_descs = entry.m_shader_descs, build = entry.m_build](uint32 worker_index)
+		{
+			UNUSED(worker_index);
+			ReloadResult result{ .m_pipeline = {}, .m_success = true };
+			result.m_pipeline.m_shaders = m_dx_compiler.Compile(m_dx_context.GetDevice(), shader_descs);
+			for (const Shader& shader : result.m_pipeline.m_shaders)
+			{
+				result.m_success &= shader.m_blob != nullptr;
+			}
+			result.m_success = result.m_success && build(m_dx_context, result.m_pipeline);
+			return result;
+		}
+	);
+}
+
+void ShaderHotReload::Update()
+{
+	for (const std::string& changed_file : m_file_watcher.Poll())
+	{
+		m_changed_files.insert(NormalizeShaderPath(changed_file));
+		m_last_change_time = std::chrono::steady_clock::now();
+	}
+	if (!m_changed_files.empty() && std::chrono::steady_clock::now() - m_last_change_time > g_settle_duration)
+	{
+		for (std::unique_ptr<Entry>& entry : m_entries)
+		{
+			for (const std::string& changed_file : m_changed_files)
+			{
+				if (entry->m_dependencies.contains(changed_file))
+				{
+					Schedule(*entry);
+					break;
+				}
+			}
+		}
+		m_changed_files.clear();
+	}
+
+	// Frame boundary, nothing recorded yet this frame references the current pipelines
+	for (std::unique_ptr<Entry>& entry : m_entries)
+	{
+		if (!entry->m_pending.valid() || entry->m_pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			continue;
+		}
+		ReloadResult result = entry->m_pending.get();
+		// Failed compilation can stop before reaching some includes, keep the previous ones as well
+		UpdateDependencies(*entry, result.m_pipeline.m_shaders, result.m_success);
+		if (result.m_success)
+		{
+			entry->m_apply(result.m_pipeline);
+			// In flight frames can still use the old pipeline
+			m_retired_pipelines.push_back({ .m_pipeline = std::move(result.m_pipeline), .m_fence_value = m_dx_context.m_fence.m_value });
+			LOG_INFO(Compiler, "Hot reload of {0} succeeded", entry->m_name);
+		}
+		else
+		{
+			LOG_ERROR(Compiler, "Hot reload of {0} failed, keeping previous version", entry->m_name);
+		}
+		if (entry->m_dirty)
+		{
+			Schedule(*entry);
+		}
+	}
+
+	const uint64 completed_fence_value = m_dx_context.m_fence.m_gpu->GetCompletedValue();
+	std::erase_if(m_retired_pipelines, [completed_fence_value](const RetiredPipeline& retired) { return retired.m_fence_value <= completed_fence_value; });
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+#include "../core/Common.h"
+#include "../core/FileWatcher.h"
+#include "../core/ThreadPool.h"
+#include "Shader.h"
+#include "RootSignature.h"
+#include "PSO.h"
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <set>
+
+class DXContext;
+class DXCompiler;
+
+// Shaders of a pass and everything derived from them
+struct ShaderPipeline
+{
+	std::vector<Shader> m_shaders;
+	RootSignature m_root_signature;
+	PSO m_pso;
+};
+
+// Off-thread, creates root signature and state object from the recompiled shaders, false keeps the previous version
+using PipelineBuildFunction = std::function<bool(DXContext& dx_context, ShaderPipeline& pipeline)>;
+// Main thread at a frame boundary, swaps the new pipeline in and leaves the old one in pipeline to be retired
+using PipelineApplyFunction = std::function<void(ShaderPipeline& pipeline)>;
+
+// Watches the shader directory and rebuilds the pipelines depending on a modified file
+// Dependencies come from the include handler, editing Common.hlsl rebuilds exactly its users
+class ShaderHotReload
+{
+public:
+	ShaderHotReload(DXContext& dx_context, const DXCompiler& dx_compiler, const std::string& directory);
+	~ShaderHotReload();
+
+	// Shaders are the initial version, their dependencies seed the graph
+	void Register(const std::string& name, const std::vector<Shader>& shaders, PipelineBuildFunction build, PipelineApplyFunction apply);
+
+	// Call once per frame after InitCommandLists
+	// Schedules rebuilds of modified pipelines, swaps in finished ones and releases retired ones
+	void Update();
+private:
+	struct ReloadResult
+	{
+		ShaderPipeline m_pipeline;
+		bool m_success;
+	};
+
+	struct Entry
+	{
+		std::string m_name;
+		std::vector<ShaderDesc> m_shader_descs;
+		std::set<std::string> m_dependencies;
+		PipelineBuildFunction m_build;
+		PipelineApplyFunction m_apply;
+		std::future<ReloadResult> m_pending;
+		// Modified again while a rebuild was running
+		bool m_dirty = false;
+	};
+
+	struct RetiredPipeline
+	{
+		ShaderPipeline m_pipeline;
+		// Last fence value signaled when swapped out, released once completed
+		uint64 m_fence_value;
+	};
+
+	void Schedule(Entry& entry);
+	void UpdateDependencies(Entry& entry, const std::vector<Shader>& shaders, bool replace);
+
+	DXContext& m_dx_context;
+	const DXCompiler& m_dx_compiler;
+	FileWatcher m_file_watcher;
+	std::vector<std::unique_ptr<Entry>> m_entries;
+	std::vector<RetiredPipeline> m_retired_pipelines;
+
+	// Editors write files in several steps, changes are handled once the directory settled
+	std::set<std::string> m_changed_files;
+	std::chrono::steady_clock::time_point m_last_change_time;
+
+	// Compiles through the job system then builds the pipeline, blocking work kept off the compiler workers
+	ThreadPool m_thread_pool{ 1 };
+};
\ No newline at end of file
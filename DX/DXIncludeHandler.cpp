@@ -0,0 +1,47 @@
+#include "DXIncludeHandler.h"
+#include "DXCommon.h"
+#include <filesystem>
+
+std::string NormalizeShaderPath(const std::string& path)
+{
+	std::error_code error_code{};
+	std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, error_code);
+	if (error_code)
+	{
+		canonical_path = std::filesystem::path(path).lexically_normal();
+	}
+	// File system is case insensitive
+	std::string normalized_path = canonical_path.generic_string();
+	std::transform(normalized_path.begin(), normalized_path.end(), normalized_path.begin(), [](char c) { return (char)tolower(c); });
+	return normalized_path;
+}
+
+DXIncludeHandler::DXIncludeHandler(ComPtr<IDxcUtils> utils)
+{
+	utils->CreateDefaultIncludeHandler(&m_default_include_handler) >> CHK;
+}
+
+HRESULT STDMETHODCALLTYPE DXIncludeHandler::LoadSource(LPCWSTR filename, IDxcBlob** include_source)
+{
+	// DXC probes every include directory, only the successful one is a dependency
+	HRESULT result = m_default_include_handler->LoadSource(filename, include_source);
+	if (SUCCEEDED(result) && *include_source != nullptr)
+	{
+		const std::string included_file = NormalizeShaderPath(std::to_string(std::wstring(filename)));
+		if (std::find(m_included_files.begin(), m_included_files.end(), included_file) == m_included_files.end())
+		{
+			m_included_files.push_back(included_file);
+		}
+	}
+	return result;
+}
+
+void DXIncludeHandler::ResetIncludedFiles()
+{
+	m_included_files.clear();
+}
+
+const std::vector<std::string>& DXIncludeHandler::GetIncludedFiles() const
+{
+	return m_included_files;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include "../core/Common.h"
+#include <dxcapi.h>
+#include <wrl/implements.h>
+
+// Canonical form of a shader file path to compare includes and file watcher events
+std::string NormalizeShaderPath(const std::string& path);
+
+// Forwards to the default DXC include handler and records every file it successfully loaded
+// Feeds the include dependency graph of shader hot reload
+class DXIncludeHandler : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IDxcIncludeHandler>
+{
+public:
+	DXIncludeHandler(ComPtr<IDxcUtils> utils);
+
+	HRESULT STDMETHODCALLTYPE LoadSource(LPCWSTR filename, IDxcBlob** include_source) override;
+
+	void ResetIncludedFiles();
+	// Normalized paths, in include order, without duplicates
+	const std::vector<std::string>& GetIncludedFiles() const;
+private:
+	ComPtr<IDxcIncludeHandler> m_default_include_handler;
+	std::vector<std::string> m_included_files;
+};
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "DXPipelineCache.h"
+#include "DXQuery.h"
+#include <filesystem>
+#include <fstream>
+#include <format>
+
+// Bump when PipelineCacheHeader changes
+// "DXPL"
+static const uint32 g_pipeline_cache_magic = 0x4C505844;
+static const uint32 g_pipeline_cache_version = 1;
+
+// Library blobs are only valid for the exact adapter and driver that serialized them
+struct PipelineCacheHeader
+{
+	uint32 m_magic;
+	uint32 m_version;
+	uint32 m_vendor_id;
+	uint32 m_device_id;
+	uint32 m_subsys_id;
+	uint32 m_revision;
+	int64 m_driver_version;
+	uint64 m_library_size;
+};
+
+void PipelineCache::Init(ComPtr<ID3D12Device14> device, ComPtr<IDXGIAdapter4> adapter, const std::string& path)
+{
+	m_device = device;
+	m_path = path;
+
+	DXGI_ADAPTER_DESC adapter_desc = GetAdapterDesc(adapter);
+	m_vendor_id = adapter_desc.VendorId;
+	m_device_id = adapter_desc.DeviceId;
+	m_subsys_id = adapter_desc.SubSysId;
+	m_revision = adapter_desc.Revision;
+	// User mode driver version
+	LARGE_INTEGER driver_version{};
+	if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driver_version)))
+	{
+		m_driver_version = driver_version.QuadPart;
+	}
+
+	std::vector<uint8> library_data;
+	ReadLibraryFile(library_data);
+	CreateLibrary(library_data);
+}
+
+bool PipelineCache::ReadLibraryFile(std::vector<uint8>& out_library_data) const
+{
+	std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	const uint64 file_size = (uint64)file.tellg();
+	PipelineCacheHeader header{};
+	if (file_size < sizeof(PipelineCacheHeader))
+	{
+		return false;
+	}
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(PipelineCacheHeader));
+	if (header.m_magic != g_pipeline_cache_magic || header.m_version != g_pipeline_cache_version || header.m_library_size != file_size - sizeof(PipelineCacheHeader))
+	{
+		LOG_WARNING(Compiler, "Pipeline cache {0} is invalid, starting empty", m_path);
+		return false;
+	}
+	if 
+	(
+		header.m_vendor_id != m_vendor_id || header.m_device_id != m_device_id || header.m_subsys_id != m_subsys_id || 
+		header.m_revision != m_revision || header.m_driver_version != m_driver_version
+	)
+	{
+		LOG_WARNING(Compiler, "Pipeline cache {0} was written by another adapter or driver, starting empty", m_path);
+		return false;
+	}
+	out_library_data.resize(header.m_library_size);
+	file.read(reinterpret_cast<char*>(out_library_data.data()), header.m_library_size);
+	return file.good();
+}
+
+void PipelineCache::CreateLibrary(const std::vector<uint8>& library_data)
+{
+	// Released before the blob it references is replaced
+	m_library.Reset();
+	m_library_data = library_data;
+	HRESULT result = E_FAIL;
+	if (!m_library_data.empty())
+	{
+		result = m_device->CreatePipelineLibrary(m_library_data.data(), m_library_data.size(), IID_PPV_ARGS(&m_library));
+		if (FAILED(result))
+		{
+			// D3D12_ERROR_DRIVER_VERSION_MISMATCH, D3D12_ERROR_ADAPTER_NOT_FOUND or E_INVALIDARG on a corrupted blob
+			LOG_WARNING(Compiler, "Pipeline cache {0} rejected by the driver: {1}, starting empty", m_path, RemapHResult(result));
+			m_library_data.clear();
+		}
+		else
+		{
+			LOG_TRACE(Compiler, "Pipeline cache {0} loaded: {1} bytes", m_path, m_library_data.size());
+		}
+	}
+	if (FAILED(result))
+	{
+		result = m_device->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library));
+	}
+	if (FAILED(result))
+	{
+		// DXGI_ERROR_UNSUPPORTED when the driver has no library support, pipelines are created uncached
+		LOG_WARNING(Compiler, "Pipeline library unsupported: {0}", RemapHResult(result));
+		m_library.Reset();
+		return;
+	}
+	NAME_DX_OBJECT(m_library, "Pipeline Library");
+}
+
+HRESULT PipelineCache::CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC& stream_desc, uint64 key, ComPtr<ID3D12PipelineState>& out_pipeline_state)
+{
+	if (!m_library)
+	{
+		return m_device->CreatePipelineState(&stream_desc, IID_PPV_ARGS(&out_pipeline_state));
+	}
+
+	const std::wstring name = std::to_wstring(std::format("{0:016x}", key));
+	// E_INVALIDARG when the name is missing or stored with a different description
+	HRESULT result = m_library->LoadPipeline(name.c_str(), &stream_desc, IID_PPV_ARGS(&out_pipeline_state));
+	if (SUCCEEDED(result))
+	{
+		++m_hit_count;
+		return result;
+	}
+
+	++m_miss_count;
+	result = m_device->CreatePipelineState(&stream_desc, IID_PPV_ARGS(&out_pipeline_state));
+	if (FAILED(result))
+	{
+		return result;
+	}
+	// Concurrent store of the same key fails with E_INVALIDARG, the first one wins
+	if (SUCCEEDED(m_library->StorePipeline(name.c_str(), out_pipeline_state.Get())))
+	{
+		m_dirty = true;
+	}
+	return result;
+}
+
+void PipelineCache::Serialize()
+{
+	if (!m_library || !m_dirty)
+	{
+		return;
+	}
+	m_dirty = false;
+
+	std::vector<uint8> library_data(m_library->GetSerializedSize());
+	HRESULT result = m_library->Serialize(library_data.data(), library_data.size());
+	if (FAILED(result))
+	{
+		LOG_ERROR(Compiler, "Failed to serialize pipeline cache {0}: {1}", m_path, RemapHResult(result));
+		return;
+	}
+
+	const std::filesystem::path directory = std::filesystem::path(m_path).parent_path();
+	if (!directory.empty() && !std::filesystem::exists(directory))
+	{
+		std::filesystem::create_directories(directory);
+	}
+	PipelineCacheHeader header
+	{
+		.m_magic = g_pipeline_cache_magic,
+		.m_version = g_pipeline_cache_version,
+		.m_vendor_id = m_vendor_id,
+		.m_device_id = m_device_id,
+		.m_subsys_id = m_subsys_id,
+		.m_revision = m_revision,
+		.m_driver_version = m_driver_version,
+		.m_library_size = library_data.size(),
+	};
+	// Written aside then renamed, a crash mid-write leaves the previous cache intact
+	const std::string temp_path = m_path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(PipelineCacheHeader));
+		file.write(reinterpret_cast<const char*>(library_data.data()), library_data.size());
+		if (!file.good())
+		{
+			LOG_ERROR(Compiler, "Failed to write pipeline cache {0}", temp_path);
+			return;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temp_path, m_path, error);
+	if (error)
+	{
+		LOG_ERROR(Compiler, "Failed to replace pipeline cache {0}: {1}", m_path, error.message());
+		return;
+	}
+	LOG_TRACE(Compiler, "Pipeline cache {0} written: {1} bytes, {2} hits, {3} misses", m_path, library_data.size(), m_hit_count.load(), m_miss_count.load());
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include "../core/Common.h"
+#include "DXCommon.h"
+#include <atomic>
+
+struct ID3D12Device14;
+struct IDXGIAdapter4;
+struct ID3D12PipelineLibrary1;
+struct ID3D12PipelineState;
+
+// Pipeline states stored in an ID3D12PipelineLibrary1, serialized to a single file on shutdown
+// Only classic pipeline states can live in a library, state objects (generic programs, work graphs) bypass it
+// File is discarded when the adapter or driver changed, driver rejecting the blob falls back to an empty library
+class PipelineCache
+{
+public:
+	void Init(ComPtr<ID3D12Device14> device, ComPtr<IDXGIAdapter4> adapter, const std::string& path);
+
+	// Loads the pipeline under key or creates and stores it, safe to call concurrently
+	HRESULT CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC& stream_desc, uint64 key, ComPtr<ID3D12PipelineState>& out_pipeline_state);
+	// Writes the library when pipelines were stored since the load
+	void Serialize();
+private:
+	bool ReadLibraryFile(std::vector<uint8>& out_library_data) const;
+	void CreateLibrary(const std::vector<uint8>& library_data);
+
+	ComPtr<ID3D12Device14> m_device;
+	// Library references the loaded blob instead of copying it, must outlive m_library so it is declared first
+	std::vector<uint8> m_library_data;
+	ComPtr<ID3D12PipelineLibrary1> m_library;
+	std::string m_path;
+
+	uint32 m_vendor_id = 0;
+	uint32 m_device_id = 0;
+	uint32 m_subsys_id = 0;
+	uint32 m_revision = 0;
+	int64 m_driver_version = 0;
+
+	std::atomic<bool> m_dirty = false;
+	std::atomic<uint32> m_hit_count = 0;
+	std::atomic<uint32> m_miss_count = 0;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "DXProfiler.h"
+#include "DXContext.h"
+
+// Begin and end timestamp per scope
+static const uint32 g_queries_per_scope = 2u;
+
+void GPUProfiler::Init(DXContext& dx_context, const std::vector<std::string>& scope_names)
+{
+	m_scope_names = scope_names;
+	dx_context.m_crash_report.SetPassNames(m_scope_names);
+	m_scope_milliseconds.assign(m_scope_names.size(), 0.0);
+	for (uint32 i = 0; i < g_backbuffer_count; ++i)
+	{
+		m_scope_written[i].assign(m_scope_names.size(), false);
+	}
+
+	const uint32 query_count = GetScopeCount() * g_queries_per_scope;
+	D3D12_QUERY_HEAP_DESC query_heap_desc
+	{
+		.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+		.Count = query_count,
+		.NodeMask = 0,
+	};
+	dx_context.GetDevice()->CreateQueryHeap(&query_heap_desc, IID_PPV_ARGS(&m_query_heap)) >> CHK;
+	NAME_DX_OBJECT(m_query_heap, "Timestamp Query Heap");
+
+	// One slot of timestamps per backbuffer
+	m_readback_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, g_backbuffer_count * query_count * sizeof(uint64));
+	m_readback_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+	m_readback_buffer.CreateResource(dx_context, "Timestamp Readback");
+
+	// Ticks per second of the queue the timestamps are written on
+	dx_context.GetCommandQueue().m_queue->GetTimestampFrequency(&m_frequency) >> CHK;
+}
+
+void GPUProfiler::BeginScope(DXContext& dx_context, uint32 scope)
+{
+	ASSERT(scope < GetScopeCount());
+	dx_context.GetCommandListGraphics()->EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, scope * g_queries_per_scope + 0);
+	dx_context.m_crash_report.MarkPassBegin(dx_context.GetCommandListGraphics().Get(), scope);
+}
+
+void GPUProfiler::EndScope(DXContext& dx_context, uint32 scope)
+{
+	ASSERT(scope < GetScopeCount());
+	dx_context.m_crash_report.MarkPassEnd(dx_context.GetCommandListGraphics().Get(), scope);
+	dx_context.GetCommandListGraphics()->EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, scope * g_queries_per_scope + 1);
+	m_scope_written[g_current_buffer_index][scope] = true;
+}
+
+void GPUProfiler::Resolve(DXContext& dx_context)
+{
+	const uint64 slot_offset = g_current_buffer_index * GetScopeCount() * g_queries_per_scope * sizeof(uint64);
+	for (uint32 scope = 0; scope < GetScopeCount(); ++scope)
+	{
+		if (m_scope_written[g_current_buffer_index][scope])
+		{
+			const uint32 query_index = scope * g_queries_per_scope;
+			dx_context.GetCommandListGraphics()->ResolveQueryData
+			(
+				m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query_index, g_queries_per_scope,
+				m_readback_buffer.m_resource.Get(), slot_offset + query_index * sizeof(uint64)
+			);
+		}
+	}
+}
+
+void GPUProfiler::Readback()
+{
+	const uint64 slot_size = GetScopeCount() * g_queries_per_scope * sizeof(uint64);
+	const uint64 slot_offset = g_current_buffer_index * slot_size;
+	const D3D12_RANGE range = { slot_offset, slot_offset + slot_size };
+	uint8* data = nullptr;
+	m_readback_buffer.m_resource->Map(0, &range, reinterpret_cast<void**>(&data)) >> CHK;
+	const uint64* timestamps = reinterpret_cast<const uint64*>(data + slot_offset);
+	for (uint32 scope = 0; scope < GetScopeCount(); ++scope)
+	{
+		if (m_scope_written[g_current_buffer_index][scope])
+		{
+			const uint64 begin = timestamps[scope * g_queries_per_scope + 0];
+			const uint64 end = timestamps[scope * g_queries_per_scope + 1];
+			m_scope_milliseconds[scope] = end > begin ? (float64)(end - begin) * 1000.0 / (float64)m_frequency : 0.0;
+			m_scope_written[g_current_buffer_index][scope] = false;
+		}
+	}
+	// Nothing written by CPU
+	const D3D12_RANGE write_range = { 0, 0 };
+	m_readback_buffer.m_resource->Unmap(0, &write_range);
+}
+
+float64 GPUProfiler::GetScopeMilliseconds(uint32 scope) const
+{
+	ASSERT(scope < GetScopeCount());
+	return m_scope_milliseconds[scope];
+}
+
+const std::string& GPUProfiler::GetScopeName(uint32 scope) const
+{
+	ASSERT(scope < GetScopeCount());
+	return m_scope_names[scope];
+}
+
+uint32 GPUProfiler::GetScopeCount() const
+{
+	return (uint32)m_scope_names.size();
+}
\ No newline at end of file
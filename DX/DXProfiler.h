@@ -0,0 +1,36 @@
+#pragma once
+#include "../core/Common.h"
+#include "DXCommon.h"
+#include "DXResource.h"
+
+class DXContext;
+struct ID3D12QueryHeap;
+
+// GPU timestamps per named scope, resolved per backbuffer slot
+// Results are read back once the fence of that slot completed, so they lag g_backbuffer_count frames behind
+class GPUProfiler
+{
+public:
+	void Init(DXContext& dx_context, const std::vector<std::string>& scope_names);
+
+	void BeginScope(DXContext& dx_context, uint32 scope);
+	void EndScope(DXContext& dx_context, uint32 scope);
+
+	// Record resolve of all scopes written this frame into the slot of the current backbuffer index
+	void Resolve(DXContext& dx_context);
+	// Read the slot of the current backbuffer index, requires the fence of that slot to be completed
+	void Readback();
+
+	float64 GetScopeMilliseconds(uint32 scope) const;
+	const std::string& GetScopeName(uint32 scope) const;
+	uint32 GetScopeCount() const;
+private:
+	ComPtr<ID3D12QueryHeap> m_query_heap;
+	DXResource m_readback_buffer;
+
+	std::vector<std::string> m_scope_names;
+	std::vector<float64> m_scope_milliseconds;
+	// Only resolve queries that were actually ended, resolving unwritten queries is invalid
+	std::vector<bool> m_scope_written[g_backbuffer_count];
+	uint64 m_frequency = 1;
+};
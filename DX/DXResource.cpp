@@ -69,7 +69,7 @@ void DXResource::SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_RESOURCE_FLAGS
 
 ResourceAllocator g_resource_allocator;
 
-void DXResource::CreateResource(DXContext& dx_context, const std::string& name_resource)
+void DXResource::CreateResource(DXContext& dx_context, std::string_view name_resource)
 {
 //	ComPtr<ID3D12Resource> resource = g_resource_allocator.CreateResource
 //	(
@@ -96,7 +96,7 @@ void DXVertexBufferResource::SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_RE
 	m_count = (uint32)m_size_in_bytes / m_stride;
 }
 
-void DXVertexBufferResource::CreateResource(DXContext& dx_context, const std::string& name_resource)
+void DXVertexBufferResource::CreateResource(DXContext& dx_context, std::string_view name_resource)
 {
 	// Less than 4GB
 	ASSERT(m_size_in_bytes < UINT32_MAX);
@@ -109,7 +109,7 @@ void DXVertexBufferResource::CreateResource(DXContext& dx_context, const std::st
 	};
 }
 
-void DXTextureResource::SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FLAGS heap_flags, D3D12_RESOURCE_FLAGS resource_flags, uint32 width, uint32 height, DXGI_FORMAT format)
+void DXTextureResource::SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FLAGS heap_flags, D3D12_RESOURCE_FLAGS resource_flags, uint32 width, uint32 height, DXGI_FORMAT format, uint16 mip_levels)
 {
 	m_heap_flags = heap_flags;
 
@@ -134,7 +134,7 @@ void DXTextureResource::SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FL
 		.Width = m_width,
 		.Height = m_height,
 		.DepthOrArraySize = 1,
-		.MipLevels = 1,
+		.MipLevels = mip_levels,
 		.Format = m_format,
 		.SampleDesc =
 		{
@@ -148,7 +148,7 @@ void DXTextureResource::SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FL
 	m_resource_state = D3D12_RESOURCE_STATE_COMMON;
 }
 
-void DXTextureResource::CreateResource(DXContext& dx_context, const std::string& name_resource)
+void DXTextureResource::CreateResource(DXContext& dx_context, std::string_view name_resource)
 {
 	DXResource::CreateResource(dx_context, name_resource);
 }
@@ -314,6 +314,14 @@ void ResourceAllocator::AddCachedResource(const ResourceDescription& resource_de
 	m_free_resource_list.push_back( { resource_description, { resource, resource_state } });
 }
 
+ResourceHandler::ResourceHandler()
+{
+	for (std::vector<DXResource>& resources : m_resources)
+	{
+		resources.reserve(s_reserved_resource_count);
+	}
+}
+
 void ResourceHandler::RegisterResource(DXResource& resource)
 {
 	m_resources[g_current_buffer_index].push_back(resource);
@@ -322,7 +330,7 @@ void ResourceHandler::RegisterResource(DXResource& resource)
 void ResourceHandler::ReRegisterResource(DXResource& resource)
 {
 	auto it = std::find_if(m_resources[g_current_buffer_index].begin(), m_resources[g_current_buffer_index].end(), 
-	[resource](DXResource element)
+	[&resource](const DXResource& element)
 	{
 		return element.m_resource == resource.m_resource;
 	});
@@ -45,7 +45,7 @@ public:
 
 	DXResource() : m_heap_flags(D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS) {};
 	virtual void SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_RESOURCE_FLAGS resource_flags, uint64 bytes);
-	virtual void CreateResource(DXContext& dx_context, const std::string& name_resource);
+	virtual void CreateResource(DXContext& dx_context, std::string_view name_resource);
 	
 	// TODO reserved resources
 //	virtual void AllocateVirtual(DXContext& dx_context);
@@ -61,7 +61,7 @@ public:
 	D3D12_VERTEX_BUFFER_VIEW m_vertex_buffer_view{};
 
 	void SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_RESOURCE_FLAGS resource_flags, uint32 size, uint32 stride);
-	virtual void CreateResource(DXContext& dx_context, const std::string& name_resource) override;
+	virtual void CreateResource(DXContext& dx_context, std::string_view name_resource) override;
 };
 
 class DXTextureResource : public DXResource
@@ -71,8 +71,9 @@ public:
 	uint32 m_height;
 	DXGI_FORMAT m_format;
 
-	virtual void SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FLAGS heap_flags, D3D12_RESOURCE_FLAGS resource_flags, uint32 width, uint32 height, DXGI_FORMAT format);
-	virtual void CreateResource(DXContext& dx_context, const std::string& name_resource);
+	// 0 mip_levels is the full chain
+	virtual void SetResourceInfo(D3D12_HEAP_TYPE heap_type, D3D12_HEAP_FLAGS heap_flags, D3D12_RESOURCE_FLAGS resource_flags, uint32 width, uint32 height, DXGI_FORMAT format, uint16 mip_levels = 1);
+	virtual void CreateResource(DXContext& dx_context, std::string_view name_resource);
 };
 
 extern uint32 g_current_buffer_index;
@@ -80,12 +81,15 @@ extern uint32 g_current_buffer_index;
 class ResourceHandler
 {
 public:
+	ResourceHandler();
 	// Create Transient Resource
 	void RegisterResource(DXResource& resource);
 	void ReRegisterResource(DXResource& resource);
 	void FreeResources();
 	// Create Persistent Resource
+	// Cleared with their capacity kept, registering does not allocate once a frame registered as many
 	std::vector<DXResource> m_resources[g_backbuffer_count];
+	static const uint32 s_reserved_resource_count = 64;
 };
 
 struct ResourceDescription
@@ -0,0 +1,254 @@
+#include "DXScreenCapture.h"
+#include "DXContext.h"
+#include "../core/ThreadPool.h"
+
+#include <chrono>
+#include <filesystem>
+#include <format>
+
+// Out of line, ThreadPool is incomplete in the header
+ScreenCapture::ScreenCapture() = default;
+
+ScreenCapture::~ScreenCapture()
+{
+	// Workers read the slots, they go first
+	m_thread_pool.reset();
+}
+
+void ScreenCapture::Init(const ScreenCaptureDesc& desc)
+{
+	ASSERT(desc.m_slot_count > 0 && desc.m_worker_count > 0);
+	m_desc = desc;
+	m_slots = std::make_unique<CaptureSlot[]>(m_desc.m_slot_count);
+	m_thread_pool = std::make_unique<ThreadPool>(m_desc.m_worker_count);
+	// Runs never overwrite each other
+	const uint64 timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	m_desc.m_directory = (std::filesystem::path(m_desc.m_directory) / std::to_string(timestamp)).string();
+	std::filesystem::create_directories(m_desc.m_directory);
+}
+
+void ScreenCapture::Shutdown()
+{
+	for (uint32 i = 0; i < m_desc.m_slot_count; ++i)
+	{
+		CaptureSlot& slot = m_slots[i];
+		if (slot.m_state.load(std::memory_order_acquire) == SlotState::Copying)
+		{
+			slot.m_state.store(SlotState::Encoding, std::memory_order_relaxed);
+			m_thread_pool->Submit([this, &slot](uint32) { Encode(slot); });
+		}
+	}
+	m_thread_pool.reset();
+}
+
+void ScreenCapture::RequestScreenshot()
+{
+	m_is_screenshot_requested = true;
+}
+
+void ScreenCapture::StartSequence(float64 frames_per_second)
+{
+	ASSERT(frames_per_second > 0.0);
+	m_is_sequence_running = true;
+	m_sequence_period = 1.0 / frames_per_second;
+	m_next_sequence_time = -1.0;
+	m_sequence_frame_index = 0;
+	m_has_logged_drop = false;
+}
+
+void ScreenCapture::StopSequence()
+{
+	if (m_is_sequence_running)
+	{
+		LOG_INFO(General, "Capture sequence {0} stopped after {1} frames", m_sequence_index, m_sequence_frame_index);
+		++m_sequence_index;
+	}
+	m_is_sequence_running = false;
+}
+
+bool ScreenCapture::IsSequenceRunning() const
+{
+	return m_is_sequence_running;
+}
+
+void ScreenCapture::SetFileFormat(ImageFileFormat format)
+{
+	m_desc.m_file_format = format;
+}
+
+ImageFileFormat ScreenCapture::GetFileFormat() const
+{
+	return m_desc.m_file_format;
+}
+
+void ScreenCapture::Readback()
+{
+	for (uint32 i = 0; i < m_desc.m_slot_count; ++i)
+	{
+		CaptureSlot& slot = m_slots[i];
+		if (slot.m_state.load(std::memory_order_acquire) == SlotState::Copying && slot.m_buffer_index == g_current_buffer_index)
+		{
+			slot.m_state.store(SlotState::Encoding, std::memory_order_relaxed);
+			m_thread_pool->Submit([this, &slot](uint32) { Encode(slot); });
+		}
+	}
+}
+
+void ScreenCapture::Record(DXContext& dx_context, DXTextureResource& texture, float64 time_seconds)
+{
+	bool is_sequence_frame = false;
+	if (m_is_sequence_running && time_seconds >= m_next_sequence_time)
+	{
+		is_sequence_frame = true;
+		m_next_sequence_time += m_sequence_period;
+		// Late frames do not catch up with a burst
+		if (m_next_sequence_time <= time_seconds)
+		{
+			m_next_sequence_time = time_seconds + m_sequence_period;
+		}
+	}
+	if (!is_sequence_frame && !m_is_screenshot_requested)
+	{
+		return;
+	}
+
+	ImagePixelFormat pixel_format{};
+	switch (texture.m_format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		pixel_format = ImagePixelFormat::R8G8B8A8_UNORM;
+		break;
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+		pixel_format = ImagePixelFormat::R10G10B10A2_UNORM;
+		break;
+	default:
+		LOG_ERROR(General, "Screen capture of format {0} is not supported", static_cast<uint32>(texture.m_format));
+		m_is_screenshot_requested = false;
+		StopSequence();
+		return;
+	}
+
+	CaptureSlot* slot = FindFreeSlot();
+	if (slot == nullptr)
+	{
+		// Screenshot stays requested, the sequence keeps its pace and leaves a gap in the frame numbers
+		if (is_sequence_frame)
+		{
+			++m_dropped_count;
+			++m_sequence_frame_index;
+			if (!m_has_logged_drop)
+			{
+				LOG_WARNING(General, "Capture sequence {0} is dropping frames, encoding or the disk is behind", m_sequence_index);
+				m_has_logged_drop = true;
+			}
+		}
+		return;
+	}
+
+	uint64 size_in_bytes = 0;
+	dx_context.GetDevice()->GetCopyableFootprints(&texture.m_resource_desc, 0, 1, 0, &slot->m_footprint, nullptr, nullptr, &size_in_bytes);
+	// Grows with the window, a free slot is not used by the GPU nor the workers
+	if (slot->m_readback_buffer.m_resource == nullptr || slot->m_readback_buffer.m_size_in_bytes < size_in_bytes)
+	{
+		slot->m_readback_buffer = DXResource{};
+		slot->m_readback_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, size_in_bytes);
+		slot->m_readback_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+		slot->m_readback_buffer.CreateResource(dx_context, "Screen Capture Readback");
+	}
+
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, texture);
+	const D3D12_TEXTURE_COPY_LOCATION destination
+	{
+		.pResource = slot->m_readback_buffer.m_resource.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+		.PlacedFootprint = slot->m_footprint,
+	};
+	const D3D12_TEXTURE_COPY_LOCATION source
+	{
+		.pResource = texture.m_resource.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+		.SubresourceIndex = 0,
+	};
+	dx_context.GetCommandListGraphics()->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+
+	const char* extension = g_image_file_extensions[static_cast<uint32>(m_desc.m_file_format)];
+	const std::string name = is_sequence_frame ?
+		std::format("sequence_{0}_{1:05}{2}", m_sequence_index, m_sequence_frame_index++, extension) :
+		std::format("screenshot_{0:03}{1}", m_screenshot_index++, extension);
+	slot->m_path = (std::filesystem::path(m_desc.m_directory) / name).string();
+	slot->m_pixel_format = pixel_format;
+	slot->m_file_format = m_desc.m_file_format;
+	slot->m_buffer_index = g_current_buffer_index;
+	slot->m_state.store(SlotState::Copying, std::memory_order_relaxed);
+	if (!is_sequence_frame)
+	{
+		m_is_screenshot_requested = false;
+	}
+	// A frame due for both only needs one copy
+	else if (m_is_screenshot_requested)
+	{
+		LOG_INFO(General, "Screenshot taken by sequence frame {0}", slot->m_path);
+		m_is_screenshot_requested = false;
+	}
+}
+
+uint32 ScreenCapture::GetWrittenCount() const
+{
+	return m_written_count.load(std::memory_order_relaxed);
+}
+
+uint32 ScreenCapture::GetDroppedCount() const
+{
+	return m_dropped_count;
+}
+
+uint32 ScreenCapture::GetPendingCount() const
+{
+	uint32 pending_count = 0;
+	for (uint32 i = 0; i < m_desc.m_slot_count; ++i)
+	{
+		pending_count += m_slots[i].m_state.load(std::memory_order_relaxed) != SlotState::Free ? 1 : 0;
+	}
+	return pending_count;
+}
+
+void ScreenCapture::Encode(CaptureSlot& slot)
+{
+	const D3D12_SUBRESOURCE_FOOTPRINT& footprint = slot.m_footprint.Footprint;
+	const uint64 size_in_bytes = slot.m_footprint.Offset + (uint64)footprint.RowPitch * footprint.Height;
+	const D3D12_RANGE range = { 0, size_in_bytes };
+	uint8* data = nullptr;
+	slot.m_readback_buffer.m_resource->Map(0, &range, reinterpret_cast<void**>(&data)) >> CHK;
+	const ImageView image
+	{
+		.m_data = data + slot.m_footprint.Offset,
+		.m_width = footprint.Width,
+		.m_height = footprint.Height,
+		.m_row_pitch = footprint.RowPitch,
+		.m_format = slot.m_pixel_format,
+	};
+	if (WriteImageFile(slot.m_path, image, slot.m_file_format))
+	{
+		m_written_count.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		LOG_ERROR(General, "Failed to write capture {0}", slot.m_path);
+	}
+	const D3D12_RANGE write_range = { 0, 0 };
+	slot.m_readback_buffer.m_resource->Unmap(0, &write_range);
+	slot.m_state.store(SlotState::Free, std::memory_order_release);
+}
+
+ScreenCapture::CaptureSlot* ScreenCapture::FindFreeSlot()
+{
+	for (uint32 i = 0; i < m_desc.m_slot_count; ++i)
+	{
+		if (m_slots[i].m_state.load(std::memory_order_acquire) == SlotState::Free)
+		{
+			return &m_slots[i];
+		}
+	}
+	return nullptr;
+}
\ No newline at end of file
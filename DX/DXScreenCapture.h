@@ -0,0 +1,93 @@
+#pragma once
+#include "../core/Common.h"
+#include "../core/ImageEncoding.h"
+#include "DXCommon.h"
+#include "DXResource.h"
+
+#include <atomic>
+#include <memory>
+
+class DXContext;
+class ThreadPool;
+
+struct ScreenCaptureDesc
+{
+	std::string m_directory = "captures";
+	ImageFileFormat m_file_format = ImageFileFormat::PNG;
+	uint32 m_worker_count = 2;
+	// Readback buffers, bounds the captures between their copy and the end of their encode
+	uint32 m_slot_count = 2 * g_backbuffer_count;
+};
+
+// Screenshots and frame sequences written to disk without the frame loop waiting on the GPU or the disk
+// A capture copies the texture into a free readback slot, the slot is handed to the workers once the fence of its backbuffer index completed
+// Workers convert and encode from the mapped slot and free it once the file is written
+// No free slot is the back pressure, a screenshot waits for the next frame and a sequence frame is dropped
+class ScreenCapture
+{
+public:
+	ScreenCapture();
+	// Waits for the encodes in flight
+	~ScreenCapture();
+	void Init(const ScreenCaptureDesc& desc);
+	// Encodes the copies not handed out yet and waits for the workers, the GPU has to be idle
+	void Shutdown();
+
+	void RequestScreenshot();
+	// Captures a frame every 1 / frames_per_second seconds of frame time until stopped
+	void StartSequence(float64 frames_per_second);
+	void StopSequence();
+	bool IsSequenceRunning() const;
+	void SetFileFormat(ImageFileFormat format);
+	ImageFileFormat GetFileFormat() const;
+
+	// Hands the copies of the frame that last used the current backbuffer index to the workers, requires the fence of that index to be completed
+	void Readback();
+	// Copies texture into a free slot when a capture is due, R8G8B8A8 and R10G10B10A2 only, texture is left in COPY_SOURCE
+	void Record(DXContext& dx_context, DXTextureResource& texture, float64 time_seconds);
+
+	uint32 GetWrittenCount() const;
+	// Sequence frames without a free slot
+	uint32 GetDroppedCount() const;
+	uint32 GetPendingCount() const;
+private:
+	enum class SlotState : uint32
+	{
+		Free,
+		// Copy recorded, fence of m_buffer_index not passed yet
+		Copying,
+		Encoding,
+	};
+
+	struct CaptureSlot
+	{
+		DXResource m_readback_buffer;
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_footprint{};
+		ImagePixelFormat m_pixel_format = ImagePixelFormat::R8G8B8A8_UNORM;
+		ImageFileFormat m_file_format = ImageFileFormat::PNG;
+		uint32 m_buffer_index = 0;
+		std::string m_path;
+		// Written by the workers when the file is done
+		std::atomic<SlotState> m_state = SlotState::Free;
+	};
+
+	void Encode(CaptureSlot& slot);
+	CaptureSlot* FindFreeSlot();
+
+	ScreenCaptureDesc m_desc;
+	std::unique_ptr<CaptureSlot[]> m_slots;
+	// Encodes and writes the files, a blocked write holds a thread of its own rather than a job system worker
+	std::unique_ptr<ThreadPool> m_thread_pool;
+	bool m_is_screenshot_requested = false;
+	uint32 m_screenshot_index = 0;
+	// Sequence
+	bool m_is_sequence_running = false;
+	float64 m_sequence_period = 0.0;
+	// Negative until the first frame of the sequence
+	float64 m_next_sequence_time = -1.0;
+	uint32 m_sequence_index = 0;
+	uint32 m_sequence_frame_index = 0;
+	bool m_has_logged_drop = false;
+	std::atomic<uint32> m_written_count = 0;
+	uint32 m_dropped_count = 0;
+};
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "DXShaderArchive.h"
+#include "DXCommon.h"
+#include "DXIncludeHandler.h"
+#include "ShaderArchiveFormat.h"
+#include <dxcapi.h>
+#include <filesystem>
+#include <fstream>
+
+ShaderArchive::~ShaderArchive()
+{
+	Close();
+}
+
+bool ShaderArchive::Open(const std::string& shader_directory, const std::string& path)
+{
+	Close();
+	m_shader_directory = shader_directory;
+	HANDLE file = CreateFileW(std::to_wstring(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_file = file;
+
+	LARGE_INTEGER file_size{};
+	if (GetFileSizeEx(m_file, &file_size) && (uint64)file_size.QuadPart >= sizeof(ShaderArchiveHeader))
+	{
+		m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+	if (m_mapping != nullptr)
+	{
+		m_data = static_cast<const uint8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	// Truncated, corrupt or foreign file, never trust offsets out of it
+	if (!IsShaderArchiveValid(m_data, (uint64)file_size.QuadPart))
+	{
+		LOG_ERROR(Compiler, "Shader archive {0} is invalid, rebuild it with ShaderBuild", path);
+		Close();
+		return false;
+	}
+	m_header = reinterpret_cast<const ShaderArchiveHeader*>(m_data);
+	m_entries = reinterpret_cast<const ShaderArchiveEntry*>(m_data + sizeof(ShaderArchiveHeader));
+	return true;
+}
+
+void ShaderArchive::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr)
+	{
+		CloseHandle(m_mapping);
+	}
+	if (m_file != nullptr)
+	{
+		CloseHandle(m_file);
+	}
+	m_file = nullptr;
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_header = nullptr;
+	m_entries = nullptr;
+}
+
+bool ShaderArchive::IsOpen() const
+{
+	return m_header != nullptr;
+}
+
+uint32 ShaderArchive::GetEntryCount() const
+{
+	return IsOpen() ? m_header->m_entry_count : 0;
+}
+
+const ShaderArchiveEntry* ShaderArchive::FindEntry(uint64 key) const
+{
+	const ShaderArchiveEntry* end = m_entries + m_header->m_entry_count;
+	const ShaderArchiveEntry* entry = std::lower_bound
+	(
+		m_entries, end, key,
+		[](const ShaderArchiveEntry& entry, uint64 key) { return entry.m_key < key; }
+	);
+	return entry != end && entry->m_key == key ? entry : nullptr;
+}
+
+std::vector<std::string> ShaderArchive::GetDependencies(const ShaderArchiveEntry& entry) const
+{
+	std::vector<std::string> dependencies{};
+	const char* string_table = reinterpret_cast<const char*>(m_data + m_header->m_string_table_offset);
+	const std::string_view all(string_table + entry.m_dependencies.m_offset, entry.m_dependencies.m_size);
+	size_t begin = 0;
+	while (begin < all.size())
+	{
+		const size_t end = (std::min)(all.find('\n', begin), all.size());
+		dependencies.emplace_back(all.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return dependencies;
+}
+
+bool ShaderArchive::IsEntryStale(const ShaderArchiveEntry& entry, const std::vector<std::string>& dependencies) const
+{
+	// Shipped without sources, the archive is authoritative
+	if (dependencies.empty() || !std::filesystem::exists(std::filesystem::path(m_shader_directory) / dependencies[0]))
+	{
+		return false;
+	}
+	uint64 source_hash = 0;
+	std::vector<char> data{};
+	for (const std::string& dependency : dependencies)
+	{
+		std::ifstream file(std::filesystem::path(m_shader_directory) / dependency, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return true;
+		}
+		data.resize((size_t)file.tellg());
+		file.seekg(0);
+		file.read(data.data(), data.size());
+		source_hash = HashShaderDependency(dependency, data.data(), data.size(), source_hash);
+	}
+	return source_hash != entry.m_source_hash;
+}
+
+bool ShaderArchive::Load(IDxcUtils* utils, const ShaderDesc& shader_desc, const std::string& shader_model, bool debug, Shader& out_shader) const
+{
+	if (!IsOpen() || shader_model != m_header->m_shader_model || (m_header->m_debug != 0) != debug)
+	{
+		return false;
+	}
+	const ShaderArchiveEntry* entry = FindEntry(GetShaderArchiveKey(shader_desc));
+	if (entry == nullptr)
+	{
+		return false;
+	}
+	const std::vector<std::string> dependencies = GetDependencies(*entry);
+	if (IsEntryStale(*entry, dependencies))
+	{
+		LOG_TRACE(Compiler, "Shader archive entry {0} {1} is stale, compiling", shader_desc.m_file_name, shader_desc.m_entry_point_name);
+		return false;
+	}
+
+	ComPtr<IDxcBlob>* blobs[g_shader_archive_blob_count] =
+	{
+		&out_shader.m_blob,
+		&out_shader.m_reflection_blob,
+		&out_shader.m_root_signature_blob,
+	};
+	for (uint32 i = 0; i < g_shader_archive_blob_count; ++i)
+	{
+		blobs[i]->Reset();
+		const ShaderArchiveRange& range = entry->m_blobs[i];
+		if (range.m_size > 0)
+		{
+			// No copy, the blob references the mapping which outlives it
+			ComPtr<IDxcBlobEncoding> blob{};
+			utils->CreateBlobFromPinned(m_data + range.m_offset, (uint32)range.m_size, DXC_CP_ACP, &blob) >> CHK;
+			*blobs[i] = blob;
+		}
+	}
+	out_shader.m_dependencies.clear();
+	for (const std::string& dependency : dependencies)
+	{
+		out_shader.m_dependencies.push_back(NormalizeShaderPath((std::filesystem::path(m_shader_directory) / dependency).string()));
+	}
+	return true;
+}
\ No newline at end of file
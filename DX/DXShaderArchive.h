@@ -0,0 +1,40 @@
+#pragma once
+#include "../core/Common.h"
+#include "Shader.h"
+
+struct IDxcUtils;
+struct ShaderArchiveHeader;
+struct ShaderArchiveEntry;
+
+// Read-only view of the archive written by the ShaderBuild tool, mapped for the lifetime of the object
+// Loaded blobs point into the mapping, they must not outlive the archive
+class ShaderArchive
+{
+public:
+	ShaderArchive() = default;
+	~ShaderArchive();
+	ShaderArchive(const ShaderArchive&) = delete;
+	ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+	// Missing or mismatching file leaves the archive closed, every Load misses then
+	bool Open(const std::string& shader_directory, const std::string& path);
+	void Close();
+
+	// Fails on missing key, other shader model or debug setting, or when present sources changed since the build
+	// Utils of the calling thread creates the blobs, safe to call concurrently
+	bool Load(IDxcUtils* utils, const ShaderDesc& shader_desc, const std::string& shader_model, bool debug, Shader& out_shader) const;
+
+	bool IsOpen() const;
+	uint32 GetEntryCount() const;
+private:
+	const ShaderArchiveEntry* FindEntry(uint64 key) const;
+	std::vector<std::string> GetDependencies(const ShaderArchiveEntry& entry) const;
+	bool IsEntryStale(const ShaderArchiveEntry& entry, const std::vector<std::string>& dependencies) const;
+
+	std::string m_shader_directory;
+	HANDLE m_file = nullptr;
+	HANDLE m_mapping = nullptr;
+	const uint8* m_data = nullptr;
+	const ShaderArchiveHeader* m_header = nullptr;
+	const ShaderArchiveEntry* m_entries = nullptr;
+};
\ No newline at end of file
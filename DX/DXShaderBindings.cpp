@@ -0,0 +1,284 @@
+#include "DXShaderBindings.h"
+#include "DXCompiler.h"
+#include "ShaderManifest.h"
+#include <d3d12shader.h>
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <sstream>
+
+// Binds every type of SharedLayouts.hlsl, never part of the manifest since it is not a real shader
+static const ShaderDesc g_shared_layout_probe_desc =
+{
+	.m_type = ShaderType::COMPUTE_SHADER,
+	.m_file_name = "SharedLayouts.hlsl",
+	.m_entry_point_name = "LayoutProbe",
+	.m_defines = { "SHARED_LAYOUT_PROBE" },
+};
+
+// Scalars and vectors of 32 bit components only, vectors become arrays so designated initializers stay simple
+static bool GetFieldType(const D3D12_SHADER_TYPE_DESC& type_desc, std::string& out_type, uint32& out_count)
+{
+	if ((type_desc.Class != D3D_SVC_SCALAR && type_desc.Class != D3D_SVC_VECTOR) || type_desc.Rows != 1 || type_desc.Elements != 0)
+	{
+		return false;
+	}
+	switch (type_desc.Type)
+	{
+	case D3D_SVT_FLOAT: out_type = "float32"; break;
+	case D3D_SVT_INT: out_type = "int32"; break;
+	case D3D_SVT_UINT: out_type = "uint32"; break;
+	// HLSL bool is 32 bits
+	case D3D_SVT_BOOL: out_type = "uint32"; break;
+	default: return false;
+	}
+	out_count = type_desc.Columns;
+	return true;
+}
+
+// Root constants parameter reading register b<shader_register> in space register_space
+static bool FindRootConstants
+(
+	const Shader& shader, uint32 shader_register, uint32 register_space,
+	uint32& out_parameter_index, uint32& out_constant_count
+)
+{
+	if (!shader.m_root_signature_blob)
+	{
+		return false;
+	}
+	ComPtr<ID3D12VersionedRootSignatureDeserializer> deserializer{};
+	D3D12CreateVersionedRootSignatureDeserializer
+	(
+		shader.m_root_signature_blob->GetBufferPointer(), shader.m_root_signature_blob->GetBufferSize(), IID_PPV_ARGS(&deserializer)
+	) >> CHK;
+	const D3D12_VERSIONED_ROOT_SIGNATURE_DESC* root_signature_desc = nullptr;
+	deserializer->GetRootSignatureDescAtVersion(D3D_ROOT_SIGNATURE_VERSION_1_1, &root_signature_desc) >> CHK;
+	for (uint32 i = 0; i < root_signature_desc->Desc_1_1.NumParameters; ++i)
+	{
+		const D3D12_ROOT_PARAMETER1& parameter = root_signature_desc->Desc_1_1.pParameters[i];
+		if 
+		(
+			parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS && 
+			parameter.Constants.ShaderRegister == shader_register && parameter.Constants.RegisterSpace == register_space
+		)
+		{
+			out_parameter_index = i;
+			out_constant_count = parameter.Constants.Num32BitValues;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Struct with explicit padding wherever HLSL packing leaves a gap, followed by the asserts of its layout
+// extra_members are pasted at the end of the struct body
+static bool WriteStruct
+(
+	ID3D12ShaderReflectionType* type, const std::string& name, uint32 size, 
+	const std::string& comment, const std::string& extra_members, std::ostringstream& out
+)
+{
+	D3D12_SHADER_TYPE_DESC type_desc{};
+	type->GetDesc(&type_desc) >> CHK;
+
+	std::ostringstream fields{};
+	std::ostringstream asserts{};
+	uint32 offset = 0;
+	uint32 padding_count = 0;
+	for (uint32 i = 0; i < type_desc.Members; ++i)
+	{
+		const std::string member_name = type->GetMemberTypeName(i);
+		D3D12_SHADER_TYPE_DESC member_desc{};
+		type->GetMemberTypeByIndex(i)->GetDesc(&member_desc) >> CHK;
+		std::string field_type{};
+		uint32 field_count = 0;
+		if (!GetFieldType(member_desc, field_type, field_count))
+		{
+			LOG_ERROR(Compiler, "{0}::{1} has no C++ equivalent, use 32 bit scalars or vectors", name, member_name);
+			return false;
+		}
+		if (member_desc.Offset > offset)
+		{
+			fields << std::format("\tuint32 padding{0}[{1}];\n", padding_count++, (member_desc.Offset - offset) / sizeof(uint32));
+		}
+		fields << std::format("\t{0} {1}{2};\n", field_type, member_name, field_count > 1 ? std::format("[{0}]", field_count) : "");
+		asserts << std::format("static_assert(offsetof({0}, {1}) == {2});\n", name, member_name, member_desc.Offset);
+		offset = member_desc.Offset + field_count * sizeof(uint32);
+	}
+	if (size > offset)
+	{
+		fields << std::format("\tuint32 padding{0}[{1}];\n", padding_count++, (size - offset) / sizeof(uint32));
+	}
+	asserts << std::format("static_assert(sizeof({0}) == {1});\n", name, size);
+
+	out << "\n" << comment << "\n";
+	out << "struct " << name << "\n{\n" << fields.str() << extra_members << "};\n" << asserts.str();
+	return true;
+}
+
+// Header text of one shader, empty when the shader has nothing to share
+static bool GenerateShaderBindingsHeader(IDxcUtils* utils, const Shader& shader, std::string& out_header)
+{
+	out_header.clear();
+	if (!shader.m_blob || !shader.m_reflection_blob)
+	{
+		LOG_ERROR(Compiler, "No reflection for {0} {1}", shader.m_shader_desc.m_file_name, shader.m_shader_desc.m_entry_point_name);
+		return false;
+	}
+	const DxcBuffer reflection_buffer
+	{
+		.Ptr = shader.m_reflection_blob->GetBufferPointer(),
+		.Size = shader.m_reflection_blob->GetBufferSize(),
+		.Encoding = DXC_CP_ACP,
+	};
+	ComPtr<ID3D12ShaderReflection> reflection{};
+	utils->CreateReflection(&reflection_buffer, IID_PPV_ARGS(&reflection)) >> CHK;
+	D3D12_SHADER_DESC shader_desc{};
+	reflection->GetDesc(&shader_desc) >> CHK;
+
+	std::ostringstream structs{};
+	for (uint32 i = 0; i < shader_desc.ConstantBuffers; ++i)
+	{
+		ID3D12ShaderReflectionConstantBuffer* buffer = reflection->GetConstantBufferByIndex(i);
+		D3D12_SHADER_BUFFER_DESC buffer_desc{};
+		buffer->GetDesc(&buffer_desc) >> CHK;
+		D3D12_SHADER_INPUT_BIND_DESC bind_desc{};
+		reflection->GetResourceBindingDescByName(buffer_desc.Name, &bind_desc) >> CHK;
+		// ConstantBuffer<T> and StructuredBuffer<T> both reflect as a single variable of type T
+		D3D12_SHADER_VARIABLE_DESC variable_desc{};
+		ID3D12ShaderReflectionVariable* variable = buffer->GetVariableByIndex(0);
+		variable->GetDesc(&variable_desc) >> CHK;
+		ID3D12ShaderReflectionType* type = variable->GetType();
+		D3D12_SHADER_TYPE_DESC type_desc{};
+		type->GetDesc(&type_desc) >> CHK;
+		if (buffer_desc.Variables != 1 || type_desc.Class != D3D_SVC_STRUCT)
+		{
+			LOG_ERROR(Compiler, "{0} in {1} is not declared as ConstantBuffer<T> or StructuredBuffer<T>", buffer_desc.Name, shader.m_shader_desc.m_file_name);
+			return false;
+		}
+
+		if (buffer_desc.Type == D3D_CT_CBUFFER)
+		{
+			uint32 parameter_index = 0;
+			uint32 constant_count = 0;
+			if (!FindRootConstants(shader, bind_desc.BindPoint, bind_desc.Space, parameter_index, constant_count))
+			{
+				LOG_ERROR(Compiler, "{0} in {1} is not bound to RootConstants in the root signature", buffer_desc.Name, shader.m_shader_desc.m_file_name);
+				return false;
+			}
+			// Only the constants actually declared get written, the root signature may reserve more
+			const std::string comment = std::format
+			(
+				"// ConstantBuffer {0} : register(b{1}, space{2}), root parameter {3} with {4} constants",
+				buffer_desc.Name, bind_desc.BindPoint, bind_desc.Space, parameter_index, constant_count
+			);
+			const std::string extra_members = std::format
+			(
+				"\n\tstatic constexpr uint32 g_root_parameter_index = {0};\n\tstatic constexpr uint32 g_root_constant_count = {1};\n",
+				parameter_index, constant_count
+			);
+			if (!WriteStruct(type, type_desc.Name, variable_desc.Size, comment, extra_members, structs))
+			{
+				return false;
+			}
+			structs << std::format("static_assert(sizeof({0}) <= {0}::g_root_constant_count * sizeof(uint32));\n", type_desc.Name);
+		}
+		else if (buffer_desc.Type == D3D_CT_RESOURCE_BIND_INFO)
+		{
+			const std::string comment = std::format("// Element of {0} : register(t{1}, space{2})", buffer_desc.Name, bind_desc.BindPoint, bind_desc.Space);
+			if (!WriteStruct(type, type_desc.Name, variable_desc.Size, comment, "", structs))
+			{
+				return false;
+			}
+		}
+	}
+	if (structs.str().empty())
+	{
+		return true;
+	}
+
+	std::ostringstream header{};
+	header << "#pragma once\n";
+	header << std::format("// Generated by GenerateShaderBindings from the reflection of {0}, do not edit\n", shader.m_shader_desc.m_file_name);
+	header << "#include \"../../core/Types.h\"\n";
+	header << "#include <cstddef>\n";
+	header << structs.str();
+	out_header = header.str();
+	return true;
+}
+
+bool GenerateShaderBindings(ComPtr<ID3D12Device> device, const DXCompiler& dx_compiler, const std::string& output_directory)
+{
+	// Every permutation has to agree, otherwise C++ could not pick one struct
+	std::vector<ShaderDesc> shader_descs{ g_shared_layout_probe_desc };
+	for (const ShaderPermutationDesc& permutation_desc : GetShaderManifest())
+	{
+		// Libraries have no root constants, their records come from SharedLayouts.hlsl
+		if (permutation_desc.m_shader_desc.m_type == ShaderType::LIB_SHADER)
+		{
+			continue;
+		}
+		for (ShaderPermutationKey key = 0; key < GetPermutationCount(permutation_desc); ++key)
+		{
+			if (!IsPermutationPruned(permutation_desc, key))
+			{
+				shader_descs.push_back(GetPermutationShaderDesc(permutation_desc, key));
+			}
+		}
+	}
+	const std::vector<Shader> shaders = dx_compiler.Compile(device, shader_descs);
+
+	ComPtr<IDxcUtils> utils{};
+	DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&utils)) >> CHK;
+	bool success = true;
+	std::map<std::string, std::string> headers{};
+	for (const Shader& shader : shaders)
+	{
+		std::string header{};
+		if (!GenerateShaderBindingsHeader(utils.Get(), shader, header))
+		{
+			success = false;
+			continue;
+		}
+		if (header.empty())
+		{
+			continue;
+		}
+		const std::string file_name = std::filesystem::path(shader.m_shader_desc.m_file_name).stem().string() + "Bindings.h";
+		const auto& [iterator, inserted] = headers.emplace(file_name, header);
+		if (!inserted && iterator->second != header)
+		{
+			LOG_ERROR(Compiler, "Permutations of {0} declare different root constants", shader.m_shader_desc.m_file_name);
+			success = false;
+		}
+	}
+
+	std::filesystem::create_directories(output_directory);
+	// Left behind by a shader that has nothing to share anymore, or written by hand
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(output_directory))
+	{
+		const std::string file_name = entry.path().filename().string();
+		if (entry.path().extension() == ".h" && !headers.contains(file_name))
+		{
+			LOG_ERROR(Compiler, "{0} is not generated from any shader, remove it", entry.path().string());
+			success = false;
+		}
+	}
+	for (const auto& [file_name, header] : headers)
+	{
+		const std::filesystem::path path = std::filesystem::path(output_directory) / file_name;
+		std::ifstream current_file(path, std::ios::binary);
+		const std::string current_header{ std::istreambuf_iterator<char>(current_file), std::istreambuf_iterator<char>() };
+		current_file.close();
+		if (current_header == header)
+		{
+			continue;
+		}
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(header.data(), header.size());
+		LOG_ERROR(Compiler, "{0} was out of date and got regenerated, rebuild the application", path.string());
+		success = false;
+	}
+	return success;
+}
\ No newline at end of file
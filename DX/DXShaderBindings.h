@@ -0,0 +1,27 @@
+#pragma once
+#include "../core/Common.h"
+#include "DXCommon.h"
+
+class DXCompiler;
+
+// Writes one <Shader>Bindings.h per shader of the manifest into output_directory, from the DXC reflection of
+// its ConstantBuffer<T> root constants, and SharedLayoutsBindings.h for the buffer elements and records of SharedLayouts.hlsl
+// Generated structs static_assert every offset and their size, headers are only rewritten when their content changed
+// Returns false when a header was out of date, is not generated from any shader or a layout cannot be expressed, the application needs a rebuild then
+// Debug builds run it at startup and stop on false
+bool GenerateShaderBindings(ComPtr<ID3D12Device> device, const DXCompiler& dx_compiler, const std::string& output_directory);
+
+// Typed setters of the generated root constant structs, the whole struct in a single call
+template<typename T>
+void SetComputeRootConstants(ID3D12GraphicsCommandList* command_list, const T& constants)
+{
+	static_assert(sizeof(T) % sizeof(uint32) == 0);
+	command_list->SetComputeRoot32BitConstants(T::g_root_parameter_index, sizeof(T) / sizeof(uint32), &constants, 0);
+}
+
+template<typename T>
+void SetGraphicsRootConstants(ID3D12GraphicsCommandList* command_list, const T& constants)
+{
+	static_assert(sizeof(T) % sizeof(uint32) == 0);
+	command_list->SetGraphicsRoot32BitConstants(T::g_root_parameter_index, sizeof(T) / sizeof(uint32), &constants, 0);
+}
\ No newline at end of file
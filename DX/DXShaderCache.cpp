@@ -0,0 +1,143 @@
+#include "DXShaderCache.h"
+#include "DXCommon.h"
+#include <dxcapi.h>
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <thread>
+
+// Bump when ShaderCacheHeader or the blob layout changes
+// "DXSC"
+static const uint32 g_shader_cache_magic = 0x43535844;
+static const uint32 g_shader_cache_version = 1;
+static const uint32 g_blob_count = static_cast<uint32>(ShaderCacheBlob::Count);
+
+struct ShaderCacheHeader
+{
+	uint32 m_magic;
+	uint32 m_version;
+	uint64 m_key;
+	float64 m_compile_milliseconds;
+	uint64 m_blob_sizes[g_blob_count];
+};
+
+void ShaderCache::Init(const std::string& directory)
+{
+	m_directory = directory;
+	if (!std::filesystem::exists(m_directory))
+	{
+		bool create_success = std::filesystem::create_directories(m_directory);
+		ASSERT(create_success);
+	}
+}
+
+std::string ShaderCache::GetPath(uint64 key) const
+{
+	return std::format("{0}\\{1:016x}.dxcache", m_directory, key);
+}
+
+bool ShaderCache::Load(IDxcUtils* utils, uint64 key, ShaderCacheEntry& out_entry) const
+{
+	const std::wstring path = std::to_wstring(GetPath(key));
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	bool success = false;
+	LARGE_INTEGER file_size{};
+	HANDLE mapping = nullptr;
+	const uint8* data = nullptr;
+	if (GetFileSizeEx(file, &file_size) && (uint64)file_size.QuadPart >= sizeof(ShaderCacheHeader))
+	{
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+	if (mapping != nullptr)
+	{
+		data = static_cast<const uint8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (data != nullptr)
+	{
+		const ShaderCacheHeader* header = reinterpret_cast<const ShaderCacheHeader*>(data);
+		uint64 expected_size = sizeof(ShaderCacheHeader);
+		for (uint32 i = 0; i < g_blob_count; ++i)
+		{
+			expected_size += header->m_blob_sizes[i];
+		}
+		// Truncated or foreign file is treated as a miss and overwritten by the next store
+		if 
+		(
+			header->m_magic == g_shader_cache_magic && header->m_version == g_shader_cache_version && 
+			header->m_key == key && expected_size == (uint64)file_size.QuadPart
+		)
+		{
+			uint64 offset = sizeof(ShaderCacheHeader);
+			for (uint32 i = 0; i < g_blob_count; ++i)
+			{
+				out_entry.m_blobs[i].Reset();
+				if (header->m_blob_sizes[i] > 0)
+				{
+					// Copies out of the mapping, view is released below
+					ComPtr<IDxcBlobEncoding> blob{};
+					utils->CreateBlob(data + offset, (uint32)header->m_blob_sizes[i], DXC_CP_ACP, &blob) >> CHK;
+					out_entry.m_blobs[i] = blob;
+				}
+				offset += header->m_blob_sizes[i];
+			}
+			out_entry.m_compile_milliseconds = header->m_compile_milliseconds;
+			success = true;
+		}
+		UnmapViewOfFile(data);
+	}
+	if (mapping != nullptr)
+	{
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+	return success;
+}
+
+void ShaderCache::Store(uint64 key, const ShaderCacheEntry& entry) const
+{
+	ShaderCacheHeader header
+	{
+		.m_magic = g_shader_cache_magic,
+		.m_version = g_shader_cache_version,
+		.m_key = key,
+		.m_compile_milliseconds = entry.m_compile_milliseconds,
+		.m_blob_sizes = {},
+	};
+	for (uint32 i = 0; i < g_blob_count; ++i)
+	{
+		header.m_blob_sizes[i] = entry.m_blobs[i] ? entry.m_blobs[i]->GetBufferSize() : 0;
+	}
+
+	// Write aside then rename, a reader never sees a partially written entry
+	// Temporary file unique per process and thread, writers storing the same key never share one
+	const std::string path = GetPath(key);
+	const std::string temporary_path = std::format("{0}.{1}.{2}.tmp", path, GetCurrentProcessId(), std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	{
+		std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			LOG_ERROR(Compiler, "Shader cache failed to write {0}", temporary_path);
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (uint32 i = 0; i < g_blob_count; ++i)
+		{
+			if (header.m_blob_sizes[i] > 0)
+			{
+				file.write(static_cast<const char*>(entry.m_blobs[i]->GetBufferPointer()), header.m_blob_sizes[i]);
+			}
+		}
+	}
+	std::error_code error_code{};
+	std::filesystem::rename(temporary_path, path, error_code);
+	if (error_code)
+	{
+		LOG_ERROR(Compiler, "Shader cache failed to rename {0}: {1}", temporary_path, error_code.message());
+		std::filesystem::remove(temporary_path, error_code);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include "../core/Common.h"
+
+struct IDxcUtils;
+struct IDxcBlob;
+
+enum class ShaderCacheBlob : uint32
+{
+	Object = 0,
+	Reflection,
+	RootSignature,
+	Count
+};
+
+struct ShaderCacheEntry
+{
+	// Empty blob when the compiler did not output it
+	ComPtr<IDxcBlob> m_blobs[static_cast<uint32>(ShaderCacheBlob::Count)];
+	// Cost of the original compilation, to report time saved on a hit
+	float64 m_compile_milliseconds = 0.0;
+};
+
+// One file per key in the cache directory, header followed by the blobs
+// Key is expected to cover everything influencing the compiler output, entries are never invalidated otherwise
+class ShaderCache
+{
+public:
+	void Init(const std::string& directory);
+
+	// Single memory-mapped read of the entry file, fails on missing or mismatching file
+	// Utils of the calling thread creates the blobs, safe to call concurrently for different keys
+	bool Load(IDxcUtils* utils, uint64 key, ShaderCacheEntry& out_entry) const;
+	void Store(uint64 key, const ShaderCacheEntry& entry) const;
+private:
+	std::string GetPath(uint64 key) const;
+
+	std::string m_directory;
+};
\ No newline at end of file
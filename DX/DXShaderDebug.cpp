@@ -0,0 +1,218 @@
+#include "DXShaderDebug.h"
+#include "DXContext.h"
+
+#include <bit>
+#include <format>
+
+namespace
+{
+	// Matches the layout of ShaderDebugAppend in Common.hlsl
+	const uint32 g_shader_debug_header_size = 16;
+	const uint32 g_shader_debug_reserved_offset = 0;
+	const uint32 g_shader_debug_dropped_offset = 4;
+	const uint32 g_shader_debug_cap_offset = 8;
+	const uint32 g_shader_debug_max_args = 4;
+
+	enum class ShaderDebugArgType : uint32
+	{
+		Uint = 0,
+		Int,
+		Float
+	};
+
+	const char* g_shader_debug_formats[] =
+	{
+#define SHADER_DEBUG_FORMAT(name, format) format,
+#include "../shaders/ShaderDebugFormats.h"
+#undef SHADER_DEBUG_FORMAT
+	};
+	static_assert(COUNT(g_shader_debug_formats) == static_cast<uint32>(ShaderDebugFormat::Count));
+
+	// Raw word of a record, formatted by its type with the spec of the format string
+	struct ShaderDebugArg
+	{
+		uint32 m_value = 0;
+		ShaderDebugArgType m_type = ShaderDebugArgType::Uint;
+	};
+}
+
+template<>
+struct std::formatter<ShaderDebugArg>
+{
+	std::string_view m_spec;
+
+	constexpr std::format_parse_context::iterator parse(std::format_parse_context& context)
+	{
+		std::format_parse_context::iterator it = context.begin();
+		while (it != context.end() && *it != '}')
+		{
+			++it;
+		}
+		m_spec = std::string_view(context.begin(), it);
+		return it;
+	}
+
+	std::format_context::iterator format(const ShaderDebugArg& arg, std::format_context& context) const
+	{
+		const std::string format = std::format("{{:{0}}}", m_spec);
+		switch (arg.m_type)
+		{
+		case ShaderDebugArgType::Int:
+		{
+			const int32 value = std::bit_cast<int32>(arg.m_value);
+			return std::vformat_to(context.out(), format, std::make_format_args(value));
+		}
+		case ShaderDebugArgType::Float:
+		{
+			const float32 value = std::bit_cast<float32>(arg.m_value);
+			return std::vformat_to(context.out(), format, std::make_format_args(value));
+		}
+		default:
+			return std::vformat_to(context.out(), format, std::make_format_args(arg.m_value));
+		}
+	}
+};
+
+void ShaderDebugChannel::Init(DXContext& dx_context, uint32 byte_cap)
+{
+	m_byte_cap = byte_cap;
+	const uint32 buffer_size = g_shader_debug_header_size + m_byte_cap;
+	m_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, buffer_size);
+	m_buffer.CreateResource(dx_context, "Shader Debug Records");
+	m_uav = dx_context.CreateUAV(m_buffer, GetByteBufferUAVDesc(buffer_size), DescriptorLifetime::Persistent);
+
+	// One slot of records per backbuffer
+	m_readback_buffer.SetResourceInfo(D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_FLAG_NONE, g_backbuffer_count * buffer_size);
+	m_readback_buffer.m_resource_state = D3D12_RESOURCE_STATE_COPY_DEST;
+	m_readback_buffer.CreateResource(dx_context, "Shader Debug Readback");
+}
+
+void ShaderDebugChannel::Begin(DXContext& dx_context)
+{
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_DEST, m_buffer);
+	const D3D12_GPU_VIRTUAL_ADDRESS address = m_buffer.m_resource->GetGPUVirtualAddress();
+	D3D12_WRITEBUFFERIMMEDIATE_PARAMETER header_reset[] =
+	{
+		{ address + g_shader_debug_reserved_offset, 0 },
+		{ address + g_shader_debug_dropped_offset, 0 },
+		{ address + g_shader_debug_cap_offset, m_byte_cap },
+	};
+	dx_context.GetCommandListGraphics()->WriteBufferImmediate(COUNT(header_reset), header_reset, nullptr);
+	dx_context.Transition(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, m_buffer);
+	m_is_recording = true;
+}
+
+uint32 ShaderDebugChannel::GetBindlessIndex() const
+{
+	return m_is_recording ? m_uav.m_bindless_index : UAV{}.m_bindless_index;
+}
+
+void ShaderDebugChannel::Resolve(DXContext& dx_context)
+{
+	if (!m_is_recording)
+	{
+		return;
+	}
+	const uint64 buffer_size = g_shader_debug_header_size + m_byte_cap;
+	dx_context.Transition(D3D12_RESOURCE_STATE_COPY_SOURCE, m_buffer);
+	dx_context.GetCommandListGraphics()->CopyBufferRegion
+	(
+		m_readback_buffer.m_resource.Get(), g_current_buffer_index * buffer_size,
+		m_buffer.m_resource.Get(), 0, buffer_size
+	);
+	m_slot_written[g_current_buffer_index] = true;
+	m_is_recording = false;
+}
+
+void ShaderDebugChannel::Readback()
+{
+	if (!m_slot_written[g_current_buffer_index])
+	{
+		return;
+	}
+	m_slot_written[g_current_buffer_index] = false;
+
+	const uint64 buffer_size = g_shader_debug_header_size + m_byte_cap;
+	const uint64 slot_offset = g_current_buffer_index * buffer_size;
+	const D3D12_RANGE range = { slot_offset, slot_offset + buffer_size };
+	uint8* data = nullptr;
+	m_readback_buffer.m_resource->Map(0, &range, reinterpret_cast<void**>(&data)) >> CHK;
+	const uint8* slot = data + slot_offset;
+
+	uint32 reserved_bytes = 0;
+	memcpy(&reserved_bytes, slot + g_shader_debug_reserved_offset, sizeof(reserved_bytes));
+	memcpy(&m_dropped_count, slot + g_shader_debug_dropped_offset, sizeof(m_dropped_count));
+	// Reservations over the cap were dropped as a whole, every record below the end is complete
+	const uint32 end = (std::min)(reserved_bytes, m_byte_cap);
+	const uint8* records = slot + g_shader_debug_header_size;
+	m_record_count = 0;
+	std::string message;
+	for (uint32 offset = 0; offset + 2 * sizeof(uint32) <= end;)
+	{
+		uint32 words[2 + g_shader_debug_max_args] = {};
+		memcpy(words, records + offset, 2 * sizeof(uint32));
+		const uint32 format = words[0] & 0xFFF;
+		const uint32 arg_count = (std::min)((words[0] >> 12) & 0x7, g_shader_debug_max_args);
+		const bool is_assert = ((words[0] >> 15) & 0x1) != 0;
+		const uint32 record_size = (2 + arg_count) * sizeof(uint32);
+		if (offset + record_size > end)
+		{
+			break;
+		}
+		memcpy(words + 2, records + offset + 2 * sizeof(uint32), arg_count * sizeof(uint32));
+		offset += record_size;
+		++m_record_count;
+
+		ShaderDebugArg args[g_shader_debug_max_args]{};
+		for (uint32 i = 0; i < arg_count; ++i)
+		{
+			args[i] = { .m_value = words[2 + i], .m_type = static_cast<ShaderDebugArgType>((words[0] >> (16 + i * 2)) & 0x3) };
+		}
+		const uint32 thread_x = words[1] & 0xFFFF;
+		const uint32 thread_y = words[1] >> 16;
+		message = std::format("Thread ({0}, {1}) ", thread_x, thread_y);
+		if (format < COUNT(g_shader_debug_formats))
+		{
+			// Unused arguments are ignored by the format
+			try
+			{
+				std::vformat_to(std::back_inserter(message), g_shader_debug_formats[format], std::make_format_args(args[0], args[1], args[2], args[3]));
+			}
+			catch (const std::format_error& error)
+			{
+				message += std::format("invalid shader format \"{0}\": {1}", g_shader_debug_formats[format], error.what());
+			}
+		}
+		else
+		{
+			message += std::format("unknown shader format {0}", format);
+		}
+
+		if (is_assert)
+		{
+			LOG_ERROR(Shader, "Assert failed: {0}", message);
+		}
+		else
+		{
+			LOG_INFO(Shader, message);
+		}
+	}
+	if (m_dropped_count > 0)
+	{
+		LOG_WARNING(Shader, "{0} records dropped over the cap of {1} bytes", m_dropped_count, m_byte_cap);
+	}
+
+	// Nothing written by CPU
+	const D3D12_RANGE write_range = { 0, 0 };
+	m_readback_buffer.m_resource->Unmap(0, &write_range);
+}
+
+uint32 ShaderDebugChannel::GetRecordCount() const
+{
+	return m_record_count;
+}
+
+uint32 ShaderDebugChannel::GetDroppedCount() const
+{
+	return m_dropped_count;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include "../core/Common.h"
+#include "DXCommon.h"
+#include "DXResource.h"
+
+class DXContext;
+
+// Ids of the shader Print and Assert formats, in the order of shaders/ShaderDebugFormats.h
+enum class ShaderDebugFormat : uint32
+{
+#define SHADER_DEBUG_FORMAT(name, format) name,
+#include "../shaders/ShaderDebugFormats.h"
+#undef SHADER_DEBUG_FORMAT
+	Count
+};
+
+// Default bytes of records kept per frame, later records are counted as dropped
+static const uint32 g_shader_debug_byte_cap = 64 * 1024;
+
+// GPU side of the shader Print and Assert library of Common.hlsl
+// Records are copied per backbuffer slot and decoded once the fence of that slot completed, the CPU never waits on them
+class ShaderDebugChannel
+{
+public:
+	void Init(DXContext& dx_context, uint32 byte_cap = g_shader_debug_byte_cap);
+
+	// Reset the header for the frame being recorded, shaders may append until Resolve
+	void Begin(DXContext& dx_context);
+	// Bindless index of the record buffer between Begin and Resolve, INVALID_BINDLESS_INDEX otherwise so shaders skip their calls
+	uint32 GetBindlessIndex() const;
+	// Record the copy of the records of this frame into the slot of the current backbuffer index
+	void Resolve(DXContext& dx_context);
+	// Decode the slot of the current backbuffer index and log its records, requires the fence of that slot to be completed
+	void Readback();
+
+	uint32 GetRecordCount() const;
+	uint32 GetDroppedCount() const;
+private:
+	DXResource m_buffer;
+	DXResource m_readback_buffer;
+	UAV m_uav;
+	uint32 m_byte_cap = 0;
+	bool m_is_recording = false;
+	bool m_slot_written[g_backbuffer_count] = {};
+	// Last decoded frame
+	uint32 m_record_count = 0;
+	uint32 m_dropped_count = 0;
+};
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "DXStreamer.h"
+
+void Streamer::Init(DXContext& dx_context, const StreamSchedulerDesc& desc)
+{
+	// Slots hold texture rows, their offsets must be valid placement offsets
+	ASSERT(desc.m_chunk_size % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT == 0);
+	m_scheduler.Init(desc);
+
+	m_staging.SetResourceInfo(D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_FLAG_NONE, m_scheduler.GetStagingSize());
+	m_staging.CreateResource(dx_context, "Streamer Staging");
+	// Upload heaps can stay mapped, write combined so chunks are only ever written sequentially
+	void* staging_data = nullptr;
+	m_staging.m_resource->Map(0, nullptr, &staging_data) >> CHK;
+	m_staging_data = static_cast<uint8*>(staging_data);
+
+	for (StreamBatch& batch : m_batches)
+	{
+		dx_context.CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, batch.m_allocator);
+		NAME_DX_OBJECT(batch.m_allocator.m_allocator, "Streamer CommandAllocator");
+	}
+	dx_context.CreateCommandList(D3D12_COMMAND_LIST_TYPE_COPY, m_batches[0].m_allocator, m_command_list);
+	NAME_DX_OBJECT(m_command_list.m_list, "Streamer CommandList");
+	dx_context.CreateFence(m_fence);
+	NAME_DX_OBJECT(m_fence.m_gpu, "Streamer Fence");
+}
+
+void Streamer::Shutdown(DXContext& dx_context)
+{
+	std::vector<StreamRequestId> requests{};
+	for (const auto& [request, target] : m_targets)
+	{
+		requests.push_back(request);
+	}
+	for (StreamRequestId request : requests)
+	{
+		m_scheduler.Cancel(request);
+	}
+	for (uint32 i = 0; i < s_batch_count; ++i)
+	{
+		if (m_batches[i].m_is_in_flight)
+		{
+			dx_context.Wait(m_fence, i);
+		}
+	}
+	Update(dx_context);
+	ASSERT(m_targets.empty());
+	m_staging.m_resource->Unmap(0, nullptr);
+	m_staging_data = nullptr;
+	CloseHandle(m_fence.m_event);
+}
+
+StreamRequestId Streamer::LoadBuffer(DXContext& dx_context, const std::string& path, int32 priority, DXResource& out_buffer, StreamCallback callback)
+{
+	StreamTarget target{};
+	if (!target.m_file.Open(path) || target.m_file.GetSize() == 0)
+	{
+		LOG_ERROR(Memory, "Streamer failed to map {0}", path);
+		return g_invalid_stream_request;
+	}
+	const uint64 size_in_bytes = target.m_file.GetSize();
+	out_buffer.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE, size_in_bytes);
+	out_buffer.CreateResource(dx_context, path);
+	target.m_resource = out_buffer.m_resource.Get();
+	return Submit(std::move(target), size_in_bytes, 1, priority, std::move(callback));
+}
+
+StreamRequestId Streamer::LoadTexture
+(
+	DXContext& dx_context, const std::string& path,
+	uint32 width, uint32 height, DXGI_FORMAT format,
+	int32 priority, DXTextureResource& out_texture, StreamCallback callback
+)
+{
+	StreamTarget target{};
+	if (!target.m_file.Open(path))
+	{
+		LOG_ERROR(Memory, "Streamer failed to map {0}", path);
+		return g_invalid_stream_request;
+	}
+	out_texture.SetResourceInfo(D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_RESOURCE_FLAG_NONE, width, height, format);
+	// Rows of blocks for block compressed formats
+	uint64 staging_size = 0;
+	dx_context.GetDevice()->GetCopyableFootprints(&out_texture.m_resource_desc, 0, 1, 0, &target.m_footprint, &target.m_row_count, &target.m_row_size, &staging_size);
+	if (target.m_file.GetSize() != target.m_row_count * target.m_row_size)
+	{
+		LOG_ERROR(Memory, "Streamer {0} is {1} bytes, expected {2} rows of {3} bytes", path, target.m_file.GetSize(), target.m_row_count, target.m_row_size);
+		return g_invalid_stream_request;
+	}
+	out_texture.CreateResource(dx_context, path);
+	target.m_resource = out_texture.m_resource.Get();
+	const uint64 row_pitch = target.m_footprint.Footprint.RowPitch;
+	const uint64 size_in_bytes = target.m_row_count * row_pitch;
+	return Submit(std::move(target), size_in_bytes, row_pitch, priority, std::move(callback));
+}
+
+StreamRequestId Streamer::Submit(StreamTarget&& target, uint64 size_in_bytes, uint64 granularity, int32 priority, StreamCallback callback)
+{
+	// Target dropped before the caller is told, the callback may reuse the destination
+	const StreamRequestId request = m_scheduler.Submit
+	(
+		size_in_bytes, granularity, priority,
+		[this, callback = std::move(callback)](StreamRequestId request, StreamStatus status)
+		{
+			m_targets.erase(request);
+			if (callback)
+			{
+				callback(request, status);
+			}
+		}
+	);
+	if (request == g_invalid_stream_request)
+	{
+		LOG_ERROR(Memory, "Streamer row of {0} bytes is larger than a chunk", granularity);
+		return request;
+	}
+	m_targets.emplace(request, std::move(target));
+	return request;
+}
+
+bool Streamer::Cancel(StreamRequestId request)
+{
+	return m_scheduler.Cancel(request);
+}
+
+void Streamer::RecordChunk(const StreamChunk& chunk, uint8* staging_data)
+{
+	const StreamTarget& target = m_targets.at(chunk.m_request);
+	const uint64 staging_offset = m_scheduler.GetStagingOffset(chunk.m_staging_slot);
+	if (target.m_row_count == 0)
+	{
+		memcpy(staging_data, target.m_file.GetData() + chunk.m_offset, chunk.m_size);
+		m_command_list.m_list->CopyBufferRegion(target.m_resource, chunk.m_offset, m_staging.m_resource.Get(), staging_offset, chunk.m_size);
+		return;
+	}
+
+	// Chunks are whole rows, repitched from the file to the aligned staging rows
+	const uint64 row_pitch = target.m_footprint.Footprint.RowPitch;
+	const uint32 first_row = (uint32)(chunk.m_offset / row_pitch);
+	const uint32 row_count = (uint32)(chunk.m_size / row_pitch);
+	for (uint32 row = 0; row < row_count; ++row)
+	{
+		memcpy(staging_data + row * row_pitch, target.m_file.GetData() + (first_row + row) * target.m_row_size, target.m_row_size);
+	}
+	// Texel rows per row, 4 for block compressed formats
+	const uint32 row_height = target.m_footprint.Footprint.Height / target.m_row_count;
+	const D3D12_TEXTURE_COPY_LOCATION destination
+	{
+		.pResource = target.m_resource,
+		.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+		.SubresourceIndex = 0,
+	};
+	D3D12_TEXTURE_COPY_LOCATION source
+	{
+		.pResource = m_staging.m_resource.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+		.PlacedFootprint = target.m_footprint,
+	};
+	source.PlacedFootprint.Offset = staging_offset;
+	source.PlacedFootprint.Footprint.Height = row_count * row_height;
+	m_command_list.m_list->CopyTextureRegion(&destination, 0, first_row * row_height, 0, &source, nullptr);
+}
+
+void Streamer::Update(DXContext& dx_context)
+{
+	// Oldest first, callbacks fire in submission order
+	for (uint32 i = 0; i < s_batch_count; ++i)
+	{
+		const uint32 batch_index = (m_next_batch + i) % s_batch_count;
+		StreamBatch& batch = m_batches[batch_index];
+		if (batch.m_is_in_flight && dx_context.IsComplete(m_fence, batch_index))
+		{
+			for (const StreamChunk& chunk : batch.m_chunks)
+			{
+				m_scheduler.Retire(chunk);
+			}
+			batch.m_chunks.clear();
+			batch.m_is_in_flight = false;
+		}
+	}
+
+	StreamBatch& batch = m_batches[m_next_batch];
+	if (batch.m_is_in_flight || m_scheduler.Schedule(batch.m_chunks) == 0)
+	{
+		return;
+	}
+	batch.m_allocator.m_allocator->Reset() >> CHK;
+	m_command_list.m_list->Reset(batch.m_allocator.m_allocator.Get(), nullptr) >> CHK;
+	for (const StreamChunk& chunk : batch.m_chunks)
+	{
+		RecordChunk(chunk, m_staging_data + m_scheduler.GetStagingOffset(chunk.m_staging_slot));
+	}
+	m_command_list.m_list->Close() >> CHK;
+	const CommandQueue queue_copy = dx_context.GetCommandQueueCopy();
+	ID3D12CommandList* command_lists[] = { m_command_list.m_list.Get() };
+	queue_copy.m_queue->ExecuteCommandLists(COUNT(command_lists), command_lists);
+	dx_context.Signal(queue_copy, m_fence, m_next_batch);
+	batch.m_is_in_flight = true;
+	m_next_batch = (m_next_batch + 1) % s_batch_count;
+}
+
+uint32 Streamer::GetRequestCount() const
+{
+	return m_scheduler.GetRequestCount();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include "../core/Common.h"
+#include "../core/MappedFile.h"
+#include "../core/StreamScheduler.h"
+#include "DXContext.h"
+#include "DXResource.h"
+
+#include <unordered_map>
+
+// Streams files into placed resources through the copy queue
+// Files are mapped, chunks are copied from the mapping into a persistently mapped upload buffer of fixed size
+// Resources stay in COMMON, the copy queue promotes them to COPY_DEST and they decay back once the copy completed
+// Callbacks run in Update once the copy queue fence passed, any later graphics submission sees the data
+class Streamer
+{
+public:
+	void Init(DXContext& dx_context, const StreamSchedulerDesc& desc);
+	// Waits for the copies in flight, pending requests are cancelled
+	void Shutdown(DXContext& dx_context);
+
+	// Whole file into a new default heap buffer, out_buffer must outlive the request
+	StreamRequestId LoadBuffer(DXContext& dx_context, const std::string& path, int32 priority, DXResource& out_buffer, StreamCallback callback);
+	// Tightly packed rows of a single subresource 2D texture, out_texture must outlive the request
+	StreamRequestId LoadTexture
+	(
+		DXContext& dx_context, const std::string& path,
+		uint32 width, uint32 height, DXGI_FORMAT format,
+		int32 priority, DXTextureResource& out_texture, StreamCallback callback
+	);
+	bool Cancel(StreamRequestId request);
+
+	// Retires the completed batches and submits the next one, once per frame
+	void Update(DXContext& dx_context);
+
+	uint32 GetRequestCount() const;
+private:
+	// Source and destination of a request, the scheduler works in the staging layout
+	struct StreamTarget
+	{
+		MappedFile m_file;
+		ID3D12Resource* m_resource;
+		// Buffer when m_row_count is 0
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_footprint;
+		uint32 m_row_count;
+		// Bytes of a row in the file, m_footprint.Footprint.RowPitch in staging
+		uint64 m_row_size;
+	};
+
+	StreamRequestId Submit(StreamTarget&& target, uint64 size_in_bytes, uint64 granularity, int32 priority, StreamCallback callback);
+	void RecordChunk(const StreamChunk& chunk, uint8* staging_data);
+
+	// One batch per command allocator, the fence index of a batch is its index
+	struct StreamBatch
+	{
+		CommandAllocator m_allocator;
+		std::vector<StreamChunk> m_chunks;
+		bool m_is_in_flight = false;
+	};
+	static const uint32 s_batch_count = g_backbuffer_count;
+
+	StreamScheduler m_scheduler;
+	std::unordered_map<StreamRequestId, StreamTarget> m_targets;
+	DXResource m_staging;
+	uint8* m_staging_data = nullptr;
+	CommandList m_command_list;
+	StreamBatch m_batches[s_batch_count];
+	uint32 m_next_batch = 0;
+	Fence m_fence;
+};
\ No newline at end of file
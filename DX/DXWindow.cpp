@@ -88,8 +88,12 @@ LRESULT DXWindow::OnWindowMessage(HWND handle, UINT msg, WPARAM wParam, LPARAM l
 		pWindow = reinterpret_cast<DXWindow*>(ptr);
 	}
 
-	if (ImGui_ImplWin32_WndProcHandler(handle, msg, wParam, lParam))
-		return true;
+	{
+		// Messages sent before WM_CREATE have no window yet, ImGui is not initialized then either
+		std::unique_lock<std::recursive_mutex> lock = pWindow ? std::unique_lock(pWindow->m_ui_mutex) : std::unique_lock<std::recursive_mutex>();
+		if (ImGui_ImplWin32_WndProcHandler(handle, msg, wParam, lParam))
+			return true;
+	}
 
 	switch (msg)
 	{
@@ -100,10 +104,13 @@ LRESULT DXWindow::OnWindowMessage(HWND handle, UINT msg, WPARAM wParam, LPARAM l
 		if
 		(
 			lParam &&
-			(reqWidth != pWindow->m_width || reqHeight != pWindow->m_height)
+			(reqWidth != pWindow->m_client_width || reqHeight != pWindow->m_client_height)
 		)
 		{
-			pWindow->m_should_resize = true;
+			// Render thread resizes the swap chain when it reaches the frame with this request
+			pWindow->m_client_width = reqWidth;
+			pWindow->m_client_height = reqHeight;
+			++pWindow->m_resize_request;
 		}
 
 		// Switch to maximize state
@@ -152,8 +159,8 @@ void DXWindow::Init
 	m_window_mode = WindowMode::Normal;
 	m_window_mode_request = m_window_mode;
 
-	m_width = m_windowed_width = window_desc.m_width;
-	m_height = m_windowed_height =  window_desc.m_height;
+	m_width = m_client_width = m_windowed_width = window_desc.m_width;
+	m_height = m_client_height = m_windowed_height =  window_desc.m_height;
 	m_windowed_origin_x = window_desc.m_origin_x;
 	m_windowed_origin_y = window_desc.m_origin_y;
 
@@ -239,7 +246,8 @@ void DXWindow::Update()
 		DispatchMessageW(&msg);
 	}
 
-	if (m_window_mode_request != m_window_mode)
+	// Mode changes resize the window, wait for the render thread to catch up with the previous resize first
+	if (m_window_mode_request != m_window_mode && !IsResizePending())
 	{
 		m_window_mode = m_window_mode_request;
 		ApplyWindowStyle();
@@ -249,8 +257,8 @@ void DXWindow::Update()
 	// Store windowed size after apply, to restore later on
 	if (m_window_mode_request == WindowMode::Normal)
 	{
-		m_windowed_width = m_width;
-		m_windowed_height = m_height;
+		m_windowed_width = m_client_width;
+		m_windowed_height = m_client_height;
 		RECT rect{};
 		bool result = GetWindowRect(m_handle, &rect);
 		ASSERT(result);
@@ -259,22 +267,64 @@ void DXWindow::Update()
 	}
 }
 
-void DXWindow::Resize()
+WindowSnapshot DXWindow::GetSnapshot() const
 {
-	RECT rt{};
-	if (GetClientRect(m_handle, &rt))
+	return WindowSnapshot
 	{
-		ReleaseBuffers();
+		.m_width = m_client_width,
+		.m_height = m_client_height,
+		.m_resize_request = m_resize_request,
+	};
+}
 
-		m_width = rt.right - rt.left;
-		m_height = rt.bottom - rt.top;
-		DXGI_SWAP_CHAIN_DESC1 desc{};
-		m_swap_chain->GetDesc1(&desc);
-		m_swap_chain->ResizeBuffers(GetBackBufferCount(), GetWidth(), GetHeight(), desc.Format, desc.Flags) >> CHK;
-		m_should_resize = false;
+bool DXWindow::IsResizePending() const
+{
+	return m_resize_acknowledged.load(std::memory_order_acquire) != m_resize_request;
+}
 
-		GetBuffers();
+bool DXWindow::UpdateResize(const DXContext& dx_context, const WindowSnapshot& snapshot)
+{
+	if (snapshot.m_resize_request == m_resize_applied)
+	{
+		return true;
+	}
+	// Size of the snapshot rather than the current client rect, the window may already be resized again
+	// Requests in between are skipped, only the latest size is applied
+	if (snapshot.m_width != m_width || snapshot.m_height != m_height)
+	{
+		bool is_released = true;
+		for (uint32 i = 0; i < GetBackBufferCount(); ++i)
+		{
+			if (m_buffers[i].m_resource && dx_context.IsComplete(dx_context.m_fence, i))
+			{
+				m_buffers[i].m_resource = nullptr;
+			}
+			is_released &= m_buffers[i].m_resource == nullptr;
+		}
+		if (!is_released)
+		{
+			return false;
+		}
+		Resize(snapshot);
+		// Seems like back buffer index needs to be updated on resize
+		// Always sets it back 0
+		UpdateBackBufferIndex();
 	}
+	m_resize_applied = snapshot.m_resize_request;
+	m_resize_acknowledged.store(m_resize_applied, std::memory_order_release);
+	return true;
+}
+
+// Every back buffer reference must be released
+void DXWindow::Resize(const WindowSnapshot& snapshot)
+{
+	m_width = snapshot.m_width;
+	m_height = snapshot.m_height;
+	DXGI_SWAP_CHAIN_DESC1 desc{};
+	m_swap_chain->GetDesc1(&desc);
+	m_swap_chain->ResizeBuffers(GetBackBufferCount(), GetWidth(), GetHeight(), desc.Format, desc.Flags) >> CHK;
+
+	GetBuffers();
 }
 
 void DXWindow::SetWindowModeRequest(WindowMode window_mode)
@@ -366,11 +416,6 @@ bool DXWindow::ShouldClose() const
 	return m_should_close;
 }
 
-bool DXWindow::ShouldResize()
-{
-	return m_should_resize;
-}
-
 static const DXGI_FORMAT dxgi_format_sdr = DXGI_FORMAT_R8G8B8A8_UNORM;
 static const DXGI_FORMAT dxgi_format_hdr = DXGI_FORMAT_R10G10B10A2_UNORM;
 
@@ -528,5 +573,4 @@ void DXWindow::ReleaseBuffers()
 	{
 		m_buffers[i].m_resource = nullptr;
 	}
-}
-
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "../core/Common.h"
 #include <dxgiformat.h>
 #include "DXContext.h"
+#include <atomic>
+#include <mutex>
 
 class DXContext;
 class DXWindowManager;
@@ -56,6 +58,15 @@ enum class WindowMode
 	Count
 };
 
+// Copy of the window state taken by the main thread for one frame
+struct WindowSnapshot
+{
+	uint32 m_width;
+	uint32 m_height;
+	// Incremented by the main thread on every size change, acknowledged by the render thread once resized
+	uint32 m_resize_request;
+};
+
 enum D3D12_RESOURCE_STATES;
 class DXResource;
 
@@ -102,9 +113,15 @@ public:
 
 	void Close();
 
+	// Main thread, pumps messages and applies window mode requests once no resize is pending
 	void Update();
+	WindowSnapshot GetSnapshot() const;
+	bool IsResizePending() const;
 
-	void Resize();
+	// Render thread, applies the resize of the snapshot without flushing the queue
+	// Back buffers are released one by one as the frame that last used them completes
+	// False while some are still in flight, nothing may be recorded to the back buffers then
+	bool UpdateResize(const DXContext& dx_context, const WindowSnapshot& snapshot);
 
 	void SetWindowModeRequest(WindowMode window_mode);
 	WindowMode GetWindowModeRequest() const;
@@ -113,8 +130,6 @@ public:
 
 	bool ShouldClose() const;
 
-	bool ShouldResize();
-
 	uint32 GetWidth() const { return m_width; }
 	uint32 GetHeight() const { return m_height; }
 
@@ -129,6 +144,9 @@ public:
 	Input input;
 	// TODO dont make this public
 	bool m_should_close = false;
+	// ImGui input is written by the message handler on the main thread and read by the render thread building the UI
+	// Recursive because the handler can send messages to the same window
+	std::recursive_mutex m_ui_mutex;
 
 private:
 	void ApplyWindowStyle();
@@ -137,12 +155,20 @@ private:
 	void CreateSwapChain(const DXContext& dx_context);
 
 	void GetBuffers();
+	void Resize(const WindowSnapshot& snapshot);
 
 	void ReleaseBuffers();
 public:
 	HWND m_handle;
 private:
-	bool m_should_resize = false;
+	// Main thread
+	uint32 m_client_width;
+	uint32 m_client_height;
+	uint32 m_resize_request = 0;
+	// Render thread
+	uint32 m_resize_applied = 0;
+	// Handshake, written by the render thread and read by the main thread
+	std::atomic<uint32> m_resize_acknowledged = 0;
 
 	WindowMode m_window_mode;
 	WindowMode m_window_mode_request;
@@ -164,4 +190,4 @@ private:
 };
 
 // Declaration
-extern uint32 g_current_buffer_index;
+extern uint32 g_current_buffer_index;
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "PSO.h"
+#include "../core/Hash.h"
+#include <dxcapi.h>
 
 PSO CreatePSO(DXContext& dx_context, CD3DX12_STATE_OBJECT_DESC& so_desc, const std::string& program_name)
 {
@@ -8,7 +10,66 @@ PSO CreatePSO(DXContext& dx_context, CD3DX12_STATE_OBJECT_DESC& so_desc, const s
 
 	ComPtr<ID3D12StateObjectProperties1> state_object_properties;
 	pso.m_so.As(&state_object_properties) >> CHK;
-	const std::wstring& program_wname = std::to_wstring(program_name);
-	pso.m_program_id = state_object_properties->GetProgramIdentifier(program_wname.c_str());
+	pso.m_program_id = state_object_properties->GetProgramIdentifier(DXWideName(program_name).m_chars);
 	return pso;
+}
+
+bool TryCreatePSO(DXContext& dx_context, CD3DX12_STATE_OBJECT_DESC& so_desc, const std::string& program_name, PSO& out_pso)
+{
+	PSO pso{};
+	HRESULT result = dx_context.GetDevice()->CreateStateObject(so_desc, IID_PPV_ARGS(&pso.m_so));
+	if (FAILED(result))
+	{
+		LOG_ERROR(Compiler, "Failed to create state object {0}: {1}", program_name, RemapHResult(result));
+		return false;
+	}
+	NAME_DX_OBJECT(pso.m_so, "State Object");
+
+	ComPtr<ID3D12StateObjectProperties1> state_object_properties;
+	pso.m_so.As(&state_object_properties) >> CHK;
+	pso.m_program_id = state_object_properties->GetProgramIdentifier(DXWideName(program_name).m_chars);
+	out_pso = pso;
+	return true;
+}
+
+bool TryCreatePSO(DXContext& dx_context, const D3D12_PIPELINE_STATE_STREAM_DESC& stream_desc, uint64 cache_key, const std::string& name, PSO& out_pso)
+{
+	PSO pso{};
+	HRESULT result = dx_context.m_pipeline_cache.CreatePipelineState(stream_desc, cache_key, pso.m_pipeline_state);
+	if (FAILED(result))
+	{
+		LOG_ERROR(Compiler, "Failed to create pipeline state {0}: {1}", name, RemapHResult(result));
+		return false;
+	}
+	NAME_DX_OBJECT(pso.m_pipeline_state, name);
+	out_pso = pso;
+	return true;
+}
+
+uint64 GetPipelineCacheKey(const std::vector<Shader>& shaders, const void* description, uint64 description_size)
+{
+	uint64 key = g_hash_seed;
+	for (const Shader& shader : shaders)
+	{
+		key = Hash64(shader.m_blob->GetBufferPointer(), shader.m_blob->GetBufferSize(), key);
+	}
+	return Hash64(description, description_size, key);
+}
+
+void SetPSO(ID3D12GraphicsCommandList10* command_list, const PSO& pso)
+{
+	if (pso.m_pipeline_state)
+	{
+		command_list->SetPipelineState(pso.m_pipeline_state.Get());
+		return;
+	}
+	D3D12_SET_PROGRAM_DESC program_desc
+	{
+		.Type = D3D12_PROGRAM_TYPE_GENERIC_PIPELINE,
+		.GenericPipeline =
+		{
+			.ProgramIdentifier = pso.m_program_id
+		},
+	};
+	command_list->SetProgram(&program_desc);
 }
\ No newline at end of file
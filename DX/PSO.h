@@ -1,12 +1,41 @@
 #pragma once
 #include "DXCommon.h"
 #include "DXContext.h"
+#include <d3dx12/d3dx12_pipeline_state_stream.h>
 
 struct PSO
 {
 	ComPtr<ID3D12StateObject> m_so;
 	D3D12_PROGRAM_IDENTIFIER m_program_id;
+	// Set instead of the state object when created from a pipeline stream through the pipeline cache
+	ComPtr<ID3D12PipelineState> m_pipeline_state;
+};
+
+// Pipeline streams of the classic pipeline states, subobjects left out take their default
+struct ComputePipelineStream
+{
+	CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE m_root_signature;
+	CD3DX12_PIPELINE_STATE_STREAM_CS m_cs;
+};
+
+struct GraphicsPipelineStream
+{
+	CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE m_root_signature;
+	CD3DX12_PIPELINE_STATE_STREAM_VS m_vs;
+	CD3DX12_PIPELINE_STATE_STREAM_PS m_ps;
+	CD3DX12_PIPELINE_STATE_STREAM_PRIMITIVE_TOPOLOGY m_topology;
+	CD3DX12_PIPELINE_STATE_STREAM_RENDER_TARGET_FORMATS m_render_target_formats;
 };
 
 PSO CreatePSO(DXContext& dx_context, CD3DX12_STATE_OBJECT_DESC& so_desc, const std::string& program_name);
+// Logs and fails instead of breaking, for state objects rebuilt at runtime
+bool TryCreatePSO(DXContext& dx_context, CD3DX12_STATE_OBJECT_DESC& so_desc, const std::string& program_name, PSO& out_pso);
+
+// Classic pipeline state loaded from or stored in the pipeline cache of the context
+// Key has to cover the shader bytecode and every fixed function state of the stream
+bool TryCreatePSO(DXContext& dx_context, const D3D12_PIPELINE_STATE_STREAM_DESC& stream_desc, uint64 cache_key, const std::string& name, PSO& out_pso);
+// Hash of the bytecode of the shaders followed by the description of the remaining subobjects
+uint64 GetPipelineCacheKey(const std::vector<Shader>& shaders, const void* description, uint64 description_size);
 
+// Binds either the pipeline state or the generic program of the state object
+void SetPSO(ID3D12GraphicsCommandList10* command_list, const PSO& pso);
\ No newline at end of file
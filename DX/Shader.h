@@ -1,27 +1,17 @@
 #pragma once
 
 #include "../core/Common.h"
+#include "ShaderDesc.h"
 
 struct IDxcBlob;
 
-enum class ShaderType
-{
-	VERTEX_SHADER = 0,
-	PIXEL_SHADER,
-	COMPUTE_SHADER,
-	LIB_SHADER, // For workgraphs and raytracing shaders
-	NUMBER_SHADER_TYPES,
-};
-
-struct ShaderDesc
-{
-	ShaderType m_type;
-	std::string m_file_name;
-	std::string m_entry_point_name;
-};
-
 struct Shader
 {
 	ComPtr<IDxcBlob> m_blob;
 	ShaderDesc m_shader_desc;
+	// Parts split out by the compiler, empty when not available
+	ComPtr<IDxcBlob> m_reflection_blob;
+	ComPtr<IDxcBlob> m_root_signature_blob;
+	// Normalized paths of the source file and every file it includes
+	std::vector<std::string> m_dependencies;
 };
\ No newline at end of file
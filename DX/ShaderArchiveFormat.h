@@ -0,0 +1,117 @@
+#pragma once
+// No platform dependency, written by the ShaderBuild tool and memory-mapped by ShaderArchive
+#include "../core/Hash.h"
+#include "ShaderDesc.h"
+
+// "DXSA"
+static const uint32 g_shader_archive_magic = 0x41535844;
+// Bump when any struct below changes
+static const uint32 g_shader_archive_version = 1;
+// Blobs are aligned so bytecode can be handed out of the mapping as is
+static const uint64 g_shader_archive_alignment = 16;
+static const uint32 g_shader_archive_blob_count = 3;
+
+enum class ShaderArchiveBlob : uint32
+{
+	Object = 0,
+	Reflection,
+	RootSignature,
+};
+
+// Layout: header, entries sorted by key, string table, blobs
+struct ShaderArchiveHeader
+{
+	uint32 m_magic;
+	uint32 m_version;
+	uint32 m_entry_count;
+	// Built with -Od -Zi, matches a debug DXCompiler
+	uint32 m_debug;
+	// Shader model of the target profiles as "6_8", the runtime skips the archive for another model
+	char m_shader_model[8];
+	uint64 m_string_table_offset;
+	uint64 m_string_table_size;
+	uint64 m_file_size;
+};
+
+struct ShaderArchiveRange
+{
+	uint64 m_offset;
+	uint64 m_size;
+};
+
+struct ShaderArchiveEntry
+{
+	uint64 m_key;
+	// Content of the source and every included file, the runtime skips stale entries when sources are present
+	uint64 m_source_hash;
+	// Source hash with the compiler version and arguments, the tool only recompiles entries whose inputs changed
+	uint64 m_input_hash;
+	// Readable permutation name in the string table
+	ShaderArchiveRange m_name;
+	// Paths relative to the shader directory separated by '\n' in the string table, source first
+	ShaderArchiveRange m_dependencies;
+	// Empty range when the compiler did not output the blob
+	ShaderArchiveRange m_blobs[g_shader_archive_blob_count];
+};
+
+// Range within [0, size), compared without adding the offset so corrupt values cannot wrap
+inline bool IsShaderArchiveRangeValid(const ShaderArchiveRange& range, uint64 size)
+{
+	return range.m_offset <= size && range.m_size <= size - range.m_offset;
+}
+
+// Header, entry table, string table and every range of every entry lie within the file
+// Truncated, corrupt or foreign archives are rejected before any offset out of them is used
+inline bool IsShaderArchiveValid(const uint8* data, uint64 size)
+{
+	if (size < sizeof(ShaderArchiveHeader))
+	{
+		return false;
+	}
+	const ShaderArchiveHeader* header = reinterpret_cast<const ShaderArchiveHeader*>(data);
+	if
+	(
+		header->m_magic != g_shader_archive_magic || header->m_version != g_shader_archive_version || header->m_file_size != size ||
+		header->m_entry_count > (size - sizeof(ShaderArchiveHeader)) / sizeof(ShaderArchiveEntry) ||
+		!IsShaderArchiveRangeValid({ header->m_string_table_offset, header->m_string_table_size }, size)
+	)
+	{
+		return false;
+	}
+	const ShaderArchiveEntry* entries = reinterpret_cast<const ShaderArchiveEntry*>(data + sizeof(ShaderArchiveHeader));
+	for (uint32 i = 0; i < header->m_entry_count; ++i)
+	{
+		// Names and dependencies are relative to the string table, blobs to the file
+		if (!IsShaderArchiveRangeValid(entries[i].m_name, header->m_string_table_size) || !IsShaderArchiveRangeValid(entries[i].m_dependencies, header->m_string_table_size))
+		{
+			return false;
+		}
+		for (const ShaderArchiveRange& blob : entries[i].m_blobs)
+		{
+			if (!IsShaderArchiveRangeValid(blob, size))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Identifies a compilation independently of the compiler, what the runtime looks up
+inline uint64 GetShaderArchiveKey(const ShaderDesc& shader_desc)
+{
+	uint64 key = Hash64(static_cast<uint32>(shader_desc.m_type));
+	key = Hash64(shader_desc.m_file_name, key);
+	key = Hash64(shader_desc.m_entry_point_name, key);
+	for (const std::string& define : shader_desc.m_defines)
+	{
+		key = Hash64(define, key);
+	}
+	return key;
+}
+
+// Folds one dependency into the source hash, dependencies are hashed in the order they are stored
+inline uint64 HashShaderDependency(const std::string& relative_path, const void* data, uint64 size, uint64 seed)
+{
+	return Hash64(data, size, Hash64(relative_path, seed));
+}
\ No newline at end of file
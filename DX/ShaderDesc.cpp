@@ -0,0 +1,80 @@
+#include "ShaderDesc.h"
+
+static const std::pair<ShaderType, std::string> g_shader_type_map_string[] =
+{
+	{ShaderType::VERTEX_SHADER, "vs"},
+	{ShaderType::PIXEL_SHADER, "ps"},
+	{ShaderType::COMPUTE_SHADER, "cs"},
+	{ShaderType::LIB_SHADER, "lib"},
+};
+
+std::string GetShaderTypeString(const ShaderType& shader_type)
+{
+	return g_shader_type_map_string[static_cast<int32>(shader_type)].second;
+}
+
+uint32 GetPermutationCount(const ShaderPermutationDesc& desc)
+{
+	uint32 permutation_count = 1;
+	for (const ShaderPermutationAxis& axis : desc.m_axes)
+	{
+		permutation_count *= (uint32)axis.m_values.size();
+	}
+	return permutation_count;
+}
+
+ShaderPermutationKey GetPermutationKey(const ShaderPermutationDesc& desc, const ShaderPermutationValues& values)
+{
+	ShaderPermutationKey key = 0;
+	uint32 stride = 1;
+	for (uint32 i = 0; i < desc.m_axes.size(); ++i)
+	{
+		key += values[i] * stride;
+		stride *= (uint32)desc.m_axes[i].m_values.size();
+	}
+	return key;
+}
+
+ShaderPermutationValues GetPermutationValues(const ShaderPermutationDesc& desc, ShaderPermutationKey key)
+{
+	ShaderPermutationValues values(desc.m_axes.size());
+	for (uint32 i = 0; i < desc.m_axes.size(); ++i)
+	{
+		const uint32 value_count = (uint32)desc.m_axes[i].m_values.size();
+		values[i] = key % value_count;
+		key /= value_count;
+	}
+	return values;
+}
+
+bool IsPermutationPruned(const ShaderPermutationDesc& desc, ShaderPermutationKey key)
+{
+	return desc.m_filter && !desc.m_filter(GetPermutationValues(desc, key));
+}
+
+ShaderDesc GetPermutationShaderDesc(const ShaderPermutationDesc& desc, ShaderPermutationKey key)
+{
+	ShaderDesc shader_desc = desc.m_shader_desc;
+	const ShaderPermutationValues values = GetPermutationValues(desc, key);
+	for (uint32 i = 0; i < desc.m_axes.size(); ++i)
+	{
+		const ShaderPermutationAxis& axis = desc.m_axes[i];
+		for (uint32 value = 0; value < axis.m_values.size(); ++value)
+		{
+			shader_desc.m_defines.push_back(axis.m_name + "_" + axis.m_values[value] + "=" + std::to_string(value));
+		}
+		shader_desc.m_defines.push_back(axis.m_name + "=" + std::to_string(values[i]));
+	}
+	return shader_desc;
+}
+
+std::string GetPermutationName(const ShaderPermutationDesc& desc, ShaderPermutationKey key)
+{
+	std::string name = desc.m_shader_desc.m_file_name;
+	const ShaderPermutationValues values = GetPermutationValues(desc, key);
+	for (uint32 i = 0; i < desc.m_axes.size(); ++i)
+	{
+		name += " " + desc.m_axes[i].m_name + "=" + desc.m_axes[i].m_values[values[i]];
+	}
+	return name;
+}
\ No newline at end of file
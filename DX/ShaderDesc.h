@@ -0,0 +1,60 @@
+#pragma once
+// No platform dependency, shared with the offline shader build tool
+#include "../core/Types.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+enum class ShaderType
+{
+	VERTEX_SHADER = 0,
+	PIXEL_SHADER,
+	COMPUTE_SHADER,
+	LIB_SHADER, // For workgraphs and raytracing shaders
+	NUMBER_SHADER_TYPES,
+};
+
+// Target profile prefix, vs, ps, cs or lib
+std::string GetShaderTypeString(const ShaderType& shader_type);
+
+struct ShaderDesc
+{
+	ShaderType m_type;
+	std::string m_file_name;
+	std::string m_entry_point_name;
+	// Passed as -D, either NAME or NAME=VALUE
+	std::vector<std::string> m_defines;
+};
+
+// Option of a shader, compiled with AXIS_VALUE=i for every value and AXIS set to the selected one
+// HLSL tests it as #if AXIS == AXIS_VALUE and errors when AXIS is not defined, undefined macros compare equal otherwise
+struct ShaderPermutationAxis
+{
+	std::string m_name;
+	std::vector<std::string> m_values;
+};
+
+// Values of a permutation, one per axis in declaration order
+using ShaderPermutationValues = std::vector<uint32>;
+// Mixed radix number of the values, directly the index of the permutation
+using ShaderPermutationKey = uint32;
+
+struct ShaderPermutationDesc
+{
+	ShaderDesc m_shader_desc;
+	std::vector<ShaderPermutationAxis> m_axes;
+	// Pruned combinations are never compiled, empty keeps the full cartesian product
+	// Only worth declaring across several axes, a value never selected on its own is removed from its axis instead
+	std::function<bool(const ShaderPermutationValues& values)> m_filter;
+};
+
+// A desc without axes has a single permutation, key 0
+uint32 GetPermutationCount(const ShaderPermutationDesc& desc);
+ShaderPermutationKey GetPermutationKey(const ShaderPermutationDesc& desc, const ShaderPermutationValues& values);
+ShaderPermutationValues GetPermutationValues(const ShaderPermutationDesc& desc, ShaderPermutationKey key);
+bool IsPermutationPruned(const ShaderPermutationDesc& desc, ShaderPermutationKey key);
+// Base shader desc with the defines of the permutation
+ShaderDesc GetPermutationShaderDesc(const ShaderPermutationDesc& desc, ShaderPermutationKey key);
+// Readable name, file followed by AXIS=VALUE per axis
+std::string GetPermutationName(const ShaderPermutationDesc& desc, ShaderPermutationKey key);
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "ShaderManifest.h"
+#include "../shaders/generated/SharedLayoutsBindings.h"
+#include "../core/TextureCompression.h"
+
+template<typename T>
+static WorkGraphTest MakeWorkGraphTest(const std::string& name, const std::vector<T>& records)
+{
+	const uint8* data = reinterpret_cast<const uint8*>(records.data());
+	return { name, sizeof(T), std::vector<uint8>(data, data + records.size() * sizeof(T)) };
+}
+
+const std::vector<WorkGraphTest> g_workgraph_tests =
+{
+	MakeWorkGraphTest<SampleEntryRecord>("SAMPLE", { { .gridSize = 2, .recordIndex = 1 } }),
+	// Fixed dispatch grid without input record
+	MakeWorkGraphTest<IndexRecord>("BROADCAST", {}),
+	MakeWorkGraphTest<IndexRecord>("BROADCAST_RECORD", { { .index = 0 }, { .index = 1 } }),
+	MakeWorkGraphTest<DispatchGridRecord>
+	(
+		"DISPATCH_GRID", 
+		{ 
+			{ .DispatchGrid = { 1, 2, 3 }, .index = 0 }, 
+			{ .DispatchGrid = { 2, 2, 2 }, .index = 1 },
+		}
+	),
+	// Entry nodes of these take no input, records only make the dispatch non empty
+	MakeWorkGraphTest<IndexRecord>("NODE_OUTPUT", { { .index = 0 }, { .index = 1 }, { .index = 2 } }),
+	MakeWorkGraphTest<IndexRecord>("COALESCING", { { .index = 0 }, { .index = 1 } }),
+	MakeWorkGraphTest<RecursionRecord>("RECURSION", { { .depth = 0 } }),
+};
+
+// Every mode is selectable from the UI at runtime, so all of them are compiled and get a pipeline, no filter
+ShaderPermutationDesc GetComputePermutationDesc()
+{
+	return
+	{
+		.m_shader_desc = { ShaderType::COMPUTE_SHADER, "ComputeShader.hlsl", "main" },
+		.m_axes = { { "COMPUTE_MODE", { "GRADIENT", "CHEAP_STAR", "JULIA" } } },
+	};
+}
+
+// A test per value, RunWorkGraph compiles only the one it runs, no filter
+// Separate desc from the compute one, so COMPUTE_MODE and WORKGRAPH_TEST never multiply
+ShaderPermutationDesc GetWorkGraphPermutationDesc()
+{
+	ShaderPermutationAxis test_axis{ .m_name = "WORKGRAPH_TEST" };
+	for (const WorkGraphTest& test : g_workgraph_tests)
+	{
+		test_axis.m_values.push_back(test.m_name);
+	}
+	return
+	{
+		.m_shader_desc = { ShaderType::LIB_SHADER, "WorkGraphShader.hlsl", "main" },
+		.m_axes = { test_axis },
+	};
+}
+
+// A value per BCFormat, each picked by the format of the texture compressed, no filter
+ShaderPermutationDesc GetCompressBCPermutationDesc()
+{
+	ShaderPermutationAxis format_axis{ .m_name = "BC_FORMAT" };
+	for (const char* name : g_bc_format_names)
+	{
+		format_axis.m_values.push_back(name);
+	}
+	return
+	{
+		.m_shader_desc = { ShaderType::COMPUTE_SHADER, "CompressBCShader.hlsl", "main" },
+		.m_axes = { format_axis },
+	};
+}
+
+std::vector<ShaderPermutationDesc> GetShaderManifest()
+{
+	return
+	{
+		{ .m_shader_desc = { ShaderType::VERTEX_SHADER, "VertexShader.hlsl", "main" } },
+		{ .m_shader_desc = { ShaderType::PIXEL_SHADER, "PixelShader.hlsl", "main" } },
+		{ .m_shader_desc = { ShaderType::COMPUTE_SHADER, "CullInstancesShader.hlsl", "main" } },
+		{ .m_shader_desc = { ShaderType::COMPUTE_SHADER, "FillVertexBufferShader.hlsl", "main" } },
+		{ .m_shader_desc = { ShaderType::COMPUTE_SHADER, "IndirectShader.hlsl", "main" } },
+		{ .m_shader_desc = { ShaderType::COMPUTE_SHADER, "UpsampleShader.hlsl", "main" } },
+		{ .m_shader_desc = { ShaderType::COMPUTE_SHADER, "GenerateMipsShader.hlsl", "main" } },
+		GetComputePermutationDesc(),
+		GetWorkGraphPermutationDesc(),
+		GetCompressBCPermutationDesc(),
+	};
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+// No platform dependency, shared with the offline shader build tool
+#include "ShaderDesc.h"
+
+// Tests of WorkGraphShader.hlsl, the names are the values of its WORKGRAPH_TEST axis
+struct WorkGraphTest
+{
+	std::string m_name;
+	// CPU input records of the entry node, record_stride bytes each
+	// Record types are generated from SharedLayouts.hlsl so they match the entry node input
+	uint32 m_record_stride;
+	std::vector<uint8> m_records;
+};
+
+extern const std::vector<WorkGraphTest> g_workgraph_tests;
+
+// Options of ComputeShader.hlsl, WorkGraphShader.hlsl and CompressBCShader.hlsl, the only place they are declared
+ShaderPermutationDesc GetComputePermutationDesc();
+ShaderPermutationDesc GetWorkGraphPermutationDesc();
+// Values in BCFormat order
+ShaderPermutationDesc GetCompressBCPermutationDesc();
+
+// Every shader the application compiles, packed ahead of time by the ShaderBuild tool
+std::vector<ShaderPermutationDesc> GetShaderManifest();
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "ShaderPermutation.h"
+#include "DXCompiler.h"
+
+void ShaderPermutations::Init(const ShaderPermutationDesc& desc)
+{
+	m_desc = desc;
+	for (const ShaderPermutationAxis& axis : m_desc.m_axes)
+	{
+		ASSERT(!axis.m_values.empty());
+	}
+	const uint32 permutation_count = ::GetPermutationCount(m_desc);
+	m_pruned.assign(permutation_count, false);
+	m_compiled.assign(permutation_count, false);
+	m_shaders.assign(permutation_count, Shader{});
+	for (ShaderPermutationKey key = 0; key < permutation_count; ++key)
+	{
+		m_pruned[key] = IsPermutationPruned(m_desc, key);
+	}
+}
+
+ShaderPermutationKey ShaderPermutations::GetKey(const ShaderPermutationValues& values) const
+{
+	ASSERT(values.size() == m_desc.m_axes.size());
+	for (uint32 i = 0; i < values.size(); ++i)
+	{
+		ASSERT(values[i] < m_desc.m_axes[i].m_values.size());
+	}
+	return GetPermutationKey(m_desc, values);
+}
+
+ShaderPermutationValues ShaderPermutations::GetValues(ShaderPermutationKey key) const
+{
+	ASSERT(key < GetPermutationCount());
+	return GetPermutationValues(m_desc, key);
+}
+
+uint32 ShaderPermutations::GetAxisValue(ShaderPermutationKey key, uint32 axis) const
+{
+	ASSERT(key < GetPermutationCount() && axis < m_desc.m_axes.size());
+	return key / GetAxisStride(axis) % (uint32)m_desc.m_axes[axis].m_values.size();
+}
+
+ShaderPermutationKey ShaderPermutations::SetAxisValue(ShaderPermutationKey key, uint32 axis, uint32 value) const
+{
+	ASSERT(value < m_desc.m_axes[axis].m_values.size());
+	const uint32 stride = GetAxisStride(axis);
+	return key - GetAxisValue(key, axis) * stride + value * stride;
+}
+
+uint32 ShaderPermutations::GetValue(const std::string& axis_name, const std::string& value_name) const
+{
+	for (const ShaderPermutationAxis& axis : m_desc.m_axes)
+	{
+		if (axis.m_name != axis_name)
+		{
+			continue;
+		}
+		for (uint32 value = 0; value < axis.m_values.size(); ++value)
+		{
+			if (axis.m_values[value] == value_name)
+			{
+				return value;
+			}
+		}
+	}
+	ASSERT(false);
+	return 0;
+}
+
+uint32 ShaderPermutations::GetPermutationCount() const
+{
+	return (uint32)m_shaders.size();
+}
+
+bool ShaderPermutations::IsPruned(ShaderPermutationKey key) const
+{
+	ASSERT(key < GetPermutationCount());
+	return m_pruned[key];
+}
+
+ShaderDesc ShaderPermutations::GetShaderDesc(ShaderPermutationKey key) const
+{
+	ASSERT(key < GetPermutationCount());
+	return GetPermutationShaderDesc(m_desc, key);
+}
+
+std::string ShaderPermutations::GetName(ShaderPermutationKey key) const
+{
+	ASSERT(key < GetPermutationCount());
+	return GetPermutationName(m_desc, key);
+}
+
+const ShaderPermutationDesc& ShaderPermutations::GetDesc() const
+{
+	return m_desc;
+}
+
+void ShaderPermutations::CompileAll(const DXCompiler& dx_compiler, ComPtr<ID3D12Device> device)
+{
+	std::vector<ShaderPermutationKey> keys{};
+	std::vector<ShaderDesc> shader_descs{};
+	for (ShaderPermutationKey key = 0; key < GetPermutationCount(); ++key)
+	{
+		if (!m_pruned[key] && !m_compiled[key])
+		{
+			keys.push_back(key);
+			shader_descs.push_back(GetShaderDesc(key));
+		}
+	}
+	std::vector<Shader> shaders = dx_compiler.Compile(device, shader_descs);
+	for (uint32 i = 0; i < keys.size(); ++i)
+	{
+		m_shaders[keys[i]] = std::move(shaders[i]);
+		m_compiled[keys[i]] = true;
+	}
+}
+
+const Shader& ShaderPermutations::Get(const DXCompiler& dx_compiler, ComPtr<ID3D12Device> device, ShaderPermutationKey key)
+{
+	ASSERT(!IsPruned(key));
+	if (!m_compiled[key])
+	{
+		m_shaders[key] = dx_compiler.Compile(device, GetShaderDesc(key));
+		m_compiled[key] = true;
+	}
+	return m_shaders[key];
+}
+
+uint32 ShaderPermutations::GetAxisStride(uint32 axis) const
+{
+	uint32 stride = 1;
+	for (uint32 i = 0; i < axis; ++i)
+	{
+		stride *= (uint32)m_desc.m_axes[i].m_values.size();
+	}
+	return stride;
+}
\ No newline at end of file
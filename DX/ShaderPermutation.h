@@ -0,0 +1,42 @@
+#pragma once
+#include "../core/Common.h"
+#include "Shader.h"
+
+class DXCompiler;
+struct ID3D12Device;
+
+// Every permutation of a shader, selected by key in O(1)
+// Not thread safe, compile ahead of time with CompileAll or on first use with Get
+class ShaderPermutations
+{
+public:
+	void Init(const ShaderPermutationDesc& desc);
+
+	ShaderPermutationKey GetKey(const ShaderPermutationValues& values) const;
+	ShaderPermutationValues GetValues(ShaderPermutationKey key) const;
+	// Single axis of a key, without building the values of every axis
+	uint32 GetAxisValue(ShaderPermutationKey key, uint32 axis) const;
+	ShaderPermutationKey SetAxisValue(ShaderPermutationKey key, uint32 axis, uint32 value) const;
+	// Index of the value name on the axis, asserts on unknown names
+	uint32 GetValue(const std::string& axis_name, const std::string& value_name) const;
+	uint32 GetPermutationCount() const;
+	bool IsPruned(ShaderPermutationKey key) const;
+	// Base shader desc with the defines of the permutation
+	ShaderDesc GetShaderDesc(ShaderPermutationKey key) const;
+	// Readable name, AXIS=VALUE per axis
+	std::string GetName(ShaderPermutationKey key) const;
+	const ShaderPermutationDesc& GetDesc() const;
+
+	// Compiles every permutation not pruned concurrently on the compiler workers and the calling thread
+	void CompileAll(const DXCompiler& dx_compiler, ComPtr<ID3D12Device> device);
+	// Compiles on the calling thread when not compiled yet
+	const Shader& Get(const DXCompiler& dx_compiler, ComPtr<ID3D12Device> device, ShaderPermutationKey key);
+private:
+	// Keys are mixed radix, the first axis varies fastest
+	uint32 GetAxisStride(uint32 axis) const;
+
+	ShaderPermutationDesc m_desc;
+	std::vector<bool> m_pruned;
+	std::vector<bool> m_compiled;
+	std::vector<Shader> m_shaders;
+};
\ No newline at end of file
@@ -0,0 +1,528 @@
+// Offline shader build, compiles every permutation of the shader manifest with the DXC command line
+// and packs them in a single archive memory-mapped by ShaderArchive at runtime
+// Incremental: entries whose sources, arguments and compiler are unchanged are copied from the previous archive
+// and the archive is left untouched when nothing changed
+// Every build also writes a cost report of all permutations, optionally diffed against a baseline report
+#include "../DX/ShaderArchiveFormat.h"
+#include "../DX/ShaderManifest.h"
+#include "ShaderCost.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <set>
+#include <thread>
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif
+
+struct BuildOptions
+{
+	std::filesystem::path m_shader_directory = "shaders";
+	std::filesystem::path m_output_path;
+	std::string m_shader_model = "6_8";
+	std::string m_dxc = "dxc";
+	bool m_debug = false;
+	uint32 m_job_count = 0;
+	std::filesystem::path m_cost_report_path;
+	std::filesystem::path m_cost_baseline_path;
+	// Increase in percent of a metric still accepted against the baseline
+	float64 m_cost_tolerance = 0.0;
+};
+
+struct BuildItem
+{
+	ShaderDesc m_shader_desc;
+	std::string m_name;
+	uint64 m_key = 0;
+	std::vector<std::string> m_dependencies;
+	uint64 m_source_hash = 0;
+	uint64 m_input_hash = 0;
+	std::vector<std::string> m_arguments;
+	std::vector<uint8> m_blobs[g_shader_archive_blob_count];
+	bool m_success = false;
+	std::string m_errors;
+	ShaderCost m_cost;
+};
+
+struct PreviousEntry
+{
+	uint64 m_input_hash;
+	std::vector<uint8> m_blobs[g_shader_archive_blob_count];
+};
+
+static bool ReadFile(const std::filesystem::path& path, std::vector<uint8>& out_data)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	out_data.resize((size_t)file.tellg());
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(out_data.data()), out_data.size());
+	return file.good();
+}
+
+static bool RunCapture(const std::string& command, std::string& out_output)
+{
+	FILE* pipe = popen(command.c_str(), "r");
+	if (pipe == nullptr)
+	{
+		return false;
+	}
+	char buffer[256];
+	while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+	{
+		out_output += buffer;
+	}
+	return pclose(pipe) == 0;
+}
+
+static std::string Quote(const std::string& argument)
+{
+	return "\"" + argument + "\"";
+}
+
+// Quoted includes only, resolved against the including file then the shader directory like the -I argument
+static void ScanDependencies
+(
+	const std::filesystem::path& shader_directory, const std::filesystem::path& relative_path,
+	std::set<std::string>& visited, std::vector<std::string>& out_dependencies
+)
+{
+	const std::string relative_string = relative_path.lexically_normal().generic_string();
+	if (!visited.insert(relative_string).second)
+	{
+		return;
+	}
+	out_dependencies.push_back(relative_string);
+
+	std::ifstream file(shader_directory / relative_path);
+	static const std::regex include_regex(R"(^\s*#\s*include\s*\"([^\"]+)\")");
+	std::string line{};
+	while (std::getline(file, line))
+	{
+		std::smatch match{};
+		if (!std::regex_search(line, match, include_regex))
+		{
+			continue;
+		}
+		const std::filesystem::path sibling = relative_path.parent_path() / match[1].str();
+		const std::filesystem::path include = std::filesystem::exists(shader_directory / sibling) ? sibling : std::filesystem::path(match[1].str());
+		ScanDependencies(shader_directory, include, visited, out_dependencies);
+	}
+}
+
+// Same arguments as DXCompiler::Compile so archive and runtime compilation produce the same bytecode
+static std::vector<std::string> GetArguments(const BuildOptions& options, const ShaderDesc& shader_desc)
+{
+	std::vector<std::string> arguments =
+	{
+		"-E", shader_desc.m_entry_point_name,
+		"-T", GetShaderTypeString(shader_desc.m_type) + "_" + options.m_shader_model,
+	};
+	if (options.m_debug)
+	{
+		arguments.insert(arguments.end(), { "-Od", "-Zi" });
+	}
+	else
+	{
+		arguments.push_back("-O3");
+	}
+	arguments.insert(arguments.end(), { "-HV", "2021", "-WX" });
+	for (const std::string& define : shader_desc.m_defines)
+	{
+		arguments.insert(arguments.end(), { "-D", define });
+	}
+	return arguments;
+}
+
+static void ReadPreviousArchive(const BuildOptions& options, std::map<uint64, PreviousEntry>& out_entries)
+{
+	std::vector<uint8> data{};
+	// A corrupt archive is rebuilt from scratch
+	if (!ReadFile(options.m_output_path, data) || !IsShaderArchiveValid(data.data(), data.size()))
+	{
+		return;
+	}
+	const ShaderArchiveHeader* header = reinterpret_cast<const ShaderArchiveHeader*>(data.data());
+	if (header->m_debug != (uint32)options.m_debug || options.m_shader_model != header->m_shader_model)
+	{
+		return;
+	}
+	const ShaderArchiveEntry* entries = reinterpret_cast<const ShaderArchiveEntry*>(data.data() + sizeof(ShaderArchiveHeader));
+	for (uint32 i = 0; i < header->m_entry_count; ++i)
+	{
+		PreviousEntry& previous_entry = out_entries[entries[i].m_key];
+		previous_entry.m_input_hash = entries[i].m_input_hash;
+		for (uint32 blob = 0; blob < g_shader_archive_blob_count; ++blob)
+		{
+			const ShaderArchiveRange& range = entries[i].m_blobs[blob];
+			previous_entry.m_blobs[blob].assign(data.begin() + range.m_offset, data.begin() + range.m_offset + range.m_size);
+		}
+	}
+}
+
+static void Compile(const BuildOptions& options, const std::filesystem::path& temp_directory, BuildItem& item)
+{
+	char base_name[17];
+	snprintf(base_name, sizeof(base_name), "%016llx", (unsigned long long)item.m_key);
+	const std::filesystem::path outputs[g_shader_archive_blob_count] =
+	{
+		temp_directory / (std::string(base_name) + ".dxil"),
+		temp_directory / (std::string(base_name) + ".refl"),
+		temp_directory / (std::string(base_name) + ".rts0"),
+	};
+	const std::filesystem::path listing_path = temp_directory / (std::string(base_name) + ".txt");
+	const std::filesystem::path errors_path = temp_directory / (std::string(base_name) + ".log");
+	const std::filesystem::path pdb_path = temp_directory / (std::string(base_name) + ".pdb");
+
+	std::string command = Quote(options.m_dxc);
+	for (const std::string& argument : item.m_arguments)
+	{
+		command += " " + argument;
+	}
+	command += " -I " + Quote(options.m_shader_directory.string());
+	command += " -Fo " + Quote(outputs[0].string());
+	command += " -Fre " + Quote(outputs[1].string());
+	command += " -Frs " + Quote(outputs[2].string());
+	command += " -Fc " + Quote(listing_path.string());
+	if (options.m_debug)
+	{
+		// Debug info stays out of the object like with the API
+		command += " -Fd " + Quote(pdb_path.string());
+	}
+	command += " " + Quote((options.m_shader_directory / item.m_shader_desc.m_file_name).string());
+	command += " > " + Quote(errors_path.string()) + " 2>&1";
+#if defined(_WIN32)
+	// cmd strips the outer quotes of the whole line
+	command = Quote(command);
+#endif
+
+	item.m_success = std::system(command.c_str()) == 0;
+	std::vector<uint8> errors{};
+	if (ReadFile(errors_path, errors))
+	{
+		item.m_errors.assign(errors.begin(), errors.end());
+	}
+	for (uint32 blob = 0; blob < g_shader_archive_blob_count; ++blob)
+	{
+		// Reflection and root signature are only written when the shader has them
+		if (!ReadFile(outputs[blob], item.m_blobs[blob]))
+		{
+			item.m_blobs[blob].clear();
+		}
+		std::filesystem::remove(outputs[blob]);
+	}
+	item.m_success = item.m_success && !item.m_blobs[static_cast<uint32>(ShaderArchiveBlob::Object)].empty();
+	std::vector<uint8> listing{};
+	item.m_cost.m_input_hash = item.m_input_hash;
+	if (item.m_success && (!ReadFile(listing_path, listing) || !AnalyzeShaderDisassembly(std::string(listing.begin(), listing.end()), item.m_cost)))
+	{
+		// Not fatal, the entry is compiled again next build to fill its cost
+		item.m_errors += "Failed to analyze the disassembly, no cost reported\n";
+		item.m_cost.m_input_hash = 0;
+	}
+	std::filesystem::remove(listing_path);
+	std::filesystem::remove(errors_path);
+	std::filesystem::remove(pdb_path);
+}
+
+static bool WriteArchive(const BuildOptions& options, std::vector<BuildItem>& items)
+{
+	std::sort(items.begin(), items.end(), [](const BuildItem& a, const BuildItem& b) { return a.m_key < b.m_key; });
+
+	std::string string_table{};
+	std::vector<ShaderArchiveEntry> entries(items.size());
+	for (uint32 i = 0; i < items.size(); ++i)
+	{
+		ShaderArchiveEntry& entry = entries[i];
+		entry.m_key = items[i].m_key;
+		entry.m_source_hash = items[i].m_source_hash;
+		entry.m_input_hash = items[i].m_input_hash;
+		entry.m_name = { string_table.size(), items[i].m_name.size() };
+		string_table += items[i].m_name;
+		std::string dependencies{};
+		for (const std::string& dependency : items[i].m_dependencies)
+		{
+			dependencies += (dependencies.empty() ? "" : "\n") + dependency;
+		}
+		entry.m_dependencies = { string_table.size(), dependencies.size() };
+		string_table += dependencies;
+	}
+
+	ShaderArchiveHeader header{};
+	header.m_magic = g_shader_archive_magic;
+	header.m_version = g_shader_archive_version;
+	header.m_entry_count = (uint32)entries.size();
+	header.m_debug = options.m_debug;
+	strncpy(header.m_shader_model, options.m_shader_model.c_str(), sizeof(header.m_shader_model) - 1);
+	header.m_string_table_offset = sizeof(ShaderArchiveHeader) + entries.size() * sizeof(ShaderArchiveEntry);
+	header.m_string_table_size = string_table.size();
+
+	auto align = [](uint64 offset) { return (offset + g_shader_archive_alignment - 1) & ~(g_shader_archive_alignment - 1); };
+	uint64 offset = align(header.m_string_table_offset + header.m_string_table_size);
+	for (uint32 i = 0; i < items.size(); ++i)
+	{
+		for (uint32 blob = 0; blob < g_shader_archive_blob_count; ++blob)
+		{
+			entries[i].m_blobs[blob] = { offset, items[i].m_blobs[blob].size() };
+			offset = align(offset + items[i].m_blobs[blob].size());
+		}
+	}
+	header.m_file_size = offset;
+
+	// Written aside then renamed, the application never maps a partial archive
+	const std::filesystem::path temp_path = options.m_output_path.string() + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "Failed to write " << temp_path.string() << "\n";
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ShaderArchiveEntry));
+		file.write(string_table.data(), string_table.size());
+		for (uint32 i = 0; i < items.size(); ++i)
+		{
+			for (uint32 blob = 0; blob < g_shader_archive_blob_count; ++blob)
+			{
+				const uint64 padding = entries[i].m_blobs[blob].m_offset - (uint64)file.tellp();
+				file.write(std::string(padding, '\0').data(), padding);
+				file.write(reinterpret_cast<const char*>(items[i].m_blobs[blob].data()), items[i].m_blobs[blob].size());
+			}
+		}
+		file.write(std::string(header.m_file_size - (uint64)file.tellp(), '\0').data(), header.m_file_size - (uint64)file.tellp());
+		if (!file.good())
+		{
+			std::cerr << "Failed to write " << temp_path.string() << "\n";
+			return false;
+		}
+	}
+	std::error_code error{};
+	std::filesystem::rename(temp_path, options.m_output_path, error);
+	if (error)
+	{
+		std::cerr << "Failed to replace " << options.m_output_path.string() << ": " << error.message() << "\n";
+		return false;
+	}
+	return true;
+}
+
+// Returns the exit code of the build, 2 when the baseline comparison found regressions
+static int WriteCostReport(const BuildOptions& options, const std::vector<BuildItem>& items)
+{
+	ShaderCostReport report{};
+	for (const BuildItem& item : items)
+	{
+		if (item.m_cost.m_input_hash != 0)
+		{
+			report[item.m_name] = item.m_cost;
+		}
+	}
+	const std::string text = FormatShaderCostReport(report);
+	std::vector<uint8> previous_text{};
+	if (!ReadFile(options.m_cost_report_path, previous_text) || std::string(previous_text.begin(), previous_text.end()) != text)
+	{
+		std::ofstream file(options.m_cost_report_path, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), text.size());
+		if (!file.good())
+		{
+			std::cerr << "Failed to write " << options.m_cost_report_path.string() << "\n";
+			return 1;
+		}
+	}
+
+	if (options.m_cost_baseline_path.empty())
+	{
+		return 0;
+	}
+	ShaderCostReport baseline{};
+	if (!ReadShaderCostReport(options.m_cost_baseline_path.string(), baseline))
+	{
+		std::cerr << "Failed to read the cost baseline " << options.m_cost_baseline_path.string() << "\n";
+		return 1;
+	}
+	std::cout << "Cost against " << options.m_cost_baseline_path.string() << ", regressions marked with !\n";
+	const uint32 regression_count = DiffShaderCostReports(baseline, report, options.m_cost_tolerance);
+	std::cout << regression_count << " cost regressions\n";
+	return regression_count > 0 ? 2 : 0;
+}
+
+static void PrintUsage()
+{
+	std::cout <<
+		"ShaderBuild [--shaders <dir>] [--output <archive>] [--shader-model 6_8] [--debug] [--dxc <path>] [--jobs <n>]\n"
+		"            [--cost-report <file>] [--cost-baseline <file>] [--cost-tolerance <percent>]\n"
+		"  Compiles every permutation of the shader manifest into <dir>/shaders.archive by default\n"
+		"  Writes the cost of every permutation to <archive>.cost, a baseline is an older report to diff against\n"
+		"  Exits with 2 when a cost metric grew more than the tolerance over the baseline\n";
+}
+
+int main(int argc, char** argv)
+{
+	BuildOptions options{};
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (argument == "--shaders" && has_value) options.m_shader_directory = argv[++i];
+		else if (argument == "--output" && has_value) options.m_output_path = argv[++i];
+		else if (argument == "--shader-model" && has_value) options.m_shader_model = argv[++i];
+		else if (argument == "--dxc" && has_value) options.m_dxc = argv[++i];
+		else if (argument == "--jobs" && has_value) options.m_job_count = (uint32)std::stoul(argv[++i]);
+		else if (argument == "--cost-report" && has_value) options.m_cost_report_path = argv[++i];
+		else if (argument == "--cost-baseline" && has_value) options.m_cost_baseline_path = argv[++i];
+		else if (argument == "--cost-tolerance" && has_value) options.m_cost_tolerance = std::stod(argv[++i]);
+		else if (argument == "--debug") options.m_debug = true;
+		else
+		{
+			PrintUsage();
+			return argument == "--help" ? 0 : 1;
+		}
+	}
+	if (options.m_output_path.empty())
+	{
+		options.m_output_path = options.m_shader_directory / "shaders.archive";
+	}
+	if (options.m_cost_report_path.empty())
+	{
+		options.m_cost_report_path = options.m_output_path.string() + ".cost";
+	}
+	if (options.m_job_count == 0)
+	{
+		options.m_job_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+	}
+
+	// Any compiler update rebuilds everything
+	std::string dxc_version{};
+	if (!RunCapture(Quote(options.m_dxc) + " --version 2>&1", dxc_version))
+	{
+		std::cerr << "Failed to run " << options.m_dxc << "\n";
+		return 1;
+	}
+
+	std::vector<BuildItem> items{};
+	for (const ShaderPermutationDesc& permutation_desc : GetShaderManifest())
+	{
+		for (ShaderPermutationKey key = 0; key < GetPermutationCount(permutation_desc); ++key)
+		{
+			if (IsPermutationPruned(permutation_desc, key))
+			{
+				continue;
+			}
+			BuildItem item{};
+			item.m_shader_desc = GetPermutationShaderDesc(permutation_desc, key);
+			item.m_name = GetPermutationName(permutation_desc, key);
+			item.m_key = GetShaderArchiveKey(item.m_shader_desc);
+			item.m_arguments = GetArguments(options, item.m_shader_desc);
+
+			std::set<std::string> visited{};
+			ScanDependencies(options.m_shader_directory, item.m_shader_desc.m_file_name, visited, item.m_dependencies);
+			for (const std::string& dependency : item.m_dependencies)
+			{
+				std::vector<uint8> data{};
+				if (!ReadFile(options.m_shader_directory / dependency, data))
+				{
+					std::cerr << item.m_name << ": missing " << dependency << "\n";
+					return 1;
+				}
+				item.m_source_hash = HashShaderDependency(dependency, data.data(), data.size(), item.m_source_hash);
+			}
+			item.m_input_hash = Hash64(dxc_version, item.m_source_hash);
+			for (const std::string& argument : item.m_arguments)
+			{
+				item.m_input_hash = Hash64(argument, item.m_input_hash);
+			}
+			items.push_back(item);
+		}
+	}
+
+	std::map<uint64, PreviousEntry> previous_entries{};
+	ReadPreviousArchive(options, previous_entries);
+	ShaderCostReport previous_report{};
+	ReadShaderCostReport(options.m_cost_report_path.string(), previous_report);
+	std::vector<BuildItem*> pending_items{};
+	for (BuildItem& item : items)
+	{
+		// Cost is only measured while compiling, an entry missing from the report is compiled again
+		auto previous_entry = previous_entries.find(item.m_key);
+		auto previous_cost = previous_report.find(item.m_name);
+		if 
+		(
+			previous_entry != previous_entries.end() && previous_entry->second.m_input_hash == item.m_input_hash &&
+			previous_cost != previous_report.end() && previous_cost->second.m_input_hash == item.m_input_hash
+		)
+		{
+			for (uint32 blob = 0; blob < g_shader_archive_blob_count; ++blob)
+			{
+				item.m_blobs[blob] = std::move(previous_entry->second.m_blobs[blob]);
+			}
+			item.m_cost = previous_cost->second;
+			item.m_success = true;
+		}
+		else
+		{
+			pending_items.push_back(&item);
+		}
+	}
+	if (pending_items.empty() && previous_entries.size() == items.size())
+	{
+		std::cout << options.m_output_path.string() << " is up to date, " << items.size() << " permutations\n";
+		return WriteCostReport(options, items);
+	}
+
+	const std::filesystem::path temp_directory = std::filesystem::temp_directory_path() / "ShaderBuild";
+	std::filesystem::create_directories(temp_directory);
+	std::atomic<uint32> next_item = 0;
+	std::vector<std::thread> workers{};
+	for (uint32 i = 0; i < (std::min)(options.m_job_count, (uint32)pending_items.size()); ++i)
+	{
+		workers.emplace_back
+		(
+			[&]()
+			{
+				for (uint32 index = next_item++; index < pending_items.size(); index = next_item++)
+				{
+					Compile(options, temp_directory, *pending_items[index]);
+				}
+			}
+		);
+	}
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	bool success = true;
+	for (const BuildItem* item : pending_items)
+	{
+		if (!item->m_errors.empty())
+		{
+			std::cerr << item->m_name << ":\n" << item->m_errors;
+		}
+		if (!item->m_success)
+		{
+			std::cerr << "Failed to compile " << item->m_name << "\n";
+			success = false;
+		}
+	}
+	// Keeps the previous archive rather than packing a partial set
+	if (!success || !WriteArchive(options, items))
+	{
+		return 1;
+	}
+	std::cout << options.m_output_path.string() << ": " << pending_items.size() << " compiled, " << items.size() - pending_items.size() << " reused\n";
+	return WriteCostReport(options, items);
+}
\ No newline at end of file
@@ -0,0 +1,547 @@
+#include "ShaderCost.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <set>
+#include <sstream>
+
+// LLVM instructions by category, dx.op calls are categorized by their name instead
+static const std::map<std::string, std::string> g_instruction_categories =
+{
+	{ "fadd", "alu" }, { "fsub", "alu" }, { "fmul", "alu" }, { "fdiv", "alu" }, { "frem", "alu" },
+	{ "add", "alu" }, { "sub", "alu" }, { "mul", "alu" }, { "udiv", "alu" }, { "sdiv", "alu" }, { "urem", "alu" }, { "srem", "alu" },
+	{ "shl", "alu" }, { "lshr", "alu" }, { "ashr", "alu" }, { "and", "alu" }, { "or", "alu" }, { "xor", "alu" },
+	{ "fcmp", "alu" }, { "icmp", "alu" }, { "select", "alu" },
+	{ "extractelement", "alu" }, { "insertelement", "alu" }, { "shufflevector", "alu" }, { "extractvalue", "alu" }, { "insertvalue", "alu" },
+	{ "trunc", "conversion" }, { "zext", "conversion" }, { "sext", "conversion" }, { "fptrunc", "conversion" }, { "fpext", "conversion" },
+	{ "fptoui", "conversion" }, { "fptosi", "conversion" }, { "uitofp", "conversion" }, { "sitofp", "conversion" },
+	{ "bitcast", "conversion" }, { "ptrtoint", "conversion" }, { "inttoptr", "conversion" }, { "addrspacecast", "conversion" },
+	{ "load", "memory" }, { "store", "memory" }, { "alloca", "memory" }, { "getelementptr", "memory" },
+	{ "atomicrmw", "atomic" }, { "cmpxchg", "atomic" }, { "fence", "atomic" },
+	{ "br", "control" }, { "switch", "control" }, { "phi", "control" }, { "ret", "control" }, { "unreachable", "control" },
+};
+
+// numthreads in the properties of dx.entryPoints
+static const uint32 g_numthreads_tag = 4;
+
+static std::string GetDXOpCategory(const std::string& op)
+{
+	auto starts_with = [&](const char* prefix) { return op.rfind(prefix, 0) == 0; };
+	if (starts_with("wave") || starts_with("quad")) return "wave";
+	if (starts_with("atomic")) return "atomic";
+	if (starts_with("barrier")) return "sync";
+	if (starts_with("sample") || starts_with("textureGather")) return "sample";
+	if (starts_with("createHandle") || starts_with("annotateHandle")) return "resource";
+	if (op.find("Load") != std::string::npos || op.find("Store") != std::string::npos) return "memory";
+	if
+	(
+		starts_with("unary") || starts_with("binary") || starts_with("tertiary") || starts_with("quaternary") ||
+		starts_with("dot") || starts_with("fma") || starts_with("isSpecialFloat")
+	)
+	{
+		return "alu";
+	}
+	return "other";
+}
+
+// Struct types referencing each other deeper than this are rejected rather than followed
+static const uint32 g_max_type_depth = 16;
+
+// Size in bytes of an LLVM type at the start of text, structs are summed without padding
+// False on a type it does not know, position is then left anywhere and the size is not reported
+static bool ParseTypeSize(const std::string& text, size_t& position, const std::map<std::string, std::string>& struct_types, uint32 depth, uint64& out_size)
+{
+	auto skip_spaces = [&]() { while (position < text.size() && text[position] == ' ') ++position; };
+	auto parse_number = [&]()
+	{
+		uint64 value = 0;
+		while (position < text.size() && isdigit((unsigned char)text[position])) value = value * 10 + (text[position++] - '0');
+		return value;
+	};
+	// Consumes the expected character, after optional spaces
+	auto expect = [&](char character)
+	{
+		skip_spaces();
+		if (position >= text.size() || text[position] != character)
+		{
+			return false;
+		}
+		++position;
+		return true;
+	};
+	skip_spaces();
+	if (position >= text.size() || depth > g_max_type_depth)
+	{
+		return false;
+	}
+	out_size = 0;
+	const char first = text[position];
+	if (first == '<' && position + 1 < text.size() && text[position + 1] == '{')
+	{
+		// Packed struct, summed without padding like the others
+		++position;
+		if (!ParseTypeSize(text, position, struct_types, depth + 1, out_size) || !expect('>'))
+		{
+			return false;
+		}
+	}
+	else if (first == '[' || first == '<')
+	{
+		++position;
+		skip_spaces();
+		const size_t count_position = position;
+		const uint64 count = parse_number();
+		uint64 element_size = 0;
+		if (position == count_position || !expect('x') || !ParseTypeSize(text, position, struct_types, depth + 1, element_size) || !expect(first == '[' ? ']' : '>'))
+		{
+			return false;
+		}
+		out_size = count * element_size;
+	}
+	else if (first == '{')
+	{
+		++position;
+		skip_spaces();
+		if (position < text.size() && text[position] == '}')
+		{
+			++position;
+			return true;
+		}
+		while (true)
+		{
+			uint64 element_size = 0;
+			if (!ParseTypeSize(text, position, struct_types, depth + 1, element_size))
+			{
+				return false;
+			}
+			out_size += element_size;
+			if (expect('}'))
+			{
+				break;
+			}
+			if (!expect(','))
+			{
+				return false;
+			}
+		}
+	}
+	else if (first == 'i' && position + 1 < text.size() && isdigit((unsigned char)text[position + 1]))
+	{
+		++position;
+		out_size = (parse_number() + 7) / 8;
+	}
+	else if (first == '%')
+	{
+		size_t end = position + 1;
+		if (end < text.size() && text[end] == '"')
+		{
+			end = text.find('"', end + 1);
+			if (end == std::string::npos)
+			{
+				return false;
+			}
+			++end;
+		}
+		else
+		{
+			while (end < text.size() && (isalnum((unsigned char)text[end]) || strchr("-$._", text[end]) != nullptr)) ++end;
+		}
+		const std::string name = text.substr(position, end - position);
+		position = end;
+		const auto struct_type = struct_types.find(name);
+		size_t body_position = 0;
+		if (struct_type == struct_types.end() || !ParseTypeSize(struct_type->second, body_position, struct_types, depth + 1, out_size))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		static const std::pair<const char*, uint64> float_types[] = { { "half", 2 }, { "float", 4 }, { "double", 8 } };
+		const auto float_type = std::find_if(std::begin(float_types), std::end(float_types), [&](const auto& type) { return text.compare(position, strlen(type.first), type.first) == 0; });
+		if (float_type == std::end(float_types))
+		{
+			return false;
+		}
+		position += strlen(float_type->first);
+		out_size = float_type->second;
+	}
+	// Pointers, handles hold them, sized as 64 bit
+	skip_spaces();
+	if (text.compare(position, strlen("addrspace("), "addrspace(") == 0)
+	{
+		position = text.find(')', position);
+		if (position == std::string::npos)
+		{
+			return false;
+		}
+		++position;
+		skip_spaces();
+		if (position >= text.size() || text[position] != '*')
+		{
+			return false;
+		}
+	}
+	while (position < text.size() && text[position] == '*')
+	{
+		++position;
+		out_size = 8;
+	}
+	return true;
+}
+
+// Elements of a metadata tuple body, values never nest braces in entry point metadata
+static std::vector<std::string> SplitTuple(const std::string& body)
+{
+	std::vector<std::string> elements{};
+	size_t begin = 0;
+	while (begin <= body.size())
+	{
+		const size_t end = (std::min)(body.find(", ", begin), body.size());
+		elements.push_back(body.substr(begin, end - begin));
+		begin = end + 2;
+	}
+	return elements;
+}
+
+struct FunctionBody
+{
+	std::string m_symbol;
+	// Block names in order, the unnamed entry block is empty
+	std::vector<std::string> m_blocks;
+	// Block index and text of every instruction
+	std::vector<std::pair<uint32, std::string>> m_instructions;
+};
+
+static void AnalyzeFunction(const FunctionBody& function, ShaderCostMetrics& metrics)
+{
+	static const std::regex assignment_regex(R"(^%[-$._A-Za-z0-9]+ = )");
+	static const std::regex dx_op_regex(R"(@dx\.op\.([A-Za-z0-9]+))");
+	static const std::regex label_regex(R"(label %([-$._A-Za-z0-9]+))");
+	metrics["instructions"] = 0;
+	metrics["loops"] = 0;
+	metrics["wave_ops"] = 0;
+	for (const auto& [block, line] : function.m_instructions)
+	{
+		const std::string instruction = std::regex_replace(line, assignment_regex, "", std::regex_constants::format_first_only);
+		std::string opcode = instruction.substr(0, instruction.find(' '));
+		if (opcode == "tail")
+		{
+			opcode = "call";
+		}
+		++metrics["instructions"];
+
+		std::string category = "other";
+		std::smatch match{};
+		if (opcode == "call" && std::regex_search(instruction, match, dx_op_regex))
+		{
+			const std::string op = match[1].str();
+			category = GetDXOpCategory(op);
+			++metrics["dx_op." + op];
+			if (category == "wave")
+			{
+				++metrics["wave_ops"];
+			}
+		}
+		else if (opcode == "call")
+		{
+			category = "call";
+		}
+		else if (const auto found = g_instruction_categories.find(opcode); found != g_instruction_categories.end())
+		{
+			category = found->second;
+		}
+		++metrics["instructions." + category];
+
+		// Branching to the same or an earlier block closes a loop
+		if (opcode == "br" || opcode == "switch")
+		{
+			for (std::sregex_iterator target(instruction.begin(), instruction.end(), label_regex), end; target != end; ++target)
+			{
+				const auto target_block = std::find(function.m_blocks.begin(), function.m_blocks.end(), (*target)[1].str());
+				if (target_block != function.m_blocks.end() && (uint32)(target_block - function.m_blocks.begin()) <= block)
+				{
+					++metrics["loops"];
+				}
+			}
+		}
+	}
+}
+
+bool AnalyzeShaderDisassembly(const std::string& listing, ShaderCost& out_cost)
+{
+	static const std::regex function_regex(R"(^define [^@]*@("[^"]*"|[-$._A-Za-z0-9]+)\()");
+	static const std::regex numbered_label_regex(R"(^; <label>:(\d+))");
+	static const std::regex named_label_regex(R"(^([-$._A-Za-z0-9]+):)");
+	static const std::regex struct_regex(R"(^(%[-$._A-Za-z0-9"\\]+) = type (.*)$)");
+	static const std::regex groupshared_regex(R"( addrspace\(3\) global (.*)$)");
+	static const std::regex metadata_regex(R"(^!(\d+) = (?:distinct )?!\{(.*)\}$)");
+	static const std::regex entry_points_regex(R"(^!dx\.entryPoints = !\{(.*)\}$)");
+	static const std::regex symbol_regex(R"(@("[^"]*"|[-$._A-Za-z0-9]+))");
+
+	std::vector<FunctionBody> functions{};
+	std::map<std::string, std::string> struct_types{};
+	std::vector<std::string> groupshared_types{};
+	std::map<std::string, std::string> metadata{};
+	std::string entry_points{};
+	uint64 binding_count = 0;
+	// 0 outside the table, 1 in its header, 2 in its rows
+	uint32 binding_table_state = 0;
+
+	std::istringstream stream(listing);
+	std::string line{};
+	FunctionBody* function = nullptr;
+	while (std::getline(stream, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		std::smatch match{};
+		if (function != nullptr)
+		{
+			if (line == "}")
+			{
+				function = nullptr;
+			}
+			else if (std::regex_search(line, match, numbered_label_regex))
+			{
+				function->m_blocks.push_back(match[1].str());
+			}
+			else if (std::regex_search(line, match, named_label_regex))
+			{
+				function->m_blocks.push_back(match[1].str());
+			}
+			else if (line.size() > 2 && line.compare(0, 2, "  ") == 0 && line[2] != ';')
+			{
+				function->m_instructions.emplace_back((uint32)function->m_blocks.size() - 1, line.substr(line.find_first_not_of(' ')));
+			}
+			continue;
+		}
+
+		// Header comment of the listing
+		if (line.rfind("; Resource Bindings:", 0) == 0)
+		{
+			binding_table_state = 1;
+		}
+		else if (binding_table_state == 1 && line.rfind("; ---", 0) == 0)
+		{
+			binding_table_state = 2;
+		}
+		else if (binding_table_state == 2)
+		{
+			if (line.size() > 2 && line[0] == ';' && line.find_first_not_of(' ', 1) != std::string::npos)
+			{
+				++binding_count;
+			}
+			else
+			{
+				binding_table_state = 0;
+			}
+		}
+		else if (std::regex_search(line, match, function_regex))
+		{
+			functions.push_back({ .m_symbol = match[1].str(), .m_blocks = { "" } });
+			function = &functions.back();
+		}
+		else if (std::regex_search(line, match, struct_regex))
+		{
+			struct_types[match[1].str()] = match[2].str();
+		}
+		else if (std::regex_search(line, match, groupshared_regex))
+		{
+			groupshared_types.push_back(match[1].str());
+		}
+		else if (std::regex_search(line, match, metadata_regex))
+		{
+			metadata["!" + match[1].str()] = match[2].str();
+		}
+		else if (std::regex_search(line, match, entry_points_regex))
+		{
+			entry_points = match[1].str();
+		}
+	}
+	if (functions.empty())
+	{
+		return false;
+	}
+
+	// Entry point metadata names the functions and holds numthreads
+	std::map<std::string, std::string> entry_names{};
+	std::map<std::string, std::vector<uint64>> entry_numthreads{};
+	for (const std::string& entry : SplitTuple(entry_points))
+	{
+		const std::vector<std::string> elements = SplitTuple(metadata[entry]);
+		std::smatch match{};
+		if (elements.size() < 5 || !std::regex_search(elements[0], match, symbol_regex))
+		{
+			continue;
+		}
+		const std::string symbol = match[1].str();
+		if (elements[1].rfind("!\"", 0) == 0)
+		{
+			entry_names[symbol] = elements[1].substr(2, elements[1].size() - 3);
+		}
+		const std::vector<std::string> properties = SplitTuple(metadata[elements[4]]);
+		for (size_t i = 0; i + 1 < properties.size(); i += 2)
+		{
+			if (properties[i] != "i32 " + std::to_string(g_numthreads_tag))
+			{
+				continue;
+			}
+			for (const std::string& dimension : SplitTuple(metadata[properties[i + 1]]))
+			{
+				entry_numthreads[symbol].push_back(std::strtoull(dimension.c_str() + dimension.find_last_of(' ') + 1, nullptr, 10));
+			}
+		}
+	}
+
+	out_cost.m_functions.clear();
+	for (const FunctionBody& body : functions)
+	{
+		// Functions left after inlining that are not entry points are reported under their symbol
+		const auto entry_name = entry_names.find(body.m_symbol);
+		const std::string name = entry_name != entry_names.end() ? entry_name->second : body.m_symbol;
+		ShaderCostMetrics& metrics = out_cost.m_functions[name];
+		AnalyzeFunction(body, metrics);
+		const std::vector<uint64>& numthreads = entry_numthreads[body.m_symbol];
+		if (numthreads.size() == 3)
+		{
+			metrics["numthreads.x"] = numthreads[0];
+			metrics["numthreads.y"] = numthreads[1];
+			metrics["numthreads.z"] = numthreads[2];
+		}
+	}
+	ShaderCostMetrics& module_metrics = out_cost.m_functions[g_shader_cost_module];
+	module_metrics["bindings"] = binding_count;
+	module_metrics["groupshared_bytes"] = 0;
+	for (const std::string& type : groupshared_types)
+	{
+		size_t position = 0;
+		uint64 size = 0;
+		if (!ParseTypeSize(type, position, struct_types, 0, size))
+		{
+			// Unknown type, no size rather than a wrong one
+			return false;
+		}
+		module_metrics["groupshared_bytes"] += size;
+	}
+	return true;
+}
+
+bool ReadShaderCostReport(const std::string& path, ShaderCostReport& out_report)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	ShaderCost* cost = nullptr;
+	std::string line{};
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+		if (line[0] == '[')
+		{
+			const size_t end = line.rfind(']');
+			cost = &out_report[line.substr(1, end - 1)];
+			cost->m_input_hash = std::stoull(line.substr(end + 2), nullptr, 16);
+			continue;
+		}
+		std::istringstream fields(line);
+		std::string function{};
+		std::string metric{};
+		uint64 value = 0;
+		if (cost == nullptr || !(fields >> function >> metric >> value))
+		{
+			return false;
+		}
+		cost->m_functions[function][metric] = value;
+	}
+	return true;
+}
+
+std::string FormatShaderCostReport(const ShaderCostReport& report)
+{
+	std::string text = "# Shader cost report written by ShaderBuild, [permutation] input hash then function metric value\n";
+	for (const auto& [name, cost] : report)
+	{
+		char input_hash[17];
+		snprintf(input_hash, sizeof(input_hash), "%016llx", (unsigned long long)cost.m_input_hash);
+		text += "[" + name + "] " + input_hash + "\n";
+		for (const auto& [function, metrics] : cost.m_functions)
+		{
+			for (const auto& [metric, value] : metrics)
+			{
+				text += function + " " + metric + " " + std::to_string(value) + "\n";
+			}
+		}
+	}
+	return text;
+}
+
+uint32 DiffShaderCostReports(const ShaderCostReport& baseline, const ShaderCostReport& report, float64 tolerance_percent)
+{
+	uint32 regression_count = 0;
+	for (const auto& [name, cost] : report)
+	{
+		const auto baseline_cost = baseline.find(name);
+		if (baseline_cost == baseline.end())
+		{
+			std::cout << "  [" << name << "]: new\n";
+			continue;
+		}
+		// Union of both sides, a metric missing on one side counts as 0
+		std::map<std::string, std::pair<uint64, uint64>> values{};
+		for (const auto& [function, metrics] : baseline_cost->second.m_functions)
+		{
+			for (const auto& [metric, value] : metrics)
+			{
+				values[function + " " + metric].first = value;
+			}
+		}
+		for (const auto& [function, metrics] : cost.m_functions)
+		{
+			for (const auto& [metric, value] : metrics)
+			{
+				values[function + " " + metric].second = value;
+			}
+		}
+		for (const auto& [metric, value] : values)
+		{
+			const auto& [baseline_value, current_value] = value;
+			if (current_value == baseline_value)
+			{
+				continue;
+			}
+			const float64 percent = baseline_value > 0 ? ((float64)current_value - (float64)baseline_value) * 100.0 / (float64)baseline_value : 100.0;
+			// More threads per group is a choice, not a cost
+			const bool is_regression = current_value > baseline_value && percent > tolerance_percent && metric.find(" numthreads") == std::string::npos;
+			char change[128];
+			snprintf
+			(
+				change, sizeof(change), "%llu -> %llu (%+.1f%%)",
+				(unsigned long long)baseline_value, (unsigned long long)current_value, percent
+			);
+			std::cout << (is_regression ? "! " : "  ") << "[" << name << "] " << metric << ": " << change << "\n";
+			regression_count += is_regression ? 1 : 0;
+		}
+	}
+	for (const auto& [name, cost] : baseline)
+	{
+		if (report.find(name) == report.end())
+		{
+			std::cout << "  [" << name << "]: removed\n";
+		}
+	}
+	return regression_count;
+}
\ No newline at end of file
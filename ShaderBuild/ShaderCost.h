@@ -0,0 +1,35 @@
+#pragma once
+// Static cost of compiled shaders, extracted from the DXIL disassembly so it runs wherever DXC runs
+#include "../core/Types.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Metric name to value, ordered so reports diff line by line
+using ShaderCostMetrics = std::map<std::string, uint64>;
+
+struct ShaderCost
+{
+	// Input hash of the archive entry the cost was measured on, reused as long as it matches
+	uint64 m_input_hash = 0;
+	// Per entry function, a library has one per node, module wide metrics are under g_shader_cost_module
+	std::map<std::string, ShaderCostMetrics> m_functions;
+};
+
+// Permutation name to cost
+using ShaderCostReport = std::map<std::string, ShaderCost>;
+
+static const char* const g_shader_cost_module = "<module>";
+
+// Parses the -Fc listing of DXC
+// Per function: instruction count by category, dx.op calls by name, loops, wave ops, numthreads
+// Per module: groupshared bytes and bound resources
+bool AnalyzeShaderDisassembly(const std::string& listing, ShaderCost& out_cost);
+
+bool ReadShaderCostReport(const std::string& path, ShaderCostReport& out_report);
+std::string FormatShaderCostReport(const ShaderCostReport& report);
+
+// Prints every metric that changed, increases above tolerance_percent are regressions
+// Returns the number of regressions
+uint32 DiffShaderCostReports(const ShaderCostReport& baseline, const ShaderCostReport& report, float64 tolerance_percent);
\ No newline at end of file
@@ -0,0 +1,196 @@
+// AnalyzeShaderDisassembly over -Fc listings in the layout DXC writes them, trimmed to what the analysis reads
+#include "../CoreTests/CoreTest.h"
+#include "ShaderCost.h"
+
+#include <string>
+
+// Compute shader with a loop, a wave op, groupshared arrays of a struct and numthreads(64, 1, 1)
+static const char* const g_compute_listing = R"(;
+; Note: shader requires additional functionality:
+;       Wave level operations
+;
+; Resource Bindings:
+;
+; Name                                 Type  Format         Dim      ID      HLSL Bind  Count
+; ------------------------------ ---------- ------- ----------- ------- -------------- ------
+; m_cbuffer                         cbuffer      NA          NA     CB0            cb0     1
+; g_output                              UAV  struct         r/w      U0             u0     1
+;
+target datalayout = "e-m:e-p:32:32-i1:32-i8:32-i16:32-i32:32-i64:64-f16:32-f32:32-f64:64-n8:16:32:64"
+target triple = "dxil-ms-dx"
+
+%dx.types.Handle = type { i8* }
+%dx.types.CBufRet.i32 = type { i32, i32, i32, i32 }
+%struct.Tile = type { [4 x float], <2 x i32>, half }
+
+@"\01?g_tile@@3PAMA" = external addrspace(3) global [256 x float], align 4
+@"\01?g_tiles@@3PAUTile@@A" = addrspace(3) global [8 x %struct.Tile] undef, align 4
+
+define void @main() {
+  %1 = call %dx.types.Handle @dx.op.createHandle(i32 57, i8 1, i32 0, i32 0, i1 false)  ; CreateHandle(resourceClass,rangeId,index,nonUniformIndex)
+  %2 = call i32 @dx.op.threadId.i32(i32 93, i32 0)  ; ThreadId(component)
+  br label %3
+
+; <label>:3                                       ; preds = %3, %0
+  %4 = phi i32 [ 0, %0 ], [ %7, %3 ]
+  %5 = phi float [ 0.000000e+00, %0 ], [ %6, %3 ]
+  %6 = fadd fast float %5, 1.000000e+00
+  %7 = add nuw nsw i32 %4, 1
+  %8 = icmp eq i32 %7, 4
+  br i1 %8, label %9, label %3
+
+; <label>:9                                       ; preds = %3
+  %10 = call float @dx.op.waveActiveOp.f32(i32 119, float %6, i8 0, i8 0)  ; WaveActiveOp(value,op,sop)
+  call void @dx.op.bufferStore.f32(i32 69, %dx.types.Handle %1, i32 %2, i32 0, float %10, float undef, float undef, float undef, i8 1)  ; BufferStore(uav,coord0,coord1,value0,value1,value2,value3,mask)
+  ret void
+}
+
+declare i32 @dx.op.threadId.i32(i32, i32) #0
+
+!dx.entryPoints = !{!8}
+
+!5 = !{null, !6, null, null}
+!6 = !{!7}
+!7 = !{i32 0, %struct.Tile* undef, !"", i32 0, i32 0, i32 1, i32 12, i1 false, i1 false, i1 false, null}
+!8 = !{void ()* @main, !"main", null, !5, !9}
+!9 = !{i32 0, i64 8388624, i32 4, !10}
+!10 = !{i32 64, i32 1, i32 1}
+)";
+
+static void TestCompute()
+{
+	ShaderCost cost{};
+	CHECK(AnalyzeShaderDisassembly(g_compute_listing, cost));
+	CHECK(cost.m_functions.size() == 2);
+	ShaderCostMetrics& main = cost.m_functions["main"];
+	CHECK(main["instructions"] == 12);
+	CHECK(main["instructions.control"] == 5);
+	CHECK(main["instructions.alu"] == 3);
+	CHECK(main["instructions.wave"] == 1);
+	CHECK(main["instructions.memory"] == 1);
+	CHECK(main["instructions.resource"] == 1);
+	CHECK(main["dx_op.waveActiveOp"] == 1);
+	CHECK(main["dx_op.bufferStore"] == 1);
+	CHECK(main["wave_ops"] == 1);
+	CHECK(main["loops"] == 1);
+	CHECK(main["numthreads.x"] == 64);
+	CHECK(main["numthreads.y"] == 1);
+	CHECK(main["numthreads.z"] == 1);
+
+	ShaderCostMetrics& module = cost.m_functions[g_shader_cost_module];
+	CHECK(module["bindings"] == 2);
+	// 256 floats, then 8 tiles of 4 floats, 2 ints and a half
+	CHECK(module["groupshared_bytes"] == 256 * 4 + 8 * (16 + 8 + 2));
+}
+
+// Listing with the groupshared line replaced, the analysis has to return instead of hanging or recursing
+static bool AnalyzeGroupshared(const std::string& type, ShaderCost& out_cost)
+{
+	std::string listing = g_compute_listing;
+	const std::string original = "[256 x float], align 4";
+	listing.replace(listing.find(original), original.size(), type);
+	return AnalyzeShaderDisassembly(listing, out_cost);
+}
+
+static void TestGroupsharedTypes()
+{
+	ShaderCost cost{};
+	CHECK(AnalyzeGroupshared("[4 x [16 x i32]], align 4", cost));
+	CHECK(cost.m_functions[g_shader_cost_module]["groupshared_bytes"] == 4 * 16 * 4 + 8 * 26);
+	CHECK(AnalyzeGroupshared("<4 x double>, align 8", cost));
+	CHECK(cost.m_functions[g_shader_cost_module]["groupshared_bytes"] == 32 + 8 * 26);
+	CHECK(AnalyzeGroupshared("<{ i32, i8 }>, align 1", cost));
+	CHECK(cost.m_functions[g_shader_cost_module]["groupshared_bytes"] == 5 + 8 * 26);
+	CHECK(AnalyzeGroupshared("{}, align 4", cost));
+	CHECK(cost.m_functions[g_shader_cost_module]["groupshared_bytes"] == 8 * 26);
+	CHECK(AnalyzeGroupshared("{ i32*, %dx.types.Handle }, align 4", cost));
+	CHECK(cost.m_functions[g_shader_cost_module]["groupshared_bytes"] == 16 + 8 * 26);
+
+	// No x after the count, used to wrap the position back to the bracket and recurse forever
+	CHECK(!AnalyzeGroupshared("[4 float], align 4", cost));
+	CHECK(!AnalyzeGroupshared("[4", cost));
+	// Tokens the parser does not consume, used to spin in the struct loop
+	CHECK(!AnalyzeGroupshared("{ i32, ptr }, align 4", cost));
+	CHECK(!AnalyzeGroupshared("{ i32 i32 }, align 4", cost));
+	CHECK(!AnalyzeGroupshared("{ i32, float", cost));
+	CHECK(!AnalyzeGroupshared("[2 x %struct.Missing], align 4", cost));
+	CHECK(!AnalyzeGroupshared("%\"unterminated, align 4", cost));
+	CHECK(!AnalyzeGroupshared("", cost));
+}
+
+static void TestRecursiveStruct()
+{
+	// Struct types naming each other, followed only up to a depth
+	std::string listing = g_compute_listing;
+	const std::string tile = "%struct.Tile = type { [4 x float], <2 x i32>, half }";
+	listing.replace(listing.find(tile), tile.size(), "%struct.Tile = type { %struct.Node }\n%struct.Node = type { i32, %struct.Tile }");
+	ShaderCost cost{};
+	CHECK(!AnalyzeShaderDisassembly(listing, cost));
+}
+
+static void TestNoFunction()
+{
+	ShaderCost cost{};
+	CHECK(!AnalyzeShaderDisassembly("", cost));
+	CHECK(!AnalyzeShaderDisassembly("; only comments\n;\n", cost));
+}
+
+// Library with a node entry named through metadata and a leftover helper function
+static const char* const g_library_listing = R"(;
+; Resource Bindings:
+;
+; Name                                 Type  Format         Dim      ID      HLSL Bind  Count
+; ------------------------------ ---------- ------- ----------- ------- -------------- ------
+;
+target triple = "dxil-ms-dx"
+
+define void @"\01?Helper@@YAXXZ"() #0 {
+  ret void
+}
+
+define void @BroadcastNode() #0 {
+entry:
+  %0 = call i32 @dx.op.flattenedThreadIdInGroup.i32(i32 96)
+  br label %loop
+
+loop:
+  %1 = phi i32 [ 0, %entry ], [ %2, %loop ]
+  %2 = add i32 %1, 1
+  %3 = icmp ult i32 %2, %0
+  br i1 %3, label %loop, label %exit
+
+exit:
+  call void @dx.op.barrierByMemoryType(i32 244, i32 1, i32 2)
+  ret void
+}
+
+!dx.entryPoints = !{!3}
+
+!3 = !{void ()* @BroadcastNode, !"BroadcastNode", null, null, !4}
+!4 = !{i32 8, i32 15, i32 4, !5}
+!5 = !{i32 32, i32 2, i32 1}
+)";
+
+static void TestLibrary()
+{
+	ShaderCost cost{};
+	CHECK(AnalyzeShaderDisassembly(g_library_listing, cost));
+	ShaderCostMetrics& node = cost.m_functions["BroadcastNode"];
+	CHECK(node["instructions"] == 8);
+	CHECK(node["loops"] == 1);
+	CHECK(node["instructions.sync"] == 1);
+	CHECK(node["numthreads.x"] == 32 && node["numthreads.y"] == 2 && node["numthreads.z"] == 1);
+	CHECK(cost.m_functions["\"\\01?Helper@@YAXXZ\""]["instructions"] == 1);
+	CHECK(cost.m_functions[g_shader_cost_module]["bindings"] == 0);
+	CHECK(cost.m_functions[g_shader_cost_module]["groupshared_bytes"] == 0);
+}
+
+int main()
+{
+	TestCompute();
+	TestGroupsharedTypes();
+	TestRecursiveStruct();
+	TestNoFunction();
+	TestLibrary();
+	return GetTestResult();
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+// No Common.h, MemoryReporting.h redefines new in Debug
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64> g_allocation_count = 0;
+	thread_local uint64 t_thread_allocation_count = 0;
+
+	void CountAllocation()
+	{
+		g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+		++t_thread_allocation_count;
+	}
+}
+
+uint64 GetAllocationCount()
+{
+	return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+uint64 GetThreadAllocationCount()
+{
+	return t_thread_allocation_count;
+}
+
+// Every form is replaced, the defaults forwarding to the plain ones is not guaranteed by all runtimes
+void* operator new(std::size_t size)
+{
+	CountAllocation();
+	// Zero sized allocations still return a unique pointer
+	void* data = std::malloc(size == 0 ? 1 : size);
+	if (data == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return data;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	CountAllocation();
+	const std::size_t alignment_size = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+	void* data = _aligned_malloc(size == 0 ? 1 : size, alignment_size);
+#else
+	// Size has to be a multiple of the alignment
+	void* data = std::aligned_alloc(alignment_size, ((size == 0 ? 1 : size) + alignment_size - 1) / alignment_size * alignment_size);
+#endif
+	if (data == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return data;
+}
+
+void operator delete(void* data) noexcept
+{
+	std::free(data);
+}
+
+void operator delete(void* data, std::align_val_t) noexcept
+{
+#if defined(_WIN32)
+	_aligned_free(data);
+#else
+	std::free(data);
+#endif
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { try { return operator new(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return operator new(size); } catch (...) { return nullptr; } }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return operator new(size, alignment); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return operator new(size, alignment); } catch (...) { return nullptr; } }
+
+void operator delete[](void* data) noexcept { operator delete(data); }
+void operator delete(void* data, std::size_t) noexcept { operator delete(data); }
+void operator delete[](void* data, std::size_t) noexcept { operator delete(data); }
+void operator delete(void* data, const std::nothrow_t&) noexcept { operator delete(data); }
+void operator delete[](void* data, const std::nothrow_t&) noexcept { operator delete(data); }
+void operator delete[](void* data, std::align_val_t alignment) noexcept { operator delete(data, alignment); }
+void operator delete(void* data, std::size_t, std::align_val_t alignment) noexcept { operator delete(data, alignment); }
+void operator delete[](void* data, std::size_t, std::align_val_t alignment) noexcept { operator delete(data, alignment); }
+void operator delete(void* data, std::align_val_t alignment, const std::nothrow_t&) noexcept { operator delete(data, alignment); }
+void operator delete[](void* data, std::align_val_t alignment, const std::nothrow_t&) noexcept { operator delete(data, alignment); }
\ No newline at end of file
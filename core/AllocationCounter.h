@@ -0,0 +1,9 @@
+#pragma once
+#include "Types.h"
+
+// Global operator new and delete of the executable are replaced to count general purpose heap allocations
+// Not counted: other modules such as the D3D12 runtime and the driver, direct malloc calls such as the ImGui ones,
+// and in Debug the new expressions of files including MemoryReporting.h which go to the CRT debug new, containers are counted
+uint64 GetAllocationCount();
+// Allocations of the calling thread, its difference around a frame is what the frame costs to the render thread
+uint64 GetThreadAllocationCount();
\ No newline at end of file
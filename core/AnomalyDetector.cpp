@@ -0,0 +1,174 @@
+#include "AnomalyDetector.h"
+#include <algorithm>
+#include <fstream>
+
+void AnomalyDetector::Init(const AnomalyDetectorDesc& desc, const std::vector<std::string>& series_names)
+{
+	m_desc = desc;
+	m_series_names = series_names;
+	const uint32 series_count = (uint32)m_series_names.size();
+
+	m_baseline_samples.assign(m_desc.m_baseline_frame_count * series_count, 0.0);
+	m_baseline_sums.assign(series_count, 0.0);
+	m_baseline_count = 0;
+	m_baseline_cursor = 0;
+
+	m_history.assign(m_desc.m_history_frame_count * series_count, 0.0);
+	m_history_frames.assign(m_desc.m_history_frame_count, 0);
+	m_history_count = 0;
+	m_history_cursor = 0;
+
+	m_frame_index = 0;
+	m_cooldown_frames_left = 0;
+	m_trigger_series = 0;
+	m_trigger_milliseconds = 0.0;
+	m_trigger_baseline_milliseconds = 0.0;
+}
+
+bool AnomalyDetector::Update(const std::vector<float64>& milliseconds)
+{
+	const uint32 series_count = (uint32)m_series_names.size();
+	if (milliseconds.size() != series_count || m_desc.m_baseline_frame_count == 0)
+	{
+		return false;
+	}
+
+	if (m_desc.m_history_frame_count > 0)
+	{
+		std::copy(milliseconds.begin(), milliseconds.end(), m_history.begin() + m_history_cursor * series_count);
+		m_history_frames[m_history_cursor] = m_frame_index;
+		m_history_cursor = (m_history_cursor + 1) % m_desc.m_history_frame_count;
+		m_history_count = (std::min)(m_history_count + 1, m_desc.m_history_frame_count);
+	}
+	++m_frame_index;
+
+	// Judged against the baseline before the sample enters it
+	const bool is_baseline_full = m_baseline_count == m_desc.m_baseline_frame_count;
+	bool is_triggered = false;
+	if (m_cooldown_frames_left > 0)
+	{
+		--m_cooldown_frames_left;
+	}
+	else if (is_baseline_full)
+	{
+		// Largest spike relative to its baseline is reported
+		float64 max_ratio = 0.0;
+		for (uint32 series = 0; series < series_count; ++series)
+		{
+			const float64 baseline = GetBaselineMilliseconds(series);
+			const float64 sample = milliseconds[series];
+			if (sample > baseline * m_desc.m_spike_ratio && sample > baseline + m_desc.m_spike_margin_milliseconds)
+			{
+				const float64 ratio = baseline > 0.0 ? sample / baseline : sample;
+				if (!is_triggered || ratio > max_ratio)
+				{
+					max_ratio = ratio;
+					m_trigger_series = series;
+					m_trigger_milliseconds = sample;
+					m_trigger_baseline_milliseconds = baseline;
+				}
+				is_triggered = true;
+			}
+		}
+		if (is_triggered)
+		{
+			m_cooldown_frames_left = m_desc.m_cooldown_frame_count;
+		}
+	}
+
+	for (uint32 series = 0; series < series_count; ++series)
+	{
+		float64 sample = milliseconds[series];
+		if (is_baseline_full)
+		{
+			const float64 baseline = GetBaselineMilliseconds(series);
+			sample = (std::min)(sample, (std::max)(baseline * m_desc.m_spike_ratio, baseline + m_desc.m_spike_margin_milliseconds));
+		}
+		float64& slot = m_baseline_samples[m_baseline_cursor * series_count + series];
+		m_baseline_sums[series] += sample - slot;
+		slot = sample;
+	}
+	m_baseline_cursor = (m_baseline_cursor + 1) % m_desc.m_baseline_frame_count;
+	m_baseline_count = (std::min)(m_baseline_count + 1, m_desc.m_baseline_frame_count);
+	return is_triggered;
+}
+
+uint32 AnomalyDetector::GetTriggerSeries() const
+{
+	return m_trigger_series;
+}
+
+float64 AnomalyDetector::GetTriggerMilliseconds() const
+{
+	return m_trigger_milliseconds;
+}
+
+float64 AnomalyDetector::GetTriggerBaselineMilliseconds() const
+{
+	return m_trigger_baseline_milliseconds;
+}
+
+float64 AnomalyDetector::GetBaselineMilliseconds(uint32 series) const
+{
+	return m_baseline_count > 0 ? m_baseline_sums[series] / m_baseline_count : 0.0;
+}
+
+const std::vector<std::string>& AnomalyDetector::GetSeriesNames() const
+{
+	return m_series_names;
+}
+
+const AnomalyDetectorDesc& AnomalyDetector::GetDesc() const
+{
+	return m_desc;
+}
+
+bool AnomalyDetector::WriteHistory(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+	const uint32 series_count = (uint32)m_series_names.size();
+	file << "frame";
+	for (const std::string& name : m_series_names)
+	{
+		file << "," << name << " ms";
+	}
+	file << "\n";
+	// Oldest row is at the cursor once the ring wrapped
+	const uint32 first_row = m_history_count == m_desc.m_history_frame_count ? m_history_cursor : 0;
+	for (uint32 i = 0; i < m_history_count; ++i)
+	{
+		const uint32 row = (first_row + i) % m_desc.m_history_frame_count;
+		file << m_history_frames[row];
+		for (uint32 series = 0; series < series_count; ++series)
+		{
+			file << "," << m_history[row * series_count + series];
+		}
+		file << "\n";
+	}
+	file << "baseline";
+	for (uint32 series = 0; series < series_count; ++series)
+	{
+		file << "," << GetBaselineMilliseconds(series);
+	}
+	file << "\n";
+	return (bool)file;
+}
+
+std::vector<uint32> ReplayAnomalyDetector(const AnomalyDetectorDesc& desc, const std::vector<std::string>& series_names, const std::vector<std::vector<float64>>& frames)
+{
+	AnomalyDetector detector{};
+	detector.Init(desc, series_names);
+	std::vector<uint32> trigger_frames;
+	for (uint32 frame = 0; frame < frames.size(); ++frame)
+	{
+		if (detector.Update(frames[frame]))
+		{
+			trigger_frames.push_back(frame);
+		}
+	}
+	return trigger_frames;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include "Types.h"
+#include <string>
+#include <vector>
+
+// Settings of the timing spike detector, every series is judged against its own baseline
+struct AnomalyDetectorDesc
+{
+	// Frames averaged into the rolling baseline, no spike is reported before it is full
+	uint32 m_baseline_frame_count = 120;
+	// A sample is a spike when it is over the baseline by both the ratio and the margin
+	// The margin keeps noise on passes of a fraction of a millisecond from triggering
+	float64 m_spike_ratio = 2.0;
+	float64 m_spike_margin_milliseconds = 2.0;
+	// Frames captured once triggered
+	uint32 m_capture_frame_count = 2;
+	// Frames after a trigger during which spikes are ignored, one hitch gives one capture
+	uint32 m_cooldown_frame_count = 600;
+	// Frames of every series kept for the report written next to the capture
+	uint32 m_history_frame_count = 240;
+};
+
+// Watches per frame timing series, frame time and GPU passes, against a rolling baseline
+// Samples enter the baseline clamped to the spike threshold, a lasting change of cost is learned without a single hitch skewing it
+// No GPU dependency so it can be driven by recorded timings
+class AnomalyDetector
+{
+public:
+	void Init(const AnomalyDetectorDesc& desc, const std::vector<std::string>& series_names);
+
+	// One sample per series for the frame, true when a spike triggers
+	bool Update(const std::vector<float64>& milliseconds);
+
+	// Spike of the last trigger
+	uint32 GetTriggerSeries() const;
+	float64 GetTriggerMilliseconds() const;
+	float64 GetTriggerBaselineMilliseconds() const;
+
+	float64 GetBaselineMilliseconds(uint32 series) const;
+	const std::vector<std::string>& GetSeriesNames() const;
+	const AnomalyDetectorDesc& GetDesc() const;
+
+	// History as comma separated values, a row per frame oldest first, false when the file could not be written
+	bool WriteHistory(const std::string& path) const;
+private:
+	AnomalyDetectorDesc m_desc;
+	std::vector<std::string> m_series_names;
+
+	// Ring of clamped samples per series, m_baseline_frame_count entries each
+	std::vector<float64> m_baseline_samples;
+	std::vector<float64> m_baseline_sums;
+	uint32 m_baseline_count = 0;
+	uint32 m_baseline_cursor = 0;
+
+	// Ring of raw samples per frame, m_history_frame_count rows of one sample per series
+	std::vector<float64> m_history;
+	std::vector<uint64> m_history_frames;
+	uint32 m_history_count = 0;
+	uint32 m_history_cursor = 0;
+
+	uint64 m_frame_index = 0;
+	uint32 m_cooldown_frames_left = 0;
+	uint32 m_trigger_series = 0;
+	float64 m_trigger_milliseconds = 0.0;
+	float64 m_trigger_baseline_milliseconds = 0.0;
+};
+
+// Replays a recorded series set, a row of one sample per series for every frame
+// Returns the frames that triggered
+std::vector<uint32> ReplayAnomalyDetector(const AnomalyDetectorDesc& desc, const std::vector<std::string>& series_names, const std::vector<std::vector<float64>>& frames);
\ No newline at end of file
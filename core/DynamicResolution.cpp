@@ -0,0 +1,109 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolutionController::Init(const DynamicResolutionDesc& desc)
+{
+	m_desc = desc;
+	m_scale = m_desc.m_max_scale;
+	m_settle_frames_left = 0;
+	m_sample_count = 0;
+	m_sample_sum = 0.0;
+}
+
+void DynamicResolutionController::SetTargetMilliseconds(float64 target_milliseconds)
+{
+	m_desc.m_target_milliseconds = target_milliseconds;
+}
+
+float32 DynamicResolutionController::Update(float64 gpu_milliseconds)
+{
+	// Nothing measured, timestamps not resolved yet
+	if (gpu_milliseconds <= 0.0)
+	{
+		return m_scale;
+	}
+	// Still measuring frames rendered at the previous scale
+	if (m_settle_frames_left > 0)
+	{
+		--m_settle_frames_left;
+		return m_scale;
+	}
+	m_sample_sum += gpu_milliseconds;
+	++m_sample_count;
+	if (m_sample_count < m_desc.m_window_frame_count)
+	{
+		return m_scale;
+	}
+
+	const float64 average_milliseconds = m_sample_sum / m_sample_count;
+	m_sample_count = 0;
+	m_sample_sum = 0.0;
+
+	// Scale at which the cost would hit the target, pixel count grows with the square of the scale
+	const float32 ideal_scale = m_scale * (float32)std::sqrt(m_desc.m_target_milliseconds / average_milliseconds);
+	float32 next_scale = m_scale;
+	if (average_milliseconds > m_desc.m_target_milliseconds * m_desc.m_over_budget_ratio)
+	{
+		next_scale = QuantizeDown(ideal_scale);
+		// Over budget by less than a step still lowers by one
+		if (next_scale >= m_scale)
+		{
+			next_scale = m_scale - m_desc.m_scale_step;
+		}
+	}
+	else if (average_milliseconds < m_desc.m_target_milliseconds * m_desc.m_under_budget_ratio)
+	{
+		// Only raise when the next step is predicted to stay within budget
+		next_scale = (std::min)(m_scale + m_desc.m_scale_step, QuantizeDown(ideal_scale));
+	}
+	next_scale = std::clamp(next_scale, m_desc.m_min_scale, m_desc.m_max_scale);
+
+	if (next_scale != m_scale)
+	{
+		m_scale = next_scale;
+		m_settle_frames_left = m_desc.m_settle_frame_count;
+	}
+	return m_scale;
+}
+
+float32 DynamicResolutionController::GetScale() const
+{
+	return m_scale;
+}
+
+float64 DynamicResolutionController::GetAverageMilliseconds() const
+{
+	return m_sample_count > 0 ? m_sample_sum / m_sample_count : 0.0;
+}
+
+const DynamicResolutionDesc& DynamicResolutionController::GetDesc() const
+{
+	return m_desc;
+}
+
+float32 DynamicResolutionController::QuantizeDown(float32 scale) const
+{
+	// Epsilon keeps exact multiples from falling one step down
+	return std::floor(scale / m_desc.m_scale_step + 1e-4f) * m_desc.m_scale_step;
+}
+
+std::vector<float32> ReplayDynamicResolution(const DynamicResolutionDesc& desc, const std::vector<float64>& full_resolution_milliseconds, uint32 latency_frame_count)
+{
+	DynamicResolutionController controller{};
+	controller.Init(desc);
+	std::vector<float32> scales(full_resolution_milliseconds.size());
+	for (uint32 frame = 0; frame < scales.size(); ++frame)
+	{
+		scales[frame] = controller.GetScale();
+		// Timing of an earlier frame becomes available now
+		float64 gpu_milliseconds = 0.0;
+		if (frame >= latency_frame_count)
+		{
+			const uint32 measured_frame = frame - latency_frame_count;
+			gpu_milliseconds = full_resolution_milliseconds[measured_frame] * scales[measured_frame] * scales[measured_frame];
+		}
+		controller.Update(gpu_milliseconds);
+	}
+	return scales;
+}
\ No newline at end of file
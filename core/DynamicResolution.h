@@ -0,0 +1,51 @@
+#pragma once
+#include "Types.h"
+#include <vector>
+
+// Settings of the render scale controller, the scale applies to both width and height
+struct DynamicResolutionDesc
+{
+	// GPU budget of the scaled pass
+	float64 m_target_milliseconds = 4.0;
+	float32 m_min_scale = 0.25f;
+	float32 m_max_scale = 1.0f;
+	// Scales are multiples of the step so small timing noise never changes the resolution
+	float32 m_scale_step = 0.05f;
+	// Hysteresis band relative to the target, lowers above the first and raises below the second
+	float64 m_over_budget_ratio = 1.05;
+	float64 m_under_budget_ratio = 0.85;
+	// Samples ignored after a change, covers the latency of the timestamp readback
+	uint32 m_settle_frame_count = 8;
+	// Samples averaged before deciding
+	uint32 m_window_frame_count = 8;
+};
+
+// Chooses the render scale from the GPU time of the scaled pass, cost is assumed proportional to the pixel count
+// Lowers as far as needed in one change, raises one step at a time
+// No GPU dependency so it can be driven by recorded timings
+class DynamicResolutionController
+{
+public:
+	void Init(const DynamicResolutionDesc& desc);
+	void SetTargetMilliseconds(float64 target_milliseconds);
+
+	// GPU time of a frame rendered with a scale returned earlier, returns the scale of the next frame
+	float32 Update(float64 gpu_milliseconds);
+
+	float32 GetScale() const;
+	// Average of the current window, 0 until the first sample after a change
+	float64 GetAverageMilliseconds() const;
+	const DynamicResolutionDesc& GetDesc() const;
+private:
+	float32 QuantizeDown(float32 scale) const;
+
+	DynamicResolutionDesc m_desc;
+	float32 m_scale = 1.0f;
+	uint32 m_settle_frames_left = 0;
+	uint32 m_sample_count = 0;
+	float64 m_sample_sum = 0.0;
+};
+
+// Replays a trace of full resolution GPU times, each sample is seen latency_frame_count frames later at the scale of its frame
+// Returns the scale chosen for every frame
+std::vector<float32> ReplayDynamicResolution(const DynamicResolutionDesc& desc, const std::vector<float64>& full_resolution_milliseconds, uint32 latency_frame_count);
\ No newline at end of file
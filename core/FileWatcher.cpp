@@ -0,0 +1,90 @@
+#include "FileWatcher.h"
+
+FileWatcher::~FileWatcher()
+{
+	if (m_directory_handle != INVALID_HANDLE_VALUE)
+	{
+		// Pending read still references m_buffer and m_overlapped
+		CancelIoEx(m_directory_handle, &m_overlapped);
+		DWORD bytes = 0;
+		GetOverlappedResult(m_directory_handle, &m_overlapped, &bytes, TRUE);
+		CloseHandle(m_directory_handle);
+	}
+	if (m_overlapped.hEvent != nullptr)
+	{
+		CloseHandle(m_overlapped.hEvent);
+	}
+}
+
+bool FileWatcher::Init(const std::string& directory)
+{
+	m_directory = directory;
+	m_directory_handle = CreateFileW
+	(
+		std::to_wstring(directory).c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		// Backup semantics required to open a directory
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr
+	);
+	if (m_directory_handle == INVALID_HANDLE_VALUE)
+	{
+		LOG_ERROR(General, "File watcher failed to open {0}", directory);
+		return false;
+	}
+	m_overlapped.hEvent = CreateEvent(nullptr, true, false, nullptr);
+	ASSERT(m_overlapped.hEvent != nullptr);
+	return IssueRead();
+}
+
+bool FileWatcher::IssueRead()
+{
+	ResetEvent(m_overlapped.hEvent);
+	const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+	bool success = ReadDirectoryChangesW(m_directory_handle, m_buffer, sizeof(m_buffer), false, filter, nullptr, &m_overlapped, nullptr);
+	if (!success)
+	{
+		LOG_ERROR(General, "File watcher failed to watch {0}", m_directory);
+	}
+	return success;
+}
+
+std::vector<std::string> FileWatcher::Poll()
+{
+	std::vector<std::string> changed_files{};
+	if (m_directory_handle == INVALID_HANDLE_VALUE)
+	{
+		return changed_files;
+	}
+
+	DWORD bytes = 0;
+	// Fails with ERROR_IO_INCOMPLETE while nothing changed
+	while (GetOverlappedResult(m_directory_handle, &m_overlapped, &bytes, false))
+	{
+		if (bytes == 0)
+		{
+			// Buffer overflow, changes are lost
+			LOG_ERROR(General, "File watcher overflow on {0}", m_directory);
+		}
+		uint32 offset = 0;
+		while (bytes > 0)
+		{
+			const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(m_buffer + offset);
+			// Editors often save through a temporary file renamed over the original
+			if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+			{
+				const std::wstring file_name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+				changed_files.push_back(m_directory + "\\" + std::to_string(file_name));
+			}
+			if (info->NextEntryOffset == 0)
+			{
+				break;
+			}
+			offset += info->NextEntryOffset;
+		}
+		if (!IssueRead())
+		{
+			break;
+		}
+	}
+	return changed_files;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include "Common.h"
+
+// Non recursive watch of a directory through ReadDirectoryChangesW
+// Overlapped read polled from the caller, no thread
+class FileWatcher
+{
+public:
+	FileWatcher() = default;
+	~FileWatcher();
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	bool Init(const std::string& directory);
+	// Paths (directory + file name) written, created or renamed since the last poll, non blocking
+	std::vector<std::string> Poll();
+private:
+	bool IssueRead();
+
+	std::string m_directory;
+	HANDLE m_directory_handle = INVALID_HANDLE_VALUE;
+	OVERLAPPED m_overlapped{};
+	// FILE_NOTIFY_INFORMATION requires DWORD alignment
+	alignas(DWORD) uint8 m_buffer[16 * 1024];
+};
\ No newline at end of file
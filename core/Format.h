@@ -0,0 +1,12 @@
+#pragma once
+#include <version>
+
+// std::format where the standard library has it, otherwise the fmt bundled with spdlog, same replacement field syntax
+// Portable core formats through format_library, the Windows only code keeps using std directly
+#if defined(__cpp_lib_format)
+#include <format>
+namespace format_library = std;
+#else
+#include <spdlog/fmt/fmt.h>
+namespace format_library = fmt;
+#endif
\ No newline at end of file
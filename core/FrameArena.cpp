@@ -0,0 +1,81 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// Aligns the address rather than the offset, alignments over the one of new uint8[] are honored too
+	uint64 AlignOffset(const uint8* data, uint64 offset, uint64 alignment)
+	{
+		const uintptr_t address = reinterpret_cast<uintptr_t>(data + offset);
+		return offset + ((alignment - address % alignment) % alignment);
+	}
+}
+
+FrameArena::FrameArena(uint64 capacity)
+{
+	m_blocks.push_back({ .m_data = std::make_unique<uint8[]>(capacity), .m_size = capacity });
+}
+
+void* FrameArena::Allocate(uint64 size, uint64 alignment)
+{
+	uint64 begin = AlignOffset(m_blocks.back().m_data.get(), m_offset, alignment);
+	if (begin + size > m_blocks.back().m_size)
+	{
+		// Rest of the frame goes to a new block, the end of the current one is counted as used
+		m_used_bytes += m_blocks.back().m_size - m_offset;
+		const uint64 block_size = (std::max)(m_blocks.back().m_size, size + alignment);
+		m_blocks.push_back({ .m_data = std::make_unique<uint8[]>(block_size), .m_size = block_size });
+		m_offset = 0;
+		begin = AlignOffset(m_blocks.back().m_data.get(), m_offset, alignment);
+	}
+	m_used_bytes += begin + size - m_offset;
+	m_offset = begin + size;
+	m_peak_bytes = (std::max)(m_peak_bytes, m_used_bytes);
+	return m_blocks.back().m_data.get() + begin;
+}
+
+std::string_view FrameArena::CopyString(std::string_view string)
+{
+	char* chars = AllocateArray<char>(string.size() + 1);
+	memcpy(chars, string.data(), string.size());
+	return { chars, string.size() };
+}
+
+void FrameArena::Reset()
+{
+	if (m_blocks.size() > 1)
+	{
+		// Sized for the peak, every overflow shows up once
+		uint64 capacity = 0;
+		for (const Block& block : m_blocks)
+		{
+			capacity += block.m_size;
+		}
+		m_blocks.clear();
+		m_blocks.push_back({ .m_data = std::make_unique<uint8[]>(capacity), .m_size = capacity });
+		++m_grow_count;
+	}
+	m_offset = 0;
+	m_used_bytes = 0;
+}
+
+uint64 FrameArena::GetCapacity() const
+{
+	return m_blocks.front().m_size;
+}
+
+uint64 FrameArena::GetUsedBytes() const
+{
+	return m_used_bytes;
+}
+
+uint64 FrameArena::GetPeakBytes() const
+{
+	return m_peak_bytes;
+}
+
+uint32 FrameArena::GetGrowCount() const
+{
+	return m_grow_count;
+}
\ No newline at end of file
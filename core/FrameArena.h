@@ -0,0 +1,56 @@
+#pragma once
+#include "Types.h"
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data living until the next Reset, typically until the frame of a backbuffer index is done on the GPU
+// Allocating bumps an offset and Reset rewinds it, no destructor is run
+// Overflow chains another block for the rest of the frame, Reset merges the chain so the next frames fit in one block
+class FrameArena
+{
+public:
+	explicit FrameArena(uint64 capacity = 1 << 16);
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Alignment is a power of 2
+	void* Allocate(uint64 size, uint64 alignment = alignof(std::max_align_t));
+
+	// Value initialized
+	template<typename T>
+	T* AllocateArray(uint64 count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Arena memory is released without running destructors");
+		T* values = static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+		std::uninitialized_value_construct_n(values, count);
+		return values;
+	}
+
+	// Null terminated copy
+	std::string_view CopyString(std::string_view string);
+
+	void Reset();
+
+	uint64 GetCapacity() const;
+	uint64 GetUsedBytes() const;
+	// Highest usage between two resets, alignment padding included
+	uint64 GetPeakBytes() const;
+	// Resets that had to merge overflow blocks, non zero after warm up means the capacity is too small
+	uint32 GetGrowCount() const;
+private:
+	struct Block
+	{
+		std::unique_ptr<uint8[]> m_data;
+		uint64 m_size = 0;
+	};
+
+	// Allocations come from the last block
+	std::vector<Block> m_blocks;
+	uint64 m_offset = 0;
+	uint64 m_used_bytes = 0;
+	uint64 m_peak_bytes = 0;
+	uint32 m_grow_count = 0;
+};
\ No newline at end of file
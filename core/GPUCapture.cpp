@@ -85,11 +85,11 @@ bool LoadPIX(HMODULE* pix_module_out)
 	{
 		auto[pix_path, pix_version] = GetWinPixGpuCapturerPath();
 		pix_module = LoadLibrary(std::to_wstring(pix_path).c_str());
-		LogTrace(pix_version);
+		LOG_TRACE(Device, pix_version);
 	}
 	else
 	{
-		LogTrace("PIX is already loaded");
+		LOG_TRACE(Device, "PIX is already loaded");
 	}
 	*pix_module_out = pix_module;
 
@@ -140,12 +140,17 @@ void PIXCapture::OpenCapture()
 	ShellExecute(0, 0, pix_absolute_path_wstring.c_str(), 0, 0, SW_SHOW);
 }
 
+const std::string& PIXCapture::GetCapturePath() const
+{
+	return m_pix_absolute_path;
+}
+
 void PIXCapture::Init()
 {
 	bool success = LoadPIX(&m_pix_module);
 	if (!success)
 	{
-		LogError("PIX not installed {}\n", GetLastError());
+		LOG_ERROR(Device, "PIX not installed {}\n", GetLastError());
 	}
 }
 
@@ -279,12 +284,17 @@ void RenderDocCapture::OpenCapture()
 	ShellExecute(0, 0, renderdoc_absolute_path_wstring.c_str(), 0, 0, SW_SHOW);
 }
 
+const std::string& RenderDocCapture::GetCapturePath() const
+{
+	return m_renderdoc_absolute_path;
+}
+
 void RenderDocCapture::Init()
 {
 	bool success = LoadRenderdoc(&m_renderdoc_module, &m_renderdoc_api);
 	if (!success)
 	{
-		LogError("RenderDoc not installed {}\n", GetLastError());
+		LOG_ERROR(Device, "RenderDoc not installed {}\n", GetLastError());
 	}
 }
 
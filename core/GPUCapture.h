@@ -10,6 +10,8 @@ public:
 	virtual void StartCapture() = 0;
 	virtual void EndCapture() = 0;
 	virtual void OpenCapture() = 0;
+	// File of the last capture, known once EndCapture returned
+	virtual const std::string& GetCapturePath() const = 0;
 };
 
 class PIXCapture : public GPUCapture
@@ -20,6 +22,7 @@ public:
 	virtual void StartCapture();
 	virtual void EndCapture();
 	virtual void OpenCapture();
+	virtual const std::string& GetCapturePath() const;
 private:
 	void Init();
 	void Close();
@@ -38,6 +41,7 @@ public:
 	virtual void StartCapture();
 	virtual void EndCapture();
 	virtual void OpenCapture();
+	virtual const std::string& GetCapturePath() const;
 private:
 	void Init();
 	void Close();
@@ -0,0 +1,32 @@
+#pragma once
+#include "Types.h"
+#include <string>
+#include <type_traits>
+
+// FNV-1a 64 bits, not cryptographic, meant for cache keys
+static const uint64 g_hash_seed = 0xcbf29ce484222325ull;
+
+inline uint64 Hash64(const void* data, uint64 size_in_bytes, uint64 seed = g_hash_seed)
+{
+	const uint8* bytes = static_cast<const uint8*>(data);
+	uint64 hash = seed;
+	for (uint64 i = 0; i < size_in_bytes; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+inline uint64 Hash64(const std::string& string, uint64 seed = g_hash_seed)
+{
+	// Include the terminator so consecutive strings hash differently than their concatenation
+	return Hash64(string.c_str(), string.size() + 1, seed);
+}
+
+template<typename T>
+uint64 Hash64(const T& value, uint64 seed = g_hash_seed)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Hashed bytewise");
+	return Hash64(&value, sizeof(T), seed);
+}
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include "ImageEncoding.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	// Deflate stored blocks hold at most 65535 bytes
+	const uint32 g_stored_block_size = 65535;
+
+	// Table t is the CRC of a byte followed by t zero bytes
+	struct CRC32Tables
+	{
+		uint32 m_values[8][256];
+
+		CRC32Tables()
+		{
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				uint32 value = i;
+				for (uint32 bit = 0; bit < 8; ++bit)
+				{
+					value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				}
+				m_values[0][i] = value;
+			}
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				for (uint32 t = 1; t < 8; ++t)
+				{
+					m_values[t][i] = (m_values[t - 1][i] >> 8) ^ m_values[0][m_values[t - 1][i] & 0xFF];
+				}
+			}
+		}
+	};
+
+	// Slicing by 8, independent lookups for 8 bytes instead of a dependent one per byte, little endian
+	uint32 UpdateCRC32(uint32 crc, const uint8* data, uint64 size)
+	{
+		static const CRC32Tables tables{};
+		const auto& table = tables.m_values;
+		uint64 i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			uint32 low = 0;
+			uint32 high = 0;
+			memcpy(&low, data + i, sizeof(low));
+			memcpy(&high, data + i + 4, sizeof(high));
+			low ^= crc;
+			crc =
+				table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+				table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+		}
+		for (; i < size; ++i)
+		{
+			crc = table[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+	void WriteBigEndian32(std::vector<uint8>& out, uint32 value)
+	{
+		out.push_back((uint8)(value >> 24));
+		out.push_back((uint8)(value >> 16));
+		out.push_back((uint8)(value >> 8));
+		out.push_back((uint8)value);
+	}
+
+	template<typename T>
+	void WriteLittleEndian(std::vector<uint8>& out, T value)
+	{
+		const uint8* bytes = reinterpret_cast<const uint8*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+
+	void WriteString(std::vector<uint8>& out, const char* value)
+	{
+		out.insert(out.end(), value, value + strlen(value) + 1);
+	}
+
+	// Length, type, data and CRC of type and data
+	void WritePNGChunk(std::vector<uint8>& out, const char* type, const uint8* data, uint64 size)
+	{
+		WriteBigEndian32(out, (uint32)size);
+		const uint64 type_offset = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data, data + size);
+		const uint32 crc = UpdateCRC32(0xFFFFFFFFu, out.data() + type_offset, size + 4) ^ 0xFFFFFFFFu;
+		WriteBigEndian32(out, crc);
+	}
+
+	// Bits of R, G, B and A from the low bits up
+	struct ChannelLayout
+	{
+		uint32 m_bits[4];
+	};
+
+	ChannelLayout GetChannelLayout(ImagePixelFormat format)
+	{
+		return format == ImagePixelFormat::R8G8B8A8_UNORM ? ChannelLayout{ 8, 8, 8, 8 } : ChannelLayout{ 10, 10, 10, 2 };
+	}
+}
+
+std::vector<uint8> EncodePNG(const ImageView& image)
+{
+	const bool is_16_bit = image.m_format == ImagePixelFormat::R10G10B10A2_UNORM;
+	const uint32 bytes_per_texel = is_16_bit ? 8 : 4;
+	// Filter type byte in front of every row, 0 is no filter
+	const uint64 row_size = 1 + (uint64)image.m_width * bytes_per_texel;
+	std::vector<uint8> rows(row_size * image.m_height, 0);
+	for (uint32 y = 0; y < image.m_height; ++y)
+	{
+		const uint8* source = image.m_data + (uint64)y * image.m_row_pitch;
+		uint8* destination = rows.data() + y * row_size + 1;
+		if (!is_16_bit)
+		{
+			memcpy(destination, source, (uint64)image.m_width * 4);
+			continue;
+		}
+		for (uint32 x = 0; x < image.m_width; ++x)
+		{
+			uint32 texel = 0;
+			memcpy(&texel, source + x * 4, sizeof(texel));
+			// Bit replication of the 10 and 2 bit values, big endian samples
+			const uint32 channels[4] =
+			{
+				((texel & 0x3FF) << 6) | ((texel & 0x3FF) >> 4),
+				(((texel >> 10) & 0x3FF) << 6) | (((texel >> 10) & 0x3FF) >> 4),
+				(((texel >> 20) & 0x3FF) << 6) | (((texel >> 20) & 0x3FF) >> 4),
+				(texel >> 30) * 0x5555,
+			};
+			for (uint32 c = 0; c < 4; ++c)
+			{
+				destination[x * 8 + c * 2 + 0] = (uint8)(channels[c] >> 8);
+				destination[x * 8 + c * 2 + 1] = (uint8)channels[c];
+			}
+		}
+	}
+
+	// Zlib stream of stored blocks, Adler-32 of the uncompressed rows at the end
+	std::vector<uint8> zlib{};
+	zlib.reserve(rows.size() + rows.size() / g_stored_block_size * 5 + 16);
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	uint64 offset = 0;
+	do
+	{
+		const uint32 block_size = (uint32)(std::min)(rows.size() - offset, (uint64)g_stored_block_size);
+		const bool is_last = offset + block_size == rows.size();
+		zlib.push_back(is_last ? 1 : 0);
+		WriteLittleEndian(zlib, (uint16)block_size);
+		WriteLittleEndian(zlib, (uint16)~block_size);
+		zlib.insert(zlib.end(), rows.begin() + offset, rows.begin() + offset + block_size);
+		offset += block_size;
+	} while (offset < rows.size());
+	uint32 adler_a = 1;
+	uint32 adler_b = 0;
+	for (uint64 i = 0; i < rows.size(); )
+	{
+		// Largest run before the sums can overflow
+		const uint64 end = (std::min)(i + 5552, (uint64)rows.size());
+		for (; i < end; ++i)
+		{
+			adler_a += rows[i];
+			adler_b += adler_a;
+		}
+		adler_a %= 65521;
+		adler_b %= 65521;
+	}
+	WriteBigEndian32(zlib, (adler_b << 16) | adler_a);
+
+	// Starts as the signature, inserting it into an empty reserved vector trips a false -Wstringop-overflow of GCC 12
+	const uint8 signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<uint8> out(signature, signature + sizeof(signature));
+	out.reserve(zlib.size() + 64);
+	std::vector<uint8> header{};
+	WriteBigEndian32(header, image.m_width);
+	WriteBigEndian32(header, image.m_height);
+	// Bit depth, RGBA color type, deflate, adaptive filtering, no interlace
+	const uint8 header_fields[] = { (uint8)(is_16_bit ? 16 : 8), 6, 0, 0, 0 };
+	header.insert(header.end(), header_fields, header_fields + sizeof(header_fields));
+	WritePNGChunk(out, "IHDR", header.data(), header.size());
+	WritePNGChunk(out, "IDAT", zlib.data(), zlib.size());
+	WritePNGChunk(out, "IEND", nullptr, 0);
+	return out;
+}
+
+std::vector<uint8> EncodeEXR(const ImageView& image)
+{
+	std::vector<uint8> out{};
+	// Magic number and version 2, single part scanline
+	WriteLittleEndian(out, (uint32)20000630);
+	WriteLittleEndian(out, (uint32)2);
+
+	// Channels are sorted by name, A B G R
+	const char* channel_names[] = { "A", "B", "G", "R" };
+	const uint32 channel_order[] = { 3, 2, 1, 0 };
+	WriteString(out, "channels");
+	WriteString(out, "chlist");
+	WriteLittleEndian(out, (uint32)(4 * 18 + 1));
+	for (const char* name : channel_names)
+	{
+		WriteString(out, name);
+		// Half, not perceptually linear, reserved bytes, no subsampling
+		WriteLittleEndian(out, (uint32)1);
+		WriteLittleEndian(out, (uint32)0);
+		WriteLittleEndian(out, (uint32)1);
+		WriteLittleEndian(out, (uint32)1);
+	}
+	out.push_back(0);
+
+	WriteString(out, "compression");
+	WriteString(out, "compression");
+	WriteLittleEndian(out, (uint32)1);
+	out.push_back(0);
+
+	const int32 window[] = { 0, 0, (int32)image.m_width - 1, (int32)image.m_height - 1 };
+	for (const char* name : { "dataWindow", "displayWindow" })
+	{
+		WriteString(out, name);
+		WriteString(out, "box2i");
+		WriteLittleEndian(out, (uint32)sizeof(window));
+		for (int32 value : window)
+		{
+			WriteLittleEndian(out, value);
+		}
+	}
+
+	// Increasing y
+	WriteString(out, "lineOrder");
+	WriteString(out, "lineOrder");
+	WriteLittleEndian(out, (uint32)1);
+	out.push_back(0);
+
+	WriteString(out, "pixelAspectRatio");
+	WriteString(out, "float");
+	WriteLittleEndian(out, (uint32)4);
+	WriteLittleEndian(out, 1.0f);
+
+	WriteString(out, "screenWindowCenter");
+	WriteString(out, "v2f");
+	WriteLittleEndian(out, (uint32)8);
+	WriteLittleEndian(out, 0.0f);
+	WriteLittleEndian(out, 0.0f);
+
+	WriteString(out, "screenWindowWidth");
+	WriteString(out, "float");
+	WriteLittleEndian(out, (uint32)4);
+	WriteLittleEndian(out, 1.0f);
+	out.push_back(0);
+
+	// Half of every UNORM value of each channel, at most 1024 values
+	const ChannelLayout layout = GetChannelLayout(image.m_format);
+	std::vector<uint16> halfs[4];
+	uint32 shifts[4] = {};
+	for (uint32 c = 0; c < 4; ++c)
+	{
+		const uint32 value_count = 1u << layout.m_bits[c];
+		shifts[c] = c == 0 ? 0 : shifts[c - 1] + layout.m_bits[c - 1];
+		halfs[c].resize(value_count);
+		for (uint32 value = 0; value < value_count; ++value)
+		{
+			halfs[c][value] = FloatToHalf((float32)value / (float32)(value_count - 1));
+		}
+	}
+
+	// Offset table, one chunk per scanline without compression
+	const uint32 line_size = image.m_width * 4 * sizeof(uint16);
+	const uint64 table_offset = out.size();
+	out.resize(table_offset + (uint64)image.m_height * sizeof(uint64));
+	out.reserve(out.size() + (uint64)image.m_height * (8 + line_size));
+	std::vector<uint16> line(image.m_width * 4);
+	for (uint32 y = 0; y < image.m_height; ++y)
+	{
+		const uint64 chunk_offset = out.size();
+		memcpy(out.data() + table_offset + y * sizeof(uint64), &chunk_offset, sizeof(chunk_offset));
+		WriteLittleEndian(out, (int32)y);
+		WriteLittleEndian(out, line_size);
+		// Planar within the line, every channel of the line in turn
+		const uint8* row = image.m_data + (uint64)y * image.m_row_pitch;
+		for (uint32 c = 0; c < 4; ++c)
+		{
+			const uint32 channel = channel_order[c];
+			const uint32 mask = (1u << layout.m_bits[channel]) - 1;
+			uint16* destination = line.data() + c * image.m_width;
+			for (uint32 x = 0; x < image.m_width; ++x)
+			{
+				uint32 texel = 0;
+				memcpy(&texel, row + x * 4, sizeof(texel));
+				destination[x] = halfs[channel][(texel >> shifts[channel]) & mask];
+			}
+		}
+		const uint8* line_bytes = reinterpret_cast<const uint8*>(line.data());
+		out.insert(out.end(), line_bytes, line_bytes + line_size);
+	}
+	return out;
+}
+
+std::vector<uint8> EncodeImage(const ImageView& image, ImageFileFormat format)
+{
+	return format == ImageFileFormat::PNG ? EncodePNG(image) : EncodeEXR(image);
+}
+
+bool WriteImageFile(const std::string& path, const ImageView& image, ImageFileFormat format)
+{
+	const std::vector<uint8> data = EncodeImage(image, format);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return file.good();
+}
+
+uint16 FloatToHalf(float32 value)
+{
+	uint32 bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32 sign = (bits >> 16) & 0x8000;
+	const int32 exponent = (int32)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32 mantissa = bits & 0x7FFFFF;
+	if (exponent >= 31)
+	{
+		return (uint16)(sign | 0x7C00);
+	}
+	if (exponent <= 0)
+	{
+		// Subnormal, the implicit one becomes explicit
+		if (exponent < -10)
+		{
+			return (uint16)sign;
+		}
+		mantissa |= 0x800000;
+		const uint32 shift = (uint32)(14 - exponent);
+		const uint32 half = (mantissa >> shift) + ((mantissa >> (shift - 1)) & 1);
+		return (uint16)(sign | half);
+	}
+	// A rounding carry into the exponent is the correct result
+	const uint32 half = (((uint32)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1);
+	return (uint16)(sign | half);
+}
\ No newline at end of file
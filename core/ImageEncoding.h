@@ -0,0 +1,48 @@
+#pragma once
+#include "Types.h"
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Texel layouts the screen capture reads back, 4 bytes each
+enum class ImagePixelFormat : uint8
+{
+	R8G8B8A8_UNORM,
+	R10G10B10A2_UNORM,
+	Count
+};
+
+enum class ImageFileFormat : uint8
+{
+	PNG,
+	EXR,
+	Count
+};
+
+constexpr const char* g_image_file_format_names[] = { "PNG", "EXR" };
+constexpr const char* g_image_file_extensions[] = { ".png", ".exr" };
+static_assert(std::size(g_image_file_format_names) == static_cast<uint32>(ImageFileFormat::Count));
+static_assert(std::size(g_image_file_extensions) == static_cast<uint32>(ImageFileFormat::Count));
+
+// Rows of width texels, row_pitch bytes apart, as laid out in a readback buffer
+struct ImageView
+{
+	const uint8* m_data = nullptr;
+	uint32 m_width = 0;
+	uint32 m_height = 0;
+	uint32 m_row_pitch = 0;
+	ImagePixelFormat m_format = ImagePixelFormat::R8G8B8A8_UNORM;
+};
+
+// RGBA PNG, 8 bits per channel from R8G8B8A8 and 16 from R10G10B10A2 so no precision is lost
+// Deflate stored blocks, encoding costs about a copy of the image, the disk pays for the size
+std::vector<uint8> EncodePNG(const ImageView& image);
+// Scanline OpenEXR with uncompressed half RGBA, values as stored in 0 to 1 without transfer function
+std::vector<uint8> EncodeEXR(const ImageView& image);
+std::vector<uint8> EncodeImage(const ImageView& image, ImageFileFormat format);
+
+// False when the file could not be written
+bool WriteImageFile(const std::string& path, const ImageView& image, ImageFileFormat format);
+
+// Round to nearest, no NaN or infinity in UNORM sources
+uint16 FloatToHalf(float32 value);
\ No newline at end of file
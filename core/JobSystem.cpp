@@ -0,0 +1,585 @@
+#include "JobSystem.h"
+#include "WorkStealingDeque.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+struct JobSystem::Job
+{
+	JobFunction m_function;
+	JobCounter* m_counter = nullptr;
+	const JobCounter* m_dependency = nullptr;
+	uint32 m_affinity = g_job_any_worker;
+};
+
+// Mutex protected FIFO for the rare paths, the count lets empty queues be skipped without locking
+struct JobSystem::JobQueue
+{
+	void Push(Job* job)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+		m_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Job* TryPop()
+	{
+		if (m_count.load(std::memory_order_relaxed) == 0)
+		{
+			return nullptr;
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_jobs.empty())
+		{
+			return nullptr;
+		}
+		Job* job = m_jobs.front();
+		m_jobs.pop_front();
+		m_count.fetch_sub(1, std::memory_order_relaxed);
+		return job;
+	}
+
+	std::mutex m_mutex;
+	std::deque<Job*> m_jobs;
+	std::atomic<uint32> m_count = 0;
+};
+
+struct JobSystem::Worker
+{
+	WorkStealingDeque<Job> m_deque;
+	// Jobs submitted with this worker as affinity
+	JobQueue m_mailbox;
+	uint32 m_random_state = 0;
+	std::atomic<uint64> m_steal_count = 0;
+	// Counted by the slot of the thread doing it
+	std::atomic<uint64> m_submitted_count = 0;
+	std::atomic<uint64> m_finished_count = 0;
+
+	// Guarded by m_sleep_mutex
+	std::condition_variable m_wake_condition;
+	bool m_is_sleeping = false;
+	std::thread m_thread;
+};
+
+// Recycled job nodes of a thread, jobs mostly run on the thread that spawned them so most submits skip the heap
+struct JobSystem::JobCache
+{
+	~JobCache()
+	{
+		for (Job* job : m_jobs)
+		{
+			delete job;
+		}
+	}
+
+	std::vector<Job*> m_jobs;
+};
+
+// Shared by the ranges of a ParallelFor, lives on the stack of the waiting caller
+struct JobSystem::ParallelForState
+{
+	JobSystem* m_job_system = nullptr;
+	const RangeFunction* m_function = nullptr;
+	JobCounter m_counter;
+	uint32 m_batch_size = 1;
+};
+
+namespace
+{
+	const uint32 g_job_cache_size = 256;
+
+	// System the thread is a worker of or helps from outside, and its slot
+	thread_local JobSystem* t_current_system = nullptr;
+	thread_local uint32 t_worker_index = 0;
+}
+
+JobSystem::JobSystem(uint32 worker_count)
+{
+	if (worker_count == 0)
+	{
+		worker_count = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+	m_worker_count = worker_count;
+	m_injection_queue = std::make_unique<JobQueue>();
+	m_waiting_jobs.reserve(64);
+	m_workers.reserve(GetThreadSlotCount());
+	for (uint32 i = 0; i < GetThreadSlotCount(); ++i)
+	{
+		m_workers.push_back(std::make_unique<Worker>());
+		// Distinct non zero xorshift seeds
+		m_workers[i]->m_random_state = 0x9E3779B9u * (i + 1);
+	}
+	// Started once every slot exists, they steal from each other right away
+	for (uint32 i = 0; i < m_worker_count; ++i)
+	{
+		m_workers[i]->m_thread = std::thread(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	// Running jobs may still spawn some
+	HelpUntil([this]() { return IsIdle(); });
+	{
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		m_stop = true;
+	}
+	for (uint32 i = 0; i < m_worker_count; ++i)
+	{
+		m_workers[i]->m_wake_condition.notify_one();
+	}
+	for (uint32 i = 0; i < m_worker_count; ++i)
+	{
+		m_workers[i]->m_thread.join();
+	}
+}
+
+void JobSystem::Submit(JobFunction function, JobCounter* counter, uint32 affinity)
+{
+	Enqueue(CreateJob(std::move(function), counter, affinity));
+}
+
+void JobSystem::SubmitAfter(const JobCounter& dependency, JobFunction function, JobCounter* counter, uint32 affinity)
+{
+	Job* job = CreateJob(std::move(function), counter, affinity);
+	job->m_dependency = &dependency;
+	{
+		std::lock_guard<std::mutex> lock(m_waiting_mutex);
+		m_waiting_jobs.push_back(job);
+		m_waiting_count.fetch_add(1, std::memory_order_seq_cst);
+	}
+	// The dependency may have reached zero before the job was registered, either this or its last job sees the other
+	if (dependency.m_value.load(std::memory_order_seq_cst) == 0)
+	{
+		ReleaseDependents();
+	}
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	HelpUntil([&counter]() { return counter.IsDone(); });
+}
+
+void JobSystem::ParallelFor(uint32 count, uint32 batch_size, const RangeFunction& function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	ParallelForState state{ .m_job_system = this, .m_function = &function, .m_counter = {}, .m_batch_size = (std::max)(batch_size, 1u) };
+	SubmitRange(state, 0, count);
+	Wait(state.m_counter);
+}
+
+uint32 JobSystem::GetWorkerCount() const
+{
+	return m_worker_count;
+}
+
+uint32 JobSystem::GetThreadSlotCount() const
+{
+	return m_worker_count + 1;
+}
+
+uint64 JobSystem::GetStealCount() const
+{
+	uint64 steal_count = 0;
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		steal_count += worker->m_steal_count.load(std::memory_order_relaxed);
+	}
+	return steal_count;
+}
+
+JobSystem::Job* JobSystem::CreateJob(JobFunction function, JobCounter* counter, uint32 affinity)
+{
+	Job* job = AllocateJob();
+	job->m_function = std::move(function);
+	job->m_counter = counter;
+	job->m_affinity = affinity == g_job_any_worker ? affinity : affinity % m_worker_count;
+	if (counter != nullptr)
+	{
+		counter->m_value.fetch_add(1, std::memory_order_relaxed);
+	}
+	const uint32 slot = t_current_system == this ? t_worker_index : m_worker_count;
+	m_workers[slot]->m_submitted_count.fetch_add(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::Enqueue(Job* job)
+{
+	// The job may run and be freed as soon as it is pushed
+	const uint32 affinity = job->m_affinity;
+	if (affinity != g_job_any_worker)
+	{
+		m_workers[affinity]->m_mailbox.Push(job);
+	}
+	else if (t_current_system == this)
+	{
+		// Helper included, a slot is only used by one thread at a time
+		m_workers[t_worker_index]->m_deque.Push(job);
+	}
+	else
+	{
+		m_injection_queue->Push(job);
+	}
+	WakeWorker(affinity);
+}
+
+void JobSystem::Execute(Job* job, uint32 worker_index)
+{
+	job->m_function(worker_index);
+	JobCounter* counter = job->m_counter;
+	// Captures are released before the counter tells they are done
+	FreeJob(job);
+	// Seq_cst against SubmitAfter registering a job on this counter
+	if (counter != nullptr && counter->m_value.fetch_sub(1, std::memory_order_seq_cst) == 1 && m_waiting_count.load(std::memory_order_seq_cst) > 0)
+	{
+		// The counter may be gone already, only the waiting list is touched
+		ReleaseDependents();
+	}
+	m_workers[worker_index]->m_finished_count.fetch_add(1, std::memory_order_release);
+}
+
+void JobSystem::ReleaseDependents()
+{
+	std::lock_guard<std::mutex> lock(m_waiting_mutex);
+	for (uint32 i = 0; i < (uint32)m_waiting_jobs.size();)
+	{
+		Job* job = m_waiting_jobs[i];
+		if (!job->m_dependency->IsDone())
+		{
+			++i;
+			continue;
+		}
+		m_waiting_jobs[i] = m_waiting_jobs.back();
+		m_waiting_jobs.pop_back();
+		m_waiting_count.fetch_sub(1, std::memory_order_relaxed);
+		job->m_dependency = nullptr;
+		Enqueue(job);
+	}
+}
+
+void JobSystem::WakeWorker(uint32 affinity)
+{
+	// Against the fence of a worker going to sleep, either it sees the job or this sees it sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_sleeping_count.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_sleep_mutex);
+	Worker* woken = nullptr;
+	if (affinity != g_job_any_worker && m_workers[affinity]->m_is_sleeping)
+	{
+		woken = m_workers[affinity].get();
+	}
+	for (uint32 i = 0; i < m_worker_count && woken == nullptr; ++i)
+	{
+		if (m_workers[i]->m_is_sleeping)
+		{
+			woken = m_workers[i].get();
+		}
+	}
+	if (woken != nullptr)
+	{
+		woken->m_is_sleeping = false;
+		m_sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+		woken->m_wake_condition.notify_one();
+	}
+}
+
+void JobSystem::WorkerLoop(uint32 worker_index)
+{
+	t_current_system = this;
+	t_worker_index = worker_index;
+	Worker& worker = *m_workers[worker_index];
+	while (true)
+	{
+		if (Job* job = FindJob(worker_index))
+		{
+			Execute(job, worker_index);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		if (m_stop)
+		{
+			return;
+		}
+		worker.m_is_sleeping = true;
+		m_sleeping_count.fetch_add(1, std::memory_order_relaxed);
+		// Against the fence of WakeWorker
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!HasWork())
+		{
+			worker.m_wake_condition.wait(lock, [this, &worker]() { return !worker.m_is_sleeping || m_stop; });
+		}
+		if (worker.m_is_sleeping)
+		{
+			worker.m_is_sleeping = false;
+			m_sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+JobSystem::Job* JobSystem::FindJob(uint32 worker_index)
+{
+	Worker& worker = *m_workers[worker_index];
+	// Newest first on the own deque, its data is the most likely in cache
+	if (Job* job = worker.m_deque.Pop())
+	{
+		return job;
+	}
+	if (Job* job = worker.m_mailbox.TryPop())
+	{
+		return job;
+	}
+	if (Job* job = m_injection_queue->TryPop())
+	{
+		return job;
+	}
+	return StealJob(worker_index);
+}
+
+JobSystem::Job* JobSystem::StealJob(uint32 worker_index)
+{
+	Worker& thief = *m_workers[worker_index];
+	// Xorshift, a random first victim keeps the thieves off the same deque
+	thief.m_random_state ^= thief.m_random_state << 13;
+	thief.m_random_state ^= thief.m_random_state >> 17;
+	thief.m_random_state ^= thief.m_random_state << 5;
+	const uint32 slot_count = GetThreadSlotCount();
+	const uint32 first_victim = thief.m_random_state % slot_count;
+	// The helper slot has no mailbox jobs but keeps what it spawned before it stopped helping
+	for (uint32 i = 0; i < slot_count; ++i)
+	{
+		const uint32 victim = (first_victim + i) % slot_count;
+		if (victim == worker_index)
+		{
+			continue;
+		}
+		if (Job* job = m_workers[victim]->m_deque.Steal())
+		{
+			thief.m_steal_count.fetch_add(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	// Jobs with an affinity last, their worker is busy
+	for (uint32 i = 0; i < m_worker_count; ++i)
+	{
+		const uint32 victim = (first_victim + i) % m_worker_count;
+		if (victim == worker_index)
+		{
+			continue;
+		}
+		if (Job* job = m_workers[victim]->m_mailbox.TryPop())
+		{
+			thief.m_steal_count.fetch_add(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+bool JobSystem::HasWork() const
+{
+	if (m_injection_queue->m_count.load(std::memory_order_relaxed) > 0)
+	{
+		return true;
+	}
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		if (!worker->m_deque.IsEmpty() || worker->m_mailbox.m_count.load(std::memory_order_relaxed) > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::HelpUntil(const std::function<bool()>& is_done)
+{
+	// Workers and the current helper run jobs, another outside thread takes the helper slot once free
+	JobSystem* previous_system = t_current_system;
+	const uint32 previous_worker_index = t_worker_index;
+	const bool is_member = t_current_system == this;
+	bool is_helping = is_member;
+	while (!is_done())
+	{
+		if (!is_helping && !m_external_helping.load(std::memory_order_relaxed) && !m_external_helping.exchange(true, std::memory_order_acquire))
+		{
+			is_helping = true;
+			t_current_system = this;
+			t_worker_index = m_worker_count;
+		}
+		Job* job = is_helping ? FindJob(t_worker_index) : nullptr;
+		if (job != nullptr)
+		{
+			Execute(job, t_worker_index);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	if (is_helping && !is_member)
+	{
+		t_current_system = previous_system;
+		t_worker_index = previous_worker_index;
+		m_external_helping.store(false, std::memory_order_release);
+	}
+}
+
+bool JobSystem::IsIdle() const
+{
+	// Finished counts first, a job submitting another finishes after it so a pending one always shows in the submitted sum
+	uint64 finished_count = 0;
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		finished_count += worker->m_finished_count.load(std::memory_order_acquire);
+	}
+	uint64 submitted_count = 0;
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		submitted_count += worker->m_submitted_count.load(std::memory_order_acquire);
+	}
+	return finished_count == submitted_count;
+}
+
+void JobSystem::SubmitRange(ParallelForState& state, uint32 begin, uint32 end)
+{
+	// Range packed so the capture fits the small buffer of std::function
+	const uint64 range = ((uint64)end << 32) | begin;
+	Submit([&state, range](uint32 worker_index)
+	{
+		state.m_job_system->RunRange(state, (uint32)range, (uint32)(range >> 32), worker_index);
+	}, &state.m_counter);
+}
+
+void JobSystem::RunRange(ParallelForState& state, uint32 begin, uint32 end, uint32 worker_index)
+{
+	// Upper halves are left for thieves, the lower one is kept until a batch remains
+	while (end - begin > state.m_batch_size)
+	{
+		const uint32 middle = begin + (end - begin) / 2;
+		SubmitRange(state, middle, end);
+		end = middle;
+	}
+	(*state.m_function)(begin, end, worker_index);
+}
+
+JobSystem::Job* JobSystem::AllocateJob()
+{
+	JobCache& cache = GetJobCache();
+	if (cache.m_jobs.empty())
+	{
+		return new Job();
+	}
+	Job* job = cache.m_jobs.back();
+	cache.m_jobs.pop_back();
+	return job;
+}
+
+void JobSystem::FreeJob(Job* job)
+{
+	job->m_function = nullptr;
+	JobCache& cache = GetJobCache();
+	if (cache.m_jobs.size() >= g_job_cache_size)
+	{
+		delete job;
+		return;
+	}
+	if (cache.m_jobs.capacity() == 0)
+	{
+		cache.m_jobs.reserve(g_job_cache_size);
+	}
+	cache.m_jobs.push_back(job);
+}
+
+JobSystem::JobCache& JobSystem::GetJobCache()
+{
+	thread_local JobCache cache;
+	return cache;
+}
+
+namespace
+{
+	// Escape iterations of the Julia set of ComputeShader.hlsl, up to a few hundred dependent multiplies per pixel
+	uint32 JuliaIterationCount(float32 x, float32 y)
+	{
+		const float32 c_real = -0.8f;
+		const float32 c_imaginary = 0.156f;
+		const uint32 max_iteration_count = 256;
+		uint32 iteration_count = 0;
+		while (iteration_count < max_iteration_count && x * x + y * y < 4.0f)
+		{
+			const float32 next_x = x * x - y * y + c_real;
+			y = 2.0f * x * y + c_imaginary;
+			x = next_x;
+			++iteration_count;
+		}
+		return iteration_count;
+	}
+}
+
+std::vector<JobSystemScalingResult> MeasureJobSystemScaling(uint32 max_worker_count, uint32 iteration_count)
+{
+	const uint32 width = 1024;
+	const uint32 height = 1024;
+	// A few thousand leaves, small enough that the split and steal costs show
+	const uint32 batch_size = 256;
+	const uint32 spawn_count = 1 << 16;
+
+	std::vector<uint32> worker_counts{};
+	for (uint32 worker_count = 1; worker_count < max_worker_count; worker_count *= 2)
+	{
+		worker_counts.push_back(worker_count);
+	}
+	worker_counts.push_back((std::max)(max_worker_count, 1u));
+
+	std::vector<uint32> pixels(width * height);
+	std::vector<JobSystemScalingResult> results{};
+	for (uint32 worker_count : worker_counts)
+	{
+		JobSystem job_system(worker_count);
+		JobSystemScalingResult result{ .m_worker_count = worker_count };
+		for (uint32 iteration = 0; iteration < iteration_count; ++iteration)
+		{
+			std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+			job_system.ParallelFor(width * height, batch_size, [&pixels](uint32 begin, uint32 end, uint32)
+			{
+				for (uint32 i = begin; i < end; ++i)
+				{
+					const float32 x = (float32)(i % width) / width * 3.0f - 1.5f;
+					const float32 y = (float32)(i / width) / height * 2.0f - 1.0f;
+					pixels[i] = JuliaIterationCount(x, y);
+				}
+			});
+			result.m_kernel_milliseconds += std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+
+			// Spawned from a job so they go through the Chase-Lev deques and not the injection queue
+			begin_time = std::chrono::steady_clock::now();
+			JobCounter root_counter{};
+			job_system.Submit([&job_system](uint32)
+			{
+				JobCounter counter{};
+				for (uint32 i = 0; i < spawn_count; ++i)
+				{
+					job_system.Submit([](uint32) {}, &counter);
+				}
+				job_system.Wait(counter);
+			}, &root_counter);
+			job_system.Wait(root_counter);
+			result.m_spawn_nanoseconds_per_job += std::chrono::duration<float64, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / spawn_count;
+		}
+		result.m_kernel_milliseconds /= (std::max)(iteration_count, 1u);
+		result.m_spawn_nanoseconds_per_job /= (std::max)(iteration_count, 1u);
+		result.m_steal_count = job_system.GetStealCount();
+		results.push_back(result);
+	}
+	return results;
+}
\ No newline at end of file
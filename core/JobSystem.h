@@ -0,0 +1,128 @@
+#pragma once
+#include "Types.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Jobs in flight signaling it, done once back to zero
+// Has to outlive the jobs signaling it and the jobs submitted after it
+struct JobCounter
+{
+	std::atomic<uint32> m_value = 0;
+
+	bool IsDone() const
+	{
+		return m_value.load(std::memory_order_acquire) == 0;
+	}
+};
+
+static const uint32 g_job_any_worker = ~0u;
+
+// Work stealing scheduler for short CPU jobs, a Chase-Lev deque per worker
+// Jobs spawned by a job go to the deque of its worker, idle workers steal the oldest ones of the others
+// No fibers, a thread waiting on a counter runs other jobs meanwhile so its stack stays below them
+// Blocking work such as file IO belongs to a ThreadPool, a blocked job holds its worker
+class JobSystem
+{
+public:
+	using JobFunction = std::function<void(uint32 worker_index)>;
+	using RangeFunction = std::function<void(uint32 begin, uint32 end, uint32 worker_index)>;
+
+	// 0 is a worker per hardware thread but the calling one, which helps when waiting
+	explicit JobSystem(uint32 worker_count = 0);
+	// Runs the jobs left before the workers exit
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Counter is incremented now and decremented once the function returned
+	// Affinity is a hint wrapping around the worker count, the job goes to that worker and others take it only when out of work
+	void Submit(JobFunction function, JobCounter* counter = nullptr, uint32 affinity = g_job_any_worker);
+	// Queued once the dependency is done, a counter at zero is done so submit the jobs it counts first
+	void SubmitAfter(const JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr, uint32 affinity = g_job_any_worker);
+	// Runs jobs until the counter is done, from a job or any other thread
+	void Wait(const JobCounter& counter);
+
+	// Calls function over [0, count) in ranges of at most batch_size and waits
+	// Ranges are split in halves as workers steal them, the cost of submitting does not grow with count
+	void ParallelFor(uint32 count, uint32 batch_size, const RangeFunction& function);
+
+	// Future of the result of function(worker_index), get does not run jobs so prefer Wait from a job
+	template<typename Function>
+	auto Async(Function&& function) -> std::future<std::invoke_result_t<Function, uint32>>
+	{
+		using Result = std::invoke_result_t<Function, uint32>;
+		// std::function requires copyable, packaged_task is move only
+		std::shared_ptr<std::packaged_task<Result(uint32)>> task = std::make_shared<std::packaged_task<Result(uint32)>>(std::forward<Function>(function));
+		std::future<Result> future = task->get_future();
+		Submit([task](uint32 worker_index) { (*task)(worker_index); });
+		return future;
+	}
+
+	uint32 GetWorkerCount() const;
+	// Per worker state is sized to this, a thread outside the system helping in Wait runs jobs as index GetWorkerCount()
+	uint32 GetThreadSlotCount() const;
+	// Jobs taken from the deque or the mailbox of another worker
+	uint64 GetStealCount() const;
+private:
+	struct Job;
+	struct JobQueue;
+	struct Worker;
+	struct JobCache;
+	struct ParallelForState;
+
+	Job* CreateJob(JobFunction function, JobCounter* counter, uint32 affinity);
+	void Enqueue(Job* job);
+	void Execute(Job* job, uint32 worker_index);
+	void ReleaseDependents();
+	void WakeWorker(uint32 affinity);
+
+	void WorkerLoop(uint32 worker_index);
+	Job* FindJob(uint32 worker_index);
+	Job* StealJob(uint32 worker_index);
+	bool HasWork() const;
+	// Runs jobs until is_done, as the single outside helper when called from outside the system
+	void HelpUntil(const std::function<bool()>& is_done);
+	bool IsIdle() const;
+
+	void SubmitRange(ParallelForState& state, uint32 begin, uint32 end);
+	void RunRange(ParallelForState& state, uint32 begin, uint32 end, uint32 worker_index);
+
+	static Job* AllocateJob();
+	static void FreeJob(Job* job);
+	static JobCache& GetJobCache();
+
+	// A slot per worker and a last one for the thread helping from outside, which has no thread of its own
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	uint32 m_worker_count = 0;
+	// Submits from threads outside the system without affinity
+	std::unique_ptr<JobQueue> m_injection_queue;
+	std::atomic<bool> m_external_helping = false;
+
+	// Jobs whose dependency is not done, rescanned whenever a counter reaches zero
+	std::mutex m_waiting_mutex;
+	std::vector<Job*> m_waiting_jobs;
+	std::atomic<uint32> m_waiting_count = 0;
+
+	// Workers out of jobs sleep on their own condition, an enqueue wakes the worker of its affinity or any one
+	std::mutex m_sleep_mutex;
+	std::atomic<uint32> m_sleeping_count = 0;
+	bool m_stop = false;
+};
+
+struct JobSystemScalingResult
+{
+	uint32 m_worker_count = 0;
+	// Fine grained ParallelFor over a CPU kernel
+	float64 m_kernel_milliseconds = 0.0;
+	// Empty jobs spawned from a job and waited on, scheduling overhead alone
+	float64 m_spawn_nanoseconds_per_job = 0.0;
+	uint64 m_steal_count = 0;
+};
+
+// Runs the same workloads on systems of 1, 2, 4... workers up to max_worker_count, the calling thread helps in all of them
+// No GPU dependency, a Julia set per pixel stands for the compute kernels emulated on the CPU
+std::vector<JobSystemScalingResult> MeasureJobSystemScaling(uint32 max_worker_count, uint32 iteration_count);
\ No newline at end of file
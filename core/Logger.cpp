@@ -1,66 +1,305 @@
 #include "Logger.h"
-#include "Common.h"
+#include "Platform.h"
 
-#if defined(_DEBUG)
-#define LOG_ENABLE
-#endif
-
-#if defined(LOG_ENABLE)
 // Added _SILENCE_STDEXT_ARR_ITERS_DEPRECATION_WARNING globally to silence spdlog fmt issue with latest MSVC
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 // Release version 1.13
 #include <spdlog/spdlog.h>
+
+#include "SPSCQueue.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
 #endif
 
-#if defined(LOG_ENABLE)
+std::atomic<LogLevel> g_log_levels[static_cast<uint32>(LogCategory::Count)] = {};
+
 namespace
 {
-	enum class LogLevel
-	{
-		Trace = 0,
-		Error
-	};
+	// Records per thread, a full ring makes its thread wait for the logging thread
+	const uint32 g_log_ring_capacity = 1024;
+	using LogRing = SPSCQueue<LogRecord, g_log_ring_capacity>;
+	// Backstop of the idle wait, LogEndRecord checks the sleeping flag without a fence to stay cheap
+	// so a record published while the logging thread goes to sleep may only be seen on the next timeout
+	const std::chrono::milliseconds g_log_idle_timeout(250);
 
 	// Only available when connected to a debugger
 	void PrintOutput(const std::string& string)
 	{
-		std::string string_ln = string + "\n";
-		OutputDebugStringW(std::to_wstring(string_ln).c_str());
+#if defined(_WIN32)
+		OutputDebugStringA(string.c_str());
+#else
+		UNUSED(string);
+#endif
 	}
 
 	void PrintConsole(const std::string& string, const LogLevel& log_level)
 	{
-		std::string string_ln = string + "\n";
-		if(log_level == LogLevel::Trace)
-			spdlog::info(string_ln);
-		else
-			spdlog::error(string_ln);
+		switch (log_level)
+		{
+		case LogLevel::Trace:
+			spdlog::trace(string);
+			break;
+		case LogLevel::Info:
+			spdlog::info(string);
+			break;
+		case LogLevel::Warning:
+			spdlog::warn(string);
+			break;
+		default:
+			spdlog::error(string);
+			break;
+		}
 	}
 
-	void Log(const std::string& string, const LogLevel& log_level)
+	// Category prefix and line break in place, the string is reused between records
+	void Write(std::string& string, const LogCategory& log_category, const LogLevel& log_level)
 	{
+		if (log_category != LogCategory::General)
+		{
+			string.insert(0, format_library::format("[{0}] ", g_log_category_names[static_cast<uint32>(log_category)]));
+		}
+		string += "\n";
 		PrintConsole(string, log_level);
-		if(log_level == LogLevel::Error)
+		if(log_level >= LogLevel::Warning)
 			PrintOutput(string);
 	}
+
+	// Messages too large for a record, the logging thread takes ownership of the copy
+	void FormatHeapString(const LogRecord& record, std::string& out_string)
+	{
+		std::string* string = nullptr;
+		memcpy(&string, record.m_payload, sizeof(string));
+		out_string = std::move(*string);
+		delete string;
+	}
+
+	// One ring per thread that logged, drained by a single background thread
+	class AsyncLogger
+	{
+	public:
+		AsyncLogger()
+		{
+			// Filtering happens before the record is queued, spdlog writes everything it receives
+			spdlog::set_level(spdlog::level::trace);
+			// Constructs the spdlog registry first so it is destroyed after the logger drained
+			spdlog::default_logger_raw();
+			m_thread = std::thread(&AsyncLogger::Run, this);
+		}
+
+		~AsyncLogger()
+		{
+			m_stop = true;
+			Wake();
+			m_thread.join();
+		}
+
+		// Rings are never freed before the logger so records of exited threads are still written
+		LogRing* CreateRing()
+		{
+			std::scoped_lock lock(m_rings_mutex);
+			m_rings.push_back(std::make_unique<LogRing>());
+			return m_rings.back().get();
+		}
+
+		void Wake()
+		{
+			{
+				std::scoped_lock lock(m_wake_mutex);
+				m_sleeping.store(false, std::memory_order_relaxed);
+			}
+			m_wake.notify_one();
+		}
+
+		// Set while the logging thread waits with every ring empty, the next published record has to wake it
+		bool IsSleeping() const
+		{
+			return m_sleeping.load(std::memory_order_relaxed);
+		}
+	private:
+		void Run()
+		{
+			std::string string;
+			while (true)
+			{
+				// Read before draining so everything queued before the stop is written
+				const bool stop = m_stop;
+				bool is_idle = true;
+				{
+					std::scoped_lock lock(m_rings_mutex);
+					for (std::unique_ptr<LogRing>& ring : m_rings)
+					{
+						for (LogRecord* record = ring->BeginPop(); record != nullptr; record = ring->BeginPop())
+						{
+							string.clear();
+							try
+							{
+								record->m_format(*record, string);
+							}
+							catch (const format_library::format_error& error)
+							{
+								string = format_library::format("Invalid log format \"{0}\": {1}", record->m_format_string, error.what());
+							}
+							Write(string, record->m_category, record->m_level);
+							ring->EndPop();
+							is_idle = false;
+						}
+					}
+				}
+				if (stop && is_idle)
+				{
+					break;
+				}
+				if (is_idle)
+				{
+					WaitForRecords();
+				}
+			}
+		}
+
+		// Raises the sleeping flag before checking the rings a last time, a record published after the check sees the flag
+		void WaitForRecords()
+		{
+			std::unique_lock lock(m_wake_mutex);
+			m_sleeping.store(true, std::memory_order_seq_cst);
+			if (!m_stop && !HasRecords())
+			{
+				m_wake.wait_for(lock, g_log_idle_timeout, [this]() { return !m_sleeping.load(std::memory_order_relaxed) || m_stop; });
+			}
+			m_sleeping.store(false, std::memory_order_relaxed);
+		}
+
+		bool HasRecords()
+		{
+			std::scoped_lock lock(m_rings_mutex);
+			for (const std::unique_ptr<LogRing>& ring : m_rings)
+			{
+				if (ring->GetSize() > 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		std::vector<std::unique_ptr<LogRing>> m_rings;
+		std::mutex m_rings_mutex;
+		std::mutex m_wake_mutex;
+		std::condition_variable m_wake;
+		std::atomic<bool> m_stop = false;
+		std::atomic<bool> m_sleeping = false;
+		std::thread m_thread;
+	};
+
+	AsyncLogger& GetLogger()
+	{
+		static AsyncLogger logger;
+		return logger;
+	}
+
+	// Ring of the calling thread, created on its first record
+	thread_local LogRing* t_ring = nullptr;
+
+	LogRing& GetThreadRing()
+	{
+		if (t_ring == nullptr)
+		{
+			t_ring = GetLogger().CreateRing();
+		}
+		return *t_ring;
+	}
+
+	// A compiled out call is a discarded statement, calling the runtime filter or the argument would not be a constant expression
+	int32 NotConstantEvaluated()
+	{
+		return 0;
+	}
+
+	constexpr bool IsCompiledOutCallEmpty()
+	{
+		LOG_TRACE(Frame, "{0}", NotConstantEvaluated());
+		return true;
+	}
+	static_assert(IsLogCompiled<LogCategory::Frame, LogLevel::Trace>() || IsCompiledOutCallEmpty(), "Compiled out log calls must generate no code");
 }
-#endif
 
-// API
-void LogTrace(const std::string& string)
+LogRecord* LogBeginRecord()
 {
-#if defined(LOG_ENABLE)
-	Log(string, LogLevel::Trace);
-#else
-	UNUSED(string);
-#endif
+	LogRing& ring = GetThreadRing();
+	LogRecord* record = ring.BeginPush();
+	while (record == nullptr)
+	{
+		// Logging thread is behind, wait for a free slot rather than dropping
+		GetLogger().Wake();
+		std::this_thread::yield();
+		record = ring.BeginPush();
+	}
+	return record;
 }
 
-void LogError(const std::string& string)
+void LogEndRecord()
 {
-#if defined(LOG_ENABLE)
-	Log(string, LogLevel::Error);
-#else
-	UNUSED(string);
-#endif
+	// Ring exists, created by LogBeginRecord
+	t_ring->EndPush();
+	// Only the first record after the logging thread ran out of work pays for the wake
+	AsyncLogger& logger = GetLogger();
+	if (logger.IsSleeping())
+	{
+		logger.Wake();
+	}
+}
+
+void LogFlush()
+{
+	LogRing& ring = GetThreadRing();
+	GetLogger().Wake();
+	while (ring.GetSize() > 0)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void LogString(LogCategory category, LogLevel level, std::string_view string)
+{
+	LogRecord* record = LogBeginRecord();
+	uint8* cursor = record->m_payload;
+	if (LogEncode<std::string_view>(cursor, record->m_payload + g_log_payload_size, string))
+	{
+		record->m_format = &LogFormatRecord<std::string_view>;
+		record->m_format_string = "{}";
+	}
+	else
+	{
+		std::string* heap_string = new std::string(string);
+		memcpy(record->m_payload, &heap_string, sizeof(heap_string));
+		record->m_format = &FormatHeapString;
+		record->m_format_string = nullptr;
+	}
+	record->m_level = level;
+	record->m_category = category;
+	LogEndRecord();
+}
+
+void LogStringImmediate(LogCategory category, LogLevel level, std::string_view string)
+{
+	std::string string_ln(string);
+	Write(string_ln, category, level);
+}
+
+void SetLogLevel(LogCategory category, LogLevel level)
+{
+	ASSERT(category < LogCategory::Count && level < LogLevel::Count);
+	g_log_levels[static_cast<uint32>(category)].store(level, std::memory_order_relaxed);
+}
+
+LogLevel GetLogLevel(LogCategory category)
+{
+	ASSERT(category < LogCategory::Count);
+	return g_log_levels[static_cast<uint32>(category)].load(std::memory_order_relaxed);
 }
\ No newline at end of file
@@ -1,25 +1,252 @@
 #pragma once
+#include "Types.h"
+#include "Format.h"
 
-#include <format>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 
-void LogTrace(const std::string& string);
-void LogError(const std::string& string);
+// Asynchronous, the calling thread only copies the format string pointer and the raw arguments into its own ring
+// A background thread formats and writes them, in order per thread but interleaved between threads
+// Errors wait until everything logged before them is written, so they are not lost on a following crash
+enum class LogLevel : uint8
+{
+	Trace = 0,
+	Info,
+	Warning,
+	Error,
+	Count
+};
+
+enum class LogCategory : uint8
+{
+	General = 0,
+	Device,
+	Memory,
+	Compiler,
+	WorkGraph,
+	Frame,
+	Shader,
+	Count
+};
+
+constexpr const char* g_log_level_names[] = { "Trace", "Info", "Warning", "Error" };
+constexpr const char* g_log_category_names[] = { "General", "Device", "Memory", "Compiler", "WorkGraph", "Frame", "Shader" };
+static_assert(std::size(g_log_level_names) == static_cast<uint32>(LogLevel::Count));
+static_assert(std::size(g_log_category_names) == static_cast<uint32>(LogCategory::Count));
+
+// Lowest level compiled in, override per build with LOG_COMPILE_LEVEL=<level>
+// Release keeps Info so benchmark and headless results are still written
+#if !defined(LOG_COMPILE_LEVEL)
+#if defined(_DEBUG)
+#define LOG_COMPILE_LEVEL Trace
+#else
+#define LOG_COMPILE_LEVEL Info
+#endif
+#endif
+constexpr LogLevel g_log_compile_level = LogLevel::LOG_COMPILE_LEVEL;
+
+// Lowest level compiled in per category, on top of the global one
+// Frame logs would be written every frame, only their warnings and errors are kept
+constexpr LogLevel g_log_category_compile_levels[] =
+{
+	LogLevel::Trace,	// General
+	LogLevel::Trace,	// Device
+	LogLevel::Trace,	// Memory
+	LogLevel::Trace,	// Compiler
+	LogLevel::Trace,	// WorkGraph
+	LogLevel::Warning,	// Frame
+	LogLevel::Trace,	// Shader
+};
+static_assert(std::size(g_log_category_compile_levels) == static_cast<uint32>(LogCategory::Count));
+
+template<LogCategory Category, LogLevel Level>
+constexpr bool IsLogCompiled()
+{
+	static_assert(Category < LogCategory::Count && Level < LogLevel::Count);
+	return Level >= g_log_compile_level && Level >= g_log_category_compile_levels[static_cast<uint32>(Category)];
+}
+
+// Runtime lowest level per category, only consulted by calls that were compiled in
+extern std::atomic<LogLevel> g_log_levels[static_cast<uint32>(LogCategory::Count)];
+
+inline bool IsLogEnabled(LogCategory category, LogLevel level)
+{
+	return level >= g_log_levels[static_cast<uint32>(category)].load(std::memory_order_relaxed);
+}
+
+void SetLogLevel(LogCategory category, LogLevel level);
+LogLevel GetLogLevel(LogCategory category);
+
+struct LogRecord;
+// Instantiated per argument list, decodes the payload and formats it
+using LogFormatFunction = void(*)(const LogRecord& record, std::string& out_string);
+
+// Payload bytes per record, larger messages are formatted by the caller instead
+static const uint32 g_log_payload_size = 224;
+
+struct LogRecord
+{
+	LogFormatFunction m_format;
+	// String literal of the call, doubles as the format id
+	const char* m_format_string;
+	LogLevel m_level;
+	LogCategory m_category;
+	uint8 m_payload[g_log_payload_size];
+};
+
+// Slot in the ring of the calling thread, waits while the ring is full
+LogRecord* LogBeginRecord();
+void LogEndRecord();
+// Blocks until every record queued by the calling thread is written
+void LogFlush();
+// Message already formatted, copied into the ring
+void LogString(LogCategory category, LogLevel level, std::string_view string);
+// Previous synchronous path, formats and writes on the calling thread, kept for comparison
+void LogStringImmediate(LogCategory category, LogLevel level, std::string_view string);
+
+// Arguments copied bytewise, strings as size and characters
+template<typename T>
+constexpr bool g_is_log_string = std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+template<typename T>
+constexpr bool g_is_log_encodable = std::is_arithmetic_v<T> || g_is_log_string<T>;
+template<typename T>
+using LogDecoded = std::conditional_t<g_is_log_string<T>, std::string_view, T>;
+
+template<typename T>
+bool LogEncode(uint8*& cursor, const uint8* end, const T& value)
+{
+	if constexpr (g_is_log_string<T>)
+	{
+		const std::string_view string = value;
+		const uint32 size = (uint32)string.size();
+		if (end - cursor < (int64)(sizeof(size) + size))
+		{
+			return false;
+		}
+		memcpy(cursor, &size, sizeof(size));
+		memcpy(cursor + sizeof(size), string.data(), size);
+		cursor += sizeof(size) + size;
+	}
+	else
+	{
+		if (end - cursor < (int64)sizeof(T))
+		{
+			return false;
+		}
+		memcpy(cursor, &value, sizeof(T));
+		cursor += sizeof(T);
+	}
+	return true;
+}
+
+template<typename T>
+LogDecoded<T> LogDecode(const uint8*& cursor)
+{
+	if constexpr (g_is_log_string<T>)
+	{
+		uint32 size = 0;
+		memcpy(&size, cursor, sizeof(size));
+		const std::string_view string(reinterpret_cast<const char*>(cursor + sizeof(size)), size);
+		cursor += sizeof(size) + size;
+		return string;
+	}
+	else
+	{
+		T value{};
+		memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return value;
+	}
+}
+
+template<typename ... Args>
+void LogFormatRecord(const LogRecord& record, std::string& out_string)
+{
+	const uint8* cursor = record.m_payload;
+	// Braced initialization decodes left to right
+	std::tuple<LogDecoded<Args>...> values{ LogDecode<Args>(cursor)... };
+	std::apply
+	(
+		[&record, &out_string](auto& ... value)
+		{
+			format_library::vformat_to(std::back_inserter(out_string), record.m_format_string, format_library::make_format_args(value...));
+		},
+		values
+	);
+}
 
 template<typename ... Args>
-void LogTrace(const std::string& string, Args && ... args)
+void Log(LogCategory category, LogLevel level, const char* format, const Args& ... args)
 {
-	std::string_view string_view = string;
-	// vformat to allow non-compile time arguments
-	std::string formatted_string = std::vformat(string_view, std::make_format_args(args...));
-	LogTrace(formatted_string);
+	if constexpr ((g_is_log_encodable<std::decay_t<const Args&>> && ...))
+	{
+		LogRecord* record = LogBeginRecord();
+		uint8* cursor = record->m_payload;
+		const uint8* end = record->m_payload + g_log_payload_size;
+		// Slot is left unpublished when the arguments do not fit, the fallback reuses it
+		if ((LogEncode<std::decay_t<const Args&>>(cursor, end, args) && ...))
+		{
+			record->m_format = &LogFormatRecord<std::decay_t<const Args&>...>;
+			record->m_format_string = format;
+			record->m_level = level;
+			record->m_category = category;
+			LogEndRecord();
+			return;
+		}
+	}
+	// Types without a bytewise copy or too large, format on the calling thread
+	LogString(category, level, format_library::vformat(format, format_library::make_format_args(args...)));
 }
 
+// Immediate counterpart of Log, the cost the asynchronous path replaces
 template<typename ... Args>
-void LogError(const std::string& string, Args && ... args)
+void LogImmediate(LogCategory category, LogLevel level, const char* format, const Args& ... args)
+{
+	LogStringImmediate(category, level, format_library::vformat(format, format_library::make_format_args(args...)));
+}
+
+// Entry points of the LOG macros, the level is a template parameter so it is known at compile time
+// Without arguments the string is written as is, never parsed as a format
+template<LogCategory Category, LogLevel Level>
+void LogMessage(std::string_view string)
+{
+	LogString(Category, Level, string);
+	if constexpr (Level == LogLevel::Error)
+	{
+		LogFlush();
+	}
+}
+
+// Format strings must be literals, they are read later by the logging thread
+template<LogCategory Category, LogLevel Level, typename Arg, typename ... Args>
+void LogMessage(const char* format, const Arg& arg, const Args& ... args)
 {
-	std::string_view string_view = string;
-	// vformat to allow non-compile time arguments
-	std::string formatted_string = std::vformat(string_view, std::make_format_args(args...));
-	LogError(formatted_string);
-}
\ No newline at end of file
+	Log(Category, Level, format, arg, args...);
+	if constexpr (Level == LogLevel::Error)
+	{
+		LogFlush();
+	}
+}
+
+// Calls below the compile level are discarded statements, no code is generated and the arguments are never evaluated
+#define LOG(category, level, ...) \
+	do \
+	{ \
+		if constexpr (IsLogCompiled<LogCategory::category, LogLevel::level>()) \
+		{ \
+			if (IsLogEnabled(LogCategory::category, LogLevel::level)) \
+			{ \
+				LogMessage<LogCategory::category, LogLevel::level>(__VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#define LOG_TRACE(category, ...) LOG(category, Trace, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG(category, Info, __VA_ARGS__)
+#define LOG_WARNING(category, ...) LOG(category, Warning, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG(category, Error, __VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "MappedFile.h"
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_is_open = std::exchange(other.m_is_open, false);
+#if defined(_WIN32)
+		m_file_handle = std::exchange(other.m_file_handle, nullptr);
+		m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+#endif
+	}
+	return *this;
+}
+
+#if defined(_WIN32)
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+	HANDLE file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file_handle, &size))
+	{
+		CloseHandle(file_handle);
+		return false;
+	}
+	m_file_handle = file_handle;
+	m_size = (uint64)size.QuadPart;
+	m_is_open = true;
+	// Mapping an empty file fails, there is nothing to read anyway
+	if (m_size == 0)
+	{
+		return true;
+	}
+	m_mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping_handle == nullptr)
+	{
+		Close();
+		return false;
+	}
+	m_data = static_cast<const uint8*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping_handle != nullptr)
+	{
+		CloseHandle(m_mapping_handle);
+	}
+	if (m_file_handle != nullptr)
+	{
+		CloseHandle(m_file_handle);
+	}
+	m_data = nullptr;
+	m_mapping_handle = nullptr;
+	m_file_handle = nullptr;
+	m_size = 0;
+	m_is_open = false;
+}
+#else
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+	const int file_descriptor = open(path.c_str(), O_RDONLY);
+	if (file_descriptor < 0)
+	{
+		return false;
+	}
+	struct stat file_stat{};
+	if (fstat(file_descriptor, &file_stat) != 0)
+	{
+		close(file_descriptor);
+		return false;
+	}
+	m_size = (uint64)file_stat.st_size;
+	m_is_open = true;
+	if (m_size > 0)
+	{
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file_descriptor);
+			Close();
+			return false;
+		}
+		// Chunks are read front to back
+		madvise(data, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const uint8*>(data);
+	}
+	// The mapping keeps its own reference to the file
+	close(file_descriptor);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<uint8*>(m_data), m_size);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_is_open = false;
+}
+#endif
+
+const uint8* MappedFile::GetData() const
+{
+	return m_data;
+}
+
+uint64 MappedFile::GetSize() const
+{
+	return m_size;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return m_is_open;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+#include "Types.h"
+#include <string>
+
+// Read only view of a whole file, pages are read by the OS on first access instead of copied up front
+// Win32 file mapping, mmap elsewhere so the streaming scheduler can be driven outside the renderer
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// False when the file is missing or could not be mapped, an empty file opens with no data
+	bool Open(const std::string& path);
+	void Close();
+
+	const uint8* GetData() const;
+	uint64 GetSize() const;
+	bool IsOpen() const;
+private:
+	const uint8* m_data = nullptr;
+	uint64 m_size = 0;
+	bool m_is_open = false;
+#if defined(_WIN32)
+	void* m_file_handle = nullptr;
+	void* m_mapping_handle = nullptr;
+#endif
+};
\ No newline at end of file
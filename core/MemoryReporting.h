@@ -1,6 +1,7 @@
 #pragma once
 
-#if defined(_DEBUG)
+// CRT debug heap, MSVC only
+#if defined(_DEBUG) && defined(_MSC_VER)
 #define MEMORY_REPORTING_ENABLE
 #endif
 
@@ -0,0 +1,41 @@
+#pragma once
+#include "Types.h"
+#include <iterator>
+
+// Portable base of Common.h, what core needs without Windows or D3D12
+// Common.h adds ComPtr, hlsl++ and the wide string conversions on top for the application
+
+#if defined(_MSC_VER)
+#define DISABLE_OPTIMISATIONS() __pragma( optimize( "", off ) )
+#define ENABLE_OPTIMISATIONS() __pragma( optimize( "", on ) )
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(__clang__)
+#define DISABLE_OPTIMISATIONS() _Pragma("clang optimize off")
+#define ENABLE_OPTIMISATIONS() _Pragma("clang optimize on")
+#define DEBUG_BREAK() __builtin_debugtrap()
+#else
+#define DISABLE_OPTIMISATIONS() _Pragma("GCC push_options") _Pragma("GCC optimize(\"O0\")")
+#define ENABLE_OPTIMISATIONS() _Pragma("GCC pop_options")
+// Stops in an attached debugger like __debugbreak, terminates otherwise
+#define DEBUG_BREAK() __builtin_trap()
+#endif
+// https://web.archive.org/web/20201129200055/http://cnicholson.net/2009/02/stupid-c-tricks-adventures-in-assert/
+#define UNUSED(x)  do { (void)sizeof(x); } while(0)
+#if defined(_DEBUG)
+#define ASSERT(x) do { if (!(x)) { DEBUG_BREAK(); } } while (0)
+#else
+#define ASSERT(x) UNUSED(x)
+#endif
+
+// Element count of an array, std::size is the portable _countof
+#define COUNT std::size
+
+inline uint32 Align(uint32 x, uint32 align)
+{
+	return (x + align - 1) & ~(align - 1);
+}
+
+inline uint32 DivideRoundUp(uint32 numerator, uint32 denominator)
+{
+	return (numerator + denominator - 1) / denominator;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+#include "Types.h"
+#include <atomic>
+
+static const uint32 g_cache_line_size = 64;
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread
+// Indices only grow and wrap on uint32, the slot is the index masked by the power of two capacity
+template<typename T, uint32 Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+	// Producer only, false when full
+	bool TryPush(const T& value)
+	{
+		const uint32 tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+		m_items[tail & (Capacity - 1)] = value;
+		m_tail.store(tail + 1, std::memory_order_release);
+		m_tail.notify_one();
+		return true;
+	}
+
+	// Consumer only, false when empty
+	bool TryPop(T& value)
+	{
+		const uint32 head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		value = m_items[head & (Capacity - 1)];
+		m_head.store(head + 1, std::memory_order_release);
+		m_head.notify_one();
+		return true;
+	}
+
+	// In place variants for polling peers, they skip the notify so they never wake a thread sleeping in Push or Pop
+	// Producer only, slot to fill in place or nullptr when full, the item is visible once EndPush is called
+	T* BeginPush()
+	{
+		const uint32 tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+		{
+			return nullptr;
+		}
+		return &m_items[tail & (Capacity - 1)];
+	}
+
+	void EndPush()
+	{
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer only, oldest item read in place or nullptr when empty, the slot is reused once EndPop is called
+	T* BeginPop()
+	{
+		const uint32 head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+		return &m_items[head & (Capacity - 1)];
+	}
+
+	void EndPop()
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Producer only, sleeps while full
+	void Push(const T& value)
+	{
+		while (!TryPush(value))
+		{
+			m_head.wait(m_tail.load(std::memory_order_relaxed) - Capacity, std::memory_order_acquire);
+		}
+	}
+
+	// Consumer only, sleeps while empty
+	void Pop(T& value)
+	{
+		while (!TryPop(value))
+		{
+			m_tail.wait(m_head.load(std::memory_order_relaxed), std::memory_order_acquire);
+		}
+	}
+
+	// Approximate from any thread other than the producer and consumer
+	uint32 GetSize() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+private:
+	// Producer and consumer indices on separate cache lines
+	alignas(g_cache_line_size) std::atomic<uint32> m_head = 0;
+	alignas(g_cache_line_size) std::atomic<uint32> m_tail = 0;
+	T m_items[Capacity];
+};
\ No newline at end of file
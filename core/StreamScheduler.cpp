@@ -0,0 +1,210 @@
+#include "StreamScheduler.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+
+void StreamScheduler::Init(const StreamSchedulerDesc& desc)
+{
+	m_desc = desc;
+	m_requests.clear();
+	m_queue.clear();
+	m_free_staging_slots.resize(m_desc.m_staging_chunk_count);
+	// Popped from the back, lowest slots first
+	for (uint32 i = 0; i < m_desc.m_staging_chunk_count; ++i)
+	{
+		m_free_staging_slots[i] = m_desc.m_staging_chunk_count - 1 - i;
+	}
+}
+
+StreamRequestId StreamScheduler::Submit(uint64 size_in_bytes, uint64 granularity, int32 priority, StreamCallback callback)
+{
+	if (granularity == 0 || granularity > m_desc.m_chunk_size)
+	{
+		return g_invalid_stream_request;
+	}
+	const StreamRequestId request = m_next_request++;
+	StreamRequest& stream_request = m_requests[request];
+	stream_request.m_size_in_bytes = size_in_bytes;
+	stream_request.m_chunk_size = m_desc.m_chunk_size / granularity * granularity;
+	stream_request.m_priority = priority;
+	stream_request.m_callback = std::move(callback);
+	if (size_in_bytes == 0)
+	{
+		Finish(request, StreamStatus::Completed);
+	}
+	else
+	{
+		m_queue.insert({ priority, request });
+	}
+	return request;
+}
+
+bool StreamScheduler::Cancel(StreamRequestId request)
+{
+	auto it = m_requests.find(request);
+	if (it == m_requests.end() || it->second.m_is_cancelled)
+	{
+		return false;
+	}
+	StreamRequest& stream_request = it->second;
+	stream_request.m_is_cancelled = true;
+	m_queue.erase({ stream_request.m_priority, request });
+	if (stream_request.m_chunks_in_flight == 0)
+	{
+		Finish(request, StreamStatus::Cancelled);
+	}
+	return true;
+}
+
+uint32 StreamScheduler::Schedule(std::vector<StreamChunk>& out_chunks)
+{
+	uint32 chunk_count = 0;
+	while (!m_free_staging_slots.empty() && !m_queue.empty())
+	{
+		const StreamRequestId request = m_queue.begin()->second;
+		StreamRequest& stream_request = m_requests.at(request);
+		const uint64 size = (std::min)(stream_request.m_chunk_size, stream_request.m_size_in_bytes - stream_request.m_next_offset);
+		out_chunks.push_back
+		({
+			.m_request = request,
+			.m_offset = stream_request.m_next_offset,
+			.m_size = size,
+			.m_staging_slot = m_free_staging_slots.back(),
+		});
+		m_free_staging_slots.pop_back();
+		stream_request.m_next_offset += size;
+		++stream_request.m_chunks_in_flight;
+		if (stream_request.m_next_offset == stream_request.m_size_in_bytes)
+		{
+			m_queue.erase(m_queue.begin());
+		}
+		++chunk_count;
+	}
+	return chunk_count;
+}
+
+void StreamScheduler::Retire(const StreamChunk& chunk)
+{
+	m_free_staging_slots.push_back(chunk.m_staging_slot);
+	StreamRequest& stream_request = m_requests.at(chunk.m_request);
+	--stream_request.m_chunks_in_flight;
+	if (stream_request.m_chunks_in_flight > 0)
+	{
+		return;
+	}
+	if (stream_request.m_is_cancelled)
+	{
+		Finish(chunk.m_request, StreamStatus::Cancelled);
+	}
+	else if (stream_request.m_next_offset == stream_request.m_size_in_bytes)
+	{
+		Finish(chunk.m_request, StreamStatus::Completed);
+	}
+}
+
+void StreamScheduler::Finish(StreamRequestId request, StreamStatus status)
+{
+	// Erased first, the callback may submit new requests
+	auto it = m_requests.find(request);
+	StreamCallback callback = std::move(it->second.m_callback);
+	m_requests.erase(it);
+	if (callback)
+	{
+		callback(request, status);
+	}
+}
+
+uint64 StreamScheduler::GetStagingOffset(uint32 staging_slot) const
+{
+	return staging_slot * m_desc.m_chunk_size;
+}
+
+uint64 StreamScheduler::GetStagingSize() const
+{
+	return m_desc.m_chunk_size * m_desc.m_staging_chunk_count;
+}
+
+uint32 StreamScheduler::GetFreeStagingSlotCount() const
+{
+	return (uint32)m_free_staging_slots.size();
+}
+
+uint32 StreamScheduler::GetRequestCount() const
+{
+	return (uint32)m_requests.size();
+}
+
+const StreamSchedulerDesc& StreamScheduler::GetDesc() const
+{
+	return m_desc;
+}
+
+StreamSimulationResult SimulateStreaming(const StreamSchedulerDesc& desc, const std::vector<std::string>& paths, const std::vector<int32>& priorities, uint32 copy_latency_batches)
+{
+	StreamSimulationResult result{};
+	result.m_completed_batches.assign(paths.size(), 0);
+	std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+
+	std::vector<MappedFile> files(paths.size());
+	// Stands in for the upload heap and the destination resources
+	std::vector<uint8> staging(desc.m_chunk_size * desc.m_staging_chunk_count);
+	std::vector<std::vector<uint8>> destinations(paths.size());
+	std::unordered_map<StreamRequestId, uint32> request_files;
+
+	StreamScheduler scheduler{};
+	scheduler.Init(desc);
+	for (uint32 i = 0; i < (uint32)paths.size(); ++i)
+	{
+		if (!files[i].Open(paths[i]))
+		{
+			continue;
+		}
+		destinations[i].resize(files[i].GetSize());
+		const StreamRequestId request = scheduler.Submit
+		(
+			files[i].GetSize(), 1, i < priorities.size() ? priorities[i] : 0,
+			[&result, i](StreamRequestId, StreamStatus)
+			{
+				result.m_completed_batches[i] = result.m_batch_count;
+			}
+		);
+		request_files[request] = i;
+	}
+
+	// Batches submitted and not retired yet, oldest first
+	std::deque<std::vector<StreamChunk>> batches_in_flight;
+	while (scheduler.GetRequestCount() > 0)
+	{
+		std::vector<StreamChunk> batch;
+		// Nothing left to hand out, only waiting on the batches in flight
+		const bool is_draining = scheduler.Schedule(batch) == 0;
+		for (const StreamChunk& chunk : batch)
+		{
+			const uint32 file = request_files.at(chunk.m_request);
+			uint8* staging_data = staging.data() + scheduler.GetStagingOffset(chunk.m_staging_slot);
+			memcpy(staging_data, files[file].GetData() + chunk.m_offset, chunk.m_size);
+			// Copy queue side, from staging into the destination
+			memcpy(destinations[file].data() + chunk.m_offset, staging_data, chunk.m_size);
+			result.m_bytes += chunk.m_size;
+		}
+		if (!is_draining)
+		{
+			result.m_chunk_count += (uint32)batch.size();
+			++result.m_batch_count;
+			batches_in_flight.push_back(std::move(batch));
+		}
+		// Out of slots the oldest batch is waited on regardless of the latency
+		while (!batches_in_flight.empty() && (is_draining || batches_in_flight.size() > copy_latency_batches || scheduler.GetFreeStagingSlotCount() == 0))
+		{
+			for (const StreamChunk& chunk : batches_in_flight.front())
+			{
+				scheduler.Retire(chunk);
+			}
+			batches_in_flight.pop_front();
+		}
+	}
+	result.m_milliseconds = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+	return result;
+}
\ No newline at end of file
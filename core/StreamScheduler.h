@@ -0,0 +1,111 @@
+#pragma once
+#include "Types.h"
+#include <functional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Ids start at 1, 0 marks a request that could not be created
+using StreamRequestId = uint32;
+static const StreamRequestId g_invalid_stream_request = 0;
+
+enum class StreamStatus : uint8
+{
+	Completed,
+	Cancelled,
+};
+
+// Called once per request from Retire or Cancel on the thread calling them, from Submit for an empty request
+using StreamCallback = std::function<void(StreamRequestId request, StreamStatus status)>;
+
+struct StreamSchedulerDesc
+{
+	// Size of a staging slot, every chunk fits in one
+	// Multiple of D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT so slots can hold texture rows
+	uint64 m_chunk_size = 1 << 20;
+	// Staging slots, bounds the staging memory in flight to m_chunk_size * m_staging_chunk_count
+	uint32 m_staging_chunk_count = 16;
+};
+
+// Piece of a request copied through one staging slot
+struct StreamChunk
+{
+	StreamRequestId m_request;
+	// Range in the request, in the staging layout of the request
+	uint64 m_offset;
+	uint64 m_size;
+	uint32 m_staging_slot;
+};
+
+// Splits requests into chunks and hands them out while staging slots are free, highest priority first
+// A request submitted later with a higher priority takes the next free slots, the one in progress resumes after it
+// CPU only, the caller fills the staging slots, issues the copies and retires the chunks once the copies completed
+class StreamScheduler
+{
+public:
+	void Init(const StreamSchedulerDesc& desc);
+
+	// Request of size_in_bytes copied in chunks of whole granules, texture rows for example
+	// Returns g_invalid_stream_request when a granule does not fit in a staging slot
+	StreamRequestId Submit(uint64 size_in_bytes, uint64 granularity, int32 priority, StreamCallback callback);
+	// Chunks not handed out yet are dropped, the callback runs once the chunks in flight are retired
+	// False when the request already finished
+	bool Cancel(StreamRequestId request);
+
+	// Appends chunks until the staging slots run out, returns the number appended
+	uint32 Schedule(std::vector<StreamChunk>& out_chunks);
+	// Copy of the chunk completed, frees its slot and finishes its request after its last chunk
+	void Retire(const StreamChunk& chunk);
+
+	uint64 GetStagingOffset(uint32 staging_slot) const;
+	uint64 GetStagingSize() const;
+	uint32 GetFreeStagingSlotCount() const;
+	uint32 GetRequestCount() const;
+	const StreamSchedulerDesc& GetDesc() const;
+private:
+	struct StreamRequest
+	{
+		uint64 m_size_in_bytes;
+		uint64 m_chunk_size;
+		int32 m_priority;
+		// Start of the next chunk to hand out
+		uint64 m_next_offset = 0;
+		uint32 m_chunks_in_flight = 0;
+		bool m_is_cancelled = false;
+		StreamCallback m_callback;
+	};
+
+	// Higher priority first, then submission order
+	struct StreamOrder
+	{
+		bool operator()(const std::pair<int32, StreamRequestId>& a, const std::pair<int32, StreamRequestId>& b) const
+		{
+			return a.first != b.first ? a.first > b.first : a.second < b.second;
+		}
+	};
+
+	void Finish(StreamRequestId request, StreamStatus status);
+
+	StreamSchedulerDesc m_desc;
+	std::unordered_map<StreamRequestId, StreamRequest> m_requests;
+	// Requests with chunks left to hand out
+	std::set<std::pair<int32, StreamRequestId>, StreamOrder> m_queue;
+	std::vector<uint32> m_free_staging_slots;
+	StreamRequestId m_next_request = 1;
+};
+
+struct StreamSimulationResult
+{
+	uint64 m_bytes = 0;
+	uint32 m_chunk_count = 0;
+	uint32 m_batch_count = 0;
+	float64 m_milliseconds = 0.0;
+	// Batch at which each file completed, in the order of the paths
+	std::vector<uint32> m_completed_batches;
+};
+
+// Streams files through the scheduler into CPU memory, batches retire copy_latency_batches later like a copy queue would
+// Measures the scheduler and the reads from the mapped files without a GPU
+StreamSimulationResult SimulateStreaming(const StreamSchedulerDesc& desc, const std::vector<std::string>& paths, const std::vector<int32>& priorities, uint32 copy_latency_batches);
\ No newline at end of file
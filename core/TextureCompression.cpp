@@ -0,0 +1,535 @@
+#include "TextureCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSION_SSE2
+#endif
+
+namespace
+{
+	// Channels of a block in structure of arrays, 0 to 255, pixel i is x = i % 4, y = i / 4
+	struct BlockPixels
+	{
+		alignas(16) float m_channels[4][16];
+	};
+
+	void LoadBlock(const uint8* rgba, uint32 width, uint32 height, uint32 block_x, uint32 block_y, BlockPixels& out_pixels)
+	{
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			const uint32 x = (std::min)(block_x * 4 + i % 4, width - 1);
+			const uint32 y = (std::min)(block_y * 4 + i / 4, height - 1);
+			const uint8* texel = rgba + (y * width + x) * 4;
+			for (uint32 c = 0; c < 4; ++c)
+			{
+				out_pixels.m_channels[c][i] = (float32)texel[c];
+			}
+		}
+	}
+
+	void GetRange(const float* values, float32& out_min, float32& out_max)
+	{
+#if defined(TEXTURE_COMPRESSION_SSE2)
+		__m128 min_values = _mm_load_ps(values);
+		__m128 max_values = min_values;
+		for (uint32 i = 4; i < 16; i += 4)
+		{
+			const __m128 value = _mm_load_ps(values + i);
+			min_values = _mm_min_ps(min_values, value);
+			max_values = _mm_max_ps(max_values, value);
+		}
+		min_values = _mm_min_ps(min_values, _mm_shuffle_ps(min_values, min_values, _MM_SHUFFLE(2, 3, 0, 1)));
+		min_values = _mm_min_ps(min_values, _mm_shuffle_ps(min_values, min_values, _MM_SHUFFLE(1, 0, 3, 2)));
+		max_values = _mm_max_ps(max_values, _mm_shuffle_ps(max_values, max_values, _MM_SHUFFLE(2, 3, 0, 1)));
+		max_values = _mm_max_ps(max_values, _mm_shuffle_ps(max_values, max_values, _MM_SHUFFLE(1, 0, 3, 2)));
+		out_min = _mm_cvtss_f32(min_values);
+		out_max = _mm_cvtss_f32(max_values);
+#else
+		out_min = *std::min_element(values, values + 16);
+		out_max = *std::max_element(values, values + 16);
+#endif
+	}
+
+	// Projection of every pixel on the segment from endpoint 0 to endpoint 1, rounded to one of level_max + 1 levels
+	void ProjectLevels(const float* const* channels, uint32 channel_count, const float32* endpoint0, const float32* endpoint1, uint32 level_max, uint32* out_levels)
+	{
+		float32 direction[4]{};
+		float32 length_squared = 0.0f;
+		for (uint32 c = 0; c < channel_count; ++c)
+		{
+			direction[c] = endpoint1[c] - endpoint0[c];
+			length_squared += direction[c] * direction[c];
+		}
+		if (length_squared == 0.0f)
+		{
+			std::fill(out_levels, out_levels + 16, 0u);
+			return;
+		}
+#if defined(TEXTURE_COMPRESSION_SSE2)
+		const __m128 length_squared4 = _mm_set1_ps(length_squared);
+		const __m128 level_max4 = _mm_set1_ps((float32)level_max);
+		for (uint32 i = 0; i < 16; i += 4)
+		{
+			__m128 dot = _mm_setzero_ps();
+			for (uint32 c = 0; c < channel_count; ++c)
+			{
+				const __m128 offset = _mm_sub_ps(_mm_load_ps(channels[c] + i), _mm_set1_ps(endpoint0[c]));
+				dot = _mm_add_ps(dot, _mm_mul_ps(offset, _mm_set1_ps(direction[c])));
+			}
+			__m128 t = _mm_div_ps(dot, length_squared4);
+			t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			// Positive, truncation is the floor
+			const __m128i level = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(t, level_max4), _mm_set1_ps(0.5f)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out_levels + i), level);
+		}
+#else
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			float32 dot = 0.0f;
+			for (uint32 c = 0; c < channel_count; ++c)
+			{
+				dot += (channels[c][i] - endpoint0[c]) * direction[c];
+			}
+			const float32 t = (std::min)((std::max)(dot / length_squared, 0.0f), 1.0f);
+			out_levels[i] = (uint32)(t * (float32)level_max + 0.5f);
+		}
+#endif
+	}
+
+	// Blocks as little endian 32 bit words, fields may straddle two words
+	void InsertBits(uint32* words, uint32 offset, uint32 value, uint32 count)
+	{
+		const uint32 shift = offset % 32;
+		words[offset / 32] |= value << shift;
+		if (shift + count > 32)
+		{
+			words[offset / 32 + 1] |= value >> (32 - shift);
+		}
+	}
+
+	uint32 ExtractBits(const uint32* words, uint32 offset, uint32 count)
+	{
+		const uint32 shift = offset % 32;
+		uint64 value = words[offset / 32] >> shift;
+		if (shift + count > 32)
+		{
+			value |= (uint64)words[offset / 32 + 1] << (32 - shift);
+		}
+		return (uint32)(value & ((1ull << count) - 1));
+	}
+
+	uint32 Pack565(const float32* color)
+	{
+		const uint32 r = (uint32)(color[0] * (31.0f / 255.0f) + 0.5f);
+		const uint32 g = (uint32)(color[1] * (63.0f / 255.0f) + 0.5f);
+		const uint32 b = (uint32)(color[2] * (31.0f / 255.0f) + 0.5f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	// Bit replication, same expansion as the hardware
+	void Unpack565(uint32 color, uint32* out_color)
+	{
+		const uint32 r = (color >> 11) & 31;
+		const uint32 g = (color >> 5) & 63;
+		const uint32 b = color & 31;
+		out_color[0] = (r << 3) | (r >> 2);
+		out_color[1] = (g << 2) | (g >> 4);
+		out_color[2] = (b << 3) | (b >> 2);
+	}
+
+	// Bounding box of the channels pulled in by a fraction of its size, the extremes are rarely worth an endpoint
+	void GetInsetRange(const BlockPixels& pixels, uint32 channel_count, float32 inset_ratio, float32* out_min, float32* out_max)
+	{
+		for (uint32 c = 0; c < channel_count; ++c)
+		{
+			GetRange(pixels.m_channels[c], out_min[c], out_max[c]);
+			const float32 inset = (out_max[c] - out_min[c]) * inset_ratio;
+			out_min[c] += inset;
+			out_max[c] -= inset;
+		}
+	}
+
+	void EncodeBC1Block(const BlockPixels& pixels, uint32* out_words)
+	{
+		float32 min_color[3];
+		float32 max_color[3];
+		GetInsetRange(pixels, 3, 1.0f / 16.0f, min_color, max_color);
+		uint32 color0 = Pack565(max_color);
+		uint32 color1 = Pack565(min_color);
+		// color0 > color1 selects the 4 color mode
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+		out_words[0] = color0 | (color1 << 16);
+		out_words[1] = 0;
+		if (color0 == color1)
+		{
+			return;
+		}
+		uint32 endpoints[2][3];
+		Unpack565(color0, endpoints[0]);
+		Unpack565(color1, endpoints[1]);
+		const float32 endpoint0[3] = { (float32)endpoints[0][0], (float32)endpoints[0][1], (float32)endpoints[0][2] };
+		const float32 endpoint1[3] = { (float32)endpoints[1][0], (float32)endpoints[1][1], (float32)endpoints[1][2] };
+		const float* channels[3] = { pixels.m_channels[0], pixels.m_channels[1], pixels.m_channels[2] };
+		uint32 levels[16];
+		ProjectLevels(channels, 3, endpoint0, endpoint1, 3, levels);
+		// Levels from color0 to color1 in index order
+		const uint32 indices[4] = { 0, 2, 3, 1 };
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			out_words[1] |= indices[levels[i]] << (i * 2);
+		}
+	}
+
+	void EncodeBC4Block(const float* values, uint32* out_words)
+	{
+		float32 min_value = 0.0f;
+		float32 max_value = 0.0f;
+		GetRange(values, min_value, max_value);
+		// red0 > red1 selects the 8 value mode
+		const uint32 red0 = (uint32)(max_value + 0.5f);
+		const uint32 red1 = (uint32)(min_value + 0.5f);
+		out_words[0] = red0 | (red1 << 8);
+		out_words[1] = 0;
+		if (red0 == red1)
+		{
+			return;
+		}
+		const float32 endpoint0 = (float32)red0;
+		const float32 endpoint1 = (float32)red1;
+		uint32 levels[16];
+		ProjectLevels(&values, 1, &endpoint0, &endpoint1, 7, levels);
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			const uint32 index = levels[i] == 0 ? 0 : levels[i] == 7 ? 1 : levels[i] + 1;
+			InsertBits(out_words, 16 + i * 3, index, 3);
+		}
+	}
+
+	// 7 bits per channel plus a p-bit shared by the channels, the p-bit giving the smaller error is kept
+	void QuantizeMode6Endpoint(const float32* endpoint, uint32* out_quantized, uint32& out_p_bit, float32* out_endpoint)
+	{
+		float32 best_error = std::numeric_limits<float32>::max();
+		for (uint32 p_bit = 0; p_bit < 2; ++p_bit)
+		{
+			uint32 quantized[4];
+			float32 error = 0.0f;
+			for (uint32 c = 0; c < 4; ++c)
+			{
+				quantized[c] = (uint32)(std::min)((std::max)((endpoint[c] - p_bit) * 0.5f + 0.5f, 0.0f), 127.0f);
+				const float32 difference = (float32)(quantized[c] * 2 + p_bit) - endpoint[c];
+				error += difference * difference;
+			}
+			if (error < best_error)
+			{
+				best_error = error;
+				out_p_bit = p_bit;
+				for (uint32 c = 0; c < 4; ++c)
+				{
+					out_quantized[c] = quantized[c];
+					out_endpoint[c] = (float32)(quantized[c] * 2 + p_bit);
+				}
+			}
+		}
+	}
+
+	void EncodeBC7Block(const BlockPixels& pixels, uint32* out_words)
+	{
+		float32 min_color[4];
+		float32 max_color[4];
+		GetInsetRange(pixels, 4, 1.0f / 32.0f, min_color, max_color);
+		uint32 quantized[2][4];
+		uint32 p_bits[2];
+		float32 endpoints[2][4];
+		QuantizeMode6Endpoint(min_color, quantized[0], p_bits[0], endpoints[0]);
+		QuantizeMode6Endpoint(max_color, quantized[1], p_bits[1], endpoints[1]);
+		const float* channels[4] = { pixels.m_channels[0], pixels.m_channels[1], pixels.m_channels[2], pixels.m_channels[3] };
+		uint32 levels[16];
+		ProjectLevels(channels, 4, endpoints[0], endpoints[1], 15, levels);
+		// Most significant bit of the anchor index is implicit 0, swapping the endpoints flips every index
+		const uint32 first = levels[0] >= 8 ? 1 : 0;
+		if (first == 1)
+		{
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				levels[i] = 15 - levels[i];
+			}
+		}
+
+		memset(out_words, 0, 16);
+		// Mode 6 is 6 zeros and a one
+		InsertBits(out_words, 0, 1 << 6, 7);
+		for (uint32 c = 0; c < 4; ++c)
+		{
+			InsertBits(out_words, 7 + c * 14, quantized[first][c], 7);
+			InsertBits(out_words, 14 + c * 14, quantized[1 - first][c], 7);
+		}
+		InsertBits(out_words, 63, p_bits[first], 1);
+		InsertBits(out_words, 64, p_bits[1 - first], 1);
+		InsertBits(out_words, 65, levels[0], 3);
+		for (uint32 i = 1; i < 16; ++i)
+		{
+			InsertBits(out_words, 68 + (i - 1) * 4, levels[i], 4);
+		}
+	}
+
+	void DecodeBC1Block(const uint32* words, uint8 out_texels[16][4])
+	{
+		const uint32 color0 = words[0] & 0xFFFF;
+		const uint32 color1 = words[0] >> 16;
+		uint32 colors[4][3];
+		Unpack565(color0, colors[0]);
+		Unpack565(color1, colors[1]);
+		for (uint32 c = 0; c < 3; ++c)
+		{
+			if (color0 > color1)
+			{
+				colors[2][c] = (2 * colors[0][c] + colors[1][c]) / 3;
+				colors[3][c] = (colors[0][c] + 2 * colors[1][c]) / 3;
+			}
+			else
+			{
+				colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+				colors[3][c] = 0;
+			}
+		}
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			const uint32 index = (words[1] >> (i * 2)) & 3;
+			for (uint32 c = 0; c < 3; ++c)
+			{
+				out_texels[i][c] = (uint8)colors[index][c];
+			}
+			out_texels[i][3] = 255;
+		}
+	}
+
+	void DecodeBC4Block(const uint32* words, uint32 channel, uint8 out_texels[16][4])
+	{
+		uint32 values[8];
+		values[0] = words[0] & 0xFF;
+		values[1] = (words[0] >> 8) & 0xFF;
+		if (values[0] > values[1])
+		{
+			for (uint32 i = 2; i < 8; ++i)
+			{
+				values[i] = ((8 - i) * values[0] + (i - 1) * values[1]) / 7;
+			}
+		}
+		else
+		{
+			for (uint32 i = 2; i < 6; ++i)
+			{
+				values[i] = ((6 - i) * values[0] + (i - 1) * values[1]) / 5;
+			}
+			values[6] = 0;
+			values[7] = 255;
+		}
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			out_texels[i][channel] = (uint8)values[ExtractBits(words, 16 + i * 3, 3)];
+		}
+	}
+
+	bool DecodeBC7Block(const uint32* words, uint8 out_texels[16][4])
+	{
+		if (ExtractBits(words, 0, 7) != (1 << 6))
+		{
+			return false;
+		}
+		const uint32 weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		uint32 endpoints[2][4];
+		for (uint32 c = 0; c < 4; ++c)
+		{
+			endpoints[0][c] = ExtractBits(words, 7 + c * 14, 7) * 2 + ExtractBits(words, 63, 1);
+			endpoints[1][c] = ExtractBits(words, 14 + c * 14, 7) * 2 + ExtractBits(words, 64, 1);
+		}
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			const uint32 index = i == 0 ? ExtractBits(words, 65, 3) : ExtractBits(words, 68 + (i - 1) * 4, 4);
+			for (uint32 c = 0; c < 4; ++c)
+			{
+				out_texels[i][c] = (uint8)(((64 - weights[index]) * endpoints[0][c] + weights[index] * endpoints[1][c] + 32) >> 6);
+			}
+		}
+		return true;
+	}
+
+	float32 sRGBToLinear(float32 x)
+	{
+		return x <= 0.04045f ? x / 12.92f : std::pow((x + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float32 LinearTosRGB(float32 x)
+	{
+		return x <= 0.0031308f ? 12.92f * x : 1.055f * std::pow(x, 1.0f / 2.4f) - 0.055f;
+	}
+}
+
+uint32 GetBCBlockSize(BCFormat format)
+{
+	return format == BCFormat::BC1 || format == BCFormat::BC4 ? 8 : 16;
+}
+
+void EncodeBC(BCFormat format, const uint8* rgba, uint32 width, uint32 height, uint8* out_blocks)
+{
+	const uint32 block_count_x = (width + 3) / 4;
+	const uint32 block_count_y = (height + 3) / 4;
+	const uint32 block_size = GetBCBlockSize(format);
+	BlockPixels pixels{};
+	for (uint32 block_y = 0; block_y < block_count_y; ++block_y)
+	{
+		for (uint32 block_x = 0; block_x < block_count_x; ++block_x)
+		{
+			LoadBlock(rgba, width, height, block_x, block_y, pixels);
+			uint32 words[4]{};
+			switch (format)
+			{
+			case BCFormat::BC1:
+				EncodeBC1Block(pixels, words);
+				break;
+			case BCFormat::BC4:
+				EncodeBC4Block(pixels.m_channels[0], words);
+				break;
+			case BCFormat::BC5:
+				EncodeBC4Block(pixels.m_channels[0], words);
+				EncodeBC4Block(pixels.m_channels[1], words + 2);
+				break;
+			default:
+				EncodeBC7Block(pixels, words);
+				break;
+			}
+			memcpy(out_blocks + (block_y * block_count_x + block_x) * block_size, words, block_size);
+		}
+	}
+}
+
+bool DecodeBC(BCFormat format, const uint8* blocks, uint32 width, uint32 height, uint8* out_rgba)
+{
+	const uint32 block_count_x = (width + 3) / 4;
+	const uint32 block_count_y = (height + 3) / 4;
+	const uint32 block_size = GetBCBlockSize(format);
+	for (uint32 block_y = 0; block_y < block_count_y; ++block_y)
+	{
+		for (uint32 block_x = 0; block_x < block_count_x; ++block_x)
+		{
+			uint32 words[4]{};
+			memcpy(words, blocks + (block_y * block_count_x + block_x) * block_size, block_size);
+			uint8 texels[16][4]{};
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				texels[i][3] = 255;
+			}
+			switch (format)
+			{
+			case BCFormat::BC1:
+				DecodeBC1Block(words, texels);
+				break;
+			case BCFormat::BC4:
+				DecodeBC4Block(words, 0, texels);
+				break;
+			case BCFormat::BC5:
+				DecodeBC4Block(words, 0, texels);
+				DecodeBC4Block(words + 2, 1, texels);
+				break;
+			default:
+				if (!DecodeBC7Block(words, texels))
+				{
+					return false;
+				}
+				break;
+			}
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				const uint32 x = block_x * 4 + i % 4;
+				const uint32 y = block_y * 4 + i / 4;
+				if (x < width && y < height)
+				{
+					memcpy(out_rgba + (y * width + x) * 4, texels[i], 4);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+uint32 GetMipCount(uint32 width, uint32 height)
+{
+	uint32 mip_count = 1;
+	while ((width >> mip_count) > 0 || (height >> mip_count) > 0)
+	{
+		++mip_count;
+	}
+	return mip_count;
+}
+
+std::vector<std::vector<uint8>> GenerateMipsReference(const uint8* rgba, uint32 width, uint32 height, bool is_srgb)
+{
+	std::vector<float32> level(width * height * 4);
+	for (uint32 i = 0; i < width * height * 4; ++i)
+	{
+		const float32 value = rgba[i] / 255.0f;
+		level[i] = is_srgb && i % 4 != 3 ? sRGBToLinear(value) : value;
+	}
+
+	std::vector<std::vector<uint8>> mips{};
+	const uint32 mip_count = GetMipCount(width, height);
+	for (uint32 mip = 1; mip < mip_count; ++mip)
+	{
+		const uint32 mip_width = (std::max)(width >> 1, 1u);
+		const uint32 mip_height = (std::max)(height >> 1, 1u);
+		std::vector<float32> next_level(mip_width * mip_height * 4);
+		std::vector<uint8> texels(mip_width * mip_height * 4);
+		for (uint32 y = 0; y < mip_height; ++y)
+		{
+			for (uint32 x = 0; x < mip_width; ++x)
+			{
+				const uint32 x0 = (std::min)(x * 2, width - 1);
+				const uint32 x1 = (std::min)(x * 2 + 1, width - 1);
+				const uint32 y0 = (std::min)(y * 2, height - 1);
+				const uint32 y1 = (std::min)(y * 2 + 1, height - 1);
+				for (uint32 c = 0; c < 4; ++c)
+				{
+					const float32 value =
+					(
+						level[(y0 * width + x0) * 4 + c] + level[(y0 * width + x1) * 4 + c] +
+						level[(y1 * width + x0) * 4 + c] + level[(y1 * width + x1) * 4 + c]
+					) * 0.25f;
+					next_level[(y * mip_width + x) * 4 + c] = value;
+					const float32 encoded = is_srgb && c != 3 ? LinearTosRGB(value) : value;
+					texels[(y * mip_width + x) * 4 + c] = (uint8)((std::min)((std::max)(encoded, 0.0f), 1.0f) * 255.0f + 0.5f);
+				}
+			}
+		}
+		mips.push_back(std::move(texels));
+		level = std::move(next_level);
+		width = mip_width;
+		height = mip_height;
+	}
+	return mips;
+}
+
+float64 ComputePSNR(const uint8* rgba_a, const uint8* rgba_b, uint32 texel_count, uint32 channel_count)
+{
+	float64 error = 0.0;
+	for (uint32 i = 0; i < texel_count; ++i)
+	{
+		for (uint32 c = 0; c < channel_count; ++c)
+		{
+			const float64 difference = (float64)rgba_a[i * 4 + c] - (float64)rgba_b[i * 4 + c];
+			error += difference * difference;
+		}
+	}
+	if (error == 0.0)
+	{
+		return std::numeric_limits<float64>::infinity();
+	}
+	const float64 mean_error = error / ((float64)texel_count * channel_count);
+	return 10.0 * std::log10(255.0 * 255.0 / mean_error);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include "Types.h"
+#include <iterator>
+#include <vector>
+
+// Block formats written by CompressBCShader.hlsl, the values are the indices of its BC_FORMAT axis
+enum class BCFormat : uint8
+{
+	BC1,
+	BC4,
+	BC5,
+	BC7,
+	Count
+};
+
+constexpr const char* g_bc_format_names[] = { "BC1", "BC4", "BC5", "BC7" };
+static_assert(std::size(g_bc_format_names) == static_cast<uint32>(BCFormat::Count));
+
+// Bytes of a 4x4 block
+uint32 GetBCBlockSize(BCFormat format);
+
+// Reference of the GPU encoders, same endpoint selection and index quantization
+// Endpoints are the bounding box of the block, inset for BC1 and BC7, indices are the rounded projection on the endpoint line
+// BC7 only uses mode 6, one subset with 4 bit indices, alpha included
+// SSE2 over the 16 pixels of a block where available, scalar otherwise
+// rgba is width * height texels of 4 bytes, blocks are written row by row, edge blocks repeat the last row and column
+void EncodeBC(BCFormat format, const uint8* rgba, uint32 width, uint32 height, uint8* out_blocks);
+// Back to RGBA, channels not stored by the format are 0 and alpha 255, false on a BC7 mode other than 6
+bool DecodeBC(BCFormat format, const uint8* blocks, uint32 width, uint32 height, uint8* out_rgba);
+
+// Box filtered mips 1 and below of an RGBA texture, filtered in linear when is_srgb
+// Reference of GenerateMipsShader.hlsl, only kept as floats between levels so within a rounding of the GPU
+std::vector<std::vector<uint8>> GenerateMipsReference(const uint8* rgba, uint32 width, uint32 height, bool is_srgb);
+
+uint32 GetMipCount(uint32 width, uint32 height);
+
+// Peak signal to noise ratio in dB over the given channels, infinity when identical
+float64 ComputePSNR(const uint8* rgba_a, const uint8* rgba_b, uint32 texel_count, uint32 channel_count);
\ No newline at end of file
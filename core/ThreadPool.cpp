@@ -0,0 +1,59 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(uint32 worker_count)
+{
+	ASSERT(worker_count > 0);
+	m_workers.reserve(worker_count);
+	for (uint32 i = 0; i < worker_count; ++i)
+	{
+		m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_all();
+	// Remaining tasks are drained before the workers exit
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::Submit(Task task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ASSERT(!m_stop);
+		m_tasks.push_back(std::move(task));
+	}
+	m_condition.notify_one();
+}
+
+uint32 ThreadPool::GetWorkerCount() const
+{
+	return (uint32)m_workers.size();
+}
+
+void ThreadPool::WorkerLoop(uint32 worker_index)
+{
+	while (true)
+	{
+		Task task{};
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+			if (m_tasks.empty())
+			{
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task(worker_index);
+	}
+}
\ No newline at end of file
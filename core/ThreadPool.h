@@ -0,0 +1,49 @@
+#pragma once
+#include "Platform.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads consuming a shared FIFO of tasks
+// Tasks receive the index of the worker running them to address per worker state
+// Only for blocking work such as file IO or waiting on the GPU, CPU work goes to the JobSystem
+class ThreadPool
+{
+public:
+	using Task = std::function<void(uint32 worker_index)>;
+
+	explicit ThreadPool(uint32 worker_count);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(Task task);
+
+	// Future of the result of function(worker_index)
+	template<typename Function>
+	auto Async(Function&& function) -> std::future<std::invoke_result_t<Function, uint32>>
+	{
+		using Result = std::invoke_result_t<Function, uint32>;
+		// std::function requires copyable, packaged_task is move only
+		std::shared_ptr<std::packaged_task<Result(uint32)>> task = std::make_shared<std::packaged_task<Result(uint32)>>(std::forward<Function>(function));
+		std::future<Result> future = task->get_future();
+		Submit([task](uint32 worker_index) { (*task)(worker_index); });
+		return future;
+	}
+
+	uint32 GetWorkerCount() const;
+private:
+	void WorkerLoop(uint32 worker_index);
+
+	std::vector<std::thread> m_workers;
+	std::deque<Task> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stop = false;
+};
\ No newline at end of file
@@ -1,7 +1,12 @@
 #pragma once
+#include <cstdint>
 
 using uint8 = unsigned char;
 using int8 = char;
+using uint16 = unsigned short;
+using int16 = short;
+static_assert(sizeof(int16) == 2);
+static_assert(sizeof(uint16) == 2);
 using int32 = int; 
 using uint32 = unsigned int;
 static_assert(sizeof(int32) == 4);
@@ -0,0 +1,126 @@
+#pragma once
+#include "Types.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Chase-Lev deque of pointers, "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+// The owner thread pushes and pops at the bottom in LIFO order, any thread steals the oldest at the top
+// Grows by doubling, retired buffers are kept until destruction since a thief may still read one
+template<typename T>
+class WorkStealingDeque
+{
+public:
+	explicit WorkStealingDeque(uint32 capacity = 256)
+	{
+		// Power of 2 so indices wrap with a mask
+		uint32 power_of_2_capacity = 1;
+		while (power_of_2_capacity < capacity)
+		{
+			power_of_2_capacity <<= 1;
+		}
+		m_buffers.push_back(std::make_unique<Buffer>(power_of_2_capacity));
+		m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+	}
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// Owner only
+	void Push(T* value)
+	{
+		const int64 bottom = m_bottom.load(std::memory_order_relaxed);
+		const int64 top = m_top.load(std::memory_order_acquire);
+		Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+		if (bottom - top > buffer->m_capacity - 1)
+		{
+			buffer = Grow(buffer, top, bottom);
+		}
+		buffer->At(bottom).store(value, std::memory_order_relaxed);
+		// Release store instead of the release fence of the paper, same on x86 and visible to thread sanitizers
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	// Owner only, nullptr when empty
+	T* Pop()
+	{
+		const int64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64 top = m_top.load(std::memory_order_relaxed);
+		if (top > bottom)
+		{
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		T* value = buffer->At(bottom).load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last one, raced against the thieves through top
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				value = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return value;
+	}
+
+	// Any thread, nullptr when empty or when another thread took it first
+	T* Steal()
+	{
+		int64 top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 bottom = m_bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+		// Consume in the paper, acquire is what compilers implement it as
+		Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+		T* value = buffer->At(top).load(std::memory_order_relaxed);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return value;
+	}
+
+	// Approximate when other threads are working on it
+	bool IsEmpty() const
+	{
+		return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+	}
+private:
+	struct Buffer
+	{
+		explicit Buffer(int64 capacity) : m_capacity(capacity), m_values(std::make_unique<std::atomic<T*>[]>(capacity)) {}
+
+		std::atomic<T*>& At(int64 index)
+		{
+			return m_values[index & (m_capacity - 1)];
+		}
+
+		int64 m_capacity;
+		std::unique_ptr<std::atomic<T*>[]> m_values;
+	};
+
+	Buffer* Grow(Buffer* buffer, int64 top, int64 bottom)
+	{
+		m_buffers.push_back(std::make_unique<Buffer>(buffer->m_capacity * 2));
+		Buffer* grown = m_buffers.back().get();
+		for (int64 i = top; i < bottom; ++i)
+		{
+			grown->At(i).store(buffer->At(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		m_buffer.store(grown, std::memory_order_release);
+		return grown;
+	}
+
+	// Own cache lines, thieves hammer top while the owner works on bottom
+	alignas(64) std::atomic<int64> m_top = 0;
+	alignas(64) std::atomic<int64> m_bottom = 0;
+	alignas(64) std::atomic<Buffer*> m_buffer = nullptr;
+	// Owner only
+	std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
\ No newline at end of file
@@ -3,6 +3,153 @@
 // CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED for bindless
 #define ROOTFLAGS_DEFAULT "RootFlags(CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED | DENY_HULL_SHADER_ROOT_ACCESS | DENY_DOMAIN_SHADER_ROOT_ACCESS | DENY_GEOMETRY_SHADER_ROOT_ACCESS)"
 
+// Matches DXDescriptor::m_bindless_index default, marks an unbound resource
+#define INVALID_BINDLESS_INDEX 0xFFFFFFFF
+
+// Shader Print and Assert, records appended to a bindless byte buffer read back by ShaderDebugChannel
+// The channel index is INVALID_BINDLESS_INDEX when no channel is bound, calls are then skipped
+// Header: bytes reserved, records dropped over the cap, byte cap written by the CPU each frame
+#define SHADER_DEBUG_HEADER_SIZE 16
+#define SHADER_DEBUG_MAX_ARGS 4
+// Record: format id, argument count, assert flag and argument types packed in one word, thread id xy in 16 bits each, arguments
+#define SHADER_DEBUG_ARG_UINT 0
+#define SHADER_DEBUG_ARG_INT 1
+#define SHADER_DEBUG_ARG_FLOAT 2
+
+enum ShaderDebugFormat
+{
+#define SHADER_DEBUG_FORMAT(name, format) SHADER_DEBUG_FORMAT_##name,
+#include "ShaderDebugFormats.h"
+#undef SHADER_DEBUG_FORMAT
+};
+
+uint2 ShaderDebugArg(uint value)
+{
+	return uint2(value, SHADER_DEBUG_ARG_UINT);
+}
+
+uint2 ShaderDebugArg(int value)
+{
+	return uint2(asuint(value), SHADER_DEBUG_ARG_INT);
+}
+
+uint2 ShaderDebugArg(float value)
+{
+	return uint2(asuint(value), SHADER_DEBUG_ARG_FLOAT);
+}
+
+uint2 ShaderDebugArg(bool value)
+{
+	return uint2(value ? 1 : 0, SHADER_DEBUG_ARG_UINT);
+}
+
+void ShaderDebugAppend(uint channel, uint format, bool is_assert, uint3 thread_id, uint arg_count, uint4 args, uint4 types)
+{
+	if (channel == INVALID_BINDLESS_INDEX)
+	{
+		return;
+	}
+	RWByteAddressBuffer buffer = ResourceDescriptorHeap[channel];
+	const uint size = (2 + arg_count) * 4;
+	uint offset;
+	buffer.InterlockedAdd(0, size, offset);
+	// Offsets only grow, once a record is over the cap every later one is too
+	if (offset + size > buffer.Load(8))
+	{
+		buffer.InterlockedAdd(4, 1);
+		return;
+	}
+	const uint header = (format & 0xFFF) | (arg_count << 12) | ((is_assert ? 1 : 0) << 15) |
+		(types.x << 16) | (types.y << 18) | (types.z << 20) | (types.w << 22);
+	const uint address = SHADER_DEBUG_HEADER_SIZE + offset;
+	buffer.Store2(address, uint2(header, (thread_id.x & 0xFFFF) | (thread_id.y << 16)));
+	for (uint i = 0; i < arg_count; ++i)
+	{
+		buffer.Store(address + 8 + i * 4, args[i]);
+	}
+}
+
+void Print(uint channel, uint format, uint3 thread_id)
+{
+	ShaderDebugAppend(channel, format, false, thread_id, 0, (uint4)0, (uint4)0);
+}
+
+template<typename T0>
+void Print(uint channel, uint format, uint3 thread_id, T0 a0)
+{
+	const uint2 p0 = ShaderDebugArg(a0);
+	ShaderDebugAppend(channel, format, false, thread_id, 1, uint4(p0.x, 0, 0, 0), uint4(p0.y, 0, 0, 0));
+}
+
+template<typename T0, typename T1>
+void Print(uint channel, uint format, uint3 thread_id, T0 a0, T1 a1)
+{
+	const uint2 p0 = ShaderDebugArg(a0);
+	const uint2 p1 = ShaderDebugArg(a1);
+	ShaderDebugAppend(channel, format, false, thread_id, 2, uint4(p0.x, p1.x, 0, 0), uint4(p0.y, p1.y, 0, 0));
+}
+
+template<typename T0, typename T1, typename T2>
+void Print(uint channel, uint format, uint3 thread_id, T0 a0, T1 a1, T2 a2)
+{
+	const uint2 p0 = ShaderDebugArg(a0);
+	const uint2 p1 = ShaderDebugArg(a1);
+	const uint2 p2 = ShaderDebugArg(a2);
+	ShaderDebugAppend(channel, format, false, thread_id, 3, uint4(p0.x, p1.x, p2.x, 0), uint4(p0.y, p1.y, p2.y, 0));
+}
+
+template<typename T0, typename T1, typename T2, typename T3>
+void Print(uint channel, uint format, uint3 thread_id, T0 a0, T1 a1, T2 a2, T3 a3)
+{
+	const uint2 p0 = ShaderDebugArg(a0);
+	const uint2 p1 = ShaderDebugArg(a1);
+	const uint2 p2 = ShaderDebugArg(a2);
+	const uint2 p3 = ShaderDebugArg(a3);
+	ShaderDebugAppend(channel, format, false, thread_id, 4, uint4(p0.x, p1.x, p2.x, p3.x), uint4(p0.y, p1.y, p2.y, p3.y));
+}
+
+// Records only when the condition fails, logged as an error
+void Assert(uint channel, bool condition, uint format, uint3 thread_id)
+{
+	if (!condition)
+	{
+		ShaderDebugAppend(channel, format, true, thread_id, 0, (uint4)0, (uint4)0);
+	}
+}
+
+template<typename T0>
+void Assert(uint channel, bool condition, uint format, uint3 thread_id, T0 a0)
+{
+	if (!condition)
+	{
+		const uint2 p0 = ShaderDebugArg(a0);
+		ShaderDebugAppend(channel, format, true, thread_id, 1, uint4(p0.x, 0, 0, 0), uint4(p0.y, 0, 0, 0));
+	}
+}
+
+template<typename T0, typename T1>
+void Assert(uint channel, bool condition, uint format, uint3 thread_id, T0 a0, T1 a1)
+{
+	if (!condition)
+	{
+		const uint2 p0 = ShaderDebugArg(a0);
+		const uint2 p1 = ShaderDebugArg(a1);
+		ShaderDebugAppend(channel, format, true, thread_id, 2, uint4(p0.x, p1.x, 0, 0), uint4(p0.y, p1.y, 0, 0));
+	}
+}
+
+template<typename T0, typename T1, typename T2>
+void Assert(uint channel, bool condition, uint format, uint3 thread_id, T0 a0, T1 a1, T2 a2)
+{
+	if (!condition)
+	{
+		const uint2 p0 = ShaderDebugArg(a0);
+		const uint2 p1 = ShaderDebugArg(a1);
+		const uint2 p2 = ShaderDebugArg(a2);
+		ShaderDebugAppend(channel, format, true, thread_id, 3, uint4(p0.x, p1.x, p2.x, 0), uint4(p0.y, p1.y, p2.y, 0));
+	}
+}
+
 float Reinhard(float x)
 {
     return x / (x + 1.0f);
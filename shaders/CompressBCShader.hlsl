@@ -0,0 +1,243 @@
+#include "Common.hlsl"
+
+// One 4x4 block per thread from an RGBA8 mip into a byte buffer laid out as the placed footprint of the block texture
+// Same endpoint selection and index quantization as EncodeBC in core/TextureCompression.cpp, its CPU reference
+// BC_FORMAT: BC1, BC4 (red), BC5 (red and green), BC7 (mode 6 only)
+struct CompressBCConstants
+{
+	uint source_bindless_index;
+	uint destination_bindless_index;
+	// Placed footprint of the mip in the destination buffer
+	uint destination_offset;
+	uint row_pitch;
+	uint block_count_x;
+	uint block_count_y;
+	uint mip_width;
+	uint mip_height;
+};
+
+ConstantBuffer<CompressBCConstants> m_cbuffer : register(b0);
+
+// Axis declared by GetCompressBCPermutationDesc in DX/ShaderManifest.cpp
+#if !defined(BC_FORMAT)
+#error BC_FORMAT is defined by the permutation, compile through ShaderPermutations
+#endif
+
+// Channels of the block in 0 to 255, pixel i is x = i % 4, y = i / 4
+static float4 g_pixels[16];
+
+void InsertBits(inout uint4 words, uint offset, uint value, uint count)
+{
+	const uint shift = offset % 32;
+	words[offset / 32] |= value << shift;
+	if (shift + count > 32)
+	{
+		words[offset / 32 + 1] |= value >> (32 - shift);
+	}
+}
+
+// Projection on the segment from endpoint 0 to endpoint 1 of the first channel_count channels, rounded to one of level_max + 1 levels
+uint ProjectLevel(float4 pixel, float4 endpoint0, float4 endpoint1, uint channel_count, uint level_max)
+{
+	const float4 direction = endpoint1 - endpoint0;
+	float length_squared = 0.0f;
+	float projection = 0.0f;
+	for (uint c = 0; c < channel_count; ++c)
+	{
+		length_squared += direction[c] * direction[c];
+		projection += (pixel[c] - endpoint0[c]) * direction[c];
+	}
+	if (length_squared == 0.0f)
+	{
+		return 0;
+	}
+	return uint(saturate(projection / length_squared) * level_max + 0.5f);
+}
+
+void GetInsetRange(float inset_ratio, out float4 min_color, out float4 max_color)
+{
+	min_color = g_pixels[0];
+	max_color = g_pixels[0];
+	for (uint i = 1; i < 16; ++i)
+	{
+		min_color = min(min_color, g_pixels[i]);
+		max_color = max(max_color, g_pixels[i]);
+	}
+	const float4 inset = (max_color - min_color) * inset_ratio;
+	min_color += inset;
+	max_color -= inset;
+}
+
+uint Pack565(float3 color)
+{
+	const uint3 quantized = uint3(color * (float3(31.0f, 63.0f, 31.0f) / 255.0f) + 0.5f);
+	return (quantized.r << 11) | (quantized.g << 5) | quantized.b;
+}
+
+float3 Unpack565(uint color)
+{
+	const uint3 quantized = uint3((color >> 11) & 31, (color >> 5) & 63, color & 31);
+	return float3((quantized.r << 3) | (quantized.r >> 2), (quantized.g << 2) | (quantized.g >> 4), (quantized.b << 3) | (quantized.b >> 2));
+}
+
+uint2 EncodeBC1()
+{
+	float4 min_color;
+	float4 max_color;
+	GetInsetRange(1.0f / 16.0f, min_color, max_color);
+	uint color0 = Pack565(max_color.rgb);
+	uint color1 = Pack565(min_color.rgb);
+	// color0 > color1 selects the 4 color mode
+	if (color0 < color1)
+	{
+		const uint color = color0;
+		color0 = color1;
+		color1 = color;
+	}
+	uint2 block = uint2(color0 | (color1 << 16), 0);
+	if (color0 == color1)
+	{
+		return block;
+	}
+	const float4 endpoint0 = float4(Unpack565(color0), 0.0f);
+	const float4 endpoint1 = float4(Unpack565(color1), 0.0f);
+	// Levels from color0 to color1 in index order
+	const uint indices[4] = { 0, 2, 3, 1 };
+	for (uint i = 0; i < 16; ++i)
+	{
+		block.y |= indices[ProjectLevel(g_pixels[i], endpoint0, endpoint1, 3, 3)] << (i * 2);
+	}
+	return block;
+}
+
+uint2 EncodeBC4(uint channel)
+{
+	float4 min_color;
+	float4 max_color;
+	GetInsetRange(0.0f, min_color, max_color);
+	// red0 > red1 selects the 8 value mode
+	const uint red0 = uint(max_color[channel] + 0.5f);
+	const uint red1 = uint(min_color[channel] + 0.5f);
+	uint4 block = uint4(red0 | (red1 << 8), 0, 0, 0);
+	if (red0 == red1)
+	{
+		return block.xy;
+	}
+	for (uint i = 0; i < 16; ++i)
+	{
+		const uint level = ProjectLevel(float4(g_pixels[i][channel], 0.0f, 0.0f, 0.0f), float4(red0, 0.0f, 0.0f, 0.0f), float4(red1, 0.0f, 0.0f, 0.0f), 1, 7);
+		const uint index = level == 0 ? 0 : level == 7 ? 1 : level + 1;
+		InsertBits(block, 16 + i * 3, index, 3);
+	}
+	return block.xy;
+}
+
+// 7 bits per channel plus a p-bit shared by the channels, the p-bit giving the smaller error is kept
+void QuantizeMode6Endpoint(float4 endpoint, out uint4 quantized, out uint p_bit, out float4 decoded)
+{
+	quantized = 0;
+	p_bit = 0;
+	decoded = 0.0f;
+	float best_error = 3.402823466e+38f;
+	for (uint bit = 0; bit < 2; ++bit)
+	{
+		const uint4 candidate = uint4(clamp((endpoint - bit) * 0.5f + 0.5f, 0.0f, 127.0f));
+		const float4 difference = float4(candidate * 2 + bit) - endpoint;
+		float error = 0.0f;
+		for (uint c = 0; c < 4; ++c)
+		{
+			error += difference[c] * difference[c];
+		}
+		if (error < best_error)
+		{
+			best_error = error;
+			quantized = candidate;
+			p_bit = bit;
+			decoded = float4(candidate * 2 + bit);
+		}
+	}
+}
+
+uint4 EncodeBC7()
+{
+	float4 min_color;
+	float4 max_color;
+	GetInsetRange(1.0f / 32.0f, min_color, max_color);
+	uint4 quantized[2];
+	uint p_bits[2];
+	float4 endpoints[2];
+	QuantizeMode6Endpoint(min_color, quantized[0], p_bits[0], endpoints[0]);
+	QuantizeMode6Endpoint(max_color, quantized[1], p_bits[1], endpoints[1]);
+	uint levels[16];
+	for (uint i = 0; i < 16; ++i)
+	{
+		levels[i] = ProjectLevel(g_pixels[i], endpoints[0], endpoints[1], 4, 15);
+	}
+	// Most significant bit of the anchor index is implicit 0, swapping the endpoints flips every index
+	const uint first = levels[0] >= 8 ? 1 : 0;
+	uint4 block = 0;
+	// Mode 6 is 6 zeros and a one
+	InsertBits(block, 0, 1 << 6, 7);
+	for (uint c = 0; c < 4; ++c)
+	{
+		InsertBits(block, 7 + c * 14, quantized[first][c], 7);
+		InsertBits(block, 14 + c * 14, quantized[1 - first][c], 7);
+	}
+	InsertBits(block, 63, p_bits[first], 1);
+	InsertBits(block, 64, p_bits[1 - first], 1);
+	InsertBits(block, 65, first == 1 ? 15 - levels[0] : levels[0], 3);
+	for (uint j = 1; j < 16; ++j)
+	{
+		InsertBits(block, 68 + (j - 1) * 4, first == 1 ? 15 - levels[j] : levels[j], 4);
+	}
+	return block;
+}
+
+[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=8, b0)")]
+[numthreads(8, 8, 1)]
+void main
+(
+	const uint3 inDispatchThreadID : SV_DispatchThreadID
+)
+{
+	const uint2 block_id = inDispatchThreadID.xy;
+	if (any(block_id >= uint2(m_cbuffer.block_count_x, m_cbuffer.block_count_y)))
+	{
+		return;
+	}
+	RWTexture2D<float4> source = ResourceDescriptorHeap[m_cbuffer.source_bindless_index];
+	RWByteAddressBuffer destination = ResourceDescriptorHeap[m_cbuffer.destination_bindless_index];
+
+	// Edge blocks repeat the last row and column
+	const uint2 max_texel = uint2(m_cbuffer.mip_width, m_cbuffer.mip_height) - 1;
+	for (uint i = 0; i < 16; ++i)
+	{
+		const uint2 texel = min(block_id * 4 + uint2(i % 4, i / 4), max_texel);
+		// UNORM back to the 8 bit values
+		g_pixels[i] = round(source[texel] * 255.0f);
+	}
+
+#if BC_FORMAT == BC_FORMAT_BC1
+	const uint block_size = 8;
+	const uint4 block = uint4(EncodeBC1(), 0, 0);
+#elif BC_FORMAT == BC_FORMAT_BC4
+	const uint block_size = 8;
+	const uint4 block = uint4(EncodeBC4(0), 0, 0);
+#elif BC_FORMAT == BC_FORMAT_BC5
+	const uint block_size = 16;
+	const uint4 block = uint4(EncodeBC4(0), EncodeBC4(1));
+#else
+	const uint block_size = 16;
+	const uint4 block = EncodeBC7();
+#endif
+
+	const uint offset = m_cbuffer.destination_offset + block_id.y * m_cbuffer.row_pitch + block_id.x * block_size;
+	if (block_size == 8)
+	{
+		destination.Store2(offset, block.xy);
+	}
+	else
+	{
+		destination.Store4(offset, block);
+	}
+}
\ No newline at end of file
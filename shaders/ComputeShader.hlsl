@@ -1,23 +1,25 @@
 #include "Common.hlsl"
-// TODO shader assert readback
-// TODO shader printf readback
 //https://therealmjp.github.io/posts/hlsl-printf/
 // TODO shader printf GPU
 // TODO shader unit test readback
 // TODO shader debug draw
 //https://www.gijskaerts.com/wordpress/?p=190
 
-struct MyCBuffer
+struct ComputeConstants
 {
 	float iTime;
-	int iFrame;
-	int bindless_index;
+	uint iFrame;
+	uint bindless_index;
+	// Print and Assert channel, INVALID_BINDLESS_INDEX when not bound
+	uint debug_bindless_index;
 };
 
-ConstantBuffer<MyCBuffer> m_cbuffer : register(b0);
+ConstantBuffer<ComputeConstants> m_cbuffer : register(b0);
 
-//#define CHEAP_STAR
-#define JULIA
+// Axis declared by GetComputePermutationDesc in DX/ShaderManifest.cpp
+#if !defined(COMPUTE_MODE)
+#error COMPUTE_MODE is defined by the permutation, compile through ShaderPermutations
+#endif
 
 float cheap_star(float2 uv, float anim)
 {
@@ -149,10 +151,10 @@ void main
 	m_uav.GetDimensions(width, height);
 	float2 uv = (inDispatchThreadID.xy + 0.5f) / float2(width, height);
 	float3 out_color;
-#if defined(CHEAP_STAR)
+#if COMPUTE_MODE == COMPUTE_MODE_CHEAP_STAR
 	out_color = animate_star(uv, m_cbuffer.iTime);
 	out_color = sRGBToLinear(out_color);
-#elif defined(JULIA)
+#elif COMPUTE_MODE == COMPUTE_MODE_JULIA
 	Complex z0;
 	float maxFrame = 1000.0f;
 	float scale = lerp(0.75, 1.5, (m_cbuffer.iFrame) / maxFrame);
@@ -165,6 +167,7 @@ void main
 //	c.im = 0;
 	int N = 150;
 	float j = julia(z0, c, N);
+	Assert(m_cbuffer.debug_bindless_index, j <= N, SHADER_DEBUG_FORMAT_JULIA_ITERATIONS, inDispatchThreadID, j, N);
 	out_color = 0.5f + 0.5 * cos( 3.0 + j *0.15 + float3(0.0,0.6,1.0));
 
 	float noiseScale = 1.0f / 256.0f;
@@ -176,6 +179,7 @@ void main
 	out_color = float3(uv, 0.0f);
 	out_color = sRGBToLinear(out_color);
 #endif
+	Assert(m_cbuffer.debug_bindless_index, all(isfinite(out_color)), SHADER_DEBUG_FORMAT_NON_FINITE_COLOR, inDispatchThreadID, out_color.r, out_color.g, out_color.b);
 	// Presentation to display
 	m_uav[inDispatchThreadID.xy] = float4(LinearTosRGB(out_color), 1.0f);
 }
\ No newline at end of file
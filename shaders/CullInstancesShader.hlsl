@@ -0,0 +1,58 @@
+#include "Common.hlsl"
+#include "SharedLayouts.hlsl"
+
+struct CullConstants
+{
+	uint instance_count;
+	uint instance_bindless_index;
+	uint visible_bindless_index;
+	uint draw_args_bindless_index;
+	float2 view_offset;
+	float view_scale;
+	// Instances with a smaller clip space radius cover no pixels, cull them as well
+	float min_radius;
+};
+
+ConstantBuffer<CullConstants> m_cbuffer : register(b0);
+
+// Bounding radius of the triangle in VertexBuffer, before instance scale
+static const float g_instance_radius = 0.36f;
+// Byte offset of InstanceCount in D3D12_DRAW_ARGUMENTS
+static const uint g_instance_count_offset = 4;
+
+[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=8, b0)")]
+[numthreads(64, 1, 1)]
+void main
+(
+	const uint3 inDispatchThreadID : SV_DispatchThreadID
+)
+{
+	StructuredBuffer<InstanceTransform> instance_buffer = ResourceDescriptorHeap[m_cbuffer.instance_bindless_index];
+	RWStructuredBuffer<uint> visible_instances = ResourceDescriptorHeap[m_cbuffer.visible_bindless_index];
+	RWByteAddressBuffer draw_args = ResourceDescriptorHeap[m_cbuffer.draw_args_bindless_index];
+
+	const uint instance_index = inDispatchThreadID.x;
+	bool is_visible = false;
+	if (instance_index < m_cbuffer.instance_count)
+	{
+		InstanceTransform transform = instance_buffer[instance_index];
+		// Frustum test of the bounding circle against the clip space rectangle
+		float2 center = (transform.position + m_cbuffer.view_offset) * m_cbuffer.view_scale;
+		float radius = g_instance_radius * transform.scale * m_cbuffer.view_scale;
+		is_visible = all(abs(center) - radius < 1.0f) && radius >= m_cbuffer.min_radius;
+	}
+
+	// Compact across the wave, one atomic per wave instead of one per instance
+	const uint wave_visible_count = WaveActiveCountBits(is_visible);
+	uint wave_offset = 0;
+	if (WaveIsFirstLane() && wave_visible_count > 0)
+	{
+		draw_args.InterlockedAdd(g_instance_count_offset, wave_visible_count, wave_offset);
+	}
+	wave_offset = WaveReadLaneFirst(wave_offset);
+
+	if (is_visible)
+	{
+		visible_instances[wave_offset + WavePrefixCountBits(is_visible)] = instance_index;
+	}
+}
\ No newline at end of file
@@ -1,19 +1,14 @@
 #include "Common.hlsl"
+#include "SharedLayouts.hlsl"
 // TODO shader debug draw
 //https://www.gijskaerts.com/wordpress/?p=190
 
-struct Vertex
+struct FillVertexBufferConstants
 {
-	float2 position;
-	float3 color;
+	uint bindless_index;
 };
 
-struct MyCBuffer
-{
-	int bindless_index;
-};
-
-ConstantBuffer<MyCBuffer> m_cbuffer : register(b0);
+ConstantBuffer<FillVertexBufferConstants> m_cbuffer : register(b0);
 
 [RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=1, b0)")]
 [numthreads(1, 1, 1)]
@@ -0,0 +1,140 @@
+#include "Common.hlsl"
+
+// Full mip chain of an RGBA8 texture in a single dispatch, box filtered
+// Every group reduces a 64x64 tile of mip 0 down to 6 levels through groupshared memory
+// The last group to finish reduces mip 6, at most 64x64, down to the remaining levels so textures up to 4096 get their full chain
+// Mips are read and written through UAVs, the whole texture stays in UNORDERED_ACCESS
+struct GenerateMipsConstants
+{
+	// Levels written below mip 0, at most 12
+	uint mip_count;
+	// Filtered in linear, stored sRGB encoded
+	uint is_srgb;
+	// Groups done with the first 6 levels, zero before the dispatch
+	uint counter_bindless_index;
+	uint group_count;
+	// UAV of mip i in component i % 4 of vector i / 4
+	uint4 mip_bindless_indices0;
+	uint4 mip_bindless_indices1;
+	uint4 mip_bindless_indices2;
+	uint4 mip_bindless_indices3;
+};
+
+ConstantBuffer<GenerateMipsConstants> m_cbuffer : register(b0);
+
+// Levels reduced by one pass of a group
+static const uint g_pass_level_count = 6;
+
+groupshared float4 g_tile[16][16];
+groupshared bool g_is_last_group;
+
+uint GetMipBindlessIndex(uint mip)
+{
+	const uint4 indices = mip < 4 ? m_cbuffer.mip_bindless_indices0 : mip < 8 ? m_cbuffer.mip_bindless_indices1 : mip < 12 ? m_cbuffer.mip_bindless_indices2 : m_cbuffer.mip_bindless_indices3;
+	return indices[mip % 4];
+}
+
+uint2 GetMipSize(uint2 size, uint mip)
+{
+	return max(size >> mip, 1);
+}
+
+// Coherent, mip 6 is written by every group and read by the last one
+float4 LoadMip(uint mip, uint2 size, uint2 texel)
+{
+	globallycoherent RWTexture2D<float4> mip_texture = ResourceDescriptorHeap[GetMipBindlessIndex(mip)];
+	const float4 value = mip_texture[min(texel, GetMipSize(size, mip) - 1)];
+	return m_cbuffer.is_srgb ? float4(sRGBToLinear(value.rgb), value.a) : value;
+}
+
+void StoreMip(uint mip, uint2 size, uint2 texel, float4 value)
+{
+	if (all(texel < GetMipSize(size, mip)))
+	{
+		globallycoherent RWTexture2D<float4> mip_texture = ResourceDescriptorHeap[GetMipBindlessIndex(mip)];
+		mip_texture[texel] = m_cbuffer.is_srgb ? float4(LinearTosRGB(value.rgb), value.a) : value;
+	}
+}
+
+// Reduces the 64x64 tile of source_mip into up to 6 levels below it, level_count is uniform across the group
+void ReduceTile(uint source_mip, uint2 size, uint2 tile, uint2 thread, uint level_count)
+{
+	// First level, 2x2 texels per thread straight from the source
+	float4 sum = 0.0f;
+	[unroll]
+	for (uint i = 0; i < 4; ++i)
+	{
+		const uint2 texel = tile * 32 + thread * 2 + uint2(i & 1, i >> 1);
+		const float4 value =
+		(
+			LoadMip(source_mip, size, texel * 2) + LoadMip(source_mip, size, texel * 2 + uint2(1, 0)) +
+			LoadMip(source_mip, size, texel * 2 + uint2(0, 1)) + LoadMip(source_mip, size, texel * 2 + uint2(1, 1))
+		) * 0.25f;
+		StoreMip(source_mip + 1, size, texel, value);
+		sum += value;
+	}
+	if (level_count < 2)
+	{
+		return;
+	}
+
+	// Second level, one texel per thread, kept unquantized in groupshared for the next ones
+	const float4 value = sum * 0.25f;
+	StoreMip(source_mip + 2, size, tile * 16 + thread, value);
+	g_tile[thread.y][thread.x] = value;
+	for (uint level = 3; level <= level_count; ++level)
+	{
+		// Texels per side of the tile at this level
+		const uint level_size = 64 >> level;
+		const bool is_active = all(thread < level_size);
+		GroupMemoryBarrierWithGroupSync();
+		float4 reduced = 0.0f;
+		if (is_active)
+		{
+			const uint2 texel = thread * 2;
+			reduced = (g_tile[texel.y][texel.x] + g_tile[texel.y][texel.x + 1] + g_tile[texel.y + 1][texel.x] + g_tile[texel.y + 1][texel.x + 1]) * 0.25f;
+			StoreMip(source_mip + level, size, tile * level_size + thread, reduced);
+		}
+		GroupMemoryBarrierWithGroupSync();
+		if (is_active)
+		{
+			g_tile[thread.y][thread.x] = reduced;
+		}
+	}
+}
+
+[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=20, b0)")]
+[numthreads(16, 16, 1)]
+void main
+(
+	const uint3 inGroupID : SV_GroupID,
+	const uint3 inGroupThreadID : SV_GroupThreadID,
+	const uint inGroupIndex : SV_GroupIndex
+)
+{
+	RWTexture2D<float4> mip0 = ResourceDescriptorHeap[GetMipBindlessIndex(0)];
+	uint2 size;
+	mip0.GetDimensions(size.x, size.y);
+
+	ReduceTile(0, size, inGroupID.xy, inGroupThreadID.xy, min(m_cbuffer.mip_count, g_pass_level_count));
+	if (m_cbuffer.mip_count <= g_pass_level_count)
+	{
+		return;
+	}
+
+	// Mip 6 of this tile visible to the other groups before it is counted
+	DeviceMemoryBarrierWithGroupSync();
+	if (inGroupIndex == 0)
+	{
+		RWByteAddressBuffer counter = ResourceDescriptorHeap[m_cbuffer.counter_bindless_index];
+		uint finished_count;
+		counter.InterlockedAdd(0, 1, finished_count);
+		g_is_last_group = finished_count == m_cbuffer.group_count - 1;
+	}
+	GroupMemoryBarrierWithGroupSync();
+	if (!g_is_last_group)
+	{
+		return;
+	}
+	ReduceTile(g_pass_level_count, size, uint2(0, 0), inGroupThreadID.xy, m_cbuffer.mip_count - g_pass_level_count);
+}
\ No newline at end of file
@@ -10,12 +10,12 @@ struct D3D12_DRAW_ARGUMENTS
 	uint StartInstanceLocation;
 };
 
-struct MyCBuffer
+struct IndirectConstants
 {
-	int bindless_index;
+	uint bindless_index;
 };
 
-ConstantBuffer<MyCBuffer> m_cbuffer : register(b0);
+ConstantBuffer<IndirectConstants> m_cbuffer : register(b0);
 
 [RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=1, b0)")]
 [numthreads(1, 1, 1)]
@@ -11,7 +11,7 @@ struct PSOutput
 	float4 color : SV_TARGET;
 };
 
-[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=1, b0)")]
+[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=7, b0)")]
 PSOutput main(in const PSInput input) 
 {
 	PSOutput output = (PSOutput)0;
@@ -0,0 +1,5 @@
+// Format strings of shader Print and Assert, std::format syntax with {0} to {3} for the arguments
+// Shared by Common.hlsl for the ids and DX/DXShaderDebug.cpp for the strings, the id is the position in this list
+// SHADER_DEBUG_FORMAT(name, format)
+SHADER_DEBUG_FORMAT(NON_FINITE_COLOR, "Compute color is not finite: {0}, {1}, {2}")
+SHADER_DEBUG_FORMAT(JULIA_ITERATIONS, "Julia iterations {0:.2f} out of range, limit {1}")
\ No newline at end of file
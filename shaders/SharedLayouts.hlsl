@@ -0,0 +1,60 @@
+#pragma once
+// Buffer elements and work graph records also written or read by C++
+// Bindless access hides them from reflection, so the layout probe below binds each one for GenerateShaderBindings
+// which writes generated/SharedLayoutsBindings.h, regenerate after any change here
+
+struct Vertex
+{
+	float2 position : Position;
+	float3 color : Color;
+};
+
+struct InstanceTransform
+{
+	float2 position;
+	float scale;
+	float padding;
+};
+
+// Input records of the WORKGRAPH_TEST permutations
+struct IndexRecord
+{
+	uint index;
+};
+
+struct DispatchGridRecord
+{
+	uint3 DispatchGrid : SV_DispatchGrid;
+	uint index;
+};
+
+struct RecursionRecord
+{
+	uint depth;
+};
+
+struct SampleEntryRecord
+{
+	uint gridSize : SV_DispatchGrid;
+	uint recordIndex;
+};
+
+#if defined(SHARED_LAYOUT_PROBE)
+// Never dispatched, every layout has to be read to stay in the reflection
+StructuredBuffer<Vertex> g_vertex : register(t0);
+StructuredBuffer<InstanceTransform> g_instance_transform : register(t1);
+StructuredBuffer<IndexRecord> g_index_record : register(t2);
+StructuredBuffer<DispatchGridRecord> g_dispatch_grid_record : register(t3);
+StructuredBuffer<RecursionRecord> g_recursion_record : register(t4);
+StructuredBuffer<SampleEntryRecord> g_sample_entry_record : register(t5);
+RWByteAddressBuffer g_probe_output : register(u0);
+
+[numthreads(1, 1, 1)]
+void LayoutProbe()
+{
+	uint sum = asuint(g_vertex[0].position.x) + asuint(g_instance_transform[0].scale);
+	sum += g_index_record[0].index + g_dispatch_grid_record[0].index;
+	sum += g_recursion_record[0].depth + g_sample_entry_record[0].recordIndex;
+	g_probe_output.Store(0, sum);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "Common.hlsl"
+
+// Bilinear upscale of the dynamic resolution output to the full resolution
+struct UpsampleConstants
+{
+	uint source_bindless_index;
+	uint destination_bindless_index;
+};
+
+ConstantBuffer<UpsampleConstants> m_cbuffer : register(b0);
+
+[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=2, b0)")]
+[numthreads(8, 8, 1)]
+void main
+(
+	const uint3 inDispatchThreadID : SV_DispatchThreadID
+)
+{
+	Texture2D<float4> source = ResourceDescriptorHeap[m_cbuffer.source_bindless_index];
+	RWTexture2D<float4> destination = ResourceDescriptorHeap[m_cbuffer.destination_bindless_index];
+	uint2 source_size;
+	source.GetDimensions(source_size.x, source_size.y);
+	uint2 destination_size;
+	destination.GetDimensions(destination_size.x, destination_size.y);
+	if (any(inDispatchThreadID.xy >= destination_size))
+	{
+		return;
+	}
+
+	// Texel centers of the destination mapped onto the source
+	const float2 position = (inDispatchThreadID.xy + 0.5f) * float2(source_size) / float2(destination_size) - 0.5f;
+	const int2 base = int2(floor(position));
+	const float2 weight = position - base;
+	const int2 max_texel = int2(source_size) - 1;
+	const int2 texel00 = clamp(base, 0, max_texel);
+	const int2 texel11 = clamp(base + 1, 0, max_texel);
+
+	// Source holds sRGB encoded values, filter in linear
+	const float3 color00 = sRGBToLinear(source.Load(int3(texel00.x, texel00.y, 0)).rgb);
+	const float3 color10 = sRGBToLinear(source.Load(int3(texel11.x, texel00.y, 0)).rgb);
+	const float3 color01 = sRGBToLinear(source.Load(int3(texel00.x, texel11.y, 0)).rgb);
+	const float3 color11 = sRGBToLinear(source.Load(int3(texel11.x, texel11.y, 0)).rgb);
+	const float3 color = lerp(lerp(color00, color10, weight.x), lerp(color01, color11, weight.x), weight.y);
+	destination[inDispatchThreadID.xy] = float4(LinearTosRGB(color), 1.0f);
+}
\ No newline at end of file
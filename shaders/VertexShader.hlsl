@@ -1,10 +1,5 @@
 #include "Common.hlsl"
-
-struct VSInput
-{
-	float2 pos : Position;
-	float3 color : Color;
-};
+#include "SharedLayouts.hlsl"
 
 struct VSOutput
 {
@@ -12,23 +7,38 @@ struct VSOutput
 	float3 color : COLOR;
 };
 
-struct MyCBuffer
+// Fields of a cbuffer do not cross 16 byte boundaries, view_offset stays within the first 16 bytes
+struct DrawConstants
 {
-	int bindless_index;
+	uint bindless_index;
+	uint instance_bindless_index;
+	float2 view_offset;
+	// INVALID_BINDLESS_INDEX draws every instance, otherwise indexes the compacted list of the culling pass
+	uint visible_bindless_index;
+	float view_scale;
+	// SV_InstanceID ignores StartInstanceLocation, draws split in instance ranges pass their start here
+	uint instance_offset;
 };
 
-ConstantBuffer<MyCBuffer> m_cbuffer : register(b0);
+ConstantBuffer<DrawConstants> m_cbuffer : register(b0);
 
-[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=1, b0)")]
+[RootSignature(ROOTFLAGS_DEFAULT ", RootConstants(num32BitConstants=7, b0)")]
 VSOutput main(uint vertex_id : SV_VERTEXID, uint instance_id : SV_InstanceID) 
 {
-	StructuredBuffer<VSInput> vertex_buffer = ResourceDescriptorHeap[m_cbuffer.bindless_index];
-	VSInput input = vertex_buffer[vertex_id];
+	StructuredBuffer<Vertex> vertex_buffer = ResourceDescriptorHeap[m_cbuffer.bindless_index];
+	Vertex input = vertex_buffer[vertex_id];
+
+	uint instance_index = m_cbuffer.instance_offset + instance_id;
+	if (m_cbuffer.visible_bindless_index != INVALID_BINDLESS_INDEX)
+	{
+		StructuredBuffer<uint> visible_instances = ResourceDescriptorHeap[m_cbuffer.visible_bindless_index];
+		instance_index = visible_instances[instance_index];
+	}
+	StructuredBuffer<InstanceTransform> instance_buffer = ResourceDescriptorHeap[m_cbuffer.instance_bindless_index];
+	InstanceTransform transform = instance_buffer[instance_index];
 
 	VSOutput output = (VSOutput)0;
-	output.pos = float4(input.pos, 0, 1);
-	output.pos.xy /= 6;
-	output.pos += float4(-1 + 0.25f + (instance_id % 4) * 0.5f, -0.75f + (instance_id / 4) * 0.5f, 0, 0);
+	output.pos = float4((input.position * transform.scale + transform.position + m_cbuffer.view_offset) * m_cbuffer.view_scale, 0, 1);
 	
     output.color = input.color;
 	return output;
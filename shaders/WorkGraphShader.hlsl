@@ -1,12 +1,12 @@
 GlobalRootSignature globalRS = { "UAV(u0)" };
 globallycoherent RWStructuredBuffer<uint> UAV : register(u0); // 16MB byte buffer from global root sig
-//#define WORKGRAPH_TEST1
-//#define WORKGRAPH_TEST2
-//#define WORKGRAPH_TEST3
-//#define WORKGRAPH_TEST4
-//#define WORKGRAPH_TEST5
-//#define WORKGRAPH_TEST6
-#if defined(WORKGRAPH_TEST1)
+// Entry records filled by C++ come from here, records between nodes stay local
+#include "SharedLayouts.hlsl"
+// Axis declared by g_workgraph_tests in DX/ShaderManifest.cpp, which also holds the input records of each test
+#if !defined(WORKGRAPH_TEST)
+#error WORKGRAPH_TEST is defined by the permutation, compile through ShaderPermutations
+#endif
+#if WORKGRAPH_TEST == WORKGRAPH_TEST_BROADCAST
 
 [Shader("node")]
 [NodeLaunch("broadcasting")]
@@ -17,11 +17,8 @@ void BroadcastNode()
 	InterlockedAdd(UAV[0], 123);
 }
 
-#elif defined(WORKGRAPH_TEST2)
-struct InputRecord
-{
-	uint index;
-};
+#elif WORKGRAPH_TEST == WORKGRAPH_TEST_BROADCAST_RECORD
+typedef IndexRecord InputRecord;
 
 [Shader("node")]
 [NodeLaunch("broadcasting")]
@@ -32,12 +29,8 @@ void BroadcastNode(DispatchNodeInputRecord<InputRecord> inputData)
 	InterlockedAdd(UAV[inputData.Get().index * 4], 124);
 }
 
-#elif defined(WORKGRAPH_TEST3)
-struct InputRecord
-{
-	uint3 DispatchGrid : SV_DispatchGrid;
-	uint index;
-};
+#elif WORKGRAPH_TEST == WORKGRAPH_TEST_DISPATCH_GRID
+typedef DispatchGridRecord InputRecord;
 
 [Shader("node")]
 [NodeLaunch("broadcasting")]
@@ -47,7 +40,7 @@ void BroadcastNode(DispatchNodeInputRecord<InputRecord> inputData)
 {
 	InterlockedAdd(UAV[inputData.Get().index * 4], 1);
 }
-#elif defined(WORKGRAPH_TEST4)
+#elif WORKGRAPH_TEST == WORKGRAPH_TEST_NODE_OUTPUT
 struct InputRecord
 {
 	uint index;
@@ -73,7 +66,7 @@ void SecondNode(DispatchNodeInputRecord<InputRecord> inputData)
 	InterlockedAdd(UAV[inputData.Get().index * 4], 1);
 }
 
-#elif defined(WORKGRAPH_TEST5)
+#elif WORKGRAPH_TEST == WORKGRAPH_TEST_COALESCING
 struct InputRecord
 {
 	uint index;
@@ -111,11 +104,8 @@ void SecondNode
 		//InterlockedAdd(UAV[GroupIndex], 1);
 	}
 }
-#elif defined(WORKGRAPH_TEST6)
-struct InputRecord
-{
-	uint depth;
-};
+#elif WORKGRAPH_TEST == WORKGRAPH_TEST_RECURSION
+typedef RecursionRecord InputRecord;
 
 [Shader("node")]
 [NodeLaunch("broadcasting")]
@@ -138,13 +128,9 @@ void RecursiveNode
 		record.OutputComplete();
 	}
 }
-#else
+#elif WORKGRAPH_TEST == WORKGRAPH_TEST_SAMPLE
 
-struct entryRecord
-{
-    uint gridSize : SV_DispatchGrid;
-    uint recordIndex;
-};
+typedef SampleEntryRecord entryRecord;
 
 struct secondNodeInput
 {
@@ -0,0 +1,30 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of CompressBCShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 8 constants
+struct CompressBCConstants
+{
+	uint32 source_bindless_index;
+	uint32 destination_bindless_index;
+	uint32 destination_offset;
+	uint32 row_pitch;
+	uint32 block_count_x;
+	uint32 block_count_y;
+	uint32 mip_width;
+	uint32 mip_height;
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 8;
+};
+static_assert(offsetof(CompressBCConstants, source_bindless_index) == 0);
+static_assert(offsetof(CompressBCConstants, destination_bindless_index) == 4);
+static_assert(offsetof(CompressBCConstants, destination_offset) == 8);
+static_assert(offsetof(CompressBCConstants, row_pitch) == 12);
+static_assert(offsetof(CompressBCConstants, block_count_x) == 16);
+static_assert(offsetof(CompressBCConstants, block_count_y) == 20);
+static_assert(offsetof(CompressBCConstants, mip_width) == 24);
+static_assert(offsetof(CompressBCConstants, mip_height) == 28);
+static_assert(sizeof(CompressBCConstants) == 32);
+static_assert(sizeof(CompressBCConstants) <= CompressBCConstants::g_root_constant_count * sizeof(uint32));
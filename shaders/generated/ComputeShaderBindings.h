@@ -0,0 +1,22 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of ComputeShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 4 constants
+struct ComputeConstants
+{
+	float32 iTime;
+	uint32 iFrame;
+	uint32 bindless_index;
+	uint32 debug_bindless_index;
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 4;
+};
+static_assert(offsetof(ComputeConstants, iTime) == 0);
+static_assert(offsetof(ComputeConstants, iFrame) == 4);
+static_assert(offsetof(ComputeConstants, bindless_index) == 8);
+static_assert(offsetof(ComputeConstants, debug_bindless_index) == 12);
+static_assert(sizeof(ComputeConstants) == 16);
+static_assert(sizeof(ComputeConstants) <= ComputeConstants::g_root_constant_count * sizeof(uint32));
@@ -0,0 +1,28 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of CullInstancesShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 8 constants
+struct CullConstants
+{
+	uint32 instance_count;
+	uint32 instance_bindless_index;
+	uint32 visible_bindless_index;
+	uint32 draw_args_bindless_index;
+	float32 view_offset[2];
+	float32 view_scale;
+	float32 min_radius;
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 8;
+};
+static_assert(offsetof(CullConstants, instance_count) == 0);
+static_assert(offsetof(CullConstants, instance_bindless_index) == 4);
+static_assert(offsetof(CullConstants, visible_bindless_index) == 8);
+static_assert(offsetof(CullConstants, draw_args_bindless_index) == 12);
+static_assert(offsetof(CullConstants, view_offset) == 16);
+static_assert(offsetof(CullConstants, view_scale) == 24);
+static_assert(offsetof(CullConstants, min_radius) == 28);
+static_assert(sizeof(CullConstants) == 32);
+static_assert(sizeof(CullConstants) <= CullConstants::g_root_constant_count * sizeof(uint32));
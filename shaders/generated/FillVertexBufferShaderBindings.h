@@ -0,0 +1,16 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of FillVertexBufferShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 1 constants
+struct FillVertexBufferConstants
+{
+	uint32 bindless_index;
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 1;
+};
+static_assert(offsetof(FillVertexBufferConstants, bindless_index) == 0);
+static_assert(sizeof(FillVertexBufferConstants) == 4);
+static_assert(sizeof(FillVertexBufferConstants) <= FillVertexBufferConstants::g_root_constant_count * sizeof(uint32));
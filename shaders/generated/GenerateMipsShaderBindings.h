@@ -0,0 +1,30 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of GenerateMipsShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 20 constants
+struct GenerateMipsConstants
+{
+	uint32 mip_count;
+	uint32 is_srgb;
+	uint32 counter_bindless_index;
+	uint32 group_count;
+	uint32 mip_bindless_indices0[4];
+	uint32 mip_bindless_indices1[4];
+	uint32 mip_bindless_indices2[4];
+	uint32 mip_bindless_indices3[4];
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 20;
+};
+static_assert(offsetof(GenerateMipsConstants, mip_count) == 0);
+static_assert(offsetof(GenerateMipsConstants, is_srgb) == 4);
+static_assert(offsetof(GenerateMipsConstants, counter_bindless_index) == 8);
+static_assert(offsetof(GenerateMipsConstants, group_count) == 12);
+static_assert(offsetof(GenerateMipsConstants, mip_bindless_indices0) == 16);
+static_assert(offsetof(GenerateMipsConstants, mip_bindless_indices1) == 32);
+static_assert(offsetof(GenerateMipsConstants, mip_bindless_indices2) == 48);
+static_assert(offsetof(GenerateMipsConstants, mip_bindless_indices3) == 64);
+static_assert(sizeof(GenerateMipsConstants) == 80);
+static_assert(sizeof(GenerateMipsConstants) <= GenerateMipsConstants::g_root_constant_count * sizeof(uint32));
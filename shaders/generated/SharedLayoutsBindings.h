@@ -0,0 +1,62 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of SharedLayouts.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// Element of g_vertex : register(t0, space0)
+struct Vertex
+{
+	float32 position[2];
+	float32 color[3];
+};
+static_assert(offsetof(Vertex, position) == 0);
+static_assert(offsetof(Vertex, color) == 8);
+static_assert(sizeof(Vertex) == 20);
+
+// Element of g_instance_transform : register(t1, space0)
+struct InstanceTransform
+{
+	float32 position[2];
+	float32 scale;
+	float32 padding;
+};
+static_assert(offsetof(InstanceTransform, position) == 0);
+static_assert(offsetof(InstanceTransform, scale) == 8);
+static_assert(offsetof(InstanceTransform, padding) == 12);
+static_assert(sizeof(InstanceTransform) == 16);
+
+// Element of g_index_record : register(t2, space0)
+struct IndexRecord
+{
+	uint32 index;
+};
+static_assert(offsetof(IndexRecord, index) == 0);
+static_assert(sizeof(IndexRecord) == 4);
+
+// Element of g_dispatch_grid_record : register(t3, space0)
+struct DispatchGridRecord
+{
+	uint32 DispatchGrid[3];
+	uint32 index;
+};
+static_assert(offsetof(DispatchGridRecord, DispatchGrid) == 0);
+static_assert(offsetof(DispatchGridRecord, index) == 12);
+static_assert(sizeof(DispatchGridRecord) == 16);
+
+// Element of g_recursion_record : register(t4, space0)
+struct RecursionRecord
+{
+	uint32 depth;
+};
+static_assert(offsetof(RecursionRecord, depth) == 0);
+static_assert(sizeof(RecursionRecord) == 4);
+
+// Element of g_sample_entry_record : register(t5, space0)
+struct SampleEntryRecord
+{
+	uint32 gridSize;
+	uint32 recordIndex;
+};
+static_assert(offsetof(SampleEntryRecord, gridSize) == 0);
+static_assert(offsetof(SampleEntryRecord, recordIndex) == 4);
+static_assert(sizeof(SampleEntryRecord) == 8);
@@ -0,0 +1,18 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of UpsampleShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 2 constants
+struct UpsampleConstants
+{
+	uint32 source_bindless_index;
+	uint32 destination_bindless_index;
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 2;
+};
+static_assert(offsetof(UpsampleConstants, source_bindless_index) == 0);
+static_assert(offsetof(UpsampleConstants, destination_bindless_index) == 4);
+static_assert(sizeof(UpsampleConstants) == 8);
+static_assert(sizeof(UpsampleConstants) <= UpsampleConstants::g_root_constant_count * sizeof(uint32));
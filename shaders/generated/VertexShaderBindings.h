@@ -0,0 +1,26 @@
+#pragma once
+// Generated by GenerateShaderBindings from the reflection of VertexShader.hlsl, do not edit
+#include "../../core/Types.h"
+#include <cstddef>
+
+// ConstantBuffer m_cbuffer : register(b0, space0), root parameter 0 with 7 constants
+struct DrawConstants
+{
+	uint32 bindless_index;
+	uint32 instance_bindless_index;
+	float32 view_offset[2];
+	uint32 visible_bindless_index;
+	float32 view_scale;
+	uint32 instance_offset;
+
+	static constexpr uint32 g_root_parameter_index = 0;
+	static constexpr uint32 g_root_constant_count = 7;
+};
+static_assert(offsetof(DrawConstants, bindless_index) == 0);
+static_assert(offsetof(DrawConstants, instance_bindless_index) == 4);
+static_assert(offsetof(DrawConstants, view_offset) == 8);
+static_assert(offsetof(DrawConstants, visible_bindless_index) == 16);
+static_assert(offsetof(DrawConstants, view_scale) == 20);
+static_assert(offsetof(DrawConstants, instance_offset) == 24);
+static_assert(sizeof(DrawConstants) == 28);
+static_assert(sizeof(DrawConstants) <= DrawConstants::g_root_constant_count * sizeof(uint32));